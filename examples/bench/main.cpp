@@ -0,0 +1,189 @@
+/**
+ * @file
+ *
+ * @brief Widget hierarchy benchmarks
+ *
+ * Measures the cost of building and tearing down containers with large numbers of children (such
+ * as point markers on a plot, or the keys of a keypad grid), both one child at a time and with the
+ * bulk child operations. Times are reported per child, so they should stay roughly constant as
+ * the number of children grows.
+ *
+ * It also reports the size of each widget class, and the memory used by the widgets on the screen
+ * (as accounted in the widgets memory category) once all children have been added.
+ */
+#include <shittygui/MemoryStats.h>
+#include <shittygui/Screen.h>
+#include <shittygui/ViewController.h>
+#include <shittygui/Widgets/Button.h>
+#include <shittygui/Widgets/Checkbox.h>
+#include <shittygui/Widgets/Container.h>
+#include <shittygui/Widgets/ImageView.h>
+#include <shittygui/Widgets/Label.h>
+#include <shittygui/Widgets/PageView.h>
+#include <shittygui/Widgets/ProgressBar.h>
+#include <shittygui/Widgets/RadioButton.h>
+#include <shittygui/Widgets/TextField.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/// Screen dimensions
+constexpr static const shittygui::Size kScreenSize{800, 480};
+/// Size of each child widget
+constexpr static const shittygui::Size kChildSize{4, 4};
+
+/**
+ * @brief View controller holding the container under test
+ */
+class BenchViewController: public shittygui::ViewController {
+    public:
+        BenchViewController() {
+            this->root = shittygui::MakeWidget<shittygui::widgets::Container>({0, 0},
+                    kScreenSize);
+        }
+
+        std::shared_ptr<shittygui::Widget> &getWidget() override {
+            return this->root;
+        }
+
+    private:
+        std::shared_ptr<shittygui::Widget> root;
+};
+
+/**
+ * @brief Create the given number of child widgets
+ *
+ * Children are laid out in a grid; every other child is transparent, so that the container's
+ * transparency bookkeeping is exercised.
+ */
+static std::vector<std::shared_ptr<shittygui::Widget>> MakeChildren(const size_t count) {
+    std::vector<std::shared_ptr<shittygui::Widget>> children;
+    children.reserve(count);
+
+    const auto perRow = kScreenSize.width / kChildSize.width;
+
+    for(size_t i = 0; i < count; i++) {
+        const shittygui::Point origin{
+            static_cast<int16_t>((i % perRow) * kChildSize.width),
+            static_cast<int16_t>(((i / perRow) * kChildSize.height) % kScreenSize.height)
+        };
+
+        auto child = shittygui::MakeWidget<shittygui::widgets::Container>(origin, kChildSize);
+        child->setDrawsBorder(false);
+        child->setBorderRadius(0.);
+        if(i & 1) {
+            child->setBackgroundColor({0, 0, 0, 0});
+        }
+
+        children.emplace_back(std::move(child));
+    }
+
+    return children;
+}
+
+/**
+ * @brief Print the time taken per child since the given start time
+ */
+static void Report(const char *what, const size_t count, const Clock::time_point start) {
+    const auto nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start)
+        .count();
+    printf("%8zu children: %-24s %10.1f ns/child\n", count, what,
+            static_cast<double>(nsec) / count);
+}
+
+/**
+ * @brief Print the size of each widget class
+ */
+static void PrintSizes() {
+    using namespace shittygui;
+    using namespace shittygui::widgets;
+
+    const std::pair<const char *, size_t> sizes[]{
+        {"Widget", sizeof(Widget)},
+        {"Button", sizeof(Button)},
+        {"Checkbox", sizeof(Checkbox)},
+        {"Container", sizeof(Container)},
+        {"ImageView", sizeof(ImageView)},
+        {"Label", sizeof(Label)},
+        {"PageView", sizeof(PageView)},
+        {"ProgressBar", sizeof(ProgressBar)},
+        {"RadioButton", sizeof(RadioButton)},
+        {"TextField", sizeof(TextField)},
+    };
+
+    for(const auto &[name, size] : sizes) {
+        printf("sizeof(%s)%*s %6zu bytes\n", name, static_cast<int>(16 - strlen(name)), "",
+                size);
+    }
+}
+
+/**
+ * @brief Print the memory used by the widgets on the screen
+ */
+static void ReportMemory(const std::shared_ptr<shittygui::Screen> &screen, const size_t count) {
+    const auto bytes = screen->getMemoryStats()[shittygui::MemoryCategory::Widgets].current;
+    printf("%8zu children: %-24s %10zu bytes (%.1f bytes/child)\n", count, "widget memory",
+            bytes, static_cast<double>(bytes) / count);
+}
+
+/**
+ * @brief Run all benchmarks with the given number of children
+ */
+static void Run(const std::shared_ptr<shittygui::Screen> &screen,
+        const std::shared_ptr<shittygui::Widget> &root, const size_t count) {
+    auto children = MakeChildren(count);
+
+    // one at a time
+    auto start = Clock::now();
+    for(const auto &child : children) {
+        root->addChild(child);
+    }
+    Report("addChild", count, start);
+
+    start = Clock::now();
+    for(const auto &child : children) {
+        root->removeChild(child);
+    }
+    Report("removeChild", count, start);
+
+    // bulk operations
+    start = Clock::now();
+    root->addChildren(children);
+    Report("addChildren", count, start);
+    ReportMemory(screen, count);
+
+    start = Clock::now();
+    root->removeChildren([](const auto &child) {
+        return child->getFrame().origin.x % 8 == 0;
+    });
+    root->removeChildren([](const auto &) {
+        return true;
+    });
+    Report("removeChildren", count, start);
+}
+
+int main(int argc, const char **argv) {
+    size_t maxChildren{10000};
+    if(argc > 1) {
+        maxChildren = std::strtoul(argv[1], nullptr, 10);
+    }
+
+    PrintSizes();
+
+    auto screen = std::make_shared<shittygui::Screen>(shittygui::Screen::PixelFormat::ARGB32,
+            kScreenSize);
+
+    auto vc = std::make_shared<BenchViewController>();
+    screen->setRootViewController(vc);
+
+    for(size_t count = 100; count <= maxChildren; count *= 10) {
+        Run(screen, vc->getWidget(), count);
+    }
+}
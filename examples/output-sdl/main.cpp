@@ -13,12 +13,16 @@
 #include <shittygui/Widgets/Label.h>
 #include <shittygui/Widgets/ProgressBar.h>
 #include <shittygui/Widgets/RadioButton.h>
+#include <shittygui/Widgets/TextField.h>
 
 #include <SDL.h>
 
 #include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <future>
 #include <iostream>
 #include <memory>
 
@@ -102,6 +106,15 @@ class SecondTestViewController: public shittygui::ViewController {
             });
             cont->addChild(butt);
 
+            // text entry
+            auto field = shittygui::MakeWidget<shittygui::widgets::TextField>({10, 400}, {300, 38},
+                    "type here");
+            field->setReturnCallback([](auto whomst) {
+                auto field = std::dynamic_pointer_cast<shittygui::widgets::TextField>(whomst);
+                std::cout << "entered: " << field->getText() << std::endl;
+            });
+            cont->addChild(field);
+
             // store it as the root
             this->view = std::move(cont);
         }
@@ -292,6 +305,17 @@ static void InitScreen(const std::shared_ptr<shittygui::Screen> &screen) {
     screen->setRootViewController(vc);
 }
 
+/**
+ * @brief Convert an SDL event timestamp to a touch timestamp
+ *
+ * SDL timestamps are milliseconds since SDL was initialized; convert them based on their age
+ * relative to the current tick count.
+ */
+static shittygui::event::Touch::Clock::time_point ConvertTimestamp(const uint32_t timestamp) {
+    const auto age = std::chrono::milliseconds(SDL_GetTicks() - timestamp);
+    return shittygui::event::Touch::Clock::now() - age;
+}
+
 /**
  * @brief Insert a touch event into the screen's event queue
  *
@@ -308,7 +332,7 @@ static void InsertTouchEvent(const std::shared_ptr<shittygui::Screen> &screen,
     // touch event
     else if(event.button == SDL_BUTTON_LEFT) {
         screen->queueEvent(shittygui::event::Touch(shittygui::Point(event.x, event.y),
-                    (event.state == SDL_PRESSED)));
+                    (event.state == SDL_PRESSED), ConvertTimestamp(event.timestamp)));
     }
 }
 
@@ -325,7 +349,7 @@ static void InsertTouchEvent(const std::shared_ptr<shittygui::Screen> &screen,
     }
 
     screen->queueEvent(shittygui::event::Touch(shittygui::Point(event.x, event.y),
-                (event.state & SDL_BUTTON_LMASK)));
+                (event.state & SDL_BUTTON_LMASK), ConvertTimestamp(event.timestamp)));
 }
 
 /**
@@ -338,6 +362,80 @@ static void InsertScrollEvent(const std::shared_ptr<shittygui::Screen> &screen,
     screen->queueEvent(shittygui::event::Scroll(std::ceil(event.preciseY)));
 }
 
+/**
+ * @brief Insert a key event for an editing key
+ *
+ * Keys that don't correspond to an editing key are ignored; text is handled separately, by
+ * InsertTextEvent().
+ */
+static void InsertKeyEvent(const std::shared_ptr<shittygui::Screen> &screen,
+        const SDL_KeyboardEvent &event) {
+    using Key = shittygui::event::Key;
+
+    switch(event.keysym.sym) {
+        case SDLK_BACKSPACE:
+            screen->queueEvent(Key(Key::Backspace));
+            break;
+        case SDLK_DELETE:
+            screen->queueEvent(Key(Key::Delete));
+            break;
+        case SDLK_LEFT:
+            screen->queueEvent(Key(Key::Left));
+            break;
+        case SDLK_RIGHT:
+            screen->queueEvent(Key(Key::Right));
+            break;
+        case SDLK_HOME:
+            screen->queueEvent(Key(Key::Home));
+            break;
+        case SDLK_END:
+            screen->queueEvent(Key(Key::End));
+            break;
+        case SDLK_RETURN:
+            screen->queueEvent(Key(Key::Enter));
+            break;
+    }
+}
+
+/**
+ * @brief Insert a key event for each character of text input
+ *
+ * The UTF-8 encoded input text is decoded into code points.
+ */
+static void InsertTextEvent(const std::shared_ptr<shittygui::Screen> &screen,
+        const SDL_TextInputEvent &event) {
+    const auto *str = reinterpret_cast<const uint8_t *>(event.text);
+
+    while(*str) {
+        char32_t cp;
+        size_t len;
+
+        if(*str < 0x80) {
+            cp = *str;
+            len = 1;
+        } else if((*str & 0xE0) == 0xC0) {
+            cp = *str & 0x1F;
+            len = 2;
+        } else if((*str & 0xF0) == 0xE0) {
+            cp = *str & 0x0F;
+            len = 3;
+        } else {
+            cp = *str & 0x07;
+            len = 4;
+        }
+
+        for(size_t i = 1; i < len; i++) {
+            if((str[i] & 0xC0) != 0x80) {
+                return;
+            }
+            cp = (cp << 6) | (str[i] & 0x3F);
+        }
+
+        screen->queueEvent(shittygui::event::Key(cp));
+        str += len;
+    }
+}
+
 /**
  * Application entry point
  */
@@ -390,6 +488,11 @@ int main(const int argc, const char **argv) {
         printf("UI scale: %g\n", uiScale);
 
         screen->setScaleFactor(uiScale);
+
+        // render at window resolution and scale up, rather than rendering at full resolution
+        if(getenv("SHITTYGUI_UPSCALE")) {
+            screen->setScaleMode(shittygui::Screen::ScaleMode::Upscale);
+        }
     }
 
     InitScreen(screen);
@@ -414,8 +517,10 @@ int main(const int argc, const char **argv) {
      * here simplifies the code considerably, but may lead to various graphical artifacts.
      *
      * We simulate a rotary encoder with the mouse wheel; rotate it vertically to scroll, and click
-     * it to simulate the encoder "select" button.
+     * it to simulate the encoder "select" button. Press Ctrl+P to save a screenshot.
      */
+    std::future<shittygui::Screen::CaptureResult> capture;
+
     while(gRun) {
         // process events
         SDL_Event e;
@@ -436,7 +541,20 @@ int main(const int argc, const char **argv) {
                     InsertScrollEvent(screen, e.wheel);
                     break;
 
-                // TODO: key events
+                // take a screenshot with Ctrl+P; other keys are editing keys
+                case SDL_KEYDOWN:
+                    if(e.key.keysym.sym == SDLK_p && (e.key.keysym.mod & KMOD_CTRL)) {
+                        if(!capture.valid()) {
+                            capture = screen->captureAsync();
+                        }
+                    } else {
+                        InsertKeyEvent(screen, e.key);
+                    }
+                    break;
+                // text input
+                case SDL_TEXTINPUT:
+                    InsertTextEvent(screen, e.text);
+                    break;
 
                 // terminate the application
                 case SDL_QUIT:
@@ -449,11 +567,37 @@ int main(const int argc, const char **argv) {
         screen->processEvents();
         screen->handleAnimations();
 
-        // redraw the screen, if it indicates that it's dirty. this is slow and shitty (lol)
+        // redraw the screen, if it indicates that it's dirty; then upload only the changed parts
         if(screen->isDirty()) {
             screen->redraw();
 
-            SDL_UpdateTexture(inTex, nullptr, screen->getBuffer(), screen->getBufferStride());
+            const auto buffer = reinterpret_cast<uint8_t *>(screen->getBuffer());
+            const auto stride = screen->getBufferStride();
+
+            for(const auto &damage : screen->getLastDamage()) {
+                const auto rect = screen->convertToFramebuffer(damage);
+                if(rect.isEmpty()) {
+                    continue;
+                }
+
+                const SDL_Rect sdlRect{rect.origin.x, rect.origin.y, rect.size.width,
+                    rect.size.height};
+                const auto offset = (rect.origin.y * stride) + (rect.origin.x * 4);
+
+                SDL_UpdateTexture(inTex, &sdlRect, buffer + offset, stride);
+            }
+        }
+
+        // write out the screenshot once it's been encoded
+        if(capture.valid() &&
+                capture.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            const auto result = capture.get();
+
+            if(auto fp = fopen("screenshot.png", "wb")) {
+                fwrite(result.data.data(), 1, result.data.size(), fp);
+                fclose(fp);
+                printf("wrote screenshot (%ux%u)\n", result.size.width, result.size.height);
+            }
         }
 
         // update display
@@ -0,0 +1,175 @@
+/**
+ * @file
+ *
+ * @brief Refresh planner benchmarks
+ *
+ * Replays damage patterns through the refresh planner with the cost models of a few typical slow
+ * panels, and compares the estimated cost of the planned transfers against sending each damaged
+ * region as is. Pass the path to a frame recording (see FrameRecorder) to replay the damage
+ * recorded in it; otherwise, a set of synthetic patterns is used.
+ */
+#include <shittygui/FrameRecorder.h>
+#include <shittygui/RefreshPlanner.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using CostModel = shittygui::RefreshPlanner::CostModel;
+
+/// Screen dimensions used for the synthetic patterns
+constexpr static const shittygui::Size kScreenSize{320, 240};
+/// Number of frames in each synthetic pattern
+constexpr static const size_t kNumFrames{500};
+
+/**
+ * @brief A named cost model
+ */
+struct Panel {
+    const char *name;
+    CostModel model;
+};
+
+/**
+ * @brief A named sequence of damaged regions
+ */
+struct Pattern {
+    std::string name;
+    shittygui::Size size;
+    std::vector<std::vector<shittygui::Rect>> frames;
+};
+
+/**
+ * @brief Cost models of some typical panels
+ *
+ * Costs are in microseconds.
+ */
+static const Panel gPanels[]{
+    // 16bpp TFT on a 40MHz SPI bus: window setup commands, then 0.4µs per pixel
+    {"spi-tft", {.perTransfer = 30, .perPixel = .4, .maxTransferPixels = 4096}},
+    // 1bpp memory LCD on a 2MHz bus: full rows with a per-row address
+    {"memory-lcd", {.perTransfer = 10, .perRow = 8, .perPixel = .5, .fullRows = true}},
+    // e-paper with partial refresh: large fixed cost, byte aligned windows, at most 4 per frame
+    {"e-paper", {.perTransfer = 2000, .perPixel = .02, .alignX = 8, .maxTransfers = 4}},
+};
+
+/**
+ * @brief Generate a random rectangle of the given size somewhere on screen
+ */
+static shittygui::Rect RandomRect(std::mt19937 &rng, const uint16_t width,
+        const uint16_t height) {
+    std::uniform_int_distribution<int> x(0, kScreenSize.width - width),
+        y(0, kScreenSize.height - height);
+    return shittygui::Rect({static_cast<int16_t>(x(rng)), static_cast<int16_t>(y(rng))},
+            shittygui::Size(width, height));
+}
+
+/**
+ * @brief Generate the synthetic damage patterns
+ */
+static std::vector<Pattern> MakePatterns() {
+    std::mt19937 rng(1234);
+    std::vector<Pattern> patterns;
+
+    // a blinking caret and a clock label
+    Pattern caret{"caret+clock", kScreenSize, {}};
+    for(size_t i = 0; i < kNumFrames; i++) {
+        caret.frames.push_back({
+            shittygui::Rect({40, 100}, shittygui::Size(2, 16)),
+            shittygui::Rect({260, 4}, shittygui::Size(56, 14)),
+        });
+    }
+    patterns.emplace_back(std::move(caret));
+
+    // many tiny scattered updates (status icons, sparklines)
+    Pattern scattered{"scattered", kScreenSize, {}};
+    for(size_t i = 0; i < kNumFrames; i++) {
+        std::vector<shittygui::Rect> frame;
+        for(size_t j = 0; j < 40; j++) {
+            frame.emplace_back(RandomRect(rng, 8, 8));
+        }
+        scattered.frames.emplace_back(std::move(frame));
+    }
+    patterns.emplace_back(std::move(scattered));
+
+    // a column of list rows being updated, plus a scroll indicator
+    Pattern list{"list", kScreenSize, {}};
+    for(size_t i = 0; i < kNumFrames; i++) {
+        std::vector<shittygui::Rect> frame;
+        for(int16_t row = 0; row < 8; row++) {
+            if((i + row) % 3) {
+                frame.emplace_back(shittygui::Point(8, static_cast<int16_t>(20 + row * 26)),
+                        shittygui::Size(290, 24));
+            }
+        }
+        frame.emplace_back(shittygui::Point(306, static_cast<int16_t>(20 + (i % 180))),
+                shittygui::Size(6, 40));
+        list.frames.emplace_back(std::move(frame));
+    }
+    patterns.emplace_back(std::move(list));
+
+    return patterns;
+}
+
+/**
+ * @brief Read the damage of each frame in a recording
+ */
+static Pattern LoadRecording(const char *path) {
+    shittygui::FrameRecording recording(path);
+    Pattern pattern{path, recording.getSize(), {}};
+
+    while(recording.nextFrame()) {
+        if(recording.isKeyframe()) {
+            continue;
+        }
+        pattern.frames.emplace_back(recording.getDamage());
+    }
+
+    return pattern;
+}
+
+int main(int argc, const char **argv) {
+    std::vector<Pattern> patterns;
+
+    if(argc > 1) {
+        for(int i = 1; i < argc; i++) {
+            patterns.emplace_back(LoadRecording(argv[i]));
+        }
+    } else {
+        patterns = MakePatterns();
+    }
+
+    printf("%-16s %-12s %8s %9s %12s %12s %8s %10s\n", "pattern", "panel", "regions",
+            "transfers", "naive", "planned", "saved", "plan time");
+
+    for(const auto &pattern : patterns) {
+        for(const auto &panel : gPanels) {
+            shittygui::RefreshPlanner planner(pattern.size, panel.model);
+
+            double naive{0}, planned{0};
+            size_t regions{0}, transfers{0};
+            std::chrono::nanoseconds planTime{0};
+
+            for(const auto &frame : pattern.frames) {
+                planner.plan(frame);
+
+                const auto &stats = planner.getStats();
+                naive += stats.naiveCost;
+                planned += stats.cost;
+                regions += stats.regions;
+                transfers += stats.transfers;
+                planTime += stats.planTime;
+            }
+
+            const double frames = std::max<size_t>(pattern.frames.size(), 1);
+            printf("%-16s %-12s %8.1f %9.1f %9.0f us %9.0f us %7.1f%% %7.2f us\n",
+                    pattern.name.c_str(), panel.name, regions / frames, transfers / frames,
+                    naive / frames, planned / frames,
+                    naive ? (100. * (naive - planned) / naive) : 0.,
+                    (planTime.count() / 1000.) / frames);
+        }
+    }
+}
@@ -0,0 +1,164 @@
+/**
+ * @file
+ *
+ * @brief Text rendering benchmarks
+ *
+ * Measures the startup cost (creating a screen and drawing the first label), resident memory, and
+ * text layout/rendering throughput of the text backend the library was built with. Build the
+ * library once with each `SHITTYGUI_TEXT_BACKEND` and compare the output.
+ *
+ * It also measures automatically fitted labels, cycling through strings of varying length (as
+ * with translations): once when the fitted sizes aren't cached yet, and again once they are.
+ */
+#include <shittygui/Screen.h>
+#include <shittygui/ViewController.h>
+#include <shittygui/Widgets/Container.h>
+#include <shittygui/Widgets/Label.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include <unistd.h>
+
+using Clock = std::chrono::high_resolution_clock;
+
+/// Screen dimensions
+constexpr static const shittygui::Size kScreenSize{800, 480};
+/// Number of labels on screen
+constexpr static const size_t kNumLabels{24};
+/// Size of each label
+constexpr static const shittygui::Size kLabelSize{260, 40};
+
+/// Strings of varying length for the auto-fit benchmark
+constexpr static const char *kFitStrings[]{
+    "Settings",
+    "Einstellungen",
+    "Paramètres avancés du système",
+    "Configuración de la pantalla y del sonido",
+    "Systemeinstellungen für Netzwerkverbindungen und Energieverwaltung",
+};
+
+/**
+ * @brief View controller holding the labels under test
+ */
+class BenchViewController: public shittygui::ViewController {
+    public:
+        BenchViewController() {
+            this->root = shittygui::MakeWidget<shittygui::widgets::Container>({0, 0},
+                    kScreenSize);
+
+            for(size_t i = 0; i < kNumLabels; i++) {
+                const shittygui::Point origin{
+                    static_cast<int16_t>((i % 3) * kLabelSize.width),
+                    static_cast<int16_t>((i / 3) * kLabelSize.height),
+                };
+
+                auto label = shittygui::MakeWidget<shittygui::widgets::Label>(origin, kLabelSize,
+                        "Label <b>" + std::to_string(i) + "</b>", true);
+                label->setFont("Liberation Sans", 14);
+                label->setEllipsizeMode(shittygui::EllipsizeMode::End);
+
+                this->labels[i] = label;
+                this->root->addChild(label);
+            }
+        }
+
+        std::shared_ptr<shittygui::Widget> &getWidget() override {
+            return this->root;
+        }
+
+        std::shared_ptr<shittygui::widgets::Label> labels[kNumLabels];
+
+    private:
+        std::shared_ptr<shittygui::Widget> root;
+};
+
+/**
+ * @brief Get the resident set size of the process, in KiB
+ */
+static size_t GetRss() {
+    size_t pages{0}, resident{0};
+
+    auto fp = fopen("/proc/self/statm", "r");
+    if(!fp) {
+        return 0;
+    }
+    if(fscanf(fp, "%zu %zu", &pages, &resident) != 2) {
+        resident = 0;
+    }
+    fclose(fp);
+
+    return (resident * sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+/**
+ * @brief Get the time elapsed since the given start time, in microseconds
+ */
+static double Elapsed(const Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count() /
+        1000.;
+}
+
+int main(int argc, const char **argv) {
+    size_t iterations{1000};
+    if(argc > 1) {
+        iterations = std::strtoul(argv[1], nullptr, 10);
+    }
+
+    const auto baseRss = GetRss();
+
+    // startup: create the screen, and draw all labels once
+    auto start = Clock::now();
+
+    auto screen = std::make_shared<shittygui::Screen>(shittygui::Screen::PixelFormat::ARGB32,
+            kScreenSize);
+    auto vc = std::make_shared<BenchViewController>();
+    screen->setRootViewController(vc);
+    screen->redraw();
+
+    printf("%-24s %10.1f us\n", "startup", Elapsed(start));
+    printf("%-24s %10zu KiB (%zu KiB before startup)\n", "resident memory", GetRss(), baseRss);
+
+    // throughput: change the text of every label, and redraw
+    start = Clock::now();
+    for(size_t i = 0; i < iterations; i++) {
+        for(size_t j = 0; j < kNumLabels; j++) {
+            vc->labels[j]->setContent("Value <b>" + std::to_string(i * kNumLabels + j) +
+                    "</b> units", true);
+        }
+        screen->redraw();
+    }
+
+    const auto total = Elapsed(start);
+    printf("%-24s %10.1f us/frame, %.2f us/label\n", "layout + draw", total / iterations,
+            total / (iterations * kNumLabels));
+
+    // auto-fit: first pass fits every string, later passes hit the fit cache
+    for(auto &label : vc->labels) {
+        label->setAutoFit(true, 8);
+    }
+
+    constexpr static const size_t kNumFitStrings{sizeof(kFitStrings) / sizeof(kFitStrings[0])};
+
+    for(size_t pass = 0; pass < 2; pass++) {
+        start = Clock::now();
+
+        const auto frames = pass ? iterations : kNumFitStrings;
+        for(size_t i = 0; i < frames; i++) {
+            for(size_t j = 0; j < kNumLabels; j++) {
+                vc->labels[j]->setContent(kFitStrings[(i + j) % kNumFitStrings]);
+            }
+            screen->redraw();
+        }
+
+        const auto fitTotal = Elapsed(start);
+        printf("%-24s %10.1f us/frame, %.2f us/label\n",
+                pass ? "auto-fit (cached)" : "auto-fit (uncached)", fitTotal / frames,
+                fitTotal / (frames * kNumLabels));
+    }
+
+    printf("%-24s %10zu KiB\n", "resident memory", GetRss());
+}
@@ -12,6 +12,10 @@ class Screen;
 
 /**
  * @brief Animation manager
+ *
+ * Callbacks are invoked once per animation frame. Callbacks registered as non-critical (such as
+ * purely decorative, time based animations) may be invoked less often when the screen reduces its
+ * rendering quality to keep up with its frame budget.
  */
 class Animator {
     friend class Screen;
@@ -22,10 +26,18 @@ class Animator {
 
         Animator(Screen *);
 
-        uint32_t registerCallback(const Callback &callback);
+        uint32_t registerCallback(const Callback &callback, const bool critical = true);
         void unregisterCallback(const uint32_t token);
 
     private:
+        /// A registered callback
+        struct Entry {
+            /// Function to invoke
+            Callback callback;
+            /// Whether the callback is invoked every frame, regardless of rendering quality
+            bool critical;
+        };
+
         void frameCallback();
 
     private:
@@ -33,9 +45,14 @@ class Animator {
         Screen *owner{nullptr};
 
         /// Callbacks
-        std::unordered_map<uint32_t, Callback> callbacks;
+        std::unordered_map<uint32_t, Entry> callbacks;
         /// Next callbacck token
         uint32_t nextToken{0};
+
+        /// Number of animation frames processed
+        uint32_t frame{0};
+        /// Non-critical callbacks are only invoked every this many frames
+        uint32_t nonCriticalInterval{1};
 };
 }
 
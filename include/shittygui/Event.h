@@ -1,6 +1,7 @@
 #ifndef SHITTYGUI_EVENT_H
 #define SHITTYGUI_EVENT_H
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <variant>
@@ -14,20 +15,32 @@ namespace event {
  *
  * Indicates that a touch event took place. These are emitted any time a touch is down, when it
  * moves while down, and when it is released again.
+ *
+ * Each touch event carries the time at which the touch controller sampled it. Gesture recognizers
+ * use it to compute velocities and to resample touch positions to the frame time, so it should be
+ * as accurate as possible; if no timestamp is provided, the time the event was queued is used.
  */
 struct Touch {
+    /// Clock used for touch timestamps; it must be monotonic, since velocities are derived from it
+    using Clock = std::chrono::steady_clock;
+
     /**
      * @brief Create a touch event at the given location on screen
      *
      * @param position Center point of the touch
      * @param isDown Whether the touch is currently down or released
+     * @param timestamp Time at which the touch was sampled
      */
-    constexpr Touch(const Point position, const bool isDown) : position(position), isDown(isDown){}
+    constexpr Touch(const Point position, const bool isDown,
+            const Clock::time_point timestamp = {}) : position(position), isDown(isDown),
+        timestamp(timestamp) {}
 
     /// Touch position on screen
     Point position;
     /// Is the touch event currently pressed down?
     bool isDown{false};
+    /// Time at which the touch was sampled
+    Clock::time_point timestamp;
 };
 
 /**
@@ -78,6 +91,51 @@ struct Button {
     /// Whether the button was pressed or released
     bool isDown{false};
 };
+
+/**
+ * @brief Key events
+ *
+ * Generated by keyboards (or on-screen keypads) when a key is pressed; they're delivered to the
+ * first responder. Keys that produce text are reported as characters, already translated
+ * according to the keyboard layout and modifiers.
+ */
+struct Key {
+    /// Key type
+    enum Type: uint8_t {
+        /// A key producing a character was pressed
+        Character,
+        /// Delete the character before the cursor
+        Backspace,
+        /// Delete the character after the cursor
+        Delete,
+        /// Move the cursor left
+        Left,
+        /// Move the cursor right
+        Right,
+        /// Move the cursor to the start of the line
+        Home,
+        /// Move the cursor to the end of the line
+        End,
+        /// Confirm the input
+        Enter,
+    };
+
+    /**
+     * @brief Create a new key event for a non-character key
+     */
+    constexpr Key(const Type type) : type(type) {}
+    /**
+     * @brief Create a new key event for a character
+     *
+     * @param character Unicode code point of the character
+     */
+    constexpr Key(const char32_t character) : type(Type::Character), character(character) {}
+
+    /// Key type
+    Type type;
+    /// Unicode code point of the character (for character events)
+    char32_t character{0};
+};
 }
 
 /**
@@ -85,7 +143,8 @@ struct Button {
  *
  * Encapsulation for all supported input events
  */
-using Event = std::variant<std::monostate, event::Touch, event::Scroll, event::Button>;
+using Event = std::variant<std::monostate, event::Touch, event::Scroll, event::Button,
+        event::Key>;
 }
 
 #endif
@@ -0,0 +1,128 @@
+#ifndef SHITTYGUI_FRAMEGOVERNOR_H
+#define SHITTYGUI_FRAMEGOVERNOR_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace shittygui {
+/**
+ * @brief Rendering quality tiers
+ *
+ * Ordered from the best quality to the cheapest rendering; each tier includes the reductions of
+ * the tiers before it.
+ */
+enum class QualityTier: uint8_t {
+    /// Full quality
+    Full,
+    /**
+     * @brief Reduced quality
+     *
+     * Images are resampled, and cached patterns rendered, with faster (lower quality) filters and
+     * antialiasing; non-critical animation callbacks are only invoked every other frame.
+     */
+    Reduced,
+    /**
+     * @brief Minimal quality
+     *
+     * Nothing is antialiased and images are resampled with the nearest neighbor filter;
+     * non-critical animation callbacks are only invoked every fourth frame, and redrawing low
+     * priority widgets is deferred.
+     */
+    Minimal,
+};
+
+/**
+ * @brief Get a descriptive name for a quality tier
+ */
+constexpr inline std::string_view GetQualityTierName(const QualityTier tier) {
+    switch(tier) {
+        case QualityTier::Full:
+            return "full";
+        case QualityTier::Reduced:
+            return "reduced";
+        case QualityTier::Minimal:
+            return "minimal";
+    }
+
+    return "unknown";
+}
+
+/**
+ * @brief Adapts the rendering quality to keep frame times within a budget
+ *
+ * The governor is fed the time taken to render each frame, and compares the average of the most
+ * recent frames against the frame budget. When frames take too long, the quality is reduced by
+ * one tier; when there has been enough headroom for a while, it's restored by one tier. Changes
+ * are spaced at least a full window of frames apart, and the thresholds for reducing and
+ * restoring quality differ, so that the quality doesn't oscillate.
+ *
+ * Attach it to a screen with Screen::setFrameGovernor(); the screen then applies the selected tier
+ * and reports it in its frame statistics.
+ */
+class FrameGovernor {
+    public:
+        /**
+         * @brief Governor configuration
+         */
+        struct Config {
+            /// Target time to render a frame
+            std::chrono::nanoseconds budget{std::chrono::microseconds(16667)};
+            /// Number of recent frames whose average frame time is compared to the budget
+            uint16_t window{30};
+            /// Number of consecutive frames with headroom required to restore quality
+            uint16_t restoreFrames{120};
+            /// Quality is reduced when the average exceeds this fraction of the budget
+            double degradeThreshold{1.};
+            /// There's headroom when the average is below this fraction of the budget
+            double restoreThreshold{.5};
+            /// Lowest quality tier that may be selected
+            QualityTier lowestTier{QualityTier::Minimal};
+        };
+
+        FrameGovernor();
+        FrameGovernor(const Config &config);
+
+        bool update(const std::chrono::nanoseconds frameTime);
+        void reset();
+
+        /**
+         * @brief Get the currently selected quality tier
+         */
+        constexpr inline QualityTier getTier() const {
+            return this->tier;
+        }
+        /**
+         * @brief Get the governor configuration
+         */
+        constexpr inline const Config &getConfig() const {
+            return this->config;
+        }
+
+        std::chrono::nanoseconds getAverageFrameTime() const;
+
+    private:
+        void changeTier(const QualityTier newTier);
+
+    private:
+        /// Configuration
+        Config config;
+
+        /// Most recent frame times (ring buffer, up to the window size)
+        std::vector<std::chrono::nanoseconds> samples;
+        /// Index of the oldest sample, once the ring buffer is full
+        size_t nextSample{0};
+        /// Sum of all samples
+        std::chrono::nanoseconds sampleSum{0};
+
+        /// Number of consecutive frames with headroom
+        uint32_t headroomFrames{0};
+
+        /// Selected quality tier
+        QualityTier tier{QualityTier::Full};
+};
+}
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef SHITTYGUI_FRAMERECORDER_H
+#define SHITTYGUI_FRAMERECORDER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include <shittygui/Screen.h>
+#include <shittygui/Types.h>
+
+namespace shittygui {
+/**
+ * @brief Records screen output into a bounded in-memory buffer
+ *
+ * Attach a frame recorder to a screen to keep a history of the most recent frames (a "flight
+ * recorder") which can be saved to a file later, for example when an error occurs. Only the
+ * damaged regions of each frame are recorded, as the difference to the previous frame, and
+ * compressed; periodic keyframes contain the entire frame.
+ *
+ * When the buffer is full, the oldest frames are discarded, in units of a keyframe and the frames
+ * that follow it, so the recording always starts at a keyframe. If the size or pixel format of
+ * the framebuffer changes, all frames recorded before the change are discarded.
+ *
+ * Use FrameRecording to decode the saved recordings.
+ */
+class FrameRecorder {
+    friend class Screen;
+
+    public:
+        /**
+         * @brief Recording statistics
+         */
+        struct Stats {
+            /// Total number of frames recorded
+            uint64_t frames{0};
+            /// Number of frames that were recorded as keyframes
+            uint64_t keyframes{0};
+            /// Number of frames discarded because the buffer was full
+            uint64_t droppedFrames{0};
+            /// Number of frames currently held in the buffer
+            size_t bufferedFrames{0};
+            /// Bytes of encoded data currently held in the buffer
+            size_t bufferedBytes{0};
+            /// Total time spent encoding frames
+            std::chrono::nanoseconds encodeTime{0};
+            /// Time spent encoding the most recent frame
+            std::chrono::nanoseconds lastEncodeTime{0};
+        };
+
+        /// Default maximum number of frames between keyframes
+        constexpr static const uint32_t kDefaultKeyframeInterval{600};
+
+        FrameRecorder(const size_t capacity, const uint32_t keyframeInterval =
+                kDefaultKeyframeInterval);
+
+        void save(const std::filesystem::path &path) const;
+        void clear();
+
+        /**
+         * @brief Get recording statistics
+         */
+        constexpr inline auto &getStats() const {
+            return this->stats;
+        }
+
+    private:
+        void recordFrame(const std::byte *framebuffer, const size_t stride, const Size &size,
+                const Screen::PixelFormat format, const std::vector<Rect> &rects);
+        void encodeRect(const std::byte *framebuffer, const size_t stride, const Rect &rect,
+                const bool keyframe, std::vector<std::byte> &out);
+        void evict();
+
+    private:
+        /// Maximum number of bytes of encoded frames to retain
+        size_t capacity;
+        /// Maximum number of frames between keyframes
+        uint32_t keyframeInterval;
+
+        /// Time at which recording started
+        std::chrono::steady_clock::time_point start;
+
+        /// Size of the framebuffer being recorded
+        Size size;
+        /// Pixel format of the framebuffer
+        Screen::PixelFormat format{Screen::PixelFormat::ARGB32};
+        /// Bytes per pixel
+        size_t bytesPerPixel{4};
+
+        /// Copy of the previous frame, which deltas are calculated against
+        std::vector<std::byte> shadow;
+        /// Frames since the last keyframe
+        uint32_t framesSinceKeyframe{0};
+        /// Bytes of encoded data since the last keyframe
+        size_t bytesSinceKeyframe{0};
+
+        /// Encoded frame records, oldest first
+        std::deque<std::vector<std::byte>> records;
+
+        /// Statistics
+        Stats stats;
+};
+
+/**
+ * @brief Decodes frame recordings
+ *
+ * Reads a recording saved by FrameRecorder and reconstructs the frames in it, one at a time.
+ */
+class FrameRecording {
+    public:
+        FrameRecording(const std::filesystem::path &path);
+        FrameRecording(std::vector<std::byte> &&data);
+
+        bool nextFrame();
+
+        /// Get the size of the recorded framebuffer
+        constexpr inline auto getSize() const {
+            return this->size;
+        }
+        /// Get the pixel format of the recorded framebuffer
+        constexpr inline auto getPixelFormat() const {
+            return this->format;
+        }
+        /// Get the pixel data of the current frame
+        constexpr inline std::span<const std::byte> getFrame() const {
+            return this->frame;
+        }
+        /// Get the number of bytes per row of the current frame
+        constexpr inline size_t getStride() const {
+            return this->stride;
+        }
+        /// Get the time at which the current frame was recorded, relative to the recording start
+        constexpr inline auto getTimestamp() const {
+            return this->timestamp;
+        }
+        /// Get the regions that changed in the current frame
+        constexpr inline auto &getDamage() const {
+            return this->damage;
+        }
+        /// Whether the current frame is a keyframe
+        constexpr inline bool isKeyframe() const {
+            return this->keyframe;
+        }
+
+    private:
+        void parseHeader();
+        void decodeRect(const Rect &rect, const std::byte *data, const size_t length);
+
+    private:
+        /// Entire recording
+        std::vector<std::byte> data;
+        /// Offset of the next frame record
+        size_t offset{0};
+
+        /// Size of the framebuffer
+        Size size;
+        /// Pixel format of the framebuffer
+        Screen::PixelFormat format{Screen::PixelFormat::ARGB32};
+        /// Bytes per pixel
+        size_t bytesPerPixel{4};
+
+        /// Reconstructed frame
+        std::vector<std::byte> frame;
+        /// Bytes per row of the reconstructed frame
+        size_t stride{0};
+        /// Timestamp of the current frame
+        std::chrono::nanoseconds timestamp{0};
+        /// Regions changed in the current frame
+        std::vector<Rect> damage;
+        /// Whether the current frame is a keyframe
+        bool keyframe{false};
+};
+}
+
+#endif
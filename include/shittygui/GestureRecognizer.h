@@ -0,0 +1,432 @@
+#ifndef SHITTYGUI_GESTURERECOGNIZER_H
+#define SHITTYGUI_GESTURERECOGNIZER_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <shittygui/Event.h>
+#include <shittygui/Types.h>
+
+namespace shittygui {
+class Widget;
+
+/**
+ * @brief A position or velocity with subpixel precision
+ */
+struct GesturePoint {
+    double x{0.}, y{0.};
+};
+
+/**
+ * @brief Tracks the recent history of a touch
+ *
+ * Keeps the most recent samples of a touch, from which the velocity of the touch is estimated (by
+ * a least squares fit over the samples from the last 100ms) and its position at an arbitrary time
+ * can be resampled.
+ *
+ * Resampling compensates for touch controllers whose report rate is irregular, or isn't a multiple
+ * of the display refresh rate: the position at the frame time is interpolated between the samples
+ * around it, or extrapolated (by a few milliseconds at most) from the last two samples.
+ */
+class VelocityTracker {
+    public:
+        using Clock = event::Touch::Clock;
+
+        void addSample(const Point position, const Clock::time_point time);
+        /**
+         * @brief Remove all samples
+         */
+        inline void clear() {
+            this->count = 0;
+        }
+        /**
+         * @brief Whether there are any samples
+         */
+        constexpr inline bool isEmpty() const {
+            return !this->count;
+        }
+
+        GesturePoint getVelocity() const;
+        GesturePoint resample(const Clock::time_point time) const;
+
+    private:
+        /**
+         * @brief A single touch sample
+         */
+        struct Sample {
+            double x, y;
+            Clock::time_point time;
+        };
+
+        /**
+         * @brief Get a sample by age
+         *
+         * @param age Index of the sample, where 0 is the most recent
+         */
+        constexpr inline const Sample &get(const size_t age) const {
+            return this->samples[(this->head + kHistorySize - age) % kHistorySize];
+        }
+
+    private:
+        /// Maximum number of samples to keep
+        constexpr static const size_t kHistorySize{20};
+        /// Maximum age of samples (relative to the newest) used for velocity estimation
+        constexpr static const std::chrono::milliseconds kHorizon{100};
+        /// Gap between samples after which the touch is assumed to have stopped
+        constexpr static const std::chrono::milliseconds kAssumeStopped{40};
+        /// Maximum time to extrapolate past the newest sample
+        constexpr static const std::chrono::milliseconds kMaxPrediction{8};
+
+        /// Ring buffer of samples
+        std::array<Sample, kHistorySize> samples;
+        /// Index of the newest sample
+        size_t head{0};
+        /// Number of valid samples
+        size_t count{0};
+};
+
+/**
+ * @brief Base class for gesture recognizers
+ *
+ * Gesture recognizers are attached to widgets, and interpret the touch events that start inside
+ * that widget (or any of its children) as higher level gestures, such as taps or swipes. They
+ * receive touches regardless of whether the widget (or its children) handle them.
+ *
+ * Recognizers begin in the `Possible` state. Discrete gestures (like taps) move directly to the
+ * `Recognized` state; continuous gestures (like pans) move through `Began`, `Changed` and `Ended`.
+ * A recognizer that can no longer recognize its gesture for the current touch moves to `Failed`.
+ * The callback is invoked for every state change, except to `Failed`.
+ *
+ * Once a recognizer has recognized its gesture, all other recognizers for the touch fail; if it
+ * cancels touches (the default) the widget tracking the touch is sent a cancellation, and doesn't
+ * receive the remaining touch events. If several recognizers recognize their gestures in response
+ * to the same event, the one attached to the innermost widget wins. State changes are only
+ * reported once the screen has settled on a winner, so the callbacks of the other recognizers are
+ * never invoked: those that already transitioned are cancelled (or fail) silently.
+ *
+ * @remark Time-based recognizers (such as long presses) and the resampling of continuous gestures
+ *         are driven by the screen's animation callback (Screen::handleAnimations) and thus
+ *         require it to be invoked for every frame.
+ */
+class GestureRecognizer {
+    friend class Screen;
+
+    public:
+        using Clock = event::Touch::Clock;
+
+        /**
+         * @brief Recognizer states
+         */
+        enum class State: uint8_t {
+            /// The gesture may still be recognized
+            Possible,
+            /// A continuous gesture has started
+            Began,
+            /// A continuous gesture has changed
+            Changed,
+            /// A continuous gesture has ended
+            Ended,
+            /// A discrete gesture was recognized
+            Recognized,
+            /// The gesture was cancelled
+            Cancelled,
+            /// The gesture wasn't recognized
+            Failed,
+        };
+
+        /**
+         * @brief Callback invoked when the recognizer's state changes
+         */
+        using Callback = std::function<void(GestureRecognizer &recognizer)>;
+
+        virtual ~GestureRecognizer() = default;
+
+        /**
+         * @brief Set the callback to invoke when the state changes
+         */
+        inline void setCallback(const Callback &cb) {
+            this->callback = cb;
+        }
+
+        /**
+         * @brief Get the current state
+         */
+        constexpr inline auto getState() const {
+            return this->state;
+        }
+
+        /**
+         * @brief Get the widget the recognizer is tracking a touch for
+         *
+         * This is the widget the recognizer was added to.
+         */
+        inline std::shared_ptr<Widget> getWidget() const {
+            return this->widget.lock();
+        }
+
+        /**
+         * @brief Get the current location of the touch, in screen coordinates
+         *
+         * When a pan reports a change, this is the touch position resampled to the frame time.
+         */
+        constexpr inline auto &getLocation() const {
+            return this->location;
+        }
+        /**
+         * @brief Get the location the touch went down at, in screen coordinates
+         */
+        constexpr inline auto &getStartLocation() const {
+            return this->start;
+        }
+        /**
+         * @brief Get the distance the touch moved since it went down
+         */
+        constexpr inline GesturePoint getTranslation() const {
+            return {this->location.x - this->start.x, this->location.y - this->start.y};
+        }
+        /**
+         * @brief Get the current velocity of the touch, in points per second
+         */
+        inline GesturePoint getVelocity() const {
+            return this->tracker.getVelocity();
+        }
+
+        /**
+         * @brief Set whether the recognizer receives touches
+         */
+        inline void setEnabled(const bool enabled) {
+            this->enabled = enabled;
+        }
+        /**
+         * @brief Get whether the recognizer receives touches
+         */
+        constexpr inline bool isEnabled() const {
+            return this->enabled;
+        }
+
+        /**
+         * @brief Set whether recognizing the gesture cancels touch delivery to widgets
+         */
+        inline void setCancelsTouches(const bool cancels) {
+            this->cancelsTouches = cancels;
+        }
+        /**
+         * @brief Get whether recognizing the gesture cancels touch delivery to widgets
+         */
+        constexpr inline bool getCancelsTouches() const {
+            return this->cancelsTouches;
+        }
+
+    protected:
+        /// Distance a touch may move before it's no longer considered stationary
+        constexpr static const double kTouchSlop{10.};
+
+        /**
+         * @brief A touch went down
+         */
+        virtual void touchBegan(const event::Touch &event) {}
+        /**
+         * @brief The touch moved
+         */
+        virtual void touchMoved(const event::Touch &event) {}
+        /**
+         * @brief The touch was released
+         */
+        virtual void touchEnded(const event::Touch &event) {}
+        /**
+         * @brief Process a frame
+         *
+         * Invoked once per frame while a touch is being tracked.
+         *
+         * @param now Time of the frame
+         */
+        virtual void processFrame(const Clock::time_point now) {}
+
+        void setState(const State newState);
+
+        /**
+         * @brief Whether the recognizer is still interested in the current touch
+         */
+        constexpr inline bool isTracking() const {
+            return this->state == State::Possible || this->state == State::Began ||
+                this->state == State::Changed;
+        }
+        /**
+         * @brief Whether the recognizer has recognized its gesture for the current touch
+         */
+        constexpr inline bool hasRecognized() const {
+            return this->state == State::Began || this->state == State::Changed ||
+                this->state == State::Ended || this->state == State::Recognized;
+        }
+
+        /**
+         * @brief Get the distance from the start location to the current location
+         */
+        double getDistance() const;
+
+    private:
+        void begin(const std::shared_ptr<Widget> &widget, const event::Touch &event);
+        void handleTouch(const event::Touch &event);
+        void handleFrame(const Clock::time_point now);
+        void fail();
+        void cancel();
+        void deliverStates();
+
+    protected:
+        /// Recent samples of the touch
+        VelocityTracker tracker;
+        /// Location the touch went down
+        GesturePoint start;
+        /// Current location of the touch
+        GesturePoint location;
+        /// Time at which the touch went down
+        Clock::time_point startTime;
+
+    private:
+        /// Widget the recognizer is attached to
+        std::weak_ptr<Widget> widget;
+        /// Callback for state changes
+        std::optional<Callback> callback;
+        /// State changes that haven't been reported to the callback yet
+        std::vector<State> pendingStates;
+        /// Current state
+        State state{State::Possible};
+
+        /// Whether the recognizer receives touches
+        uintptr_t enabled                       :1{true};
+        /// Whether recognition cancels touch delivery to widgets
+        uintptr_t cancelsTouches                :1{true};
+};
+
+/**
+ * @brief Recognizes taps
+ *
+ * A tap is a touch that's released within a short time, without moving (much) from where it went
+ * down.
+ */
+class TapGestureRecognizer: public GestureRecognizer {
+    protected:
+        void touchMoved(const event::Touch &event) override;
+        void touchEnded(const event::Touch &event) override;
+        void processFrame(const Clock::time_point now) override;
+
+    private:
+        /// Maximum duration of a tap
+        constexpr static const std::chrono::milliseconds kMaxDuration{500};
+};
+
+/**
+ * @brief Recognizes long presses
+ *
+ * A long press begins once a touch has been held without moving (much) for a minimum duration.
+ * It's continuous: once it has begun, moving the touch reports changes, and the gesture ends when
+ * the touch is released.
+ */
+class LongPressGestureRecognizer: public GestureRecognizer {
+    public:
+        /**
+         * @brief Set how long a touch must be held before the gesture begins
+         */
+        inline void setMinimumDuration(const std::chrono::milliseconds duration) {
+            this->minDuration = duration;
+        }
+        /**
+         * @brief Get how long a touch must be held before the gesture begins
+         */
+        constexpr inline auto getMinimumDuration() const {
+            return this->minDuration;
+        }
+
+    protected:
+        void touchMoved(const event::Touch &event) override;
+        void touchEnded(const event::Touch &event) override;
+        void processFrame(const Clock::time_point now) override;
+
+    private:
+        /// How long the touch must be held
+        std::chrono::milliseconds minDuration{500};
+};
+
+/**
+ * @brief Recognizes pans (drags)
+ *
+ * A pan begins once the touch moved a minimum distance. Changes are reported at most once per
+ * frame, with the touch position resampled to the frame time, so that content following the touch
+ * moves smoothly even if touch reports arrive irregularly. When the touch is released, the gesture
+ * ends; the velocity at that point can be used to continue the movement (a fling.)
+ */
+class PanGestureRecognizer: public GestureRecognizer {
+    protected:
+        void touchMoved(const event::Touch &event) override;
+        void touchEnded(const event::Touch &event) override;
+        void processFrame(const Clock::time_point now) override;
+
+    private:
+        /// Location reported by the last callback
+        GesturePoint lastReported;
+
+        /**
+         * @brief Delay applied to the frame time when resampling
+         *
+         * Resampling slightly in the past means there are usually samples on either side of the
+         * resampled time to interpolate between, rather than having to extrapolate.
+         */
+        constexpr static const std::chrono::milliseconds kResampleLatency{5};
+};
+
+/**
+ * @brief Recognizes swipes (flings)
+ *
+ * A swipe is a touch that moved a minimum distance in one of the allowed directions, and was
+ * still moving quickly in that direction when it was released.
+ */
+class SwipeGestureRecognizer: public GestureRecognizer {
+    public:
+        /**
+         * @brief Swipe directions
+         */
+        enum Direction: uint8_t {
+            Left                        = (1 << 0),
+            Right                       = (1 << 1),
+            Up                          = (1 << 2),
+            Down                        = (1 << 3),
+        };
+
+        /**
+         * @brief Set the directions in which swipes are recognized
+         *
+         * @param directions Bitwise OR of Direction values
+         */
+        inline void setDirections(const uint8_t directions) {
+            this->directions = directions;
+        }
+        /**
+         * @brief Get the direction of the recognized swipe
+         */
+        constexpr inline auto getDirection() const {
+            return this->direction;
+        }
+
+    protected:
+        void touchEnded(const event::Touch &event) override;
+
+    private:
+        /// Minimum distance the touch must move
+        constexpr static const double kMinDistance{30.};
+        /// Minimum velocity at release, in points per second
+        constexpr static const double kMinVelocity{300.};
+
+        /// Allowed directions
+        uint8_t directions{Left | Right | Up | Down};
+        /// Direction of the recognized swipe
+        Direction direction{Left};
+};
+}
+
+#endif
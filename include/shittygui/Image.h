@@ -1,9 +1,13 @@
 #ifndef SHITTYGUI_IMAGE_H
 #define SHITTYGUI_IMAGE_H
 
+#include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <string>
+#include <string_view>
 
+#include <shittygui/FrameGovernor.h>
 #include <shittygui/Types.h>
 
 namespace shittygui {
@@ -18,7 +22,7 @@ namespace shittygui {
  */
 class Image {
     public:
-        virtual ~Image() = default;
+        virtual ~Image();
 
         /**
          * @brief Get the Cairo surface for this image
@@ -33,7 +37,91 @@ class Image {
          */
         virtual Size getSize() const = 0;
 
+        /**
+         * @brief Get the scale factor of the image
+         *
+         * Images intended for high pixel density displays contain more pixels than the space they
+         * occupy on screen; the scale factor is the ratio of the two.
+         */
+        constexpr inline double getScale() const {
+            return this->scale;
+        }
+        /**
+         * @brief Set the scale factor of the image
+         *
+         * @param newScale Physical pixels per logical pixel; must be positive
+         */
+        inline void setScale(const double newScale) {
+            if(newScale > 0. && newScale != this->scale) {
+                this->scale = newScale;
+                this->contentsChanged();
+            }
+        }
+        /**
+         * @brief Get the logical size of the image
+         *
+         * This is the physical size, divided by the image's scale factor; it's the size at which
+         * the image is laid out.
+         */
+        inline Size getLogicalSize() const {
+            const auto size = this->getSize();
+            return Size(static_cast<uint16_t>(size.width / this->scale + .5),
+                    static_cast<uint16_t>(size.height / this->scale + .5));
+        }
+
+        /**
+         * @brief Get the name of the image
+         *
+         * Images read from disk are named after the path they were read from. The name is how
+         * widget archives refer to the image.
+         */
+        constexpr inline std::string_view getName() const {
+            return this->name;
+        }
+        /**
+         * @brief Set the name of the image
+         */
+        inline void setName(const std::string_view newName) {
+            this->name = newName;
+        }
+
+        /**
+         * @brief Get the generation of the image's contents
+         *
+         * Each image is assigned a unique generation when created, and a new one whenever its
+         * contents change; unlike the image's address, it's never reused, so it identifies what
+         * the image looks like.
+         */
+        constexpr inline uint64_t getGeneration() const {
+            return this->generation;
+        }
+        void contentsChanged();
+
+        void draw(struct _cairo *drawCtx, const Rect &rect);
+        void releaseScaledSurface();
+
         static std::shared_ptr<Image> Read(const std::filesystem::path &path);
+        static std::shared_ptr<Image> Read(const std::filesystem::path &path, const double scale);
+
+    private:
+        struct _cairo_surface *getSurfaceForSize(const Size &size, const QualityTier quality);
+
+        static uint64_t NextGeneration();
+
+    private:
+        /// Scale factor (physical pixels per logical pixel)
+        double scale{1.};
+        /// Name of the image (usually the path it was read from)
+        std::string name;
+        /// Generation of the image's contents
+        uint64_t generation{NextGeneration()};
+
+        /// Copy of the image, resampled to the size it was last drawn at on the device
+        struct _cairo_surface *scaledSurface{nullptr};
+        /// Size of the resampled image
+        Size scaledSize;
+        /// Quality tier the image was resampled at
+        QualityTier scaledQuality{QualityTier::Full};
 };
 }
 
@@ -0,0 +1,86 @@
+#ifndef SHITTYGUI_MEMORYSTATS_H
+#define SHITTYGUI_MEMORYSTATS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace shittygui {
+/**
+ * @brief Categories of memory tracked by the library
+ */
+enum class MemoryCategory: uint8_t {
+    /// Pixel data of decoded images
+    ImagePixels,
+    /// Offscreen surfaces used to cache rendered content (patterns, layers, snapshots)
+    CachedLayers,
+    /// Text layout objects (estimated)
+    TextLayouts,
+    /// Widget objects and the data they directly own (estimated)
+    Widgets,
+    /// Pending input events
+    EventQueue,
+};
+
+/// Number of memory categories
+constexpr static const size_t kNumMemoryCategories{5};
+
+/**
+ * @brief Get a descriptive name for a memory category
+ */
+constexpr inline std::string_view GetMemoryCategoryName(const MemoryCategory category) {
+    switch(category) {
+        case MemoryCategory::ImagePixels:
+            return "imagePixels";
+        case MemoryCategory::CachedLayers:
+            return "cachedLayers";
+        case MemoryCategory::TextLayouts:
+            return "textLayouts";
+        case MemoryCategory::Widgets:
+            return "widgets";
+        case MemoryCategory::EventQueue:
+            return "eventQueue";
+    }
+
+    return "unknown";
+}
+
+/**
+ * @brief Snapshot of memory usage
+ *
+ * Memory usage is tracked per category, with the current number of bytes as well as the highest
+ * number of bytes ever used (high-water mark.)
+ *
+ * @remark Some categories (text layouts in particular) are estimates, as the underlying libraries
+ *         do not provide precise accounting.
+ */
+struct MemoryStats {
+    /// Usage information for a single category
+    struct Usage {
+        /// Number of bytes currently in use
+        size_t current{0};
+        /// Highest number of bytes that were in use at any time
+        size_t peak{0};
+    };
+
+    /// Usage per memory category
+    std::array<Usage, kNumMemoryCategories> categories;
+    /// Total memory usage over all categories
+    Usage total;
+
+    /// Configured memory budget (0 if none)
+    size_t budget{0};
+    /// Number of times the budget was exceeded and caches were trimmed
+    uint32_t trimCount{0};
+
+    /**
+     * @brief Get usage information for the given category
+     */
+    constexpr inline const Usage &operator[](const MemoryCategory category) const {
+        return this->categories[static_cast<size_t>(category)];
+    }
+};
+}
+
+#endif
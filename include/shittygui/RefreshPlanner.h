@@ -0,0 +1,153 @@
+#ifndef SHITTYGUI_REFRESHPLANNER_H
+#define SHITTYGUI_REFRESHPLANNER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <shittygui/Types.h>
+
+namespace shittygui {
+/**
+ * @brief Plans the transfers needed to update a panel from a list of damaged regions
+ *
+ * Displays attached over slow interfaces (such as SPI) or with partial refresh (e-paper, memory
+ * LCDs) pay a fixed setup cost for each window that's transferred, in addition to the cost of
+ * each row and pixel. Sending many small rectangles can thus be considerably slower than sending
+ * a single larger one that covers them all, even though more pixels are transferred.
+ *
+ * The planner takes the damaged regions of a frame (in framebuffer coordinates; see
+ * Screen::convertToFramebuffer()) and turns them into a list of transfers that is cheap according
+ * to the panel's cost model:
+ *
+ * 1. Regions are expanded to the panel's alignment requirements, and clipped to its bounds.
+ * 2. Overlapping regions are split, unless sending the overlap twice is cheaper than the
+ *    additional transfers.
+ * 3. Transfers are merged as long as this reduces the total cost, or while there are more
+ *    transfers than the limit.
+ * 4. Transfers larger than the maximum transfer size are split into bands of rows.
+ *
+ * The resulting transfers are ordered top to bottom, then left to right, matching the scan order
+ * of most panels.
+ *
+ * @remark Planning is greedy, and not guaranteed to find the cheapest set of transfers: only pairs
+ *         of transfers that are cheaper to send together are merged, even if merging two other
+ *         transfers would be cheaper yet because it covers others. Each merge takes time
+ *         proportional to the square of the number of transfers.
+ */
+class RefreshPlanner {
+    public:
+        /**
+         * @brief Cost model of a panel
+         *
+         * Costs are in arbitrary units, though using the time (in microseconds) the transfer
+         * takes is a good idea so the estimates can be compared against measurements.
+         */
+        struct CostModel {
+            /// Fixed cost of each transfer (setting the address window, command overhead, etc.)
+            double perTransfer{0};
+            /// Cost of each row of a transfer
+            double perRow{0};
+            /// Cost of each pixel transferred
+            double perPixel{1};
+
+            /// Transfers must start and end on a multiple of this many pixels horizontally
+            uint16_t alignX{1};
+            /// Transfers must start and end on a multiple of this many rows
+            uint16_t alignY{1};
+            /// Transfers always cover entire rows (for example, memory LCDs)
+            bool fullRows{false};
+
+            /// Maximum number of transfers per frame, or 0 for no limit
+            size_t maxTransfers{0};
+            /**
+             * @brief Maximum number of pixels in a single transfer, or 0 for no limit
+             *
+             * This is typically the size of a DMA buffer. Larger transfers are split into bands,
+             * each of which costs a transfer; but as splitting happens after merging, they don't
+             * count against `maxTransfers`.
+             */
+            size_t maxTransferPixels{0};
+        };
+
+        /**
+         * @brief Information about the most recently planned frame
+         */
+        struct Stats {
+            /// Number of damaged regions passed in
+            size_t regions{0};
+            /// Number of transfers planned
+            size_t transfers{0};
+            /// Number of pixels transferred
+            size_t pixels{0};
+            /// Estimated cost of transferring each (aligned) damaged region as is
+            double naiveCost{0};
+            /// Estimated cost of the planned transfers
+            double cost{0};
+            /// Time taken to plan the transfers
+            std::chrono::nanoseconds planTime{0};
+        };
+
+        RefreshPlanner(const Size &size, const CostModel &model);
+
+        const std::vector<Rect> &plan(const std::vector<Rect> &damage);
+
+        double cost(const Rect &rect) const;
+        double cost(const std::vector<Rect> &rects) const;
+
+        /**
+         * @brief Get the most recently planned transfers
+         */
+        constexpr inline auto &getTransfers() const {
+            return this->transfers;
+        }
+        /**
+         * @brief Get information about the most recently planned frame
+         */
+        constexpr inline auto &getStats() const {
+            return this->stats;
+        }
+        /**
+         * @brief Get the cost model in use
+         */
+        constexpr inline auto &getCostModel() const {
+            return this->model;
+        }
+
+    private:
+        /**
+         * @brief A pair of transfers that could be merged
+         */
+        struct MergeCandidate {
+            /// Change in cost from merging the two transfers, ignoring all other transfers
+            double delta;
+            /// Indices of the two transfers
+            uint32_t first, second;
+        };
+
+        Rect align(const Rect &rect) const;
+        size_t getBandSize(const Rect &rect, int32_t &rows, int32_t &cols) const;
+        void addDisjoint(const Rect &rect, std::vector<Rect> &out) const;
+        bool mergeBest(const bool force);
+        void splitLarge();
+
+    private:
+        /// Size of the panel, in pixels
+        Size size;
+        /// Cost model of the panel
+        CostModel model;
+
+        /// Planned transfers
+        std::vector<Rect> transfers;
+        /// Scratch buffer used while merging
+        std::vector<Rect> scratch;
+        /// Pairs of transfers considered for merging
+        std::vector<MergeCandidate> candidates;
+
+        /// Statistics of the most recent frame
+        Stats stats;
+};
+}
+
+#endif
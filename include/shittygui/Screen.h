@@ -1,18 +1,31 @@
 #ifndef SHITTYGUI_SCREEN_H
 #define SHITTYGUI_SCREEN_H
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
+#include <future>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <span>
+#include <string>
+#include <vector>
 
 #include <shittygui/Event.h>
+#include <shittygui/FrameGovernor.h>
+#include <shittygui/MemoryStats.h>
 #include <shittygui/Types.h>
 
 namespace shittygui {
 class Animator;
+class CaptureRequest;
+class CaptureWorker;
+class FocusEngine;
+class FrameRecorder;
+class GestureRecognizer;
+class SurfacePool;
 class Widget;
 class ViewController;
 
@@ -38,6 +51,47 @@ class Screen: public std::enable_shared_from_this<Screen> {
             RGB30,
         };
 
+        /**
+         * @brief Frame rendering statistics
+         *
+         * Updated every time the screen is redrawn.
+         */
+        struct FrameStats {
+            /// Total number of frames (calls to redraw) rendered
+            uint64_t frames{0};
+            /// Time taken to render the most recent frame
+            std::chrono::nanoseconds lastFrameTime{0};
+            /// Longest frame time observed
+            std::chrono::nanoseconds maxFrameTime{0};
+            /// Moving average of frame times
+            std::chrono::nanoseconds averageFrameTime{0};
+
+            /// Current rendering quality tier
+            QualityTier qualityTier{QualityTier::Full};
+            /// Number of times the quality tier changed
+            uint32_t qualityChanges{0};
+            /// Frame at which the quality tier last changed
+            uint64_t lastQualityChange{0};
+            /// Number of times redrawing a low priority widget was deferred
+            uint64_t deferredUpdates{0};
+            /// Number of widget invalidations dropped because the widget's draw state didn't change
+            uint64_t skippedUpdates{0};
+        };
+
+        /**
+         * @brief Memory pressure levels
+         *
+         * Indicates how aggressively cached resources should be released by trimMemory().
+         */
+        enum class MemoryPressure {
+            /// Release caches of widgets that have not been visible for the offscreen timeout
+            Low,
+            /// Release caches of all widgets that are not currently visible, and all idle surfaces
+            Moderate,
+            /// Release caches of all widgets, including visible ones, and all idle surfaces
+            Critical,
+        };
+
         /**
          * @brief Rotation of the logical framebuffer
          *
@@ -54,6 +108,55 @@ class Screen: public std::enable_shared_from_this<Screen> {
             Rotate270,
         };
 
+        /**
+         * @brief How the UI scale factor is applied
+         */
+        enum class ScaleMode {
+            /**
+             * @brief Render directly at the framebuffer resolution
+             *
+             * All drawing is scaled as vector graphics. This gives the best quality output, but
+             * may be expensive for fractional scale factors.
+             */
+            Vector,
+            /**
+             * @brief Render at logical resolution, then upscale
+             *
+             * The UI is rendered into an intermediate buffer at the logical resolution, and
+             * damaged regions are then scaled up into the framebuffer: by pixel replication for
+             * integer scale factors, and bilinear filtering otherwise. This is intended for
+             * devices that can't afford to render at full resolution.
+             *
+             * @remark Only supported for 32 bits per pixel and RGB565 framebuffers. Scale factors
+             *         below 1 are always rendered as vector graphics.
+             */
+            Upscale,
+        };
+
+        /**
+         * @brief Output format of screen captures
+         */
+        enum class CaptureFormat {
+            /// Pixel data in the framebuffer's pixel format
+            Raw,
+            /// PNG encoded image
+            Png,
+        };
+
+        /**
+         * @brief Result of a screen capture
+         */
+        struct CaptureResult {
+            /// Size of the captured image, in pixels
+            Size size;
+            /// Pixel format of raw captures
+            PixelFormat format{PixelFormat::ARGB32};
+            /// Bytes per row of raw captures
+            size_t stride{0};
+            /// Pixel data or encoded image
+            std::vector<std::byte> data;
+        };
+
         Screen(const PixelFormat format, const Size &size);
         Screen(const PixelFormat format, const Size &size, std::span<std::byte> framebuffer,
                 const size_t stride);
@@ -79,17 +182,46 @@ class Screen: public std::enable_shared_from_this<Screen> {
             return OptimalStrideForBuffer(format, size.width);
         }
 
+        void setScaleFactor(const double scale);
+        /**
+         * @brief Get the UI scale factor
+         */
+        constexpr inline auto getScaleFactor() const {
+            return this->scaleFactor;
+        }
+
+        void setScaleMode(const ScaleMode mode);
+        /**
+         * @brief Get the current scale mode
+         */
+        constexpr inline auto getScaleMode() const {
+            return this->scaleMode;
+        }
+
+        void setSoftwareRasterizer(const bool enabled);
         /**
-         * @brief Set the UI scale factor
+         * @brief Whether simple primitives are rasterized in software
+         */
+        constexpr inline bool isSoftwareRasterizerEnabled() const {
+            return this->softwareRasterizer;
+        }
+
+        /**
+         * @brief Enable or disable content hashing
          *
-         * The scale factor can be used to support high pixel density displays. Positive values
-         * above will increase the size of UI components, and values below 1 (and above 0) will
-         * shrink them.
+         * When enabled, invalidating a widget whose draw state (as reported by
+         * Widget::getDrawStateHash()) is the same as when it was last drawn doesn't cause it to
+         * be redrawn: its pixels are left untouched, and no damage is produced for it. This saves
+         * redrawing widgets that are invalidated without actually changing.
          */
-        inline void setScaleFactor(const double scale) {
-            this->scaleFactor = scale;
-            this->scaled = true;
-            this->needsDisplay();
+        inline void setContentHashing(const bool enabled) {
+            this->contentHashing = enabled;
+        }
+        /**
+         * @brief Whether unchanged widgets are detected using their draw state hash
+         */
+        constexpr inline bool isContentHashingEnabled() const {
+            return this->contentHashing;
         }
 
         /**
@@ -100,14 +232,7 @@ class Screen: public std::enable_shared_from_this<Screen> {
          */
         inline void setRotation(const Rotation newRotation) {
             this->rotation = newRotation;
-
-            if(this->rotation == Rotation::Rotate90 || this->rotation == Rotation::Rotate270) {
-                this->size = {this->physSize.height, this->physSize.width};
-            } else {
-                this->size = this->physSize;
-            }
-
-            this->needsDisplay();
+            this->updateGeometry();
         }
         /**
          * @brief Get the current display rotation
@@ -123,6 +248,67 @@ class Screen: public std::enable_shared_from_this<Screen> {
             this->dirtyFlag = true;
         }
 
+        /**
+         * @brief Get the regions updated by the last redraw
+         *
+         * This can be used to only copy the changed parts of the framebuffer to the display. The
+         * rectangles are in logical (screen) coordinates; use convertToFramebuffer() to get the
+         * corresponding regions of the underlying framebuffer.
+         *
+         * For displays with a high per-transfer cost, a RefreshPlanner can turn these regions into
+         * a cheaper set of transfers.
+         */
+        constexpr inline const auto &getLastDamage() const {
+            return this->lastDamage;
+        }
+        Rect convertToFramebuffer(const Rect &rect) const;
+
+        std::future<CaptureResult> captureAsync(const Rect &rect,
+                const CaptureFormat format = CaptureFormat::Png);
+        /**
+         * @brief Capture the entire screen
+         *
+         * @seeAlso captureAsync
+         */
+        inline std::future<CaptureResult> captureAsync(
+                const CaptureFormat format = CaptureFormat::Png) {
+            return this->captureAsync(Rect({0, 0}, this->size), format);
+        }
+
+        /**
+         * @brief Set the frame recorder
+         *
+         * When set, the damaged regions of each frame are passed to the recorder after the screen
+         * is redrawn.
+         *
+         * @param newRecorder Frame recorder to use, or `nullptr` to stop recording
+         */
+        inline void setFrameRecorder(const std::shared_ptr<FrameRecorder> &newRecorder) {
+            this->recorder = newRecorder;
+        }
+        /**
+         * @brief Get the current frame recorder, if any
+         */
+        constexpr inline auto &getFrameRecorder() const {
+            return this->recorder;
+        }
+
+        void setFrameGovernor(const std::shared_ptr<FrameGovernor> &newGovernor);
+        /**
+         * @brief Get the current frame governor, if any
+         */
+        constexpr inline auto &getFrameGovernor() const {
+            return this->governor;
+        }
+        /**
+         * @brief Get the rendering quality tier currently in effect
+         *
+         * Without a frame governor, the screen always renders at full quality.
+         */
+        inline QualityTier getQualityTier() const {
+            return this->governor ? this->governor->getTier() : QualityTier::Full;
+        }
+
         void setRootViewController(const std::shared_ptr<ViewController> &newRoot);
         /**
          * @brief Get the current root view controller
@@ -139,10 +325,79 @@ class Screen: public std::enable_shared_from_this<Screen> {
         inline auto &getAnimator() {
             return this->anim;
         }
+        /**
+         * @brief Get the surface pool
+         *
+         * The pool provides backing memory for offscreen surfaces used by widgets.
+         */
+        inline auto &getSurfacePool() {
+            return this->surfacePool;
+        }
 
         void redraw();
         void handleAnimations();
 
+        /**
+         * @brief Get the frame rendering statistics
+         */
+        constexpr inline auto &getFrameStats() const {
+            return this->frameStats;
+        }
+
+        void setProfilingEnabled(const bool enabled, const uint32_t windowFrames = 60);
+        /**
+         * @brief Get whether draw profiling is enabled
+         */
+        constexpr inline bool isProfilingEnabled() const {
+            return this->profiling;
+        }
+
+        std::string dumpTree();
+
+        MemoryStats getMemoryStats() const;
+        /**
+         * @brief Set the memory budget
+         *
+         * When the total memory accounted by the library exceeds this budget after a frame has
+         * been rendered, cached resources (text layouts, offscreen surfaces) are released in least
+         * recently visible order: first those belonging to widgets that are not visible, then, if
+         * that was insufficient, those of visible widgets, until usage is an eighth below the
+         * budget. They are lazily re-created when next drawn. If releasing all caches could not
+         * bring usage within the budget, nothing is released.
+         *
+         * @param bytes Memory budget in bytes, or 0 to disable
+         */
+        inline void setMemoryBudget(const size_t bytes) {
+            this->memoryBudget = bytes;
+        }
+        /**
+         * @brief Get the current memory budget
+         */
+        constexpr inline auto getMemoryBudget() const {
+            return this->memoryBudget;
+        }
+
+        /**
+         * @brief Set the offscreen cache timeout
+         *
+         * Widgets that have not been visible (because they, or one of their ancestors, are hidden
+         * or have drawing inhibited) for at least this long will have their cached resources
+         * released automatically.
+         *
+         * @param timeout Time after which caches are released, or 0 to disable
+         */
+        inline void setOffscreenCacheTimeout(const std::chrono::seconds timeout) {
+            this->offscreenCacheTimeout = timeout;
+        }
+        /**
+         * @brief Get the offscreen cache timeout
+         */
+        constexpr inline auto getOffscreenCacheTimeout() const {
+            return this->offscreenCacheTimeout;
+        }
+
+        size_t trimMemory(const MemoryPressure level);
+
         /**
          * @brief Set the screen's background color
          *
@@ -166,54 +421,85 @@ class Screen: public std::enable_shared_from_this<Screen> {
     public:
         void processEvents();
 
-        /**
-         * @brief Insert an event into the event queue
-         *
-         * @param eevnt Event to insert into the event queue
-         * @param atEnd Whether the event is to go at the end or front of the event queue
-         */
-        inline void queueEvent(const Event event, const bool atEnd = true) {
-            std::lock_guard lg(this->eventQueueLock);
-
-            if(atEnd) {
-                this->eventQueue.emplace_back(event);
-            } else {
-                this->eventQueue.emplace_front(event);
-            }
-        }
+        void queueEvent(const Event event, const bool atEnd = true);
 
+        void setFirstResponder(const std::shared_ptr<Widget> &widget);
         /**
-         * @brief Set a widget as the first responder
-         *
-         * First responder widgets will receive all modal (that is, keyboard and scroll events)
-         * user input.
+         * @brief Get the first responder widget
          */
-        inline void setFirstResponder(const std::shared_ptr<Widget> &widget) {
-            this->firstResponder = widget;
-            this->firstResponderDirty = true;
+        inline std::shared_ptr<Widget> getFirstResponder() const {
+            return this->firstResponder.lock();
         }
 
+        void moveFocus(const int steps);
+
     private:
         void commonInit();
+        void createDrawContext(struct _cairo_surface *target);
+        void updateGeometry();
+        void upscaleDamage();
+        void preserveCaptures();
+        void recordFrame();
+
+        Rect mapToFramebuffer(const Rect &rect, const double margin) const;
 
         void setRootWidget(const std::shared_ptr<Widget> &newRoot);
 
+        void addDamage(const Rect &rect);
+        void drawDamage(const Rect &rect);
+        void drawDamageFrom(const std::shared_ptr<Widget> &start, const Rect &rect);
+        void collectDirtyWidgets();
+
+        void updateFrameStats(const std::chrono::nanoseconds frameTime);
+        void applyQualityTier();
+        void checkMemoryBudget();
+        void sweepCaches();
+        void releaseStaleCaches();
+
+        bool dispatchGestureTouch(const event::Touch &event);
+        void updateGestures();
+        void cancelGestures();
+
     private:
+        /**
+         * @brief Maximum number of separate damage rectangles
+         *
+         * When more regions than this are invalidated between redraws, they're merged.
+         */
+        constexpr static const size_t kMaxDamageRects{8};
+
+        /// Time after which idle surface pool buffers are released
+        constexpr static const std::chrono::seconds kSurfacePoolIdleTime{5};
+        /**
+         * @brief Low-water mark for releasing caches, as a fraction of the memory budget
+         *
+         * When the budget is exceeded, caches are released until usage is 1/8th below the budget.
+         */
+        constexpr static const size_t kMemoryLowWaterDivisor{8};
+
+        /// At the minimal quality tier, low priority widgets are only redrawn every this many frames
+        constexpr static const uint64_t kLowPriorityInterval{4};
+
         /// Pixel format of the screen
         PixelFormat format;
 
         /// Physical size of the output framebuffer
         Size physSize;
-        /// Dimensions of the rendering surface (takes into account rotation)
+        /// Logical dimensions of the screen (takes into account rotation and scale factor)
         Size size;
         /// User interface scale factor
         double scaleFactor{1.};
         /// Display rotation
         Rotation rotation{Rotation::None};
 
+        /// How the scale factor is applied
+        ScaleMode scaleMode{ScaleMode::Vector};
+
         /// Underlying Cairo rendering surface
         struct _cairo_surface *surface{nullptr};
-        /// Cairo drawing context, backed by the framebuffer surface
+        /// Intermediate surface at logical resolution, when upscaling
+        struct _cairo_surface *lowResSurface{nullptr};
+        /// Cairo drawing context, backed by the framebuffer or intermediate surface
         struct _cairo *drawCtx{nullptr};
 
         /// Screen background color
@@ -225,12 +511,59 @@ class Screen: public std::enable_shared_from_this<Screen> {
 
         /// Animation coordinator instance
         std::shared_ptr<Animator> anim;
+        /// Pool of offscreen surface buffers
+        std::shared_ptr<SurfacePool> surfacePool;
+        /// Index of focusable widgets
+        std::shared_ptr<FocusEngine> focus;
+
+        /// Regions of the screen to redraw
+        std::vector<Rect> damage;
+        /// Regions redrawn by the last redraw
+        std::vector<Rect> lastDamage;
+
+        /// Widgets that were invalidated since the last redraw
+        std::vector<std::weak_ptr<Widget>> dirtyWidgets;
+        /// Widgets invalidated for the redraw in progress
+        std::vector<std::weak_ptr<Widget>> redrawWidgets;
+
+        /// Worker thread for encoding screen captures (created on first use)
+        std::shared_ptr<CaptureWorker> captureWorker;
+        /// Captures whose pixel data has not been entirely copied from the framebuffer yet
+        std::vector<std::shared_ptr<CaptureRequest>> pendingCaptures;
+        /// Frame recorder that receives each redrawn frame
+        std::shared_ptr<FrameRecorder> recorder;
+        /// Frame governor that selects the rendering quality tier
+        std::shared_ptr<FrameGovernor> governor;
 
         /// Event queue
         std::deque<Event> eventQueue;
         /// Lock protecting the event queue
         std::mutex eventQueueLock;
 
+        /// Frame rendering statistics
+        FrameStats frameStats;
+        /// Number of frames in a profiling window
+        uint32_t profileWindowFrames{60};
+        /// Frames rendered in the current profiling window
+        uint32_t profileWindowElapsed{0};
+
+        /// Memory budget (bytes), or 0 if none
+        size_t memoryBudget{0};
+        /// Number of times caches were trimmed because the budget was exceeded
+        uint32_t memoryTrimCount{0};
+        /// Time after which offscreen widgets release their caches (0 = never)
+        std::chrono::seconds offscreenCacheTimeout{10};
+        /// Cache tick at which caches were last swept
+        uint32_t lastCacheSweepTick{0};
+        /**
+         * @brief Widgets that may hold cached resources
+         *
+         * Widgets are added when they're drawn, and moved to the back whenever they're drawn again
+         * (at most once per cache tick) so the list is ordered from least to most recently
+         * visible. They're removed once their caches are released, or they're deallocated.
+         */
+        std::list<Widget *> cacheHolders;
+
         /// Which widget has the current input focus
         std::weak_ptr<Widget> firstResponder;
         /**
@@ -241,6 +574,8 @@ class Screen: public std::enable_shared_from_this<Screen> {
          * touch is moved up.
          */
         std::weak_ptr<Widget> touchTrackingWidget;
+        /// Gesture recognizers tracking the current touch
+        std::vector<std::shared_ptr<GestureRecognizer>> activeGestures;
 
         /// Set when any widget in this screen becomes dirty
         uintptr_t dirtyFlag                     :1{false};
@@ -252,6 +587,16 @@ class Screen: public std::enable_shared_from_this<Screen> {
         uintptr_t firstResponderDirty           :1{false};
         /// Is event processing inhibited?
         uintptr_t eventsInhibited               :1{false};
+        /// A touch is currently down
+        uintptr_t touchActive                   :1{false};
+        /// A gesture was recognized, so the current touch is no longer delivered to widgets
+        uintptr_t touchesCancelled              :1{false};
+        /// Whether draw profiling is enabled
+        uintptr_t profiling                     :1{false};
+        /// Whether simple primitives are drawn with the software rasterizer
+        uintptr_t softwareRasterizer            :1{false};
+        /// Whether invalidations of widgets with unchanged draw state are dropped
+        uintptr_t contentHashing                :1{false};
 };
 }
 
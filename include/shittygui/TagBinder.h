@@ -0,0 +1,158 @@
+#ifndef SHITTYGUI_TAGBINDER_H
+#define SHITTYGUI_TAGBINDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace shittygui {
+class Screen;
+class TagTable;
+class Widget;
+
+namespace widgets {
+class Label;
+class ProgressBar;
+}
+
+/**
+ * @brief Binds widget properties to tags
+ *
+ * Each binding connects a tag in a tag table to a property of a widget, such as a label's text or
+ * a progress bar's progress. Once per frame (or whenever apply() is invoked) bindings whose tag
+ * changed since they were last applied are updated; if no tag in the table changed at all, this
+ * costs only a single comparison.
+ *
+ * Text is formatted into a fixed buffer, without any memory allocations, and labels are only
+ * updated if the formatted text differs from what they currently display.
+ *
+ * Bindings hold weak references to their widgets, and are removed automatically once the widget
+ * is deallocated.
+ */
+class TagBinder {
+    public:
+        /**
+         * @brief Describes how a numeric value is formatted as text
+         */
+        struct NumberFormat {
+            /// Number of digits after the decimal point
+            uint8_t precision{0};
+            /// Factor to multiply the value with before formatting
+            double scale{1.};
+            /// Text inserted before the number
+            std::string prefix;
+            /// Text appended after the number (such as a unit)
+            std::string suffix;
+        };
+
+        /**
+         * @brief Callback for custom bindings
+         *
+         * Invoked with the bound widget and the tag's new value.
+         */
+        using Callback = std::function<void(const std::shared_ptr<Widget> &widget,
+                const double value)>;
+
+        TagBinder(const std::shared_ptr<TagTable> &table);
+        ~TagBinder();
+
+        TagBinder(const TagBinder &) = delete;
+        TagBinder &operator=(const TagBinder &) = delete;
+
+        void bindText(const std::shared_ptr<widgets::Label> &label, const uint32_t tag,
+                const NumberFormat &format);
+        /**
+         * @brief Bind a label's text to a tag, formatted as an integer
+         */
+        inline void bindText(const std::shared_ptr<widgets::Label> &label, const uint32_t tag) {
+            this->bindText(label, tag, NumberFormat{});
+        }
+        void bindProgress(const std::shared_ptr<widgets::ProgressBar> &bar, const uint32_t tag,
+                const double min = 0., const double max = 1.);
+        void bindHidden(const std::shared_ptr<Widget> &widget, const uint32_t tag,
+                const bool hiddenWhenZero = true);
+        void bind(const std::shared_ptr<Widget> &widget, const uint32_t tag,
+                const Callback &callback);
+
+        size_t unbind(const std::shared_ptr<Widget> &widget);
+
+        /**
+         * @brief Get the number of bindings
+         */
+        inline size_t getNumBindings() const {
+            return this->bindings.size();
+        }
+
+        void attach(const std::shared_ptr<Screen> &screen);
+        void detach();
+
+        size_t apply();
+
+        static size_t Format(const double value, const NumberFormat &format, char *out,
+                const size_t outSize);
+
+    private:
+        /**
+         * @brief Widget property a binding applies to
+         */
+        enum class Kind: uint8_t {
+            Text,
+            Progress,
+            Hidden,
+            Custom,
+        };
+
+        /**
+         * @brief A single binding
+         */
+        struct Binding {
+            /// Index of the bound tag
+            uint32_t tag;
+            /// Tag version last applied
+            uint32_t version;
+            /// Whether the binding was applied at least once
+            bool applied{false};
+            /// Property to update
+            Kind kind;
+
+            /// Widget to update
+            std::weak_ptr<Widget> widget;
+
+            /// Text format (for text bindings)
+            NumberFormat format;
+            /// Value range (for progress bindings) or polarity (for hidden bindings)
+            double min{0.}, max{1.};
+            /// Callback (for custom bindings)
+            Callback callback;
+        };
+
+        void add(Binding &&binding, const std::shared_ptr<Widget> &widget);
+        bool applyBinding(Binding &binding, const double value);
+
+    private:
+        /// Maximum length of formatted text, in bytes
+        constexpr static const size_t kMaxTextLength{64};
+
+        /// Table to read tags from
+        std::shared_ptr<TagTable> table;
+        /// All bindings, ordered by tag
+        std::vector<Binding> bindings;
+
+        /// Table generation at the last time bindings were applied
+        uint64_t lastGeneration{0};
+        /// Whether bindings were added or removed since they were last applied
+        bool bindingsDirty{false};
+
+        /// Screen whose animator applies the bindings
+        std::weak_ptr<Screen> screen;
+        /// Animator callback token
+        uint32_t animatorToken{0};
+        /// Whether the animator callback is registered
+        bool attached{false};
+};
+}
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef SHITTYGUI_TAGTABLE_H
+#define SHITTYGUI_TAGTABLE_H
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace shittygui {
+/**
+ * @brief Table of process values ("tags")
+ *
+ * A tag table holds a fixed number of numeric values, identified by their index. Each tag has a
+ * version counter that's incremented every time its value changes, and the table has a generation
+ * counter that's incremented on every change to any tag; readers (such as TagBinder) use these to
+ * cheaply find out what changed since they last looked.
+ *
+ * The table can live in memory it allocates itself, or in an externally provided region (such as
+ * shared memory written by another process.) It's safe to update tags from one thread (or
+ * process) while others read them.
+ *
+ * @remark Tags hold double precision values; booleans and enumerations are stored as numbers.
+ */
+class TagTable {
+    public:
+        /**
+         * @brief Header at the start of the table's memory
+         */
+        struct Header {
+            /// Magic value (kMagic)
+            uint32_t magic;
+            /// Number of tags in the table
+            uint32_t numTags;
+            /// Incremented whenever any tag changes
+            std::atomic<uint64_t> generation;
+        };
+
+        /**
+         * @brief Storage for a single tag
+         */
+        struct Slot {
+            /// Value of the tag (bit pattern of a double)
+            std::atomic<uint64_t> value;
+            /// Incremented whenever the value changes
+            std::atomic<uint32_t> version;
+            uint32_t reserved;
+        };
+
+        static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                "tag tables require lock free 64-bit atomics");
+
+        /// Magic value of the table header ('TAGT')
+        constexpr static const uint32_t kMagic{0x54474154};
+
+        TagTable(const size_t numTags);
+        TagTable(void *memory, const size_t size, const bool initialize = false);
+        ~TagTable();
+
+        TagTable(const TagTable &) = delete;
+        TagTable &operator=(const TagTable &) = delete;
+
+        /**
+         * @brief Get the number of bytes of memory required for a table
+         */
+        constexpr static inline size_t GetRequiredSize(const size_t numTags) {
+            return sizeof(Header) + (numTags * sizeof(Slot));
+        }
+
+        /**
+         * @brief Get the number of tags in the table
+         */
+        inline size_t getNumTags() const {
+            return this->header->numTags;
+        }
+
+        void set(const uint32_t tag, const double value);
+
+        /**
+         * @brief Get the value of a tag
+         */
+        inline double get(const uint32_t tag) const {
+            return std::bit_cast<double>(this->getSlot(tag).value.load(std::memory_order_relaxed));
+        }
+        /**
+         * @brief Get the version counter of a tag
+         *
+         * A value read after reading the version is at least as new as that version.
+         */
+        inline uint32_t getVersion(const uint32_t tag) const {
+            return this->getSlot(tag).version.load(std::memory_order_acquire);
+        }
+        /**
+         * @brief Get the generation counter of the table
+         */
+        inline uint64_t getGeneration() const {
+            return this->header->generation.load(std::memory_order_acquire);
+        }
+
+    private:
+        const Slot &getSlot(const uint32_t tag) const;
+
+    private:
+        /// Table header
+        Header *header{nullptr};
+        /// Tag storage
+        Slot *slots{nullptr};
+        /// Whether the memory was allocated by us
+        bool owned{false};
+};
+}
+
+#endif
@@ -1,20 +1,76 @@
 #ifndef SHITTYGUI_TEXTRENDERING_H
 #define SHITTYGUI_TEXTRENDERING_H
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include <shittygui/Types.h>
+#include <shittygui/WidgetArchive.h>
 
 namespace shittygui {
+/**
+ * @brief Font used to render text
+ *
+ * Opaque type defined by the text rendering backend.
+ */
+struct TextFont;
+/**
+ * @brief Text layout state
+ *
+ * Opaque type defined by the text rendering backend.
+ */
+struct TextLayout;
+
 /**
  * @brief Text rendering helper class
  *
- * This is a helper class that provides a small wrapper around Pango and the Cairo rendering
- * integration to allow widgets to render text strings. It manages the lifecycle of the underlying
- * layout object, and provides the class some methods rendering text.
+ * This is a helper class that provides a small wrapper around the text layout engine and its
+ * Cairo rendering integration to allow widgets to render text strings. It manages the lifecycle
+ * of the underlying layout object, and provides the class some methods rendering text.
+ *
+ * The layout engine is selected at build time (with the `SHITTYGUI_TEXT_BACKEND` CMake option):
+ * either Pango, or a lightweight backend that shapes text with HarfBuzz and renders it with
+ * FreeType directly, without depending on Pango or GLib. Both support the same interface; the
+ * lightweight backend supports only a subset of Pango's markup (see setTextContent().)
  */
 class TextRendering {
     public:
+        /**
+         * @brief Position of a character in a line of text
+         */
+        struct CharacterPosition {
+            /// Byte offset of the character in the text
+            uint32_t index;
+            /// Horizontal position of the character's leading edge, in pixels
+            int32_t x;
+        };
+
+        /**
+         * @brief Text to be fitted into a box
+         *
+         * Describes everything that affects the result of getFittingFontSize(), so that results
+         * can be cached.
+         */
+        struct TextFit {
+            /// Text, as it was set on the layout
+            std::string_view text;
+            /// Size of the box the text must fit in
+            Size box;
+            /// Smallest allowed font size, in points
+            double minSize;
+            /// Largest allowed font size, in points
+            double maxSize;
+            /// Whether the text contains markup
+            bool hasMarkup;
+            /// Whether the layout renders multiple paragraphs
+            bool multiParagraph;
+            /// Whether the layout wraps lines at word boundaries
+            bool wordWrap;
+        };
+
         ~TextRendering();
 
     protected:
@@ -25,22 +81,50 @@ class TextRendering {
         void initTextResources(struct _cairo *drawCtx);
         void releaseTextResources();
 
-        struct _PangoFontDescription *getFont(const std::string_view name, const double size) const;
+        TextFont *getFont(const std::string_view name, const double size) const;
+        static void ReleaseFont(TextFont *font);
+        static void EncodeFont(ArchiveEncoder &encoder, const ArchiveKey key,
+                const TextFont *font);
+        static void HashFont(uint64_t &hash, const TextFont *font);
+        static std::string GetFontName(const TextFont *font);
+        static double GetFontSize(const TextFont *font);
+        void setTextFont(const TextFont *font);
+
+        double getFittingFontSize(const TextFont *font, const TextFit &fit);
+        void setFittedTextFont(const TextFont *font, TextFont *&fitted, TextFit fit);
+
         void drawString(struct _cairo *drawCtx, const Rect &bounds, const Color &color,
                 const std::string_view &str, const VerticalAlign valign = VerticalAlign::Top,
                 const bool parseMarkup = false);
         void drawString(struct _cairo *drawCtx, const Rect &bounds, const Color &color,
                 const VerticalAlign valign = VerticalAlign::Top);
 
+        Rect getTextExtents(const Rect &bounds, const VerticalAlign valign = VerticalAlign::Top);
+
+        void drawTextLine(struct _cairo *drawCtx, const Point origin, const Color &color);
+        Size getTextLineSize();
+        void getCharacterPositions(std::vector<CharacterPosition> &out);
+
         void setTextLayoutAlign(const TextAlign newAlign, const bool justified);
         void setTextLayoutEllipsization(const EllipsizeMode newMode);
         void setTextLayoutWrapMode(const bool multiParagraph, const bool wordWrap);
 
         void setTextContent(const std::string_view &str, const bool parseMarkup = false);
 
-    protected:
-        /// Pango text layout object
-        struct _PangoLayout *layout{nullptr};
+    private:
+        static int GetVerticalOffset(const Rect &bounds, const int height,
+                const VerticalAlign valign);
+
+        void updateLayoutBytes(const size_t textLength);
+
+        Size measureText(const int width);
+
+    private:
+        /// Text layout object (backend specific)
+        TextLayout *layout{nullptr};
+
+        /// Estimated memory used by the text layout (bytes)
+        size_t layoutBytes{0};
 };
 }
 
@@ -6,6 +6,7 @@
 #ifndef SHITTYGUI_TYPES_H
 #define SHITTYGUI_TYPES_H
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 
@@ -36,6 +37,46 @@ struct Color {
     float a{1.};
 };
 
+/**
+ * @brief A compact color value (with alpha)
+ *
+ * Stores a color with 8 bits per component, which is a quarter the size of a Color. This is used
+ * where many colors are stored, such as in widgets; it converts to and from Color implicitly.
+ *
+ * @remark Components are clamped to [0, 1] when packed, so colors outside that range can't be
+ *         represented.
+ */
+struct PackedColor {
+    /// Create a fully opaque black color
+    PackedColor() = default;
+    /// Pack a color value
+    constexpr PackedColor(const Color &color) : r(Pack(color.r)), g(Pack(color.g)),
+        b(Pack(color.b)), a(Pack(color.a)) {}
+
+    /// Unpack the color value
+    constexpr operator Color() const {
+        return Color(this->r / 255.f, this->g / 255.f, this->b / 255.f, this->a / 255.f);
+    }
+
+    /// Is this color opaque?
+    constexpr inline bool isOpaque() const {
+        return (this->a == 0xFF);
+    }
+
+    constexpr bool operator==(const PackedColor &) const = default;
+
+    /// Color component values
+    uint8_t r{0}, g{0}, b{0};
+    /// Alpha component value
+    uint8_t a{0xFF};
+
+    private:
+        /// Convert a floating point color component to 8 bits
+        constexpr static uint8_t Pack(const float value) {
+            return static_cast<uint8_t>((std::clamp(value, 0.f, 1.f) * 255.f) + .5f);
+        }
+};
+
 /**
  * @brief Size of an object (in pixels)
  */
@@ -119,6 +160,104 @@ struct Rect {
               y2 = this->origin.y + this->size.height;
         return p.x >= this->origin.x && p.x <= x2 && p.y >= this->origin.y && p.y <= y2;
     }
+    /**
+     * @brief Test if the given rectangle lies entirely inside this rectangle
+     *
+     * @param r Rectangle to test
+     */
+    constexpr inline bool contains(const Rect &r) const {
+        return r.origin.x >= this->origin.x && r.origin.y >= this->origin.y &&
+            r.right() <= this->right() && r.bottom() <= this->bottom();
+    }
+
+    /**
+     * @brief Determine whether the rectangle has no area
+     */
+    constexpr inline bool isEmpty() const {
+        return !this->size.width || !this->size.height;
+    }
+
+    /**
+     * @brief Get the X coordinate one past the right edge of the rectangle
+     */
+    constexpr inline int32_t right() const {
+        return static_cast<int32_t>(this->origin.x) + this->size.width;
+    }
+    /**
+     * @brief Get the Y coordinate one past the bottom edge of the rectangle
+     */
+    constexpr inline int32_t bottom() const {
+        return static_cast<int32_t>(this->origin.y) + this->size.height;
+    }
+    /**
+     * @brief Get the area of the rectangle, in pixels
+     */
+    constexpr inline uint32_t area() const {
+        return static_cast<uint32_t>(this->size.width) * this->size.height;
+    }
+
+    /**
+     * @brief Test whether two rectangles overlap
+     *
+     * @param r Rectangle to test against
+     *
+     * @return Whether the rectangles share at least one pixel
+     */
+    constexpr inline bool intersects(const Rect &r) const {
+        return !this->isEmpty() && !r.isEmpty() && r.origin.x < this->right() &&
+            this->origin.x < r.right() && r.origin.y < this->bottom() &&
+            this->origin.y < r.bottom();
+    }
+    /**
+     * @brief Calculate the intersection of two rectangles
+     *
+     * @param r Rectangle to intersect with
+     *
+     * @return Area covered by both rectangles; an empty rectangle if they do not overlap
+     */
+    constexpr inline Rect intersection(const Rect &r) const {
+        if(!this->intersects(r)) {
+            return {};
+        }
+
+        const auto x1 = std::max(this->origin.x, r.origin.x),
+              y1 = std::max(this->origin.y, r.origin.y);
+        const auto x2 = std::min(this->right(), r.right()),
+              y2 = std::min(this->bottom(), r.bottom());
+
+        return Rect({x1, y1}, Size(x2 - x1, y2 - y1));
+    }
+    /**
+     * @brief Calculate the bounding rectangle of two rectangles
+     *
+     * @param r Rectangle to combine with
+     *
+     * @return Smallest rectangle containing both rectangles; empty rectangles are ignored
+     */
+    constexpr inline Rect unionWith(const Rect &r) const {
+        if(r.isEmpty()) {
+            return *this;
+        } else if(this->isEmpty()) {
+            return r;
+        }
+
+        const auto x1 = std::min(this->origin.x, r.origin.x),
+              y1 = std::min(this->origin.y, r.origin.y);
+        const auto x2 = std::max(this->right(), r.right()),
+              y2 = std::max(this->bottom(), r.bottom());
+
+        return Rect({x1, y1}, Size(x2 - x1, y2 - y1));
+    }
+    /**
+     * @brief Offset the rectangle's origin
+     *
+     * @param dX Offset on X axis
+     * @param dY Offset on Y axis
+     */
+    constexpr inline Rect offset(const int dX, const int dY) const {
+        return Rect({static_cast<int16_t>(this->origin.x + dX),
+                static_cast<int16_t>(this->origin.y + dY)}, this->size);
+    }
 
     Point origin;
     Size size;
@@ -1,20 +1,29 @@
 #ifndef SHITTYGUI_WIDGET_H
 #define SHITTYGUI_WIDGET_H
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <list>
 #include <memory>
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include <shittygui/Event.h>
 #include <shittygui/Screen.h>
 #include <shittygui/Types.h>
+#include <shittygui/WidgetArchive.h>
 
 namespace shittygui {
 class Animator;
+class GestureRecognizer;
+class Image;
+class JsonWriter;
 class Screen;
+class SurfacePool;
 
 /**
  * @brief Base widget class
@@ -29,6 +38,7 @@ class Screen;
  * parent of the widget.
  */
 class Widget: public std::enable_shared_from_this<Widget> {
+    friend class FocusEngine;
     friend class Screen;
     friend class ViewController;
 
@@ -41,16 +51,8 @@ class Widget: public std::enable_shared_from_this<Widget> {
          */
         using EventCallback = std::function<void(const std::shared_ptr<Widget> &sender)>;
 
-        /**
-         * @brief Initialize a widget with the given frame
-         *
-         * @param frame Frame rectangle, its origin is relative to the parent widget
-         */
-        Widget(const Rect &frame) {
-            this->setFrame(frame);
-        }
-
-        virtual ~Widget() = default;
+        Widget(const Rect &frame);
+        virtual ~Widget();
 
         /**
          * @brief Determine whether the widget is fully opaque
@@ -76,7 +78,14 @@ class Widget: public std::enable_shared_from_this<Widget> {
          * @brief Set whether the view is hidden
          */
         inline void setHidden(const bool hidden) {
+            if(hidden) {
+                this->invalidateFrame();
+            }
+
             this->hidden = hidden;
+            this->movedSinceDraw = true;
+            this->invalidateScreenGeometry();
+            this->invalidateFocus();
             this->needsDisplay();
         }
         /**
@@ -86,6 +95,23 @@ class Widget: public std::enable_shared_from_this<Widget> {
             return this->hidden;
         }
 
+        /**
+         * @brief Set whether the widget is low priority
+         *
+         * Redrawing low priority widgets (for example, purely informational displays that update
+         * frequently) may be deferred for a few frames when the screen renders at its minimal
+         * quality tier.
+         */
+        inline void setLowPriority(const bool lowPriority) {
+            this->lowPriority = lowPriority;
+        }
+        /**
+         * @brief Get whether the widget is low priority
+         */
+        constexpr inline bool isLowPriority() const {
+            return this->lowPriority;
+        }
+
 
         /**
          * @brief Does the widget need to be redrawn?
@@ -103,8 +129,25 @@ class Widget: public std::enable_shared_from_this<Widget> {
         }
 
         virtual void needsDisplay();
+        void needsDisplayInRect(const Rect &rect);
         virtual void needsChildDisplay();
 
+        /**
+         * @brief Get a hash of the state that determines the widget's appearance
+         *
+         * When content hashing is enabled on the screen, invalidations of a widget whose hash is
+         * the same as when it was last drawn are dropped, since redrawing it would produce the
+         * same pixels. The hash must cover everything that the widget's draw() method depends on,
+         * except for its size and focus state, which are accounted for separately.
+         *
+         * @return Hash of the widget's draw state, or 0 if it can't be determined (for example,
+         *         because a change is pending that hasn't been applied yet); the widget is then
+         *         always redrawn when invalidated.
+         */
+        virtual uint64_t getDrawStateHash() const {
+            return 0;
+        }
+
         /**
          * @brief Draw the widget
          *
@@ -112,16 +155,22 @@ class Widget: public std::enable_shared_from_this<Widget> {
          * region set up to cover the bounds of this view. Additionally, the drawing context will
          * be translated such that its origin is the same as the screen origin of this widget.
          *
+         * The drawing context is further clipped to the region of the widget being redrawn, which
+         * can be retrieved with getDirtyRect(); widgets can use this to skip drawing content that
+         * lies entirely outside of it.
+         *
          * @param drawCtx Cairo drawing context
          * @param everything When set, draw everything regardless of dirty status
          */
-        virtual void draw(struct _cairo *drawCtx, const bool everything = false) {
-            this->dirtyFlag = false;
-        }
+        virtual void draw(struct _cairo *drawCtx, const bool everything = false);
         virtual void drawChildren(struct _cairo *drawCtx, const bool everything = false);
 
         void addChild(const std::shared_ptr<Widget> &toAdd, const bool atStart = false);
+        void addChildren(std::span<const std::shared_ptr<Widget>> toAdd,
+                const bool atStart = false);
         bool removeChild(const std::shared_ptr<Widget> &toRemove);
+        size_t removeChildren(
+                const std::function<bool(const std::shared_ptr<Widget> &)> &predicate);
         /**
          * @brief Remove the widget from its parent
          */
@@ -134,6 +183,13 @@ class Widget: public std::enable_shared_from_this<Widget> {
             return parent->removeChild(this->shared_from_this());
         }
 
+        /**
+         * @brief Get the number of children
+         */
+        inline size_t getNumChildren() const {
+            return this->children.size();
+        }
+
         /**
          * @brief Whether this view has any children
          */
@@ -173,8 +229,11 @@ class Widget: public std::enable_shared_from_this<Widget> {
          * @param newFrame New frame rectangle
          */
         void setFrame(const Rect &newFrame) {
+            this->invalidateFrame();
             this->frame = newFrame;
-            this->bounds = {{0, 0}, newFrame.size};
+            this->movedSinceDraw = true;
+            this->invalidateScreenGeometry();
+            this->invalidateFocus();
             this->needsDisplay();
             this->frameDidChange();
         }
@@ -182,15 +241,21 @@ class Widget: public std::enable_shared_from_this<Widget> {
          * @brief Set the origin of the frame rectangle
          */
         void setFrameOrigin(const Point newOrigin) {
+            this->invalidateFrame();
             this->frame.origin = newOrigin;
+            this->movedSinceDraw = true;
+            this->invalidateScreenGeometry();
+            this->invalidateFocus();
             this->needsDisplay();
             this->frameDidChange();
         }
         /**
          * @brief Get the bounds rectangle of the widget
+         *
+         * The bounds have the same size as the frame, with the origin at (0, 0).
          */
-        constexpr inline auto getBounds() const {
-            return this->bounds;
+        constexpr inline Rect getBounds() const {
+            return Rect({0, 0}, this->frame.size);
         }
 
         /**
@@ -257,6 +322,23 @@ class Widget: public std::enable_shared_from_this<Widget> {
             return false;
         }
 
+        /**
+         * @brief Whether the widget is the first responder of its screen
+         */
+        constexpr inline bool isFocused() const {
+            return this->focused;
+        }
+        virtual void drawFocusRing(struct _cairo *drawCtx);
+
+        /**
+         * @brief Invoked when the widget became the first responder of its screen
+         */
+        virtual void didBecomeFirstResponder() {}
+        /**
+         * @brief Invoked when the widget is no longer the first responder of its screen
+         */
+        virtual void didResignFirstResponder() {}
+
         /**
          * @brief Whether the widget wants to track touch events
          *
@@ -281,6 +363,18 @@ class Widget: public std::enable_shared_from_this<Widget> {
             return false;
         }
 
+        /**
+         * @brief Handle cancellation of a touch
+         *
+         * Invoked on the widget tracking a touch when a gesture recognizer recognized its gesture
+         * and took over the touch. The widget won't receive any more events for the touch, and
+         * should revert any state it set up when the touch went down, without acting on it.
+         */
+        virtual void handleTouchCancelled() {}
+
+        void addGestureRecognizer(const std::shared_ptr<GestureRecognizer> &recognizer);
+        bool removeGestureRecognizer(const std::shared_ptr<GestureRecognizer> &recognizer);
+
         /**
          * @brief Handle a scroll event
          *
@@ -302,19 +396,46 @@ class Widget: public std::enable_shared_from_this<Widget> {
             return false;
         }
 
+        /**
+         * @brief Handle a key event
+         *
+         * Key events are delivered only to the first responder.
+         *
+         * @return Whether the event was handeled
+         */
+        virtual inline bool handleKeyEvent(const event::Key &event) {
+            return false;
+        }
+
         /**
          * @brief Set the debug label of the widget
+         *
+         * @remark If the library is built without debug labels (the `SHITTYGUI_DEBUG_LABELS`
+         *         CMake option) this does nothing.
          */
         inline void setDebugLabel(const std::string_view &newLabel) {
-            this->debugLabel = newLabel;
+#ifndef SHITTYGUI_NO_DEBUG_LABELS
+            if(newLabel.empty()) {
+                this->debugLabel.reset();
+            } else {
+                this->debugLabel = std::make_unique<std::string>(newLabel);
+            }
+#endif
         }
         /**
          * @brief Get a debug label for the component
          *
          * This is a string label that can be dumped for debugging to identify a component.
+         *
+         * @return Debug label, or an empty string if none was set; it's always NUL terminated.
          */
-        constexpr inline std::string_view getDebugLabel() const {
-            return this->debugLabel;
+        inline std::string_view getDebugLabel() const {
+#ifndef SHITTYGUI_NO_DEBUG_LABELS
+            if(this->debugLabel) {
+                return *this->debugLabel;
+            }
+#endif
+            return "";
         }
 
         /**
@@ -330,6 +451,34 @@ class Widget: public std::enable_shared_from_this<Widget> {
             return this->tag;
         }
 
+        virtual size_t getMemoryFootprint() const;
+
+        /**
+         * @brief Release cached rendering resources
+         *
+         * Invoked when memory is running low to release any resources (such as text layouts or
+         * offscreen surfaces) that can be lazily re-created the next time the widget is drawn.
+         *
+         * @remark The default implementation does nothing.
+         */
+        virtual void releaseCachedResources() {}
+
+        std::shared_ptr<Image> snapshot();
+
+        std::shared_ptr<Widget> findChildWithTag(const uintptr_t tag);
+
+        /**
+         * @brief Get the type of the widget, as stored in widget archives
+         *
+         * Widgets that return ArchiveWidgetType::None (the default) can't be archived.
+         */
+        virtual ArchiveWidgetType getArchiveType() const {
+            return ArchiveWidgetType::None;
+        }
+        virtual void encode(ArchiveEncoder &encoder) const;
+        virtual bool decode(const ArchiveValue &value);
+        virtual void decodeProperties(std::span<const ArchiveValue> values);
+
         /**
          * @brief Apply a method on all child widgets
          */
@@ -362,6 +511,22 @@ class Widget: public std::enable_shared_from_this<Widget> {
         }
 
     protected:
+        /// Width of the focus ring
+        constexpr static const double kFocusRingWidth{2.};
+        /// Color of the focus ring
+        constexpr static const Color kFocusRingColor{.2, .5, 1.};
+
+        /**
+         * @brief Get the region of the widget being redrawn
+         *
+         * This is only valid inside draw(); it's the part of the widget (in its own coordinate
+         * space) that was invalidated, either by the widget itself or by changes to widgets that
+         * overlap it.
+         */
+        constexpr inline const Rect &getDirtyRect() const {
+            return this->dirtyRect;
+        }
+
         /**
          * @brief Get the parent of this widget
          *
@@ -387,12 +552,90 @@ class Widget: public std::enable_shared_from_this<Widget> {
             return screen->getAnimator();
         }
 
+        /**
+         * @brief Find the surface pool of this widget's screen
+         *
+         * Widgets should allocate offscreen surfaces (for caching rendered content) from this
+         * pool, rather than creating them directly.
+         */
+        inline std::shared_ptr<SurfacePool> getSurfacePool() {
+            auto screen = this->getScreen();
+            if(!screen) {
+                return nullptr;
+            }
+
+            return screen->getSurfacePool();
+        }
+
         std::shared_ptr<Widget> findChildAt(const Point at, Point &outRelativePoint);
 
     private:
         void setScreen(const std::shared_ptr<Screen> &newScreen);
 
-        void updateChildData();
+        std::list<std::shared_ptr<Widget>>::iterator insertChild(
+                const std::shared_ptr<Widget> &toAdd,
+                std::list<std::shared_ptr<Widget>>::iterator pos);
+        std::list<std::shared_ptr<Widget>>::iterator detachChild(
+                std::list<std::shared_ptr<Widget>>::iterator it);
+        void invalidateFrame();
+        void addStructuralDamage(const Rect &rect);
+        void registerDirty();
+
+        void updateScreenGeometry();
+        void invalidateScreenGeometry();
+        void invalidateFocus();
+        Widget *findOpaqueCover(const Rect &area);
+
+        void drawChildRange(struct _cairo *drawCtx,
+                std::list<std::shared_ptr<Widget>>::iterator from);
+
+        void updateMemoryAccounting();
+        uint64_t computeDrawStateHash() const;
+
+        /**
+         * @brief Widget that may be holding cached resources
+         *
+         * Produced when walking the widget tree to decide which caches to release.
+         */
+        struct CacheCandidate {
+            /// Widget in question
+            Widget *widget;
+            /// Whether the widget is currently not visible (hidden or drawing inhibited)
+            bool offscreen;
+        };
+
+        void collectCacheCandidates(std::vector<CacheCandidate> &out, bool offscreen);
+        bool isOffscreen();
+
+        /**
+         * @brief Release cached resources, and remember that we did so
+         */
+        inline void purgeCachedResources() {
+            this->releaseCachedResources();
+            this->cachesReleased = true;
+            this->untrackCaches();
+        }
+
+        /**
+         * @brief Record that the widget was visited while drawing
+         *
+         * The widget is moved to the back of the cache list of the screen being drawn, at most
+         * once per cache tick.
+         */
+        inline void markVisible() {
+            if(this->lastVisibleTick != currentTick || this->cacheList != currentCacheList) {
+                this->lastVisibleTick = currentTick;
+                this->trackCaches(currentCacheList);
+            }
+            this->cachesReleased = false;
+        }
+
+        void trackCaches(std::list<Widget *> *list);
+        void untrackCaches();
+
+        void setProfilingEnabled(const bool enabled);
+        void rollProfileWindow();
+        size_t dumpTree(JsonWriter &writer);
 
         /**
          * @brief Execute a widget callback (recursive step)
@@ -430,22 +673,31 @@ class Widget: public std::enable_shared_from_this<Widget> {
         }
 
     protected:
+#ifndef SHITTYGUI_NO_DEBUG_LABELS
         /**
          * @brief Debugging label string
+         *
+         * Only allocated if a label is set, since most widgets don't have one.
          */
-        std::string debugLabel;
+        std::unique_ptr<std::string> debugLabel;
+#endif
 
         /// User specified tag value
         uintptr_t tag{0};
 
         /**
          * @brief Frame rectangle
+         *
+         * The bounds are derived from its size; see getBounds().
          */
         Rect frame;
         /**
-         * @brief Bounds rectangle
+         * @brief Region being redrawn
+         *
+         * Set before the widget is drawn to the part of it (in its own coordinate space) that is
+         * being redrawn.
          */
-        Rect bounds;
+        Rect dirtyRect;
 
         /**
          * @brief Dirty indicator
@@ -469,8 +721,8 @@ class Widget: public std::enable_shared_from_this<Widget> {
         /**
          * @brief Are any children not opaque?
          *
-         * This flag is updated any time children are added or removed from this widget. It's used
-         * to optimize drawing.
+         * This flag is updated any time children are added or removed from this widget, based on
+         * whether each child was opaque at the time it was added. It's used to optimize drawing.
          */
         uintptr_t hasTransparentChildren        :1{false};
 
@@ -497,6 +749,72 @@ class Widget: public std::enable_shared_from_this<Widget> {
         uintptr_t hidden                        :1{false};
 
     private:
+        /**
+         * @brief Current cache tick
+         *
+         * A coarse (one second resolution) timestamp, updated by the screen before every redraw.
+         * It is recorded in each widget that's visited during drawing, which allows determining
+         * how long a widget hasn't been visible.
+         */
+        static inline uint32_t currentTick{0};
+        /**
+         * @brief Cache list of the screen being drawn
+         *
+         * Set by the screen before every redraw, alongside the cache tick.
+         */
+        static inline std::list<Widget *> *currentCacheList{nullptr};
+
+        /**
+         * @brief Draw profiling information
+         *
+         * Accumulated draw times for the widget, allocated only while profiling is enabled on the
+         * screen the widget is on. Statistics are kept for the current window (of a screen defined
+         * number of frames) as well as the last completed window.
+         */
+        struct DrawProfile {
+            /// Statistics for a single profiling window
+            struct Window {
+                /// Time spent in this widget's draw method (nsec)
+                uint64_t selfTime{0};
+                /// Time spent drawing this widget and all its children (nsec)
+                uint64_t totalTime{0};
+                /// Number of times the widget was drawn
+                uint32_t drawCount{0};
+            };
+
+            /// Window being currently accumulated
+            Window current;
+            /// Last completed window
+            Window last;
+        };
+
+        /*
+         * These flags immediately follow the protected flags above, so that they all share a
+         * single word.
+         */
+        /// Cached resources were released, and the widget was not drawn since
+        uintptr_t cachesReleased                :1{false};
+        /// Cached screen geometry must be recalculated
+        uintptr_t geometryDirty                 :1{true};
+        /// Widget is on a screen, and neither it nor any of its ancestors are hidden
+        uintptr_t screenVisible                 :1{false};
+        /// Widget is in its screen's dirty widget list
+        uintptr_t inDirtyList                   :1{false};
+        /// Widget is in its screen's focus index
+        uintptr_t focusIndexed                  :1{false};
+        /// Widget is queued for re-indexing by the focus engine
+        uintptr_t focusPending                  :1{false};
+        /// Widget is the first responder, and draws a focus ring
+        uintptr_t focused                       :1{false};
+        /// Widget was not opaque when added to its parent, and counts as a transparent child
+        uintptr_t countedTransparent            :1{false};
+        /// Redrawing the widget may be deferred when the screen's rendering quality is reduced
+        uintptr_t lowPriority                   :1{false};
+        /// The screen compares the widget's draw state hash, so it's recorded when drawn
+        uintptr_t drawStateTracked              :1{false};
+        /// Widget was moved, resized, shown or added to a parent since it was last drawn
+        uintptr_t movedSinceDraw                :1{true};
+
         /**
          * @brief Parent widget
          *
@@ -520,6 +838,60 @@ class Widget: public std::enable_shared_from_this<Widget> {
          * Pointers to all children added to widget.
          */
         std::list<std::shared_ptr<Widget>> children;
+        /**
+         * @brief Position of this widget in its parent's child list
+         *
+         * Allows removing a widget from its parent in constant time. Valid only while the widget
+         * has a parent.
+         */
+        std::list<std::shared_ptr<Widget>>::iterator siblingPos;
+
+        /// Gesture recognizers attached to the widget
+        std::vector<std::shared_ptr<GestureRecognizer>> gestureRecognizers;
+
+        /// Draw profiling data, if profiling is enabled
+        std::unique_ptr<DrawProfile> profile;
+
+        /// Number of bytes accounted to the widget objects memory category
+        uint32_t accountedBytes{0};
+        /// Number of children that were not opaque when they were added
+        uint32_t numTransparentChildren{0};
+
+        /**
+         * @brief Invalidated region of the widget
+         *
+         * Accumulates the regions passed to needsDisplayInRect() (in the widget's coordinate
+         * space) until the next redraw, when it's converted to screen space.
+         */
+        Rect pendingDirtyRect;
+
+        /**
+         * @brief Origin of the widget's coordinate space, in screen coordinates
+         *
+         * This is part of the cached screen geometry, updated by updateScreenGeometry().
+         */
+        Point screenOrigin;
+        /**
+         * @brief Visible area of the widget, in screen coordinates
+         *
+         * The widget's bounds, clipped by all ancestors that clip to their bounds. For widgets
+         * that don't clip to their own bounds, this is the visible area of the parent instead.
+         */
+        Rect screenClip;
+        /// Depth of the widget in the hierarchy (root is 0)
+        uint16_t depth{0};
+
+        /// Cache tick at which the widget was last visible (visited during drawing)
+        uint32_t lastVisibleTick{0};
+        /// Screen cache list the widget is in, if any
+        std::list<Widget *> *cacheList{nullptr};
+        /// Position of the widget in its cache list; valid only if it's in one
+        std::list<Widget *>::iterator cacheEntry;
+
+        /// Key of the widget in its screen's focus index
+        uint64_t focusKey{0};
+        /// Draw state hash when the widget was last drawn, or 0 if unknown
+        uint64_t drawnStateHash{0};
 };
 
 /**
@@ -0,0 +1,236 @@
+#ifndef SHITTYGUI_WIDGETARCHIVE_H
+#define SHITTYGUI_WIDGETARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <shittygui/Types.h>
+
+namespace shittygui {
+class Image;
+class Widget;
+class WidgetArchive;
+
+/**
+ * @brief Widget types that can be stored in an archive
+ *
+ * The values are part of the archive format, and must not change.
+ */
+enum class ArchiveWidgetType: uint16_t {
+    /// The widget can't be archived
+    None                                = 0,
+    Container                           = 1,
+    Label                               = 2,
+    Button                              = 3,
+    Checkbox                            = 4,
+    RadioButton                         = 5,
+    ImageView                           = 6,
+    ProgressBar                         = 7,
+};
+
+/**
+ * @brief Keys of archived widget properties
+ *
+ * Keys are shared between all widget types; each widget type decodes only the keys it knows
+ * about. The values are part of the archive format, and must not change.
+ */
+enum class ArchiveKey: uint8_t {
+    /// Widget tag (integer)
+    Tag                                 = 0x01,
+    /// Debug label (string)
+    DebugLabel                          = 0x02,
+
+    BackgroundColor                     = 0x10,
+    BorderColor                         = 0x11,
+    BorderWidth                         = 0x12,
+    BorderRadius                        = 0x13,
+    DrawsBorder                         = 0x14,
+    FillingColor                        = 0x15,
+    SelectedFillingColor                = 0x16,
+    IndicatorColor                      = 0x17,
+    SelectedIndicatorColor              = 0x18,
+
+    /// Text content (label content, button title, toggle label)
+    Text                                = 0x20,
+    /// Whether the text contains markup (bool)
+    TextMarkup                          = 0x21,
+    Font                                = 0x22,
+    TextColor                           = 0x23,
+    SelectedTextColor                   = 0x24,
+    TextAlign                           = 0x25,
+    VerticalAlign                       = 0x26,
+    Justified                           = 0x27,
+    WordWrap                            = 0x28,
+    EllipsizeMode                       = 0x29,
+    /// Smallest font size of automatically fitted text (double; absent if not fitted)
+    MinFontSize                         = 0x2A,
+
+    Image                               = 0x30,
+    ImageMode                           = 0x31,
+    IconGravity                         = 0x32,
+
+    /// Button type, progress bar style (integer)
+    Style                               = 0x40,
+    Checked                             = 0x41,
+    CheckAreaTouchOnly                  = 0x42,
+    Progress                            = 0x43,
+};
+
+/**
+ * @brief Collects the properties of a widget being archived
+ *
+ * Passed to Widget::encode(), which adds the widget's properties to it. Values are decoded again
+ * by Widget::decode() when the archive is instantiated.
+ */
+class ArchiveEncoder {
+    friend class WidgetArchive;
+
+    public:
+        void addBool(const ArchiveKey key, const bool value);
+        void addInteger(const ArchiveKey key, const int64_t value);
+        void addDouble(const ArchiveKey key, const double value);
+        void addColor(const ArchiveKey key, const Color &value);
+        void addString(const ArchiveKey key, const std::string_view value);
+        void addFont(const ArchiveKey key, const std::string_view name, const double size);
+        void addImage(const ArchiveKey key, const std::shared_ptr<Image> &image);
+
+    private:
+        ArchiveEncoder(std::vector<std::byte> &properties, std::vector<std::byte> &strings,
+                std::unordered_map<std::string, uint32_t> &stringOffsets) :
+            properties(properties), strings(strings), stringOffsets(stringOffsets) {}
+
+        void addHeader(const ArchiveKey key, const uint8_t kind);
+        void addStringRef(const std::string_view value);
+
+    private:
+        /// Buffer receiving the encoded properties
+        std::vector<std::byte> &properties;
+        /// String table
+        std::vector<std::byte> &strings;
+        /// Offsets of strings already in the string table
+        std::unordered_map<std::string, uint32_t> &stringOffsets;
+};
+
+/**
+ * @brief A single property read from an archive
+ *
+ * Passed to Widget::decode() for each property of an archived widget. Accessing the value as a
+ * different type than it was stored as throws an exception.
+ */
+class ArchiveValue {
+    friend class WidgetArchive;
+
+    public:
+        /**
+         * @brief Get the key of the property
+         */
+        constexpr inline auto getKey() const {
+            return this->key;
+        }
+
+        bool getBool() const;
+        int64_t getInteger() const;
+        double getDouble() const;
+        Color getColor() const;
+        std::string_view getString() const;
+        double getFontSize() const;
+        std::shared_ptr<Image> getImage() const;
+
+    private:
+        /// Property key
+        ArchiveKey key;
+        /// Value type
+        uint8_t kind;
+        /// Encoded value
+        const std::byte *payload;
+        /// Archive the value was read from (to resolve strings and images)
+        const WidgetArchive *archive;
+};
+
+/**
+ * @brief Compact binary description of a widget tree
+ *
+ * Widget archives store a tree of widgets (their types, frames, and properties) in a compact,
+ * versioned binary format, which can be mapped straight from flash and instantiated in a single
+ * pass over the data. All widgets created from an archive are allocated from one block of memory.
+ *
+ * Archives are created from an existing widget tree with Export(). Callbacks aren't archived:
+ * after instantiating a tree, look up widgets (for example, with Widget::findChildWithTag()) to
+ * attach them.
+ *
+ * @remark Archives are stored in the native byte order; they're not portable between big and
+ *         little endian machines.
+ */
+class WidgetArchive {
+    friend class ArchiveValue;
+
+    public:
+        /**
+         * @brief Loads images referenced by an archive
+         *
+         * Invoked with the name the image was archived under; this is the path it was originally
+         * read from, unless the name was changed with Image::setName().
+         */
+        using ImageLoader = std::function<std::shared_ptr<Image>(const std::string_view name)>;
+
+        WidgetArchive(std::span<const std::byte> data);
+        ~WidgetArchive();
+
+        WidgetArchive(const WidgetArchive &) = delete;
+        WidgetArchive &operator=(const WidgetArchive &) = delete;
+
+        static std::shared_ptr<WidgetArchive> Open(const std::filesystem::path &path);
+
+        std::shared_ptr<Widget> instantiate(const ImageLoader &loader = {});
+
+        /**
+         * @brief Get the number of widgets in the archive
+         */
+        constexpr inline size_t getNumWidgets() const {
+            return this->numWidgets;
+        }
+
+        static std::vector<std::byte> Export(const std::shared_ptr<Widget> &root);
+        static void Export(const std::shared_ptr<Widget> &root, const std::filesystem::path &path);
+
+    private:
+        WidgetArchive(std::span<const std::byte> data, const bool mapped);
+
+        void validate();
+        std::string_view getString(const std::byte *ref) const;
+        std::shared_ptr<Image> getImage(const std::string_view name) const;
+
+        static void ExportWidget(const std::shared_ptr<Widget> &widget,
+                std::vector<std::byte> &nodes, std::vector<std::byte> &strings,
+                std::unordered_map<std::string, uint32_t> &stringOffsets, uint32_t &numWidgets,
+                size_t &allocationSize);
+
+    private:
+        /// Archive data
+        std::span<const std::byte> data;
+        /// Whether the archive data was mapped by us (and must be unmapped)
+        bool mapped{false};
+
+        /// Number of widgets in the archive
+        size_t numWidgets{0};
+        /// Widget node data
+        std::span<const std::byte> nodes;
+        /// String table
+        std::span<const std::byte> strings;
+
+        /// Image loader for the instantiation in progress
+        const ImageLoader *loader{nullptr};
+        /// Images loaded during the instantiation in progress, by name
+        mutable std::unordered_map<std::string_view, std::shared_ptr<Image>> images;
+};
+}
+
+#endif
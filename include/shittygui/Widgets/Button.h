@@ -38,6 +38,40 @@ class Button: public Widget, protected TextRendering {
             Right,
         };
 
+        /**
+         * @brief Visual style of a button
+         *
+         * Styles are shared by all buttons that look the same: each button only stores the index
+         * of its style in a shared table. Changing any style property switches the button to a
+         * different (possibly newly created) shared style.
+         *
+         * @remark A style is released from the shared table once the last button using it goes
+         *         away (or switches to another style), so the table only holds as many styles as
+         *         are in use at the same time.
+         */
+        struct Style {
+            /// Border color
+            PackedColor borderColor{Color(.5, .5, .5)};
+            /// Border width
+            float borderWidth{1.};
+            /// Border radius (for standard push buttons)
+            float borderRadius{3.};
+
+            /// Text color (normal state)
+            PackedColor textColor{Color(.92, .92, .92)};
+            /// Filling color (normal state)
+            PackedColor fillingColor{Color(.125, .125, .125)};
+            /// Text color (selected state)
+            PackedColor selectedTextColor{Color(1, 1, 1)};
+            /// Filling color (selected state)
+            PackedColor selectedFillingColor{Color(.42, .42, .42)};
+
+            /// Help button content color
+            PackedColor helpContentColor{Color(161./255., 69./255., 252./255.)};
+
+            bool operator==(const Style &) const = default;
+        };
+
         /**
          * @brief Create a button of the specified type
          *
@@ -76,16 +110,35 @@ class Button: public Widget, protected TextRendering {
             Widget::draw(drawCtx, everything);
         }
 
+        size_t getMemoryFootprint() const override;
+        uint64_t getDrawStateHash() const override;
+
+        ArchiveWidgetType getArchiveType() const override {
+            return ArchiveWidgetType::Button;
+        }
+        void encode(ArchiveEncoder &encoder) const override;
+        bool decode(const ArchiveValue &value) override;
+        void decodeProperties(std::span<const ArchiveValue> values) override;
+
         /**
          * @brief Release rendering resources when removed from view hierarchy
          *
-         * Since the drawing context for Pango keeps a reference to the underlying Cairo context,
+         * Since the text layout is configured for the underlying Cairo context (such as its scale),
          * and we might get added to a different screen (with a different drawing context) this
          * is required.
          */
         void didMoveToParent() override {
             Widget::didMoveToParent();
-            this->releaseTextResources();
+            this->releaseResources();
+        }
+
+        /**
+         * @brief Release the title text layout
+         *
+         * It is re-created the next time the button is drawn.
+         */
+        void releaseCachedResources() override {
+            this->releaseResources();
         }
 
         /**
@@ -105,6 +158,14 @@ class Button: public Widget, protected TextRendering {
 
         void setFont(const std::string_view name, const double size);
 
+        void setAutoFit(const bool enabled, const double minSize = kDefaultMinFitSize);
+        /**
+         * @brief Is the font size automatically reduced to fit the title?
+         */
+        constexpr inline bool isAutoFit() const {
+            return this->autoFit;
+        }
+
         /**
          * @brief Set the text color
          *
@@ -114,11 +175,28 @@ class Button: public Widget, protected TextRendering {
          * @param selected Text color for the selected state
          */
         inline void setTextColor(const Color &normal, const Color &selected) {
-            this->textColor = normal;
-            this->selectedTextColor = selected;
-            this->needsDisplay();
+            auto style = this->getStyle();
+            style.textColor = normal;
+            style.selectedTextColor = selected;
+            this->setStyle(style);
         }
 
+        /**
+         * @brief Set the filling color
+         *
+         * @param normal Filling color for the normal state
+         * @param selected Filling color for the selected state
+         */
+        inline void setFillingColor(const Color &normal, const Color &selected) {
+            auto style = this->getStyle();
+            style.fillingColor = normal;
+            style.selectedFillingColor = selected;
+            this->setStyle(style);
+        }
+
+        const Style &getStyle() const;
+        void setStyle(const Style &newStyle);
+
         /**
          * @brief Set the icon
          *
@@ -154,28 +232,30 @@ class Button: public Widget, protected TextRendering {
          * @param newWidth New border width; set to 0 to disable.
          */
         inline void setBorderWidth(const double newWidth) {
-            this->borderWidth = std::max(0., newWidth);
-            this->needsDisplay();
+            auto style = this->getStyle();
+            style.borderWidth = std::max(0., newWidth);
+            this->setStyle(style);
         }
         /**
          * @brief Get the width of the border
          */
-        constexpr inline auto getBorderWidth() const {
-            return this->borderWidth;
+        inline double getBorderWidth() const {
+            return this->getStyle().borderWidth;
         }
 
         /**
          * @brief Set the radius of the container's border
          */
         inline void setBorderRadius(const double newRadius) {
-            this->borderRadius = newRadius;
-            this->needsDisplay();
+            auto style = this->getStyle();
+            style.borderRadius = newRadius;
+            this->setStyle(style);
         }
         /**
          * @brief Get the current border radius
          */
-        constexpr inline auto getBorderRadius() const {
-            return this->borderRadius;
+        inline double getBorderRadius() const {
+            return this->getStyle().borderRadius;
         }
 
         /**
@@ -184,14 +264,15 @@ class Button: public Widget, protected TextRendering {
          * @param normalColor new border color
          */
         inline void setBorderColor(const Color &normalColor) {
-            this->borderColor = normalColor;
-            this->needsDisplay();
+            auto style = this->getStyle();
+            style.borderColor = normalColor;
+            this->setStyle(style);
         }
         /**
          * @brief Get the current border color
          */
-        constexpr inline auto &getBorderColor() const {
-            return this->borderColor;
+        inline Color getBorderColor() const {
+            return this->getStyle().borderColor;
         }
 
         /**
@@ -205,6 +286,22 @@ class Button: public Widget, protected TextRendering {
         }
 
         bool handleTouchEvent(const event::Touch &event) override;
+        bool handleButtonEvent(const event::Button &event) override;
+        void drawFocusRing(struct _cairo *drawCtx) override;
+
+        /**
+         * @brief Buttons can be focused, and activated with the select button
+         */
+        bool acceptsUserInput() override {
+            return true;
+        }
+        /**
+         * @brief Deselect the button when its touch is taken over by a gesture
+         */
+        void handleTouchCancelled() override {
+            this->selected = false;
+            this->needsDisplay();
+        }
 
         /**
          * @brief Set the click callback
@@ -224,7 +321,7 @@ class Button: public Widget, protected TextRendering {
     private:
         void releaseResources();
 
-        void updateTextLayout();
+        void updateTextLayout(const Size &textSize);
 
         void drawPushButton(struct _cairo *drawCtx, const bool everything);
         void drawHelpButton(struct _cairo *drawCtx, const bool everything);
@@ -237,6 +334,8 @@ class Button: public Widget, protected TextRendering {
         constexpr static const std::string_view kDefaultFont{"Liberation Sans Bold"};
         /// Default button font size
         constexpr static const double kDefaultFontSize{18.};
+        /// Default smallest font size for automatically fitted titles
+        constexpr static const double kDefaultMinFitSize{8.};
 
         /// Callback to invoke when button is pushed
         std::optional<EventCallback> pushCallback;
@@ -246,40 +345,30 @@ class Button: public Widget, protected TextRendering {
         /// Icon gravity
         IconGravity ig{IconGravity::Center};
 
-        /// Border color
-        Color borderColor{.5, .5, .5};
-        /// Border width
-        double borderWidth{1.};
-        /// Border radius (for standard push buttons)
-        double borderRadius{3.};
-
-        /// Text color (normal state)
-        Color textColor{.92, .92, .92};
-        /// Filling color (normal state)
-        Color fillingColor{.125, .125, .125};
-        /// Text color (selected state)
-        Color selectedTextColor{1, 1, 1};
-        /// Filling color (selected state)
-        Color selectedFillingColor{.42, .42, .42};
-
-        /// Help button content color
-        Color helpContentColor{161./255., 69./255., 252./255.};
+        /// Index of the button's style in the shared style table
+        uint16_t styleIndex{0};
+        /// Padding between icon and edge of content area
+        uint16_t iconPadding{2};
 
         /// Icon displayed on the push button
         std::shared_ptr<Image> icon;
-        /// Padding between icon and edge of content area
-        uint16_t iconPadding{2};
         /// Rect into which the icon was drawn
         Rect iconRect;
 
         /// String displayed inside a push button
         std::string title;
         /// Font to render title with
-        struct _PangoFontDescription *fontDesc{nullptr};
+        TextFont *fontDesc{nullptr};
+        /// Title font, at the size the title was fitted at (if automatically fitted)
+        TextFont *fitFontDesc{nullptr};
+        /// Size of the area the title was last fitted into
+        Size fitSize;
+        /// Smallest font size for automatically fitted titles, in points
+        float minFitSize{kDefaultMinFitSize};
 
         /// Set when the title changes
         uintptr_t titleDirty            :1{false};
-        /// Set when the font has been changed
+        /// Set when the font has been changed (or must be fitted again)
         uintptr_t fontDirty             :1{false};
         /// Set when the icon changed
         uintptr_t iconDirty             :1{false};
@@ -292,6 +381,8 @@ class Button: public Widget, protected TextRendering {
         uintptr_t shouldRenderIcon      :1{true};
         /// Is the button active/selected?
         uintptr_t selected              :1{false};
+        /// Is the font size reduced to fit the title?
+        uintptr_t autoFit               :1{false};
 };
 }
 
@@ -30,6 +30,19 @@ class Checkbox: public ToggleButtonBase {
             this->setChecked(isChecked);
         }
 
+        /**
+         * @brief Get the memory footprint of the widget
+         */
+        size_t getMemoryFootprint() const override {
+            return ToggleButtonBase::getMemoryFootprint() + (sizeof(Checkbox) - sizeof(ToggleButtonBase));
+        }
+
+        ArchiveWidgetType getArchiveType() const override {
+            return ArchiveWidgetType::Checkbox;
+        }
+        void encode(ArchiveEncoder &encoder) const override;
+        bool decode(const ArchiveValue &value) override;
+
         /**
          * @brief Set the width of the border
          *
@@ -58,7 +71,7 @@ class Checkbox: public ToggleButtonBase {
         /**
          * @brief Get the current border color
          */
-        constexpr inline auto &getBorderColor() const {
+        constexpr inline Color getBorderColor() const {
             return this->borderColor;
         }
 
@@ -85,7 +98,7 @@ class Checkbox: public ToggleButtonBase {
         /**
          * @brief Get the current regular filling color
          */
-        constexpr inline auto &getRegularFillingColor() const {
+        constexpr inline Color getRegularFillingColor() const {
             return this->fillingColor;
         }
 
@@ -98,7 +111,7 @@ class Checkbox: public ToggleButtonBase {
         /**
          * @brief Get the current selected filling color
          */
-        constexpr inline auto &getSelectedFillingColor() const {
+        constexpr inline Color getSelectedFillingColor() const {
             return this->selectedFillingColor;
         }
 
@@ -111,7 +124,7 @@ class Checkbox: public ToggleButtonBase {
         /**
          * @brief Get the current regular check color
          */
-        constexpr inline auto &getRegularCheckColor() const {
+        constexpr inline Color getRegularCheckColor() const {
             return this->checkColor;
         }
 
@@ -124,7 +137,7 @@ class Checkbox: public ToggleButtonBase {
         /**
          * @brief Get the current selected check color
          */
-        constexpr inline auto &getSelectedCheckColor() const {
+        constexpr inline Color getSelectedCheckColor() const {
             return this->selectedCheckColor;
         }
 
@@ -140,21 +153,21 @@ class Checkbox: public ToggleButtonBase {
 
     private:
         /// Border color
-        Color borderColor{.5, .5, .5};
+        PackedColor borderColor{Color(.5, .5, .5)};
         /// Border width
         double borderWidth{1.};
         /// Border radius (for standard push buttons)
         double borderRadius{3.};
 
         /// Filling color (normal state)
-        Color fillingColor{.125, .125, .125};
+        PackedColor fillingColor{Color(.125, .125, .125)};
         /// Check color (normal state)
-        Color checkColor{.74, .15, .15};
+        PackedColor checkColor{Color(.74, .15, .15)};
 
         /// Filling color (selected state)
-        Color selectedFillingColor{.42, .42, .42};
+        PackedColor selectedFillingColor{Color(.42, .42, .42)};
         /// Check color (selected state)
-        Color selectedCheckColor{.74, .25, .25};
+        PackedColor selectedCheckColor{Color(.74, .25, .25)};
 };
 }
 
@@ -19,6 +19,13 @@ class Container: public Widget {
         Container(const Rect &rect) : Widget(rect) {}
 
         void draw(struct _cairo *drawCtx, const bool everything) override;
+        size_t getMemoryFootprint() const override;
+
+        ArchiveWidgetType getArchiveType() const override {
+            return ArchiveWidgetType::Container;
+        }
+        void encode(ArchiveEncoder &encoder) const override;
+        bool decode(const ArchiveValue &value) override;
 
         bool isOpaque() override {
             return this->background.isOpaque();
@@ -34,7 +41,7 @@ class Container: public Widget {
         /**
          * @brief Get the current background color
          */
-        inline auto &getBackgroundColor() const {
+        inline Color getBackgroundColor() const {
             return this->background;
         }
 
@@ -48,7 +55,7 @@ class Container: public Widget {
         /**
          * @brief Get the current border color
          */
-        inline auto &getBorderColor() const {
+        inline Color getBorderColor() const {
             return this->border;
         }
 
@@ -84,9 +91,9 @@ class Container: public Widget {
         constexpr static const double kBorderWidth{1.};
 
         /// Background color
-        Color background;
+        PackedColor background;
         /// Border color
-        Color border{0, 1, 0};
+        PackedColor border{Color(0, 1, 0)};
         /// Border corner radius
         double borderRadius{5.};
 
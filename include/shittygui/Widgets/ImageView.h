@@ -60,6 +60,13 @@ class ImageView: public Widget {
         }
 
         void draw(struct _cairo *drawCtx, const bool everything) override;
+        size_t getMemoryFootprint() const override;
+
+        ArchiveWidgetType getArchiveType() const override {
+            return ArchiveWidgetType::ImageView;
+        }
+        void encode(ArchiveEncoder &encoder) const override;
+        bool decode(const ArchiveValue &value) override;
 
         /**
          * @brief Dirty the image transform matrix when our frame (size) changes
@@ -84,11 +91,7 @@ class ImageView: public Widget {
          *
          * @param newImage Image to render in the widget; a strong reference is taken.
          */
-        inline void setImage(const std::shared_ptr<Image> &newImage) {
-            this->image = newImage;
-            this->imageMatrixDirty = true;
-            this->needsDisplay();
-        }
+        void setImage(const std::shared_ptr<Image> &newImage);
         /**
          * @brief Get the currently displayed image
          */
@@ -108,7 +111,7 @@ class ImageView: public Widget {
         /**
          * @brief Get the current background color
          */
-        constexpr inline auto getBackgroundColor() const {
+        constexpr inline Color getBackgroundColor() const {
             return this->backgroundColor;
         }
 
@@ -136,16 +139,18 @@ class ImageView: public Widget {
          */
         inline void setBorderColor(const Color &normalColor) {
             this->borderColor = normalColor;
-            this->needsDisplay();
+            this->invalidateBorder();
         }
         /**
          * @brief Get the current border color
          */
-        constexpr inline auto &getBorderColor() const {
+        constexpr inline Color getBorderColor() const {
             return this->borderColor;
         }
 
     private:
+        void invalidateBorder();
+
         void drawImage(struct _cairo *, const Rect &);
         void updateImageTransform(const Rect &);
 
@@ -174,20 +179,16 @@ class ImageView: public Widget {
         std::shared_ptr<Image> image;
         /// Rect to draw the image in
         Rect imageRect;
-        /// Horizontal scale factor for the image
-        double imageXScale{1.};
-        /// Vertical scale factor for the image
-        double imageYScale{1.};
         /// Image rendering mode
         Mode imageMode{Mode::None};
 
         /// Border thickness
         double borderWidth{1.};
         /// Color of the image border
-        Color borderColor{.33, .33, .33};
+        PackedColor borderColor{Color(.33, .33, .33)};
 
         /// Background color (behind transparent images)
-        Color backgroundColor{0, 0, 0};
+        PackedColor backgroundColor{Color(0, 0, 0)};
 
         /// Is the cached image rendering information dirty?
         uintptr_t imageMatrixDirty              :1{true};
@@ -17,6 +17,8 @@ namespace shittygui::widgets {
  * Renders a read-only text string to the screen. The font, color, and alignment can be specified,
  * and the text may be optionally wrapped to fit in the available space.
  *
+ * Labels can also automatically reduce their font size so that the text fits, which is useful for
+ * translated strings of varying length; see setAutoFit().
  */
 class Label: public Widget, protected TextRendering {
     public:
@@ -51,11 +53,19 @@ class Label: public Widget, protected TextRendering {
         }
 
         void draw(struct _cairo *drawCtx, const bool everything) override;
+        size_t getMemoryFootprint() const override;
+        uint64_t getDrawStateHash() const override;
+
+        ArchiveWidgetType getArchiveType() const override {
+            return ArchiveWidgetType::Label;
+        }
+        void encode(ArchiveEncoder &encoder) const override;
+        bool decode(const ArchiveValue &value) override;
 
         /**
          * @brief Release rendering resources when removed from view hierarchy
          *
-         * Since the drawing context for Pango keeps a reference to the underlying Cairo context,
+         * Since the text layout is configured for the underlying Cairo context (such as its scale),
          * and we might get added to a different screen (with a different drawing context) this
          * is required.
          */
@@ -65,23 +75,24 @@ class Label: public Widget, protected TextRendering {
         }
 
         /**
-         * @brief Set the text displayed on the label
+         * @brief Release the text layout
          *
-         * @param hasMarkup Whether the string contains Pango markup
+         * It is re-created the next time the label is drawn.
          */
-        inline void setContent(const std::string_view newContent, const bool hasMarkup = false) {
-            this->content = newContent;
-            this->contentDirty = true;
-            this->contentHasMarkup = hasMarkup;
-            this->needsDisplay();
-
-            // if we do not draw our own background, force parent to redraw itself too
-            if(!this->drawBackground || this->background.a < 1.) {
-                if(auto parent = this->getParent()) {
-                    parent->needsDisplay();
-                }
+        void releaseCachedResources() override {
+            this->releaseResources();
+        }
+        /**
+         * @brief Fit the text to the new size of the label
+         */
+        void frameDidChange() override {
+            Widget::frameDidChange();
+            if(this->autoFit) {
+                this->fontDirty = true;
             }
         }
+
+        void setContent(const std::string_view newContent, const bool hasMarkup = false);
         /**
          * @brief Get the currently displayed label text
          */
@@ -132,6 +143,9 @@ class Label: public Widget, protected TextRendering {
         inline void setWordWrap(const bool enabled) {
             this->wordWrap = enabled;
             this->wordWrapDirty = true;
+            if(this->autoFit) {
+                this->fontDirty = true;
+            }
             this->needsDisplay();
         }
         /**
@@ -161,17 +175,31 @@ class Label: public Widget, protected TextRendering {
          */
         inline void setTextColor(const Color &newColor) {
             this->foreground = newColor;
-            this->needsDisplay();
+
+            // only the text itself changes
+            if(!this->textRect.isEmpty()) {
+                this->needsDisplayInRect(this->textRect);
+            } else {
+                this->needsDisplay();
+            }
         }
         /**
          * @brief Get the text color
          */
-        constexpr inline auto getTextColor() const {
+        constexpr inline Color getTextColor() const {
             return this->foreground;
         }
 
         void setFont(const std::string_view name, const double size);
 
+        void setAutoFit(const bool enabled, const double minSize = kDefaultMinFitSize);
+        /**
+         * @brief Is the font size automatically reduced to fit the text?
+         */
+        constexpr inline bool isAutoFit() const {
+            return this->autoFit;
+        }
+
         /**
          * @brief Set the label's background color
          */
@@ -187,6 +215,9 @@ class Label: public Widget, protected TextRendering {
         void updateLayout();
 
     private:
+        /// Default smallest font size for automatically fitted text
+        constexpr static const double kDefaultMinFitSize{8.};
+
         /// Text layout
         TextAlign hAlign{TextAlign::Left};
         /// Vertical text alignment
@@ -194,20 +225,27 @@ class Label: public Widget, protected TextRendering {
         /// Ellipsization mode
         EllipsizeMode ellipsizationMode{EllipsizeMode::End};
         /// Text foreground color
-        Color foreground;
+        PackedColor foreground;
         /// Background color
-        Color background;
+        PackedColor background;
+
+        /// Area covered by the text when it was last drawn
+        Rect textRect;
+        /// Smallest font size for automatically fitted text, in points
+        float minFitSize{kDefaultMinFitSize};
 
         /// Content value of the label
         std::string content;
-        /// Pango font descriptor for the label's font
-        struct _PangoFontDescription *fontDesc{nullptr};
+        /// Font descriptor for the label's font
+        TextFont *fontDesc{nullptr};
+        /// Label's font, at the size the text was fitted at (if automatically fitted)
+        TextFont *fitFontDesc{nullptr};
 
         /// Set when the text content changes
         uintptr_t contentDirty          :1{false};
         /// Whether the content has embedded Pango markup
         uintptr_t contentHasMarkup      :1{false};
-        /// Set when the font has been changed
+        /// Set when the font has been changed (or must be fitted again)
         uintptr_t fontDirty             :1{false};
         /// Set when the alignment changes (includes justification)
         uintptr_t alignDirty            :1{true};
@@ -222,6 +260,8 @@ class Label: public Widget, protected TextRendering {
         uintptr_t wordWrap              :1{false};
         /// Do we draw a background color?
         uintptr_t drawBackground        :1{false};
+        /// Is the font size reduced to fit the text?
+        uintptr_t autoFit               :1{false};
 };
 }
 
@@ -0,0 +1,230 @@
+#ifndef SHITTYGUI_WIDGETS_MARQUEE_H
+#define SHITTYGUI_WIDGETS_MARQUEE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <shittygui/Widget.h>
+#include <shittygui/Types.h>
+#include <shittygui/TextRendering.h>
+
+namespace shittygui::widgets {
+/**
+ * @brief Horizontally scrolling text (ticker)
+ *
+ * Displays a single line of text that continuously scrolls from right to left, wrapping around
+ * with a gap between the end of the text and its next repetition.
+ *
+ * The text is laid out and rendered only once, into a cached strip (containing the background,
+ * the text, and the gap after it.) Each frame, the strip is blitted at an offset derived from the
+ * time elapsed since scrolling started; so the scrolling speed doesn't depend on the frame rate.
+ * The marquee only invalidates its own bounds when the offset moved by at least a pixel, and not
+ * at all while paused.
+ *
+ * @remark Give the marquee an opaque background color; otherwise, its parent must be redrawn
+ *         every time it scrolls.
+ *
+ * @remark The strip is limited to the maximum width of an image surface (32767 pixels); longer
+ *         text is cut off.
+ */
+class Marquee: public Widget, protected TextRendering {
+    public:
+        /**
+         * @brief Initialize a marquee with the given frame
+         *
+         * It will not have a content string.
+         */
+        Marquee(const Rect &rect) : Widget(rect) {}
+        /**
+         * @brief Initialize a marquee with the given frame and content
+         *
+         * @param text Text to scroll
+         * @param hasMarkup Whether the string contains Pango markup
+         */
+        Marquee(const Rect &rect, const std::string_view text, const bool hasMarkup = false) :
+            Widget(rect) {
+            this->setContent(text, hasMarkup);
+        }
+        ~Marquee();
+
+        /**
+         * @brief Marquees are opaque if their background is
+         */
+        bool isOpaque() override {
+            return this->background.isOpaque();
+        }
+
+        void draw(struct _cairo *drawCtx, const bool everything) override;
+        size_t getMemoryFootprint() const override;
+
+        void willMoveToParent(const std::shared_ptr<Widget> &newParent) override {
+            Widget::willMoveToParent(newParent);
+            this->stopAnimating();
+        }
+        /**
+         * @brief Release rendering resources when removed from view hierarchy
+         *
+         * The text layout and the strip are configured for the drawing context of the screen, so
+         * they must be re-created for the new screen.
+         */
+        void didMoveToParent() override {
+            Widget::didMoveToParent();
+            this->releaseResources();
+        }
+        /**
+         * @brief Release the text layout and the cached strip
+         *
+         * They're re-created the next time the marquee is drawn.
+         */
+        void releaseCachedResources() override {
+            this->releaseResources();
+        }
+        /**
+         * @brief Re-render the strip when the height of the marquee changes
+         */
+        void frameDidChange() override {
+            Widget::frameDidChange();
+            this->stripDirty = true;
+        }
+
+        void setContent(const std::string_view newContent, const bool hasMarkup = false);
+        /**
+         * @brief Get the scrolling text
+         */
+        constexpr inline const std::string_view getContent() const {
+            return this->content;
+        }
+
+        void setFont(const std::string_view name, const double size);
+
+        /**
+         * @brief Set the text color
+         */
+        inline void setTextColor(const Color &newColor) {
+            this->foreground = newColor;
+            this->stripDirty = true;
+            this->needsDisplay();
+        }
+        /**
+         * @brief Get the text color
+         */
+        constexpr inline Color getTextColor() const {
+            return this->foreground;
+        }
+
+        /**
+         * @brief Set the background color
+         */
+        inline void setBackgroundColor(const Color &newColor) {
+            this->background = newColor;
+            this->stripDirty = true;
+            this->needsDisplay();
+        }
+        /**
+         * @brief Get the background color
+         */
+        constexpr inline Color getBackgroundColor() const {
+            return this->background;
+        }
+
+        void setSpeed(const double pixelsPerSecond);
+        /**
+         * @brief Get the scrolling speed, in pixels per second
+         */
+        constexpr inline double getSpeed() const {
+            return this->speed;
+        }
+
+        /**
+         * @brief Set the gap between the end of the text and its next repetition
+         *
+         * @param newGap Gap width, in pixels
+         */
+        inline void setGap(const uint16_t newGap) {
+            this->gap = newGap;
+            this->stripDirty = true;
+            this->needsDisplay();
+        }
+        /**
+         * @brief Get the gap between repetitions of the text, in pixels
+         */
+        constexpr inline uint16_t getGap() const {
+            return this->gap;
+        }
+
+        void setPaused(const bool paused);
+        /**
+         * @brief Is scrolling paused?
+         */
+        constexpr inline bool isPaused() const {
+            return this->paused;
+        }
+
+        void restart();
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        void releaseResources();
+        void releaseStrip();
+        void updateStrip(struct _cairo *drawCtx);
+
+        double getScrollOffset(const Clock::time_point now) const;
+
+        void startAnimating();
+        void stopAnimating();
+        void processAnimationFrame();
+
+    private:
+        /// Default font for marquees
+        constexpr static const std::string_view kDefaultFont{"Liberation Sans Bold"};
+        /// Default font size
+        constexpr static const double kDefaultFontSize{16.};
+
+        /// Text color
+        PackedColor foreground{Color(1, 1, 1)};
+        /// Background color
+        PackedColor background{Color(0, 0, 0)};
+
+        /// Gap between repetitions of the text, in pixels
+        uint16_t gap{40};
+        /// Scrolling speed, in pixels per second
+        double speed{60.};
+
+        /// Text to scroll
+        std::string content;
+        /// Font descriptor for the marquee's font
+        TextFont *fontDesc{nullptr};
+
+        /// Rendered strip (background, text and gap), or `nullptr` if not yet rendered
+        struct _cairo_surface *strip{nullptr};
+        /// Width of the strip (the distance after which the scrolling repeats), in pixels
+        int stripWidth{0};
+
+        /// Time at which the scrolling offset was zero
+        Clock::time_point start{Clock::now()};
+        /// Offset at which scrolling was paused, in pixels
+        double pausedOffset{0};
+        /// Offset the marquee was last drawn at, in pixels
+        int drawnOffset{0};
+
+        /// Animator callback token
+        uint32_t animatorToken{0};
+
+        /// Whether the content contains Pango markup
+        uintptr_t contentHasMarkup              :1{false};
+        /// Set when the strip must be rendered again
+        uintptr_t stripDirty                    :1{true};
+        /// Scrolling is paused
+        uintptr_t paused                        :1{false};
+        /// Whether the animator callback is registered
+        uintptr_t animatorRegistered            :1{false};
+        /// Whether the strip was taken from the surface pool (which then accounts for it)
+        uintptr_t stripPooled                   :1{false};
+};
+}
+
+#endif
@@ -0,0 +1,222 @@
+#ifndef SHITTYGUI_WIDGETS_PAGEVIEW_H
+#define SHITTYGUI_WIDGETS_PAGEVIEW_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <shittygui/Widget.h>
+#include <shittygui/Types.h>
+
+namespace shittygui {
+class GestureRecognizer;
+class Image;
+class PanGestureRecognizer;
+}
+
+namespace shittygui::widgets {
+/**
+ * @brief Container for a horizontally swipeable set of pages
+ *
+ * Only one page is visible at a time. Pages are created by a factory function when they're first
+ * shown, and only a limited number of them are kept alive; the least recently shown pages are
+ * destroyed (and re-created when they're shown again.)
+ *
+ * Swiping between pages doesn't redraw the pages' widget trees: instead, snapshots of the current
+ * page and its neighbors are taken when the swipe begins, and composited while the swipe is in
+ * progress. Snapshots of neighboring pages are cached, so they're available even if the page
+ * itself was destroyed.
+ *
+ * Swipes are tracked with a pan gesture recognizer, so they work regardless of which widget on the
+ * page the touch started on. Releasing a swipe with enough velocity (a fling) changes the page
+ * even if it wasn't moved very far.
+ */
+class PageView: public Widget {
+    public:
+        /**
+         * @brief Function that creates the widget tree of a page
+         *
+         * Invoked with the index of the page. The page is resized to fill the page view.
+         */
+        using PageFactory = std::function<std::shared_ptr<Widget>(const size_t index)>;
+
+        /**
+         * @brief Callback invoked when the current page changes
+         */
+        using PageChangeCallback = std::function<void(const std::shared_ptr<Widget> &sender,
+                const size_t index)>;
+
+        /**
+         * @brief Initialize an empty page view
+         */
+        PageView(const Rect &rect);
+        ~PageView();
+
+        void draw(struct _cairo *drawCtx, const bool everything) override;
+        size_t getMemoryFootprint() const override;
+        void frameDidChange() override;
+
+        /**
+         * @brief Page views are opaque if their background is
+         */
+        bool isOpaque() override {
+            return this->background.isOpaque();
+        }
+
+        /**
+         * @brief Release the cached page snapshots
+         *
+         * They're taken again when the next swipe begins.
+         */
+        void releaseCachedResources() override {
+            this->releaseSnapshots();
+        }
+
+        void willMoveToParent(const std::shared_ptr<Widget> &newParent) override;
+
+        size_t addPage(const PageFactory &factory);
+
+        /**
+         * @brief Get the number of pages
+         */
+        inline size_t getNumPages() const {
+            return this->pages.size();
+        }
+        /**
+         * @brief Get the index of the current page
+         */
+        constexpr inline size_t getCurrentPage() const {
+            return this->current;
+        }
+        void setCurrentPage(const size_t index, const bool animated = false);
+
+        std::shared_ptr<Widget> getPage(const size_t index) const;
+        void invalidatePageSnapshot(const size_t index);
+
+        /**
+         * @brief Set the maximum number of pages to keep alive
+         *
+         * When more pages than this have been created, the least recently shown pages are
+         * destroyed. The current page is never destroyed.
+         */
+        inline void setMaxLivePages(const size_t newMax) {
+            this->maxLivePages = std::max(newMax, size_t{1});
+            this->evictPages();
+        }
+        /**
+         * @brief Get the maximum number of pages that are kept alive
+         */
+        constexpr inline auto getMaxLivePages() const {
+            return this->maxLivePages;
+        }
+
+        /**
+         * @brief Set the callback invoked when the current page changes
+         */
+        inline void setPageChangeCallback(const PageChangeCallback &cb) {
+            this->pageChangeCallback = cb;
+        }
+
+        /**
+         * @brief Set the background color
+         *
+         * It's visible when swiping past the first or last page.
+         */
+        inline void setBackgroundColor(const Color &newColor) {
+            this->background = newColor;
+            this->needsDisplay();
+        }
+        /**
+         * @brief Get the background color
+         */
+        constexpr inline Color getBackgroundColor() const {
+            return this->background;
+        }
+
+    private:
+        /**
+         * @brief Information about a single page
+         */
+        struct Page {
+            /// Function to create the page's widgets
+            PageFactory factory;
+            /// The page's root widget, if it's alive
+            std::shared_ptr<Widget> widget;
+            /// Most recent snapshot of the page
+            std::shared_ptr<Image> snapshot;
+            /// Value of the show counter when the page was last shown
+            uint64_t lastShown{0};
+        };
+
+        void showPage(const size_t index);
+        Page &makeLive(const size_t index);
+        void evictPages();
+
+        std::shared_ptr<Image> &getSnapshot(const size_t index);
+        void releaseSnapshots();
+        void trimSnapshots();
+
+        void handlePan(GestureRecognizer &recognizer);
+        void beginSwipe();
+        void cancelSwipe();
+        void animateTo(const size_t target);
+        void finishSwipe();
+        bool processAnimationFrame();
+        void stopAnimating();
+
+        void drawSnapshot(struct _cairo *drawCtx, const size_t index, const int x);
+
+    private:
+        /// Fraction of the width a page must be swiped to move to the next page
+        constexpr static const double kPageChangeFraction{.33};
+        /// Release velocity (points per second) above which a swipe moves to the next page
+        constexpr static const double kFlingVelocity{400.};
+        /// Fraction of the touch movement applied when swiping past the first or last page
+        constexpr static const double kOverscrollResistance{.3};
+        /// Duration of the settle animation after a swipe, in seconds
+        constexpr static const double kSettleDuration{.25};
+
+        /// All pages
+        std::vector<Page> pages;
+        /// Index of the current page
+        size_t current{0};
+        /// Maximum number of pages to keep alive
+        size_t maxLivePages{3};
+        /// Counter incremented every time a page is shown
+        uint64_t showCounter{0};
+
+        /// Background color
+        PackedColor background{Color(0, 0, 0)};
+
+        /// Callback invoked when the current page changes
+        std::optional<PageChangeCallback> pageChangeCallback;
+
+        /// Recognizer for swipes
+        std::shared_ptr<PanGestureRecognizer> pan;
+        /// Horizontal offset of the current page, while swiping or animating
+        double offset{0.};
+
+        /// Offset at the start of the settle animation
+        double animStartOffset{0.};
+        /// Offset at the end of the settle animation
+        double animEndOffset{0.};
+        /// Page to switch to when the settle animation completes
+        size_t animTarget{0};
+        /// Time the settle animation started
+        std::chrono::high_resolution_clock::time_point animStart;
+        /// Animator callback token
+        uint32_t animatorToken{0};
+
+        /// The current touch is a swipe; snapshots are composited instead of drawing the page
+        uintptr_t swiping                       :1{false};
+        /// The settle animation is in progress
+        uintptr_t animating                     :1{false};
+};
+}
+
+#endif
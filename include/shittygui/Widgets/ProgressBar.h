@@ -3,6 +3,7 @@
 
 #include <cstdint>
 
+#include <shittygui/FrameGovernor.h>
 #include <shittygui/Widget.h>
 #include <shittygui/Types.h>
 
@@ -58,6 +59,20 @@ class ProgressBar: public Widget {
         }
 
         void draw(struct _cairo *drawCtx, const bool everything) override;
+        size_t getMemoryFootprint() const override;
+
+        ArchiveWidgetType getArchiveType() const override {
+            return ArchiveWidgetType::ProgressBar;
+        }
+        void encode(ArchiveEncoder &encoder) const override;
+        bool decode(const ArchiveValue &value) override;
+
+        /**
+         * @brief Release the cached indeterminate fill pattern
+         */
+        void releaseCachedResources() override {
+            this->releaseFill();
+        }
 
         void willMoveToParent(const std::shared_ptr<Widget> &newParent) override {
             Widget::willMoveToParent(newParent);
@@ -84,10 +99,7 @@ class ProgressBar: public Widget {
          *
          * @param newProgress Progress percentage {0, 1}
          */
-        inline void setProgress(const double newProgress) {
-            this->progress = std::max(std::min(newProgress, 1.), 0.);
-            this->needsDisplay();
-        }
+        void setProgress(const double newProgress);
         /**
          * @brief Get the current progress percentage
          */
@@ -100,6 +112,8 @@ class ProgressBar: public Widget {
          */
         inline void setStyle(const Style newStyle) {
             this->style = newStyle;
+            this->fillDirty = true;
+            this->needsDisplay();
 
             if(newStyle == Style::Determinate && this->animatorRegistered) {
                 this->unregisterAnimCallback();
@@ -114,13 +128,14 @@ class ProgressBar: public Widget {
 
     private:
         void releaseResources();
+        void releaseFill();
 
         void registerAnimCallback();
         void unregisterAnimCallback();
 
         void processAnimationFrame();
 
-        void updateIndeterminateFill(const Rect &);
+        void updateIndeterminateFill(const Rect &, const QualityTier);
         void drawIndeterminatePattern(_cairo *, const double, const double);
 
     private:
@@ -143,6 +158,8 @@ class ProgressBar: public Widget {
         struct _cairo_pattern *barberPattern{nullptr};
         /// Width of the pattern (in pixels)
         double patternWidth;
+        /// Quality tier the pattern was rendered at
+        QualityTier fillQuality{QualityTier::Full};
 
         /// animator callback token
         uint32_t animatorToken{0};
@@ -157,6 +174,12 @@ class ProgressBar: public Widget {
          * This flag is used to set up the state of the animation callbacks.
          */
         uintptr_t animatorRegistered            :1{false};
+        /**
+         * @brief Whether the barber pole surface was taken from the surface pool
+         *
+         * Pooled surfaces are accounted for by the pool; others are accounted for by the bar.
+         */
+        uintptr_t barberPooled                  :1{false};
 };
 }
 
@@ -71,6 +71,19 @@ class RadioButton: public ToggleButtonBase {
             this->setChecked(isChecked);
         }
 
+        /**
+         * @brief Get the memory footprint of the widget
+         */
+        size_t getMemoryFootprint() const override {
+            return ToggleButtonBase::getMemoryFootprint() + (sizeof(RadioButton) - sizeof(ToggleButtonBase));
+        }
+
+        ArchiveWidgetType getArchiveType() const override {
+            return ArchiveWidgetType::RadioButton;
+        }
+        void encode(ArchiveEncoder &encoder) const override;
+        bool decode(const ArchiveValue &value) override;
+
         /**
          * @brief Set the width of the border
          *
@@ -99,7 +112,7 @@ class RadioButton: public ToggleButtonBase {
         /**
          * @brief Get the current border color
          */
-        constexpr inline auto &getBorderColor() const {
+        constexpr inline Color getBorderColor() const {
             return this->borderColor;
         }
 
@@ -112,7 +125,7 @@ class RadioButton: public ToggleButtonBase {
         /**
          * @brief Get the current regular filling color
          */
-        constexpr inline auto &getRegularFillingColor() const {
+        constexpr inline Color getRegularFillingColor() const {
             return this->fillingColor;
         }
 
@@ -125,7 +138,7 @@ class RadioButton: public ToggleButtonBase {
         /**
          * @brief Get the current selected filling color
          */
-        constexpr inline auto &getSelectedFillingColor() const {
+        constexpr inline Color getSelectedFillingColor() const {
             return this->selectedFillingColor;
         }
 
@@ -138,7 +151,7 @@ class RadioButton: public ToggleButtonBase {
         /**
          * @brief Get the current regular indicator color
          */
-        constexpr inline auto &getRegularIndicatorColor() const {
+        constexpr inline Color getRegularIndicatorColor() const {
             return this->indicatorColor;
         }
 
@@ -151,7 +164,7 @@ class RadioButton: public ToggleButtonBase {
         /**
          * @brief Get the current selected indicator color
          */
-        constexpr inline auto &getSelectedIndicatorColor() const {
+        constexpr inline Color getSelectedIndicatorColor() const {
             return this->selectedIndicatorColor;
         }
 
@@ -167,19 +180,19 @@ class RadioButton: public ToggleButtonBase {
 
     private:
         /// Border color
-        Color borderColor{.5, .5, .5};
+        PackedColor borderColor{Color(.5, .5, .5)};
         /// Border width
         double borderWidth{1.};
 
         /// Filling color (normal state)
-        Color fillingColor{.125, .125, .125};
+        PackedColor fillingColor{Color(.125, .125, .125)};
         /// Indicator color (normal state)
-        Color indicatorColor{.74, .15, .15};
+        PackedColor indicatorColor{Color(.74, .15, .15)};
 
         /// Filling color (selected state)
-        Color selectedFillingColor{.42, .42, .42};
+        PackedColor selectedFillingColor{Color(.42, .42, .42)};
         /// Indicator color (selected state)
-        Color selectedIndicatorColor{.74, .25, .25};
+        PackedColor selectedIndicatorColor{Color(.74, .25, .25)};
 };
 
 }
@@ -0,0 +1,269 @@
+#ifndef SHITTYGUI_WIDGETS_TEXTFIELD_H
+#define SHITTYGUI_WIDGETS_TEXTFIELD_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <shittygui/Widget.h>
+#include <shittygui/Types.h>
+#include <shittygui/TextRendering.h>
+
+namespace shittygui::widgets {
+/**
+ * @brief Single line text input field
+ *
+ * Displays an editable line of text with a caret. Touching the field makes it the first
+ * responder, and places the caret at the touched character; it then receives key events to edit
+ * the text. Text that's wider than the field scrolls horizontally to keep the caret visible.
+ *
+ * The field's text layout is updated as soon as the text is edited, and the horizontal position
+ * of every character boundary is cached; so edits only redraw the part of the field from the
+ * first changed character onwards, and the blinking caret only redraws the caret itself.
+ *
+ * @remark Caret positions are byte offsets into the UTF-8 encoded text, and always lie on a
+ *         character boundary.
+ */
+class TextField: public Widget, protected TextRendering {
+    public:
+        /**
+         * @brief Initialize an empty text field
+         */
+        TextField(const Rect &rect) : Widget(rect) {}
+        /**
+         * @brief Initialize a text field with the given text
+         *
+         * The caret is placed at the end of the text.
+         */
+        TextField(const Rect &rect, const std::string_view text) : Widget(rect) {
+            this->setText(text);
+        }
+        ~TextField();
+
+        /**
+         * Text fields always fill their background.
+         */
+        bool isOpaque() override {
+            return true;
+        }
+
+        void draw(struct _cairo *drawCtx, const bool everything) override;
+        size_t getMemoryFootprint() const override;
+
+        /**
+         * @brief Text fields receive key events
+         */
+        bool acceptsUserInput() override {
+            return true;
+        }
+        /**
+         * @brief Receive all touch events until the touch is released
+         */
+        bool wantsTouchTracking() override {
+            return true;
+        }
+        bool handleTouchEvent(const event::Touch &event) override;
+        bool handleKeyEvent(const event::Key &event) override;
+
+        void didBecomeFirstResponder() override;
+        void didResignFirstResponder() override;
+
+        void willMoveToParent(const std::shared_ptr<Widget> &newParent) override {
+            Widget::willMoveToParent(newParent);
+            this->stopBlinking();
+        }
+        /**
+         * @brief Release the text layout when removed from view hierarchy
+         *
+         * The text layout is configured for the drawing context of the screen, so it must be
+         * re-created for the new screen.
+         */
+        void didMoveToParent() override {
+            Widget::didMoveToParent();
+            this->releaseResources();
+        }
+        /**
+         * @brief Release the text layout
+         *
+         * It is re-created the next time the field is drawn.
+         */
+        void releaseCachedResources() override {
+            this->releaseResources();
+        }
+
+        void setText(const std::string_view newText);
+        /**
+         * @brief Get the current text
+         */
+        constexpr inline const std::string_view getText() const {
+            return this->text;
+        }
+
+        void insertText(const std::string_view str);
+
+        void setCaretPosition(const size_t position);
+        /**
+         * @brief Get the caret position, as a byte offset into the text
+         */
+        constexpr inline size_t getCaretPosition() const {
+            return this->caret;
+        }
+
+        void setFont(const std::string_view name, const double size);
+
+        /**
+         * @brief Set the text color
+         */
+        inline void setTextColor(const Color &newColor) {
+            this->foreground = newColor;
+            this->needsDisplay();
+        }
+        /**
+         * @brief Get the text color
+         */
+        constexpr inline Color getTextColor() const {
+            return this->foreground;
+        }
+
+        /**
+         * @brief Set the background color
+         */
+        inline void setBackgroundColor(const Color &newColor) {
+            this->background = newColor;
+            this->needsDisplay();
+        }
+        /**
+         * @brief Get the background color
+         */
+        constexpr inline Color getBackgroundColor() const {
+            return this->background;
+        }
+
+        /**
+         * @brief Set the caret color
+         */
+        inline void setCaretColor(const Color &newColor) {
+            this->caretColor = newColor;
+            this->needsDisplayInRect(this->getCaretRect());
+        }
+
+        /**
+         * @brief Set the callback invoked when the text is edited
+         *
+         * It's invoked after every change to the text made with key events, but not when the text
+         * is changed with setText() or insertText().
+         */
+        inline void setChangeCallback(const EventCallback &cb) {
+            this->changeCallback = cb;
+        }
+        /**
+         * @brief Remove the change callback
+         */
+        inline void resetChangeCallback() {
+            this->changeCallback.reset();
+        }
+
+        /**
+         * @brief Set the callback invoked when the enter key is pressed
+         */
+        inline void setReturnCallback(const EventCallback &cb) {
+            this->returnCallback = cb;
+        }
+        /**
+         * @brief Remove the return callback
+         */
+        inline void resetReturnCallback() {
+            this->returnCallback.reset();
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        /// Horizontal position of a character boundary in the laid out text
+        using CaretStop = CharacterPosition;
+
+        void releaseResources();
+
+        void updateLayout();
+        void edit(const size_t start, const size_t end, const std::string_view replacement);
+        void moveCaret(const size_t position);
+
+        int getCaretX(const size_t position) const;
+        size_t getPositionAt(const int x) const;
+        Rect getCaretRect() const;
+        Rect getTextRect() const;
+        bool scrollToCaret();
+
+        void startBlinking();
+        void stopBlinking();
+        void processAnimationFrame();
+
+        static size_t PrevCharacter(const std::string_view str, const size_t position);
+        static size_t NextCharacter(const std::string_view str, const size_t position);
+
+    private:
+        /// Default font for text fields
+        constexpr static const std::string_view kDefaultFont{"Liberation Sans"};
+        /// Default font size
+        constexpr static const double kDefaultFontSize{16.};
+
+        /// Horizontal space between the edge of the field and the text
+        constexpr static const int kTextPadding{6};
+        /// Width of the caret
+        constexpr static const int kCaretWidth{2};
+        /// Width of the field border
+        constexpr static const double kBorderWidth{1.};
+        /// Color of the field border
+        constexpr static const Color kBorderColor{0.5, 0.5, 0.5};
+
+        /// Time between toggling the caret visibility
+        constexpr static const std::chrono::milliseconds kBlinkInterval{530};
+
+        /// Text color
+        PackedColor foreground{Color(0, 0, 0)};
+        /// Background color
+        PackedColor background{Color(1, 1, 1)};
+        /// Caret color
+        PackedColor caretColor{Color(0, 0, 0)};
+
+        /// Text being edited
+        std::string text;
+        /// Caret position (byte offset into the text)
+        size_t caret{0};
+
+        /// Position of each character boundary of the laid out text, by ascending index
+        std::vector<CaretStop> stops;
+        /// Width of the laid out text, in pixels
+        int textWidth{0};
+        /// Height of a line of text, in pixels
+        int lineHeight{0};
+        /// Horizontal scroll offset of the text, in pixels
+        int scrollOffset{0};
+
+        /// Font descriptor for the field's font
+        TextFont *fontDesc{nullptr};
+
+        /// Callback invoked when the text is edited
+        std::optional<EventCallback> changeCallback;
+        /// Callback invoked when the enter key is pressed
+        std::optional<EventCallback> returnCallback;
+
+        /// Time at which the caret was last shown or hidden
+        Clock::time_point lastBlink;
+        /// Animator callback token (for blinking the caret)
+        uint32_t animatorToken{0};
+
+        /// Set when the layout must be rebuilt (the text or font changed without a layout)
+        uintptr_t layoutDirty           :1{true};
+        /// Whether the animator callback is registered
+        uintptr_t animatorRegistered    :1{false};
+        /// Whether the caret is currently shown
+        uintptr_t caretVisible          :1{false};
+};
+}
+
+#endif
@@ -30,12 +30,26 @@ class ToggleButtonBase: public Widget, protected TextRendering {
             }
         }
 
+        size_t getMemoryFootprint() const override;
+
+        void encode(ArchiveEncoder &encoder) const override;
+        bool decode(const ArchiveValue &value) override;
+
         /**
          * @brief Release text rendering resources when moving around.
          */
         void didMoveToParent() override {
             Widget::didMoveToParent();
-            this->releaseTextResources();
+            this->releaseResources();
+        }
+
+        /**
+         * @brief Release the label text layout
+         *
+         * It is re-created the next time the button is drawn.
+         */
+        void releaseCachedResources() override {
+            this->releaseResources();
         }
 
         /**
@@ -67,6 +81,21 @@ class ToggleButtonBase: public Widget, protected TextRendering {
         }
 
         bool handleTouchEvent(const event::Touch &event) override;
+        bool handleButtonEvent(const event::Button &event) override;
+
+        /**
+         * @brief Toggle buttons can be focused, and toggled with the select button
+         */
+        bool acceptsUserInput() override {
+            return true;
+        }
+        /**
+         * @brief Deselect the checkbox when its touch is taken over by a gesture
+         */
+        void handleTouchCancelled() override {
+            this->selected = false;
+            this->needsDisplay();
+        }
 
         /**
          * @brief Set the click callback
@@ -133,6 +162,7 @@ class ToggleButtonBase: public Widget, protected TextRendering {
 
         void drawLabel(struct _cairo *, const bool);
         void updateTextLayout();
+        void releaseResources();
 
         /**
          * @brief Update internal state in response to a touch event
@@ -165,11 +195,11 @@ class ToggleButtonBase: public Widget, protected TextRendering {
         constexpr static const double kDefaultFontSize{18.};
 
         /// Color for the text label
-        Color textColor{1., 1., 1.};
+        PackedColor textColor{Color(1., 1., 1.)};
         /// Text label
         std::optional<std::string> label;
         /// Font to render title with
-        struct _PangoFontDescription *fontDesc{nullptr};
+        TextFont *fontDesc{nullptr};
 };
 };
 
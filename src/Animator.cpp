@@ -3,6 +3,7 @@
 
 #include "Animator.h"
 #include "Screen.h"
+#include "Tracing.h"
 #include "Widget.h"
 
 using namespace shittygui;
@@ -18,12 +19,21 @@ Animator::Animator(Screen *screen) : owner(screen) {
 
 /**
  * @brief Process an animation frame
+ *
+ * Non-critical callbacks are skipped, unless this frame is a multiple of the interval set by the
+ * screen for its current quality tier.
  */
 void Animator::frameCallback() {
     std::unordered_set<uint32_t> toRemove;
+    const bool skipNonCritical = (++this->frame % this->nonCriticalInterval) != 0;
+
+    for(const auto &[token, entry] : this->callbacks) {
+        if(skipNonCritical && !entry.critical) {
+            continue;
+        }
 
-    for(const auto &[token, callback] : this->callbacks) {
-        const bool cont = callback();
+        SHITTYGUI_TRACE(animator__callback, token);
+        const bool cont = entry.callback();
         if(!cont) {
             toRemove.insert(token);
         }
@@ -37,9 +47,14 @@ void Animator::frameCallback() {
 /**
  * @brief Register an animation callback
  *
+ * @param callback Function to invoke every animation frame
+ * @param critical Whether the callback must be invoked every frame; non-critical callbacks are
+ *        invoked less often when the screen's rendering quality is reduced. Animations that are
+ *        time based (rather than advancing by a fixed amount every frame) can be non-critical.
+ *
  * @return Token used to remove the callback later
  */
-uint32_t Animator::registerCallback(const Callback &callback) {
+uint32_t Animator::registerCallback(const Callback &callback, const bool critical) {
     uint32_t token;
 
     // get an unused token
@@ -47,7 +62,7 @@ uint32_t Animator::registerCallback(const Callback &callback) {
         token = ++this->nextToken;
     } while(!token || this->callbacks.contains(token));
 
-    this->callbacks.emplace(token, callback);
+    this->callbacks.emplace(token, Entry{callback, critical});
 
     return token;
 }
@@ -9,10 +9,13 @@
 #ifndef CAIROHELPERS_H
 #define CAIROHELPERS_H
 
+#include <cmath>
 #include <numbers>
+#include <utility>
 
 #include <cairo.h>
 
+#include "DrawBackend.h"
 #include "Types.h"
 
 /// Cairo helper methods
@@ -40,6 +43,92 @@ static inline void Rectangle(cairo_t *ctx, const Rect &rect) {
     cairo_rectangle(ctx, rect.origin.x, rect.origin.y, rect.size.width, rect.size.height);
 }
 
+/**
+ * @brief Largest matrix component considered to be zero
+ *
+ * Rotations by multiples of 90° are computed with `sin` and `cos`, which leave residues on the
+ * order of 1e-16 rather than exact zeroes.
+ */
+constexpr static const double kMatrixEpsilon{1e-9};
+
+/**
+ * @brief Round the translation of the current transform to whole device pixels
+ *
+ * This is only done if the transform maps the axes onto device axes (that is, it consists only of
+ * scaling, translation and rotation by multiples of 90°) since otherwise, there are no pixel
+ * boundaries to align to.
+ */
+static inline void SnapToPixels(cairo_t *ctx) {
+    cairo_matrix_t m;
+    cairo_get_matrix(ctx, &m);
+
+    // axes are mapped onto device axes if either the diagonal or anti-diagonal is zero
+    const bool diagonal = std::abs(m.xx) > kMatrixEpsilon || std::abs(m.yy) > kMatrixEpsilon;
+    const bool antiDiagonal = std::abs(m.xy) > kMatrixEpsilon || std::abs(m.yx) > kMatrixEpsilon;
+    if(diagonal && antiDiagonal) {
+        return;
+    }
+
+    m.x0 = std::round(m.x0);
+    m.y0 = std::round(m.y0);
+    cairo_set_matrix(ctx, &m);
+}
+
+/**
+ * @brief Translate the coordinate space, aligning the new origin to a device pixel
+ *
+ * With a fractional scale factor, widget origins may fall between device pixels; snapping them
+ * ensures that rectangular fills and image blits line up with pixels, rather than requiring an
+ * antialiased composite.
+ */
+static inline void TranslateSnapped(cairo_t *ctx, const double x, const double y) {
+    cairo_translate(ctx, x, y);
+    SnapToPixels(ctx);
+}
+
+/**
+ * @brief Add a rectangle, aligned to device pixels, to the path
+ *
+ * The rectangle's corners are converted to device space and rounded to whole pixels. This is
+ * primarily used for clipping, since an unaligned clip rectangle requires a clip mask.
+ *
+ * @param rect Rectangle extents, in user space
+ * @param outward Whether to expand the rectangle to cover all partially covered pixels, rather
+ *        than rounding to the nearest pixel boundary
+ */
+static inline void AlignedRectangle(cairo_t *ctx, const Rect &rect, const bool outward = false) {
+    double x1 = rect.origin.x, y1 = rect.origin.y;
+    double x2 = rect.right(), y2 = rect.bottom();
+
+    cairo_user_to_device(ctx, &x1, &y1);
+    cairo_user_to_device(ctx, &x2, &y2);
+
+    if(x1 > x2) {
+        std::swap(x1, x2);
+    }
+    if(y1 > y2) {
+        std::swap(y1, y2);
+    }
+
+    if(outward) {
+        x1 = std::floor(x1);
+        y1 = std::floor(y1);
+        x2 = std::ceil(x2);
+        y2 = std::ceil(y2);
+    } else {
+        x1 = std::round(x1);
+        y1 = std::round(y1);
+        x2 = std::round(x2);
+        y2 = std::round(y2);
+    }
+
+    cairo_device_to_user(ctx, &x1, &y1);
+    cairo_device_to_user(ctx, &x2, &y2);
+
+    cairo_rectangle(ctx, std::min(x1, x2), std::min(y1, y2), std::abs(x2 - x1),
+            std::abs(y2 - y1));
+}
+
 /**
  * @brief Add a rounded rectangle to the path
  *
@@ -79,6 +168,44 @@ static inline void RoundedRect(cairo_t *ctx, const Rect &rect, const double corn
 
     cairo_close_path(ctx);
 }
+
+/**
+ * @brief Fill a rectangle with a solid color
+ *
+ * This (like the other drawing helpers below) draws with the draw backend attached to the
+ * context, and clears the current path.
+ */
+static inline void FillRect(cairo_t *ctx, const Rect &rect, const Color &color) {
+    DrawBackend::Get(ctx)->fillRect(ctx, rect, color);
+}
+
+/**
+ * @brief Fill a rectangle with rounded corners with a solid color
+ *
+ * @param cornerRadius Corner radius (points); zero for square corners
+ */
+static inline void FillRoundedRect(cairo_t *ctx, const Rect &rect, const double cornerRadius,
+        const Color &color) {
+    DrawBackend::Get(ctx)->fillRoundedRect(ctx, rect, cornerRadius, color);
+}
+
+/**
+ * @brief Stroke the outline of a rectangle with (optionally) rounded corners
+ *
+ * @param cornerRadius Corner radius (points); zero for square corners
+ * @param lineWidth Width of the outline, centered on the edges of the rectangle
+ */
+static inline void StrokeRoundedRect(cairo_t *ctx, const Rect &rect, const double cornerRadius,
+        const double lineWidth, const Color &color) {
+    DrawBackend::Get(ctx)->strokeRoundedRect(ctx, rect, cornerRadius, lineWidth, color);
+}
+
+/**
+ * @brief Draw an image surface, scaled to the given size, at the origin
+ */
+static inline void DrawSurface(cairo_t *ctx, cairo_surface_t *surface, const Size &size) {
+    DrawBackend::Get(ctx)->drawSurface(ctx, surface, size);
+}
 }
 
 #endif
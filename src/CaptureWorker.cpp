@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "CaptureWorker.h"
+#include "Errors.h"
+
+using namespace shittygui;
+
+/**
+ * @brief Create a capture request
+ *
+ * Allocates the buffer that receives the pixel data of the region; no pixels are copied yet.
+ *
+ * @param framebuffer Framebuffer surface to capture from
+ * @param fbRect Region of the framebuffer to capture; it must lie inside the framebuffer
+ * @param pixelFormat Pixel format of the framebuffer
+ * @param rotation Screen rotation, used to rotate the capture back into logical orientation
+ * @param format Output format
+ */
+CaptureRequest::CaptureRequest(cairo_surface_t *framebuffer, const Rect &fbRect,
+        const Screen::PixelFormat pixelFormat, const Screen::Rotation rotation,
+        const Screen::CaptureFormat format) : fbRect(fbRect), pixelFormat(pixelFormat),
+        rotation(rotation), format(format) {
+    this->source = reinterpret_cast<const std::byte *>(cairo_image_surface_get_data(framebuffer));
+    this->sourceStride = cairo_image_surface_get_stride(framebuffer);
+    this->bytesPerPixel = (pixelFormat == Screen::PixelFormat::RGB16) ? 2 : 4;
+
+    const auto stride = cairo_format_stride_for_width(cairo_image_surface_get_format(framebuffer),
+            fbRect.size.width);
+    if(stride == -1) {
+        throw std::invalid_argument("invalid capture region");
+    }
+
+    this->stride = stride;
+    this->pixels.resize(this->stride * fbRect.size.height);
+    this->copied.resize(fbRect.size.height, false);
+    this->remaining = fbRect.size.height;
+}
+
+/**
+ * @brief Copy rows of the framebuffer into the capture
+ *
+ * Rows that have already been copied are skipped, as are rows outside the captured region.
+ *
+ * @param from First framebuffer row to copy
+ * @param to Framebuffer row one past the last row to copy
+ */
+void CaptureRequest::copyRows(const int32_t from, const int32_t to) {
+    const auto first = std::max<int32_t>(from, this->fbRect.origin.y),
+          last = std::min<int32_t>(to, this->fbRect.bottom());
+    const auto rowBytes = this->fbRect.size.width * this->bytesPerPixel;
+    const auto xOffset = this->fbRect.origin.x * this->bytesPerPixel;
+
+    std::lock_guard lg(this->lock);
+
+    for(int32_t y = first; y < last && this->remaining; y++) {
+        const auto row = y - this->fbRect.origin.y;
+        if(this->copied[row]) {
+            continue;
+        }
+
+        std::memcpy(this->pixels.data() + (row * this->stride),
+                this->source + (y * this->sourceStride) + xOffset, rowBytes);
+
+        this->copied[row] = true;
+        this->remaining--;
+    }
+}
+
+
+
+/**
+ * @brief Start the worker thread
+ */
+CaptureWorker::CaptureWorker() {
+    this->thread = std::thread(&CaptureWorker::main, this);
+}
+
+/**
+ * @brief Stop the worker thread
+ *
+ * All requests that are still queued are processed before the thread exits, since the
+ * framebuffer they refer to may be released afterwards.
+ */
+CaptureWorker::~CaptureWorker() {
+    {
+        std::lock_guard lg(this->lock);
+        this->shutdown = true;
+    }
+
+    this->cond.notify_all();
+    this->thread.join();
+}
+
+/**
+ * @brief Queue a capture request for processing
+ */
+void CaptureWorker::submit(const std::shared_ptr<CaptureRequest> &request) {
+    {
+        std::lock_guard lg(this->lock);
+        this->queue.emplace_back(request);
+    }
+
+    this->cond.notify_one();
+}
+
+/**
+ * @brief Worker thread main loop
+ *
+ * Wait for requests, copy any remaining pixel data out of the framebuffer, then encode them.
+ */
+void CaptureWorker::main() {
+    while(true) {
+        std::shared_ptr<CaptureRequest> request;
+
+        {
+            std::unique_lock lg(this->lock);
+            this->cond.wait(lg, [&] {
+                return this->shutdown || !this->queue.empty();
+            });
+
+            if(this->queue.empty()) {
+                return;
+            }
+
+            request = std::move(this->queue.front());
+            this->queue.pop_front();
+        }
+
+        request->copyAll();
+
+        try {
+            request->promise.set_value(Encode(*request));
+        } catch(...) {
+            request->promise.set_exception(std::current_exception());
+        }
+    }
+}
+
+/**
+ * @brief Encode a capture
+ *
+ * If the screen is rotated, the pixel data is first rotated back so that the capture appears as
+ * the user sees it. Then it's either returned as is, or encoded as a PNG image.
+ */
+Screen::CaptureResult CaptureWorker::Encode(CaptureRequest &request) {
+    const auto cairoFormat = (request.pixelFormat == Screen::PixelFormat::RGB16) ?
+        CAIRO_FORMAT_RGB16_565 : (request.pixelFormat == Screen::PixelFormat::RGB30) ?
+        CAIRO_FORMAT_RGB30 : (request.pixelFormat == Screen::PixelFormat::RGB24) ?
+        CAIRO_FORMAT_RGB24 : CAIRO_FORMAT_ARGB32;
+
+    Screen::CaptureResult result;
+    result.format = request.pixelFormat;
+
+    auto surface = cairo_image_surface_create_for_data(
+            reinterpret_cast<unsigned char *>(request.pixels.data()), cairoFormat,
+            request.fbRect.size.width, request.fbRect.size.height, request.stride);
+    auto status = cairo_surface_status(surface);
+    if(status != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surface);
+        ThrowForCairoStatus(status);
+    }
+
+    /*
+     * Undo the screen rotation. Logical (x, y) is drawn at (y, width - x) in the framebuffer, so
+     * the pixel at (u, v) of the output comes from (v, h - u) of the captured region, where h is
+     * the height of the captured region (and thus the width of the output.)
+     */
+    if(request.rotation == Screen::Rotation::Rotate270) {
+        const auto width = request.fbRect.size.height, height = request.fbRect.size.width;
+
+        auto rotated = cairo_image_surface_create(cairoFormat, width, height);
+        status = cairo_surface_status(rotated);
+        if(status != CAIRO_STATUS_SUCCESS) {
+            cairo_surface_destroy(rotated);
+            cairo_surface_destroy(surface);
+            ThrowForCairoStatus(status);
+        }
+
+        auto ctx = cairo_create(rotated);
+        auto pattern = cairo_pattern_create_for_surface(surface);
+
+        cairo_matrix_t m;
+        cairo_matrix_init(&m, 0, -1, 1, 0, 0, width);
+        cairo_pattern_set_matrix(pattern, &m);
+        cairo_pattern_set_filter(pattern, CAIRO_FILTER_NEAREST);
+
+        cairo_set_source(ctx, pattern);
+        cairo_set_operator(ctx, CAIRO_OPERATOR_SOURCE);
+        cairo_paint(ctx);
+
+        cairo_pattern_destroy(pattern);
+        cairo_destroy(ctx);
+        cairo_surface_destroy(surface);
+
+        cairo_surface_flush(rotated);
+        surface = rotated;
+    }
+
+    result.size = Size(cairo_image_surface_get_width(surface),
+            cairo_image_surface_get_height(surface));
+
+    // produce the output
+    switch(request.format) {
+        case Screen::CaptureFormat::Raw: {
+            const auto data = reinterpret_cast<const std::byte *>(
+                    cairo_image_surface_get_data(surface));
+            result.stride = cairo_image_surface_get_stride(surface);
+            result.data.assign(data, data + (result.stride * result.size.height));
+            break;
+        }
+
+        case Screen::CaptureFormat::Png:
+            status = cairo_surface_write_to_png_stream(surface, [](void *ctx,
+                        const unsigned char *data, unsigned int length) -> cairo_status_t {
+                auto out = reinterpret_cast<std::vector<std::byte> *>(ctx);
+                auto bytes = reinterpret_cast<const std::byte *>(data);
+                out->insert(out->end(), bytes, bytes + length);
+                return CAIRO_STATUS_SUCCESS;
+            }, &result.data);
+
+            if(status != CAIRO_STATUS_SUCCESS) {
+                cairo_surface_destroy(surface);
+                ThrowForCairoStatus(status);
+            }
+            break;
+    }
+
+    cairo_surface_destroy(surface);
+    return result;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file
+ *
+ * @brief Background screen capture encoding
+ *
+ * Screen captures are taken with copy-on-write semantics: the capture request records the region
+ * of the framebuffer to capture, and a worker thread copies it out of the framebuffer and encodes
+ * it. Before the screen redraws any part of the region, it copies the affected rows into the
+ * request first, so the worker always sees the framebuffer as it was when the capture was taken.
+ */
+#ifndef SHITTYGUI_CAPTUREWORKER_H
+#define SHITTYGUI_CAPTUREWORKER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <cairo.h>
+
+#include "Screen.h"
+#include "Types.h"
+
+namespace shittygui {
+/**
+ * @brief A single screen capture request
+ *
+ * Shared between the screen (which copies rows about to be overwritten) and the worker.
+ */
+class CaptureRequest {
+    public:
+        CaptureRequest(cairo_surface_t *framebuffer, const Rect &fbRect,
+                const Screen::PixelFormat pixelFormat, const Screen::Rotation rotation,
+                const Screen::CaptureFormat format);
+
+        void copyRows(const int32_t from, const int32_t to);
+        /**
+         * @brief Copy all rows that have not been copied yet
+         */
+        inline void copyAll() {
+            this->copyRows(this->fbRect.origin.y, this->fbRect.bottom());
+        }
+
+        /**
+         * @brief Determine whether all rows have been copied
+         *
+         * Once this is the case, the framebuffer is no longer accessed.
+         */
+        inline bool isComplete() {
+            std::lock_guard lg(this->lock);
+            return !this->remaining;
+        }
+
+        /**
+         * @brief Get the region of the framebuffer captured
+         */
+        constexpr inline auto &getFramebufferRect() const {
+            return this->fbRect;
+        }
+
+        /// Promise fulfilled with the encoded capture
+        std::promise<Screen::CaptureResult> promise;
+
+    private:
+        friend class CaptureWorker;
+
+        /// Lock protecting the copy state
+        std::mutex lock;
+
+        /// Region of the framebuffer to capture
+        Rect fbRect;
+        /// Framebuffer data
+        const std::byte *source;
+        /// Bytes per row of the framebuffer
+        size_t sourceStride;
+        /// Bytes per pixel
+        size_t bytesPerPixel;
+
+        /// Pixel format of the framebuffer
+        Screen::PixelFormat pixelFormat;
+        /// Screen rotation at the time of the capture
+        Screen::Rotation rotation;
+        /// Output format
+        Screen::CaptureFormat format;
+
+        /// Copied pixel data
+        std::vector<std::byte> pixels;
+        /// Bytes per row of the copied pixel data
+        size_t stride;
+        /// Which rows have already been copied
+        std::vector<bool> copied;
+        /// Number of rows that have yet to be copied
+        size_t remaining;
+};
+
+/**
+ * @brief Worker thread for encoding screen captures
+ */
+class CaptureWorker {
+    public:
+        CaptureWorker();
+        ~CaptureWorker();
+
+        void submit(const std::shared_ptr<CaptureRequest> &request);
+
+    private:
+        void main();
+        static Screen::CaptureResult Encode(CaptureRequest &request);
+
+    private:
+        /// Lock protecting the queue
+        std::mutex lock;
+        /// Signalled when requests are added to the queue or the worker should exit
+        std::condition_variable cond;
+        /// Requests waiting to be processed
+        std::deque<std::shared_ptr<CaptureRequest>> queue;
+        /// Set when the worker should exit (after processing all queued requests)
+        bool shutdown{false};
+
+        /// Worker thread
+        std::thread thread;
+};
+}
+
+#endif
@@ -0,0 +1,129 @@
+#include <cairo.h>
+
+#include "CairoHelpers.h"
+#include "DrawBackend.h"
+
+using namespace shittygui;
+
+/// User data key for the draw backend attached to a context
+static const cairo_user_data_key_t gBackendKey{};
+/// User data key for the quality tier attached to a context
+static const cairo_user_data_key_t gQualityKey{};
+
+/// Shared Cairo draw backend
+static CairoDrawBackend gCairoBackend;
+/// Shared software draw backend
+static SoftwareDrawBackend gSoftwareBackend;
+
+/**
+ * @brief Get the draw backend for a context
+ *
+ * @return The backend set with Set(), or the Cairo backend if none was set.
+ */
+DrawBackend *DrawBackend::Get(cairo_t *ctx) {
+    auto backend = reinterpret_cast<DrawBackend *>(cairo_get_user_data(ctx, &gBackendKey));
+    return backend ? backend : &gCairoBackend;
+}
+
+/**
+ * @brief Set the draw backend of a context
+ *
+ * @param backend Backend to use for drawing into the context, or `nullptr` for the default
+ */
+void DrawBackend::Set(cairo_t *ctx, DrawBackend *backend) {
+    cairo_set_user_data(ctx, &gBackendKey, backend, nullptr);
+}
+
+/**
+ * @brief Get the rendering quality tier of a context
+ *
+ * @return The tier set with SetQuality(), or full quality if none was set.
+ */
+QualityTier DrawBackend::GetQuality(cairo_t *ctx) {
+    const auto value = reinterpret_cast<uintptr_t>(cairo_get_user_data(ctx, &gQualityKey));
+    return static_cast<QualityTier>(value);
+}
+
+/**
+ * @brief Set the rendering quality tier of a context
+ */
+void DrawBackend::SetQuality(cairo_t *ctx, const QualityTier tier) {
+    cairo_set_user_data(ctx, &gQualityKey,
+            reinterpret_cast<void *>(static_cast<uintptr_t>(tier)), nullptr);
+}
+
+/**
+ * @brief Get the shared Cairo draw backend
+ */
+DrawBackend *DrawBackend::Cairo() {
+    return &gCairoBackend;
+}
+
+/**
+ * @brief Get the shared software draw backend
+ */
+DrawBackend *DrawBackend::Software() {
+    return &gSoftwareBackend;
+}
+
+
+
+/**
+ * @brief Fill a rectangle with Cairo
+ */
+void CairoDrawBackend::fillRect(cairo_t *ctx, const Rect &rect, const Color &color) {
+    cairo_new_path(ctx);
+    cairo::Rectangle(ctx, rect);
+    cairo::SetSource(ctx, color);
+    cairo_fill(ctx);
+}
+
+/**
+ * @brief Fill a rounded rectangle with Cairo
+ */
+void CairoDrawBackend::fillRoundedRect(cairo_t *ctx, const Rect &rect, const double radius,
+        const Color &color) {
+    cairo_new_path(ctx);
+    cairo::RoundedRect(ctx, rect, radius);
+    cairo::SetSource(ctx, color);
+    cairo_fill(ctx);
+}
+
+/**
+ * @brief Stroke a rounded rectangle with Cairo
+ *
+ * Rounded rectangles are stroked with round joins, square ones with miter joins.
+ */
+void CairoDrawBackend::strokeRoundedRect(cairo_t *ctx, const Rect &rect, const double radius,
+        const double lineWidth, const Color &color) {
+    cairo_new_path(ctx);
+    cairo::RoundedRect(ctx, rect, radius);
+    cairo::SetSource(ctx, color);
+
+    cairo_set_line_cap(ctx, CAIRO_LINE_CAP_BUTT);
+    cairo_set_line_join(ctx, (radius > 0) ? CAIRO_LINE_JOIN_ROUND : CAIRO_LINE_JOIN_MITER);
+    cairo_set_line_width(ctx, lineWidth);
+
+    cairo_stroke(ctx);
+}
+
+/**
+ * @brief Draw an image surface with Cairo
+ */
+void CairoDrawBackend::drawSurface(cairo_t *ctx, cairo_surface_t *surface, const Size &size) {
+    const double width = cairo_image_surface_get_width(surface);
+    const double height = cairo_image_surface_get_height(surface);
+
+    cairo_save(ctx);
+
+    // map one pixel of the surface onto one device pixel
+    cairo_new_path(ctx);
+    cairo_rectangle(ctx, 0, 0, size.width, size.height);
+    cairo_scale(ctx, size.width / width, size.height / height);
+
+    cairo_set_source_surface(ctx, surface, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(ctx), CAIRO_FILTER_FAST);
+    cairo_fill(ctx);
+
+    cairo_restore(ctx);
+}
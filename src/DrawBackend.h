@@ -0,0 +1,121 @@
+/**
+ * @file
+ *
+ * @brief Drawing backends
+ *
+ * Widgets draw most of their content out of a handful of primitives: axis aligned and rounded
+ * rectangle fills, thin borders, and image blits. These are drawn through a draw backend, which is
+ * attached to the Cairo context; by default, they're simply drawn with Cairo.
+ *
+ * The software backend instead rasterizes these primitives directly into the pixels of the
+ * target surface, which is considerably faster than Cairo's general purpose rasterizer for
+ * 16-bit (RGB565) surfaces in particular. It handles only the simple cases (see
+ * SoftwareDrawBackend) and otherwise falls back to Cairo.
+ *
+ * The rendering quality tier selected by the screen's frame governor is attached to the context
+ * in the same way, so that code drawing into it can pick cheaper filters and antialiasing.
+ */
+#ifndef SHITTYGUI_DRAWBACKEND_H
+#define SHITTYGUI_DRAWBACKEND_H
+
+#include <cairo.h>
+
+#include "FrameGovernor.h"
+#include "Types.h"
+
+namespace shittygui {
+/**
+ * @brief Interface for drawing primitives
+ *
+ * All coordinates are in the user space of the Cairo context passed in, and drawing respects its
+ * current clip. Drawing clears the context's current path, and may change its source and line
+ * settings.
+ */
+class DrawBackend {
+    public:
+        virtual ~DrawBackend() = default;
+
+        /**
+         * @brief Fill a rectangle with a solid color
+         */
+        virtual void fillRect(cairo_t *ctx, const Rect &rect, const Color &color) = 0;
+        /**
+         * @brief Fill a rectangle with rounded corners with a solid color
+         *
+         * @param radius Corner radius; if zero, this is equivalent to fillRect()
+         */
+        virtual void fillRoundedRect(cairo_t *ctx, const Rect &rect, const double radius,
+                const Color &color) = 0;
+        /**
+         * @brief Stroke the outline of a (rounded) rectangle with a solid color
+         *
+         * The stroke is centered on the edges of the rectangle, like a Cairo stroke.
+         *
+         * @param radius Corner radius; use zero for square corners
+         * @param lineWidth Width of the stroke
+         */
+        virtual void strokeRoundedRect(cairo_t *ctx, const Rect &rect, const double radius,
+                const double lineWidth, const Color &color) = 0;
+        /**
+         * @brief Draw an image surface
+         *
+         * The surface is scaled to fill the rectangle from the origin to the given size, without
+         * filtering.
+         */
+        virtual void drawSurface(cairo_t *ctx, cairo_surface_t *surface, const Size &size) = 0;
+
+        static DrawBackend *Get(cairo_t *ctx);
+        static void Set(cairo_t *ctx, DrawBackend *backend);
+
+        static QualityTier GetQuality(cairo_t *ctx);
+        static void SetQuality(cairo_t *ctx, const QualityTier tier);
+
+        static DrawBackend *Cairo();
+        static DrawBackend *Software();
+};
+
+/**
+ * @brief Draw backend that draws everything with Cairo
+ */
+class CairoDrawBackend: public DrawBackend {
+    public:
+        void fillRect(cairo_t *ctx, const Rect &rect, const Color &color) override;
+        void fillRoundedRect(cairo_t *ctx, const Rect &rect, const double radius,
+                const Color &color) override;
+        void strokeRoundedRect(cairo_t *ctx, const Rect &rect, const double radius,
+                const double lineWidth, const Color &color) override;
+        void drawSurface(cairo_t *ctx, cairo_surface_t *surface, const Size &size) override;
+};
+
+/**
+ * @brief Draw backend that rasterizes primitives directly into image surfaces
+ *
+ * Primitives are rasterized directly when all of the following are true; otherwise, they are
+ * drawn with Cairo.
+ *
+ * - The context draws into an RGB16_565, RGB24 or ARGB32 image surface (and not into a group)
+ * - Its transform is a translation by whole pixels (no scaling or rotation)
+ * - Its clip consists of rectangles
+ * - The compositing operator is `CAIRO_OPERATOR_OVER`
+ *
+ * Images are only blitted directly if they are ARGB32, RGB24 or RGB16_565 image surfaces drawn at
+ * their native size.
+ *
+ * Edges are antialiased by their coverage of each pixel, so the results are very close to (but
+ * not bit-for-bit the same as) those produced by Cairo. The context's antialiasing mode is
+ * respected: with `CAIRO_ANTIALIAS_NONE`, pixels are either covered or not depending on whether
+ * their center lies inside the shape, and with `CAIRO_ANTIALIAS_FAST`, the coverage of rounded
+ * corners is approximated more cheaply.
+ */
+class SoftwareDrawBackend: public CairoDrawBackend {
+    public:
+        void fillRect(cairo_t *ctx, const Rect &rect, const Color &color) override;
+        void fillRoundedRect(cairo_t *ctx, const Rect &rect, const double radius,
+                const Color &color) override;
+        void strokeRoundedRect(cairo_t *ctx, const Rect &rect, const double radius,
+                const double lineWidth, const Color &color) override;
+        void drawSurface(cairo_t *ctx, cairo_surface_t *surface, const Size &size) override;
+};
+}
+
+#endif
@@ -0,0 +1,184 @@
+#include <iterator>
+
+#include "FocusEngine.h"
+#include "Screen.h"
+#include "Widget.h"
+
+using namespace shittygui;
+
+/**
+ * @brief Build the index key for a widget
+ *
+ * Keys sort by the widget's screen position (vertical first) and then by the sequence number.
+ */
+static inline uint64_t MakeKey(const Point origin, const uint32_t sequence) {
+    return (static_cast<uint64_t>(static_cast<uint16_t>(origin.y + 0x8000)) << 48) |
+        (static_cast<uint64_t>(static_cast<uint16_t>(origin.x + 0x8000)) << 32) | sequence;
+}
+
+/**
+ * @brief Queue a subtree of widgets for re-indexing
+ *
+ * Invoke whenever a widget was added to or removed from the screen's widget tree, or when its
+ * position or visibility changed; this affects all of its children, too.
+ *
+ * @param root Root of the subtree to re-index
+ */
+void FocusEngine::invalidate(const std::shared_ptr<Widget> &root) {
+    if(root->focusPending) {
+        return;
+    }
+
+    root->focusPending = true;
+    this->pending.emplace_back(root);
+
+    if(this->pending.size() > kMaxPending) {
+        this->update();
+    }
+}
+
+/**
+ * @brief Apply all pending updates to the index
+ */
+void FocusEngine::update() {
+    for(const auto &ptr : this->pending) {
+        auto root = ptr.lock();
+        if(!root || !root->focusPending) {
+            continue;
+        }
+
+        // the subtree is only indexed if it's visible on our screen
+        bool attached{false};
+        if(root->getScreen().get() == this->owner) {
+            root->updateScreenGeometry();
+            attached = root->screenVisible;
+        }
+
+        this->reindex(root.get(), attached);
+    }
+
+    this->pending.clear();
+}
+
+/**
+ * @brief Re-index a widget and its children
+ *
+ * Remove the widget from the index, then insert it again with its current position if it's
+ * focusable.
+ *
+ * @param widget Widget to re-index
+ * @param attached Whether the widget is visible on the screen
+ */
+void FocusEngine::reindex(Widget *widget, const bool attached) {
+    widget->focusPending = false;
+
+    if(widget->focusIndexed) {
+        auto it = this->index.find(widget->focusKey);
+        if(it != this->index.end() && it->second.lock().get() == widget) {
+            this->index.erase(it);
+        }
+        widget->focusIndexed = false;
+    }
+
+    if(attached && widget->acceptsUserInput()) {
+        widget->updateScreenGeometry();
+
+        auto sequence = static_cast<uint32_t>(widget->focusKey);
+        if(!sequence) {
+            sequence = ++this->sequence;
+        }
+
+        // on collision (the widget was indexed by another screen before) get a new sequence
+        auto key = MakeKey(widget->screenOrigin, sequence);
+        while(!this->index.emplace(key, widget->weak_from_this()).second) {
+            key = MakeKey(widget->screenOrigin, ++this->sequence);
+        }
+
+        widget->focusKey = key;
+        widget->focusIndexed = true;
+
+        if(widget->hasDefaultFocus() && !this->owner->getFirstResponder()) {
+            this->owner->setFirstResponder(widget->shared_from_this());
+        }
+    }
+
+    for(auto &child : widget->children) {
+        this->reindex(child.get(), attached && !child->isHidden());
+    }
+}
+
+/**
+ * @brief Find the widget a number of positions away from another
+ *
+ * Movement stops at the first and last widget. Entries for widgets that have since been
+ * deallocated are removed as they're encountered.
+ *
+ * @param from Widget to start at; if it's not in the index (or `nullptr`) the search starts at the
+ *        position it was last indexed at (or the start/end of the index.)
+ * @param steps Number of widgets to move; positive values move forward in reading order
+ *
+ * @return The widget to focus, or `nullptr` if there are no focusable widgets
+ */
+std::shared_ptr<Widget> FocusEngine::advance(const std::shared_ptr<Widget> &from,
+        const int steps) {
+    this->update();
+
+    if(this->index.empty()) {
+        return nullptr;
+    }
+
+    auto it = this->index.end();
+    int remaining = steps;
+
+    if(from && from->focusIndexed) {
+        it = this->index.find(from->focusKey);
+        if(it != this->index.end() && it->second.lock() != from) {
+            it = this->index.end();
+        }
+    }
+
+    // not indexed: moving takes us to the nearest widget in that direction
+    if(it == this->index.end()) {
+        it = from ? this->index.lower_bound(from->focusKey) :
+            ((steps > 0) ? this->index.begin() : this->index.end());
+
+        if(steps > 0) {
+            if(it == this->index.end()) {
+                --it;
+            }
+            remaining--;
+        } else if(steps < 0) {
+            if(it != this->index.begin()) {
+                --it;
+            }
+            remaining++;
+        }
+    }
+
+    // move forward
+    while(remaining > 0) {
+        auto next = std::next(it);
+        while(next != this->index.end() && next->second.expired()) {
+            next = this->index.erase(next);
+        }
+        if(next == this->index.end()) {
+            break;
+        }
+
+        it = next;
+        remaining--;
+    }
+    // or backward
+    while(remaining < 0 && it != this->index.begin()) {
+        auto prev = std::prev(it);
+        if(prev->second.expired()) {
+            this->index.erase(prev);
+            continue;
+        }
+
+        it = prev;
+        remaining++;
+    }
+
+    return it->second.lock();
+}
@@ -0,0 +1,71 @@
+/**
+ * @file
+ *
+ * @brief Focus traversal for encoder and button driven navigation
+ *
+ * Devices without a touch screen move the input focus between widgets with a rotary encoder. The
+ * focus engine keeps an index of all widgets on a screen that can receive focus, ordered by their
+ * position on screen (top to bottom, then left to right), so the next or previous widget can be
+ * found without walking the widget tree.
+ */
+#ifndef SHITTYGUI_FOCUSENGINE_H
+#define SHITTYGUI_FOCUSENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace shittygui {
+class Screen;
+class Widget;
+
+/**
+ * @brief Ordered index of focusable widgets
+ *
+ * A widget is focusable if it accepts user input, and is visible. The index is updated
+ * incrementally: whenever a subtree of widgets is added, removed, moved or hidden, its root is
+ * queued, and only the widgets in the queued subtrees are re-indexed before the next lookup.
+ *
+ * Each widget's key encodes its screen position, plus a sequence number to break ties; widgets
+ * store their key, so they can be located in the index in logarithmic time.
+ */
+class FocusEngine {
+    public:
+        FocusEngine(Screen *owner) : owner(owner) {}
+
+        void invalidate(const std::shared_ptr<Widget> &root);
+
+        std::shared_ptr<Widget> advance(const std::shared_ptr<Widget> &from, const int steps);
+
+        /**
+         * @brief Get the number of widgets in the index
+         *
+         * @remark Pending updates aren't applied, so this may be out of date.
+         */
+        inline size_t getNumWidgets() const {
+            return this->index.size();
+        }
+
+    private:
+        void update();
+        void reindex(Widget *widget, const bool attached);
+
+    private:
+        /// Maximum number of pending subtrees before they're applied immediately
+        constexpr static const size_t kMaxPending{32};
+
+        /// Screen whose widgets are indexed
+        Screen *owner;
+
+        /// Focusable widgets, by key
+        std::map<uint64_t, std::weak_ptr<Widget>> index;
+        /// Roots of subtrees to re-index
+        std::vector<std::weak_ptr<Widget>> pending;
+        /// Last assigned tie-break sequence number
+        uint32_t sequence{0};
+};
+}
+
+#endif
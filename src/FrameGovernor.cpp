@@ -0,0 +1,114 @@
+#include <stdexcept>
+
+#include "FrameGovernor.h"
+
+using namespace shittygui;
+
+/**
+ * @brief Initialize a governor with the default configuration
+ *
+ * It targets 60 frames per second.
+ */
+FrameGovernor::FrameGovernor() : FrameGovernor(Config{}) {
+
+}
+
+/**
+ * @brief Initialize a governor
+ *
+ * @param config Governor configuration
+ *
+ * @throw std::invalid_argument Invalid budget or window size
+ */
+FrameGovernor::FrameGovernor(const Config &config) : config(config) {
+    if(config.budget.count() <= 0) {
+        throw std::invalid_argument("invalid frame budget");
+    } else if(!config.window) {
+        throw std::invalid_argument("invalid window size");
+    }
+
+    this->samples.reserve(config.window);
+}
+
+/**
+ * @brief Account for a rendered frame
+ *
+ * Quality is reduced if the average over a full window of frames exceeds the budget, and restored
+ * once the average stayed below the restore threshold for the configured number of frames. The
+ * window starts over after each change, since earlier frames were rendered at a different tier.
+ *
+ * @param frameTime Time taken to render the frame
+ *
+ * @return Whether the quality tier changed
+ */
+bool FrameGovernor::update(const std::chrono::nanoseconds frameTime) {
+    const auto &cfg = this->config;
+
+    // add to the window
+    if(this->samples.size() < cfg.window) {
+        this->samples.push_back(frameTime);
+    } else {
+        this->sampleSum -= this->samples[this->nextSample];
+        this->samples[this->nextSample] = frameTime;
+        this->nextSample = (this->nextSample + 1) % cfg.window;
+    }
+    this->sampleSum += frameTime;
+
+    if(this->samples.size() < cfg.window) {
+        return false;
+    }
+
+    // compare the average against the thresholds
+    const auto average = static_cast<double>(this->getAverageFrameTime().count());
+    const auto budget = static_cast<double>(cfg.budget.count());
+
+    if(average > budget * cfg.degradeThreshold) {
+        this->headroomFrames = 0;
+
+        if(this->tier < cfg.lowestTier) {
+            this->changeTier(static_cast<QualityTier>(static_cast<uint8_t>(this->tier) + 1));
+            return true;
+        }
+    } else if(average < budget * cfg.restoreThreshold) {
+        if(++this->headroomFrames >= cfg.restoreFrames && this->tier != QualityTier::Full) {
+            this->changeTier(static_cast<QualityTier>(static_cast<uint8_t>(this->tier) - 1));
+            return true;
+        }
+    } else {
+        this->headroomFrames = 0;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Restore full quality, and discard all frame time samples
+ */
+void FrameGovernor::reset() {
+    this->changeTier(QualityTier::Full);
+}
+
+/**
+ * @brief Switch to a different tier, and start a new window
+ */
+void FrameGovernor::changeTier(const QualityTier newTier) {
+    this->tier = newTier;
+
+    this->samples.clear();
+    this->nextSample = 0;
+    this->sampleSum = {};
+    this->headroomFrames = 0;
+}
+
+/**
+ * @brief Get the average time of the frames in the current window
+ *
+ * @return Average frame time, or 0 if no frames were rendered since the last tier change
+ */
+std::chrono::nanoseconds FrameGovernor::getAverageFrameTime() const {
+    if(this->samples.empty()) {
+        return {};
+    }
+
+    return this->sampleSum / static_cast<int64_t>(this->samples.size());
+}
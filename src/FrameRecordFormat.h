@@ -0,0 +1,232 @@
+/**
+ * @file
+ *
+ * @brief Frame recording format
+ *
+ * Frame recordings consist of a file header, followed by a sequence of frame records. Each frame
+ * record contains one or more rectangles of pixel data, which are XORed against the previous
+ * frame and then run-length encoded. Since unchanged pixels XOR to zero, damaged regions that are
+ * only partially changed compress well.
+ *
+ * Keyframes encode the entire framebuffer against an all-zero frame, so that decoding can start
+ * at any keyframe.
+ *
+ * All header fields are little endian. Pixel values are stored in the byte order of the device that
+ * made the recording.
+ *
+ * Pixel data of a rectangle is encoded as a sequence of runs, in row-major order. Each run starts
+ * with a variable length (LEB128) integer, whose low two bits indicate the run type, and the
+ * remaining bits its length in pixels:
+ *
+ * - Zero: The pixels are unchanged.
+ * - Repeat: A single pixel value follows, which is XORed into all pixels of the run.
+ * - Literal: One pixel value per pixel of the run follows.
+ */
+#ifndef SHITTYGUI_FRAMERECORDFORMAT_H
+#define SHITTYGUI_FRAMERECORDFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace shittygui::framerecord {
+/// File magic value ('SGFR')
+constexpr static const uint32_t kMagic{0x52464753};
+/// Current format version
+constexpr static const uint16_t kVersion{1};
+
+/// Size of the file header, in bytes
+constexpr static const size_t kFileHeaderSize{16};
+/// Size of a frame record header, in bytes
+constexpr static const size_t kRecordHeaderSize{16};
+/// Size of a rectangle header, in bytes
+constexpr static const size_t kRectHeaderSize{12};
+
+/**
+ * @brief Frame record types
+ */
+enum class RecordType: uint8_t {
+    /// Full frame, encoded against an all-zero frame
+    Keyframe                            = 0,
+    /// Damaged rectangles, encoded against the previous frame
+    Delta                               = 1,
+};
+
+/**
+ * @brief Run types
+ */
+enum RunType: uint8_t {
+    kRunZero                            = 0,
+    kRunRepeat                          = 1,
+    kRunLiteral                         = 2,
+};
+
+/**
+ * @brief Append a little endian integer to a buffer
+ */
+template<typename T>
+static inline void Write(std::vector<std::byte> &out, const T value) {
+    for(size_t i = 0; i < sizeof(T); i++) {
+        out.push_back(static_cast<std::byte>((value >> (i * 8)) & 0xFF));
+    }
+}
+
+/**
+ * @brief Store a little endian integer at the given location in a buffer
+ */
+template<typename T>
+static inline void WriteAt(std::vector<std::byte> &out, const size_t offset, const T value) {
+    for(size_t i = 0; i < sizeof(T); i++) {
+        out[offset + i] = static_cast<std::byte>((value >> (i * 8)) & 0xFF);
+    }
+}
+
+/**
+ * @brief Read a little endian integer from a buffer
+ *
+ * @throw std::out_of_range Buffer is too short
+ */
+template<typename T>
+static inline T Read(const std::byte *data, const size_t length, size_t &offset) {
+    if(offset + sizeof(T) > length) {
+        throw std::out_of_range("truncated frame record");
+    }
+
+    T value{0};
+    for(size_t i = 0; i < sizeof(T); i++) {
+        value |= static_cast<T>(static_cast<T>(data[offset + i]) << (i * 8));
+    }
+
+    offset += sizeof(T);
+    return value;
+}
+
+/**
+ * @brief Append a variable length integer to a buffer
+ */
+static inline void WriteVarint(std::vector<std::byte> &out, uint32_t value) {
+    while(value >= 0x80) {
+        out.push_back(static_cast<std::byte>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::byte>(value));
+}
+
+/**
+ * @brief Read a variable length integer from a buffer
+ *
+ * @throw std::out_of_range Buffer is too short, or the value is too large
+ */
+static inline uint32_t ReadVarint(const std::byte *data, const size_t length, size_t &offset) {
+    uint32_t value{0};
+
+    for(unsigned shift = 0; shift < 35; shift += 7) {
+        if(offset >= length) {
+            break;
+        }
+
+        const auto byte = static_cast<uint8_t>(data[offset++]);
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+
+        if(!(byte & 0x80)) {
+            return value;
+        }
+    }
+
+    throw std::out_of_range("invalid varint in frame record");
+}
+
+/**
+ * @brief Run-length encoder for XORed pixel data
+ *
+ * Pixels are fed in one at a time; runs may span multiple rows of a rectangle.
+ */
+template<typename T>
+class RunEncoder {
+    public:
+        RunEncoder(std::vector<std::byte> &out) : out(out) {}
+
+        /**
+         * @brief Add a pixel value to the stream
+         */
+        inline void add(const T value) {
+            if(!value) {
+                if(this->type != kRunZero) {
+                    this->flush();
+                    this->type = kRunZero;
+                }
+                this->count++;
+            } else if(this->type == kRunRepeat && this->count && value == this->repeatValue) {
+                this->count++;
+            } else if(this->type == kRunLiteral && this->count &&
+                    value == this->literals.back()) {
+                // two identical values in a row: turn them into a repeat run
+                this->literals.pop_back();
+                this->count--;
+                this->flush();
+
+                this->type = kRunRepeat;
+                this->repeatValue = value;
+                this->count = 2;
+            } else if(this->type == kRunLiteral) {
+                this->literals.push_back(value);
+                this->count++;
+            } else {
+                this->flush();
+                this->type = kRunLiteral;
+                this->literals.push_back(value);
+                this->count = 1;
+            }
+        }
+
+        /**
+         * @brief Write out the current run, if any
+         */
+        void flush() {
+            if(!this->count) {
+                return;
+            }
+
+            WriteVarint(this->out, (this->count << 2) | this->type);
+
+            switch(this->type) {
+                case kRunRepeat:
+                    this->writePixels(&this->repeatValue, 1);
+                    break;
+                case kRunLiteral:
+                    this->writePixels(this->literals.data(), this->literals.size());
+                    this->literals.clear();
+                    break;
+                default:
+                    break;
+            }
+
+            this->count = 0;
+        }
+
+    private:
+        /// Append raw pixel values to the output
+        inline void writePixels(const T *values, const size_t num) {
+            const auto offset = this->out.size();
+            this->out.resize(offset + (num * sizeof(T)));
+            std::memcpy(this->out.data() + offset, values, num * sizeof(T));
+        }
+
+    private:
+        /// Output buffer
+        std::vector<std::byte> &out;
+
+        /// Type of the current run
+        RunType type{kRunZero};
+        /// Number of pixels in the current run
+        uint32_t count{0};
+        /// Value of a repeat run
+        T repeatValue{0};
+        /// Values of a literal run
+        std::vector<T> literals;
+};
+}
+
+#endif
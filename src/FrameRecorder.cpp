@@ -0,0 +1,276 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include "FrameRecordFormat.h"
+#include "FrameRecorder.h"
+
+using namespace shittygui;
+using namespace shittygui::framerecord;
+
+/**
+ * @brief Encode a rectangle of pixels
+ *
+ * The pixels are XORed against the shadow copy of the previous frame (or, for keyframes, stored
+ * as is) and run-length encoded. The shadow copy is then updated.
+ *
+ * @param framebuffer Current framebuffer contents
+ * @param stride Bytes per row of the framebuffer
+ * @param shadow Copy of the previous frame; it has a stride of `width * sizeof(T)`
+ * @param width Width of the framebuffer, in pixels
+ * @param rect Region to encode
+ * @param keyframe Whether the pixels are stored as is
+ * @param out Buffer to receive the encoded data
+ */
+template<typename T>
+static void EncodePixels(const std::byte *framebuffer, const size_t stride, std::byte *shadow,
+        const size_t width, const Rect &rect, const bool keyframe, std::vector<std::byte> &out) {
+    RunEncoder<T> encoder(out);
+
+    for(int32_t y = rect.origin.y; y < rect.bottom(); y++) {
+        const auto in = reinterpret_cast<const T *>(framebuffer + (y * stride)) + rect.origin.x;
+        auto prev = reinterpret_cast<T *>(shadow + (y * width * sizeof(T))) + rect.origin.x;
+
+        for(size_t x = 0; x < rect.size.width; x++) {
+            const T value = in[x];
+            encoder.add(keyframe ? value : (value ^ prev[x]));
+            prev[x] = value;
+        }
+    }
+
+    encoder.flush();
+}
+
+
+
+/**
+ * @brief Initialize a frame recorder
+ *
+ * @param capacity Maximum number of bytes of encoded frames to hold
+ * @param keyframeInterval Maximum number of frames between keyframes
+ *
+ * @throw std::invalid_argument Invalid capacity or keyframe interval
+ */
+FrameRecorder::FrameRecorder(const size_t capacity, const uint32_t keyframeInterval) :
+    capacity(capacity), keyframeInterval(keyframeInterval),
+    start(std::chrono::steady_clock::now()) {
+    if(!capacity) {
+        throw std::invalid_argument("invalid recorder capacity");
+    } else if(!keyframeInterval) {
+        throw std::invalid_argument("invalid keyframe interval");
+    }
+}
+
+/**
+ * @brief Discard all recorded frames
+ *
+ * The next frame is recorded as a keyframe.
+ */
+void FrameRecorder::clear() {
+    this->records.clear();
+    this->shadow.clear();
+
+    this->stats.bufferedFrames = 0;
+    this->stats.bufferedBytes = 0;
+}
+
+/**
+ * @brief Record a frame
+ *
+ * Invoked by the screen after it has been redrawn. A keyframe is recorded if this is the first
+ * frame, the framebuffer changed size or format, the keyframe interval elapsed, or the data
+ * since the last keyframe would take up more than half the buffer; otherwise only the given
+ * regions are recorded.
+ *
+ * A recording has a single framebuffer size and format, so when either changes, all frames
+ * recorded before the change are discarded.
+ *
+ * @param framebuffer Framebuffer contents
+ * @param stride Bytes per row of the framebuffer
+ * @param size Size of the framebuffer
+ * @param format Pixel format of the framebuffer
+ * @param rects Regions of the framebuffer that changed since the last frame
+ */
+void FrameRecorder::recordFrame(const std::byte *framebuffer, const size_t stride,
+        const Size &size, const Screen::PixelFormat format, const std::vector<Rect> &rects) {
+    using namespace std::chrono;
+    const auto encodeStart = steady_clock::now();
+
+    // decide whether to record a keyframe
+    const auto bpp = (format == Screen::PixelFormat::RGB16) ? 2 : 4;
+
+    const bool reconfigured = size.width != this->size.width ||
+        size.height != this->size.height || format != this->format;
+    const bool keyframe = this->shadow.empty() || reconfigured ||
+        this->framesSinceKeyframe >= this->keyframeInterval ||
+        this->bytesSinceKeyframe > (this->capacity / 2);
+
+    if(reconfigured) {
+        this->stats.droppedFrames += this->records.size();
+        this->records.clear();
+
+        this->stats.bufferedFrames = 0;
+        this->stats.bufferedBytes = 0;
+    }
+
+    if(keyframe) {
+        this->size = size;
+        this->format = format;
+        this->bytesPerPixel = bpp;
+        this->shadow.resize(size.width * size.height * bpp);
+    }
+
+    const Rect fullFrame({0, 0}, size);
+    const auto timestamp = duration_cast<nanoseconds>(encodeStart - this->start).count();
+
+    // build the record
+    std::vector<std::byte> record;
+    record.reserve(kRecordHeaderSize + 256);
+
+    Write<uint8_t>(record, static_cast<uint8_t>(keyframe ? RecordType::Keyframe :
+                RecordType::Delta));
+    Write<uint8_t>(record, 0);
+    Write<uint16_t>(record, 0);
+    Write<uint32_t>(record, 0);
+    Write<uint64_t>(record, timestamp);
+
+    uint16_t numRects{0};
+
+    if(keyframe) {
+        this->encodeRect(framebuffer, stride, fullFrame, true, record);
+        numRects = 1;
+    } else {
+        for(const auto &rect : rects) {
+            const auto area = rect.intersection(fullFrame);
+            if(area.isEmpty()) {
+                continue;
+            }
+
+            this->encodeRect(framebuffer, stride, area, false, record);
+            numRects++;
+        }
+    }
+
+    WriteAt<uint16_t>(record, 2, numRects);
+    WriteAt<uint32_t>(record, 4, record.size() - kRecordHeaderSize);
+
+    // store it
+    if(keyframe) {
+        this->framesSinceKeyframe = 0;
+        this->bytesSinceKeyframe = 0;
+        this->stats.keyframes++;
+    }
+
+    this->framesSinceKeyframe++;
+    this->bytesSinceKeyframe += record.size();
+
+    this->stats.frames++;
+    this->stats.bufferedFrames++;
+    this->stats.bufferedBytes += record.size();
+
+    record.shrink_to_fit();
+    this->records.emplace_back(std::move(record));
+
+    this->evict();
+
+    const auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - encodeStart);
+    this->stats.lastEncodeTime = elapsed;
+    this->stats.encodeTime += elapsed;
+}
+
+/**
+ * @brief Encode a single rectangle of the framebuffer
+ *
+ * Appends the rectangle header and its encoded pixel data to the output buffer.
+ */
+void FrameRecorder::encodeRect(const std::byte *framebuffer, const size_t stride,
+        const Rect &rect, const bool keyframe, std::vector<std::byte> &out) {
+    Write<uint16_t>(out, rect.origin.x);
+    Write<uint16_t>(out, rect.origin.y);
+    Write<uint16_t>(out, rect.size.width);
+    Write<uint16_t>(out, rect.size.height);
+
+    const auto lengthOffset = out.size();
+    Write<uint32_t>(out, 0);
+
+    if(this->bytesPerPixel == 2) {
+        EncodePixels<uint16_t>(framebuffer, stride, this->shadow.data(), this->size.width, rect,
+                keyframe, out);
+    } else {
+        EncodePixels<uint32_t>(framebuffer, stride, this->shadow.data(), this->size.width, rect,
+                keyframe, out);
+    }
+
+    WriteAt<uint32_t>(out, lengthOffset, out.size() - lengthOffset - sizeof(uint32_t));
+}
+
+/**
+ * @brief Discard the oldest frames until the buffer fits in its capacity
+ *
+ * Frames are discarded up to the next keyframe, since the frames following a keyframe cannot be
+ * decoded without it. The most recent keyframe and the frames after it are always retained.
+ */
+void FrameRecorder::evict() {
+    auto isKeyframe = [](const auto &record) {
+        return static_cast<RecordType>(record[0]) == RecordType::Keyframe;
+    };
+
+    while(this->stats.bufferedBytes > this->capacity && this->records.size() > 1) {
+        // find the next keyframe
+        auto next = this->records.begin() + 1;
+        while(next != this->records.end() && !isKeyframe(*next)) {
+            ++next;
+        }
+
+        if(next == this->records.end()) {
+            break;
+        }
+
+        // drop everything before it
+        for(auto it = this->records.begin(); it != next; ++it) {
+            this->stats.bufferedBytes -= it->size();
+            this->stats.bufferedFrames--;
+            this->stats.droppedFrames++;
+        }
+
+        this->records.erase(this->records.begin(), next);
+    }
+}
+
+/**
+ * @brief Write all buffered frames to a file
+ *
+ * @param path Path of the file to write; it's overwritten if it exists
+ *
+ * @throw std::system_error Failed to write the file
+ */
+void FrameRecorder::save(const std::filesystem::path &path) const {
+    std::vector<std::byte> header;
+    Write<uint32_t>(header, kMagic);
+    Write<uint16_t>(header, kVersion);
+    Write<uint16_t>(header, static_cast<uint16_t>(this->format));
+    Write<uint16_t>(header, this->size.width);
+    Write<uint16_t>(header, this->size.height);
+    Write<uint16_t>(header, this->bytesPerPixel);
+    Write<uint16_t>(header, 0);
+
+    auto fp = fopen(path.native().c_str(), "wb");
+    if(!fp) {
+        throw std::system_error(errno, std::generic_category(), "fopen recording");
+    }
+
+    bool ok = fwrite(header.data(), 1, header.size(), fp) == header.size();
+
+    for(const auto &record : this->records) {
+        if(!ok) {
+            break;
+        }
+        ok = fwrite(record.data(), 1, record.size(), fp) == record.size();
+    }
+
+    if(fclose(fp) || !ok) {
+        throw std::system_error(errno, std::generic_category(), "write recording");
+    }
+}
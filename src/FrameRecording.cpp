@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include "FrameRecordFormat.h"
+#include "FrameRecorder.h"
+
+using namespace shittygui;
+using namespace shittygui::framerecord;
+
+/**
+ * @brief Decode run-length encoded pixel data into a rectangle of a frame
+ *
+ * Decoded values are XORed into the frame, so keyframes must clear the frame first.
+ *
+ * @param frame Frame buffer to decode into
+ * @param stride Bytes per row of the frame
+ * @param rect Region of the frame the data covers
+ * @param data Encoded pixel data
+ * @param length Number of bytes of encoded pixel data
+ *
+ * @throw std::out_of_range The encoded data is truncated or covers more pixels than the rect
+ */
+template<typename T>
+static void DecodePixels(std::byte *frame, const size_t stride, const Rect &rect,
+        const std::byte *data, const size_t length) {
+    const size_t total = rect.area();
+    size_t offset{0}, pixel{0};
+
+    // XOR a value into the pixel with the given index inside the rect
+    auto apply = [&](const size_t index, const T value) {
+        const auto x = rect.origin.x + (index % rect.size.width),
+              y = rect.origin.y + (index / rect.size.width);
+        auto ptr = reinterpret_cast<T *>(frame + (y * stride)) + x;
+        *ptr ^= value;
+    };
+
+    while(offset < length) {
+        const auto header = ReadVarint(data, length, offset);
+        const auto type = header & 0b11, count = header >> 2;
+
+        if(pixel + count > total) {
+            throw std::out_of_range("run exceeds rect bounds");
+        }
+
+        switch(type) {
+            case kRunZero:
+                break;
+
+            case kRunRepeat: {
+                if(offset + sizeof(T) > length) {
+                    throw std::out_of_range("truncated repeat run");
+                }
+
+                T value;
+                std::memcpy(&value, data + offset, sizeof(T));
+                offset += sizeof(T);
+
+                for(size_t i = 0; i < count; i++) {
+                    apply(pixel + i, value);
+                }
+                break;
+            }
+
+            case kRunLiteral:
+                if(offset + (count * sizeof(T)) > length) {
+                    throw std::out_of_range("truncated literal run");
+                }
+
+                for(size_t i = 0; i < count; i++) {
+                    T value;
+                    std::memcpy(&value, data + offset, sizeof(T));
+                    offset += sizeof(T);
+
+                    apply(pixel + i, value);
+                }
+                break;
+
+            default:
+                throw std::out_of_range("invalid run type");
+        }
+
+        pixel += count;
+    }
+}
+
+
+
+/**
+ * @brief Open a recording file
+ *
+ * @param path Path to a file written by FrameRecorder::save()
+ *
+ * @throw std::system_error Failed to read the file
+ * @throw std::runtime_error The file is not a valid recording
+ */
+FrameRecording::FrameRecording(const std::filesystem::path &path) {
+    auto fp = fopen(path.native().c_str(), "rb");
+    if(!fp) {
+        throw std::system_error(errno, std::generic_category(), "fopen recording");
+    }
+
+    std::byte buf[4096];
+    size_t read;
+    while((read = fread(buf, 1, sizeof(buf), fp))) {
+        this->data.insert(this->data.end(), buf, buf + read);
+    }
+
+    const bool failed = ferror(fp);
+    fclose(fp);
+
+    if(failed) {
+        throw std::system_error(errno, std::generic_category(), "read recording");
+    }
+
+    this->parseHeader();
+}
+
+/**
+ * @brief Decode a recording held in memory
+ *
+ * @throw std::runtime_error The data is not a valid recording
+ */
+FrameRecording::FrameRecording(std::vector<std::byte> &&data) : data(std::move(data)) {
+    this->parseHeader();
+}
+
+/**
+ * @brief Parse the file header and allocate the frame buffer
+ */
+void FrameRecording::parseHeader() {
+    size_t off{0};
+
+    try {
+        const auto magic = Read<uint32_t>(this->data.data(), this->data.size(), off);
+        const auto version = Read<uint16_t>(this->data.data(), this->data.size(), off);
+
+        if(magic != kMagic) {
+            throw std::runtime_error("invalid recording magic");
+        } else if(version != kVersion) {
+            throw std::runtime_error("unsupported recording version");
+        }
+
+        this->format = static_cast<Screen::PixelFormat>(Read<uint16_t>(this->data.data(),
+                    this->data.size(), off));
+        this->size.width = Read<uint16_t>(this->data.data(), this->data.size(), off);
+        this->size.height = Read<uint16_t>(this->data.data(), this->data.size(), off);
+        this->bytesPerPixel = Read<uint16_t>(this->data.data(), this->data.size(), off);
+    } catch(const std::out_of_range &) {
+        throw std::runtime_error("truncated recording header");
+    }
+
+    if(this->bytesPerPixel != 2 && this->bytesPerPixel != 4) {
+        throw std::runtime_error("unsupported recording pixel size");
+    }
+
+    this->stride = this->size.width * this->bytesPerPixel;
+    this->frame.resize(this->stride * this->size.height);
+    this->offset = kFileHeaderSize;
+}
+
+/**
+ * @brief Decode the next frame of the recording
+ *
+ * @return Whether a frame was decoded; `false` once the end of the recording is reached
+ *
+ * @throw std::runtime_error The recording is corrupted
+ */
+bool FrameRecording::nextFrame() {
+    if(this->offset >= this->data.size()) {
+        return false;
+    }
+
+    const auto base = this->data.data();
+    const auto length = this->data.size();
+
+    try {
+        size_t off{this->offset};
+
+        const auto type = static_cast<RecordType>(Read<uint8_t>(base, length, off));
+        Read<uint8_t>(base, length, off);
+        const auto numRects = Read<uint16_t>(base, length, off);
+        const auto payloadBytes = Read<uint32_t>(base, length, off);
+        this->timestamp = std::chrono::nanoseconds(Read<uint64_t>(base, length, off));
+
+        const auto end = off + payloadBytes;
+        if(end > length) {
+            throw std::out_of_range("truncated frame payload");
+        }
+
+        this->keyframe = (type == RecordType::Keyframe);
+        if(this->keyframe) {
+            std::fill(this->frame.begin(), this->frame.end(), std::byte{0});
+        }
+
+        const Rect bounds({0, 0}, this->size);
+        this->damage.clear();
+
+        for(size_t i = 0; i < numRects; i++) {
+            Rect rect;
+            rect.origin.x = Read<uint16_t>(base, end, off);
+            rect.origin.y = Read<uint16_t>(base, end, off);
+            rect.size.width = Read<uint16_t>(base, end, off);
+            rect.size.height = Read<uint16_t>(base, end, off);
+            const auto rectBytes = Read<uint32_t>(base, end, off);
+
+            if(off + rectBytes > end) {
+                throw std::out_of_range("truncated rect data");
+            } else if(!bounds.contains(rect)) {
+                throw std::out_of_range("rect exceeds frame bounds");
+            }
+
+            this->decodeRect(rect, base + off, rectBytes);
+            this->damage.emplace_back(rect);
+
+            off += rectBytes;
+        }
+
+        this->offset = end;
+    } catch(const std::out_of_range &e) {
+        throw std::runtime_error(std::string("corrupted recording: ") + e.what());
+    }
+
+    return true;
+}
+
+/**
+ * @brief Decode the pixel data of a single rectangle into the frame
+ */
+void FrameRecording::decodeRect(const Rect &rect, const std::byte *data, const size_t length) {
+    if(this->bytesPerPixel == 2) {
+        DecodePixels<uint16_t>(this->frame.data(), this->stride, rect, data, length);
+    } else {
+        DecodePixels<uint32_t>(this->frame.data(), this->stride, rect, data, length);
+    }
+}
@@ -0,0 +1,288 @@
+#include <cmath>
+#include <utility>
+
+#include "GestureRecognizer.h"
+#include "Widget.h"
+
+using namespace shittygui;
+
+/**
+ * @brief Start tracking a touch
+ *
+ * Invoked by the screen when a touch goes down in the recognizer's widget (or one of its
+ * children.) This resets the recognizer to the `Possible` state.
+ *
+ * @param widget Widget the recognizer is attached to
+ * @param event Touch down event
+ */
+void GestureRecognizer::begin(const std::shared_ptr<Widget> &widget, const event::Touch &event) {
+    this->widget = widget;
+    this->state = State::Possible;
+    this->pendingStates.clear();
+
+    this->tracker.clear();
+    this->tracker.addSample(event.position, event.timestamp);
+
+    this->start = this->location = {static_cast<double>(event.position.x),
+        static_cast<double>(event.position.y)};
+    this->startTime = event.timestamp;
+
+    this->touchBegan(event);
+}
+
+/**
+ * @brief Handle a touch move or release
+ *
+ * Ignored once the recognizer has finished with the current touch.
+ */
+void GestureRecognizer::handleTouch(const event::Touch &event) {
+    if(!this->isTracking()) {
+        return;
+    }
+
+    this->tracker.addSample(event.position, event.timestamp);
+    this->location = {static_cast<double>(event.position.x),
+        static_cast<double>(event.position.y)};
+
+    if(event.isDown) {
+        this->touchMoved(event);
+    } else {
+        this->touchEnded(event);
+    }
+}
+
+/**
+ * @brief Handle a frame
+ *
+ * Ignored once the recognizer has finished with the current touch.
+ */
+void GestureRecognizer::handleFrame(const Clock::time_point now) {
+    if(!this->isTracking()) {
+        return;
+    }
+
+    this->processFrame(now);
+}
+
+/**
+ * @brief Fail the recognizer because another recognizer recognized its gesture
+ *
+ * A recognizer that recognized its gesture in response to the same event as the winner gives it
+ * up: continuous gestures are cancelled, discrete ones fail. None of its state changes for the
+ * touch are reported.
+ */
+void GestureRecognizer::fail() {
+    this->pendingStates.clear();
+
+    if(this->state == State::Began || this->state == State::Changed) {
+        this->state = State::Cancelled;
+    } else if(this->state != State::Cancelled) {
+        this->state = State::Failed;
+    }
+}
+
+/**
+ * @brief Abandon the current touch
+ *
+ * Continuous gestures in progress are cancelled; otherwise, the recognizer fails.
+ */
+void GestureRecognizer::cancel() {
+    if(this->state == State::Began || this->state == State::Changed) {
+        this->setState(State::Cancelled);
+    } else if(this->state == State::Possible) {
+        this->state = State::Failed;
+    }
+}
+
+/**
+ * @brief Change the recognizer's state
+ *
+ * The change is reported to the callback (for all states except failure) once the screen has
+ * arbitrated between all recognizers interested in the touch.
+ */
+void GestureRecognizer::setState(const State newState) {
+    this->state = newState;
+
+    if(newState != State::Failed && this->callback) {
+        this->pendingStates.push_back(newState);
+    }
+}
+
+/**
+ * @brief Invoke the callback for all state changes not reported yet
+ *
+ * The recognizer reports each state in turn, even if it has since moved on to another state.
+ */
+void GestureRecognizer::deliverStates() {
+    if(this->pendingStates.empty() || !this->callback) {
+        this->pendingStates.clear();
+        return;
+    }
+
+    const auto current = this->state;
+    const auto states = std::move(this->pendingStates);
+    this->pendingStates.clear();
+
+    for(const auto state : states) {
+        this->state = state;
+        (*this->callback)(*this);
+    }
+
+    this->state = current;
+}
+
+/**
+ * @brief Get the distance from the start location to the current location
+ */
+double GestureRecognizer::getDistance() const {
+    return std::hypot(this->location.x - this->start.x, this->location.y - this->start.y);
+}
+
+
+
+/**
+ * @brief Fail the tap if the touch moved too far
+ */
+void TapGestureRecognizer::touchMoved(const event::Touch &event) {
+    if(this->getDistance() > kTouchSlop) {
+        this->setState(State::Failed);
+    }
+}
+
+/**
+ * @brief Recognize the tap when the touch is released
+ */
+void TapGestureRecognizer::touchEnded(const event::Touch &event) {
+    if(this->getDistance() > kTouchSlop) {
+        this->setState(State::Failed);
+    } else {
+        this->setState(State::Recognized);
+    }
+}
+
+/**
+ * @brief Fail the tap if the touch is held for too long
+ */
+void TapGestureRecognizer::processFrame(const Clock::time_point now) {
+    if(now - this->startTime > kMaxDuration) {
+        this->setState(State::Failed);
+    }
+}
+
+
+
+/**
+ * @brief Fail if the touch moves before the press began; otherwise, report the movement
+ */
+void LongPressGestureRecognizer::touchMoved(const event::Touch &event) {
+    if(this->getState() == State::Possible) {
+        if(this->getDistance() > kTouchSlop) {
+            this->setState(State::Failed);
+        }
+    } else {
+        this->setState(State::Changed);
+    }
+}
+
+/**
+ * @brief End the gesture when the touch is released
+ *
+ * If the touch is released before the press began, the recognizer fails.
+ */
+void LongPressGestureRecognizer::touchEnded(const event::Touch &event) {
+    if(this->getState() == State::Possible) {
+        this->setState(State::Failed);
+    } else {
+        this->setState(State::Ended);
+    }
+}
+
+/**
+ * @brief Begin the gesture once the touch has been held long enough
+ */
+void LongPressGestureRecognizer::processFrame(const Clock::time_point now) {
+    if(this->getState() == State::Possible && now - this->startTime >= this->minDuration) {
+        this->setState(State::Began);
+    }
+}
+
+
+
+/**
+ * @brief Begin the pan once the touch moved far enough
+ *
+ * Subsequent movement is reported once per frame, from processFrame().
+ */
+void PanGestureRecognizer::touchMoved(const event::Touch &event) {
+    if(this->getState() == State::Possible && this->getDistance() > kTouchSlop) {
+        this->lastReported = this->location;
+        this->setState(State::Began);
+    }
+}
+
+/**
+ * @brief End the pan when the touch is released
+ *
+ * The location is the actual release location, rather than being resampled.
+ */
+void PanGestureRecognizer::touchEnded(const event::Touch &event) {
+    if(this->getState() == State::Possible) {
+        this->setState(State::Failed);
+    } else {
+        this->setState(State::Ended);
+    }
+}
+
+/**
+ * @brief Report the touch position for this frame
+ *
+ * The position is resampled to shortly before the frame time; a change is reported only if it's
+ * different from the last reported position.
+ */
+void PanGestureRecognizer::processFrame(const Clock::time_point now) {
+    if(this->getState() == State::Possible) {
+        return;
+    }
+
+    const auto pos = this->tracker.resample(now - kResampleLatency);
+    this->location = pos;
+
+    if(pos.x != this->lastReported.x || pos.y != this->lastReported.y) {
+        this->lastReported = pos;
+        this->setState(State::Changed);
+    }
+}
+
+
+
+/**
+ * @brief Check whether the released touch was a swipe
+ *
+ * The touch must have moved far enough along its dominant axis, and been moving fast enough in
+ * the same direction when released.
+ */
+void SwipeGestureRecognizer::touchEnded(const event::Touch &event) {
+    const auto delta = this->getTranslation();
+    const auto velocity = this->getVelocity();
+
+    double distance, speed;
+    Direction dir;
+
+    if(std::abs(delta.x) >= std::abs(delta.y)) {
+        dir = (delta.x < 0) ? Left : Right;
+        distance = std::abs(delta.x);
+        speed = (delta.x < 0) ? -velocity.x : velocity.x;
+    } else {
+        dir = (delta.y < 0) ? Up : Down;
+        distance = std::abs(delta.y);
+        speed = (delta.y < 0) ? -velocity.y : velocity.y;
+    }
+
+    if(!(this->directions & dir) || distance < kMinDistance || speed < kMinVelocity) {
+        this->setState(State::Failed);
+        return;
+    }
+
+    this->direction = dir;
+    this->setState(State::Recognized);
+}
@@ -1,12 +1,29 @@
+#include <atomic>
+#include <cmath>
 #include <cstdio>
+#include <string>
 
 #include <cairo.h>
 
+#include "CairoHelpers.h"
+#include "DrawBackend.h"
+#include "Errors.h"
+#include "MemoryAccounting.h"
 #include "PngImage.h"
 #include "Image.h"
 
 using namespace shittygui;
 
+/// Most recently assigned image generation
+static std::atomic<uint64_t> gLastGeneration{0};
+
+/**
+ * @brief Release the resampled image, if any
+ */
+Image::~Image() {
+    this->releaseScaledSurface();
+}
+
 /**
  * @brief Read an image from disk
  *
@@ -31,6 +48,7 @@ std::shared_ptr<Image> Image::Read(const std::filesystem::path &path) {
     // try as PNG
     try {
         auto png = std::make_shared<image::PngImage>(path);
+        png->setName(path.native());
         return png;
     } catch(const std::exception &e) {
         fprintf(stderr, "failed to read image '%s' as PNG: %s\n", path.native().c_str(), e.what());
@@ -40,3 +58,176 @@ std::shared_ptr<Image> Image::Read(const std::filesystem::path &path) {
     throw std::runtime_error("unsupported image format");
 }
 
+/**
+ * @brief Read an image from disk, picking the variant for a display scale factor
+ *
+ * High resolution variants of an image are stored alongside it, with the scale factor appended
+ * to the file name: for `icon.png`, the variant for 2× displays is `icon@2x.png`. The variant
+ * with the smallest scale factor at least as large as the display's is used, falling back to
+ * lower resolution variants, and then the image itself. The image's scale factor is set
+ * accordingly.
+ *
+ * @param path File path of the base (1×) image
+ * @param scale Scale factor of the display
+ *
+ * @return Image instance
+ *
+ * @throws std::invalid_argument File does not exist
+ * @throws std::runtime_error If the image could not be loaded
+ */
+std::shared_ptr<Image> Image::Read(const std::filesystem::path &path, const double scale) {
+    const auto ext = path.extension().string(), stem = path.stem().string();
+
+    for(int factor = static_cast<int>(std::ceil(scale)); factor > 1; factor--) {
+        const auto variant = path.parent_path() /
+            (stem + "@" + std::to_string(factor) + "x" + ext);
+
+        if(std::filesystem::exists(variant)) {
+            auto image = Read(variant);
+            image->setScale(factor);
+            image->setName(path.native());
+            return image;
+        }
+    }
+
+    return Read(path);
+}
+
+
+
+/**
+ * @brief Get the filter used to resample images at the given quality tier
+ */
+static cairo_filter_t GetResampleFilter(const QualityTier quality) {
+    switch(quality) {
+        case QualityTier::Reduced:
+            return CAIRO_FILTER_BILINEAR;
+        case QualityTier::Minimal:
+            return CAIRO_FILTER_NEAREST;
+        default:
+            return CAIRO_FILTER_GOOD;
+    }
+}
+
+/**
+ * @brief Draw the image
+ *
+ * The image is scaled to fill the given rectangle. Scaling is performed once (when the image is
+ * first drawn at a particular size on the device) rather than every time the image is drawn, so
+ * that drawing only requires copying pixels.
+ *
+ * @param drawCtx Drawing context to render into
+ * @param rect Rectangle to draw the image in, in user space
+ */
+void Image::draw(cairo_t *drawCtx, const Rect &rect) {
+    if(rect.isEmpty()) {
+        return;
+    }
+
+    cairo_save(drawCtx);
+    cairo::TranslateSnapped(drawCtx, rect.origin.x, rect.origin.y);
+
+    // figure out the size of the rect on the device (taking into account rotation)
+    double wX = rect.size.width, wY = 0, hX = 0, hY = rect.size.height;
+    cairo_user_to_device_distance(drawCtx, &wX, &wY);
+    cairo_user_to_device_distance(drawCtx, &hX, &hY);
+
+    const Size deviceSize(static_cast<uint16_t>(std::lround(std::hypot(wX, wY))),
+            static_cast<uint16_t>(std::lround(std::hypot(hX, hY))));
+
+    if(deviceSize.width && deviceSize.height) {
+        // one pixel of the surface maps onto one device pixel
+        auto surface = this->getSurfaceForSize(deviceSize, DrawBackend::GetQuality(drawCtx));
+        cairo::DrawSurface(drawCtx, surface, rect.size);
+    }
+
+    cairo_restore(drawCtx);
+}
+
+/**
+ * @brief Get a surface containing the image at the given size
+ *
+ * If the size matches the size of the image, its surface is returned directly. Otherwise, the
+ * image is resampled with a filter appropriate for the quality tier and cached; only the most
+ * recently used size is retained. A cached copy resampled at a lower quality than requested is
+ * resampled again, so images regain their full quality once the screen does.
+ *
+ * @param size Size of the image, in device pixels
+ * @param quality Rendering quality tier of the drawing context
+ */
+cairo_surface_t *Image::getSurfaceForSize(const Size &size, const QualityTier quality) {
+    const auto native = this->getSize();
+
+    if(size.width == native.width && size.height == native.height) {
+        return this->getSurface();
+    } else if(this->scaledSurface && size.width == this->scaledSize.width &&
+            size.height == this->scaledSize.height && this->scaledQuality <= quality) {
+        return this->scaledSurface;
+    }
+
+    this->releaseScaledSurface();
+
+    // resample the image
+    auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, size.width, size.height);
+    auto status = cairo_surface_status(surface);
+    if(status != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surface);
+        ThrowForCairoStatus(status);
+    }
+
+    auto ctx = cairo_create(surface);
+    cairo_scale(ctx, static_cast<double>(size.width) / native.width,
+            static_cast<double>(size.height) / native.height);
+
+    cairo_set_source_surface(ctx, this->getSurface(), 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(ctx), GetResampleFilter(quality));
+    cairo_set_operator(ctx, CAIRO_OPERATOR_SOURCE);
+    cairo_paint(ctx);
+
+    cairo_destroy(ctx);
+
+    memory::Allocated(MemoryCategory::ImagePixels,
+            cairo_image_surface_get_stride(surface) * cairo_image_surface_get_height(surface));
+
+    this->scaledSurface = surface;
+    this->scaledSize = size;
+    this->scaledQuality = quality;
+    return surface;
+}
+
+/**
+ * @brief Allocate a new, unique image generation
+ */
+uint64_t Image::NextGeneration() {
+    return ++gLastGeneration;
+}
+
+/**
+ * @brief Indicate that the contents of the image changed
+ *
+ * Invoke this after modifying the pixels of the image's surface. The resampled copy of the image
+ * is discarded, and the image gets a new generation, so widgets displaying it are not mistaken for
+ * being unchanged when they're next redrawn.
+ */
+void Image::contentsChanged() {
+    this->releaseScaledSurface();
+    this->generation = NextGeneration();
+}
+
+/**
+ * @brief Release the resampled copy of the image
+ *
+ * It's re-created when the image is next drawn at a size other than its physical size.
+ */
+void Image::releaseScaledSurface() {
+    if(!this->scaledSurface) {
+        return;
+    }
+
+    memory::Freed(MemoryCategory::ImagePixels,
+            cairo_image_surface_get_stride(this->scaledSurface) *
+            cairo_image_surface_get_height(this->scaledSurface));
+
+    cairo_surface_destroy(this->scaledSurface);
+    this->scaledSurface = nullptr;
+}
@@ -10,8 +10,11 @@
 
 #include "CairoHelpers.h"
 #include "Errors.h"
+#include "MemoryAccounting.h"
 #include "PngImage.h"
+#include "Tracing.h"
 
+using namespace shittygui;
 using namespace shittygui::image;
 
 /**
@@ -32,6 +35,8 @@ bool PngImage::IsSupported() {
 PngImage::PngImage(const std::filesystem::path &path) {
     std::array<std::byte, 8> header;
 
+    SHITTYGUI_TRACE(image__decode__start, path.native().c_str());
+
     // open file
     auto fp = fopen(path.native().c_str(), "rb");
     if(!fp) {
@@ -57,6 +62,9 @@ PngImage::PngImage(const std::filesystem::path &path) {
     }
 
     fclose(fp);
+
+    memory::Allocated(MemoryCategory::ImagePixels, this->framebuffer.size());
+    SHITTYGUI_TRACE(image__decode__done, this->getSize().width, this->getSize().height);
 }
 
 /**
@@ -189,6 +197,8 @@ PngImage::~PngImage() {
     if(this->surface) {
         cairo_surface_destroy(this->surface);
     }
+
+    memory::Freed(MemoryCategory::ImagePixels, this->framebuffer.size());
 }
 
 /**
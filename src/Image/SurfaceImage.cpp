@@ -0,0 +1,38 @@
+#include <stdexcept>
+
+#include <cairo.h>
+
+#include "SurfaceImage.h"
+
+using namespace shittygui;
+using namespace shittygui::image;
+
+/**
+ * @brief Create an image from a surface
+ *
+ * @param surface Image surface to wrap; the image takes ownership of the reference
+ *
+ * @throw std::invalid_argument The surface is not a valid image surface
+ */
+SurfaceImage::SurfaceImage(cairo_surface_t *surface) : surface(surface) {
+    if(!surface || cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS ||
+            !cairo_image_surface_get_data(surface)) {
+        cairo_surface_destroy(surface);
+        throw std::invalid_argument("invalid surface");
+    }
+}
+
+/**
+ * @brief Release the surface
+ */
+SurfaceImage::~SurfaceImage() {
+    cairo_surface_destroy(this->surface);
+}
+
+/**
+ * @brief Get the size of the underlying surface
+ */
+Size SurfaceImage::getSize() const {
+    return Size(cairo_image_surface_get_width(this->surface),
+            cairo_image_surface_get_height(this->surface));
+}
@@ -0,0 +1,32 @@
+#ifndef SHITTYGUI_IMAGE_SURFACEIMAGE_H
+#define SHITTYGUI_IMAGE_SURFACEIMAGE_H
+
+#include <shittygui/Types.h>
+#include <shittygui/Image.h>
+
+namespace shittygui::image {
+/**
+ * @brief Image backed by an existing Cairo surface
+ *
+ * Wraps an image surface that was rendered by the library, such as a snapshot of a widget.
+ */
+class SurfaceImage: public Image {
+    public:
+        SurfaceImage(struct _cairo_surface *surface);
+        ~SurfaceImage();
+
+        /**
+         * @brief Get the underlying surface
+         */
+        struct _cairo_surface *getSurface() const override {
+            return this->surface;
+        }
+        Size getSize() const override;
+
+    private:
+        /// Image surface containing the image
+        struct _cairo_surface *surface{nullptr};
+};
+}
+
+#endif
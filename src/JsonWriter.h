@@ -0,0 +1,185 @@
+/**
+ * @file
+ *
+ * @brief Minimal streaming JSON writer
+ *
+ * Used to produce the various debugging dumps (such as the widget tree) without pulling in an
+ * external JSON library.
+ */
+#ifndef SHITTYGUI_JSONWRITER_H
+#define SHITTYGUI_JSONWRITER_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace shittygui {
+/**
+ * @brief Streaming JSON writer
+ *
+ * Builds a JSON document into an internal string buffer. Separators between elements are
+ * inserted automatically; the caller is responsible for properly nesting objects and arrays.
+ */
+class JsonWriter {
+    public:
+        /// Begin a new object
+        inline void beginObject() {
+            this->beginContainer('{');
+        }
+        /// End the current object
+        inline void endObject() {
+            this->endContainer('}');
+        }
+        /// Begin a new array
+        inline void beginArray() {
+            this->beginContainer('[');
+        }
+        /// End the current array
+        inline void endArray() {
+            this->endContainer(']');
+        }
+
+        /**
+         * @brief Write an object key
+         *
+         * The next value written is associated with this key.
+         */
+        inline void key(const std::string_view name) {
+            this->separator();
+            this->writeString(name);
+            this->out.push_back(':');
+            this->afterKey = true;
+        }
+
+        /// Write a string value
+        inline void value(const std::string_view str) {
+            this->separator();
+            this->writeString(str);
+        }
+        /// Write a string value
+        inline void value(const char *str) {
+            this->value(std::string_view(str));
+        }
+        /// Write a boolean value
+        inline void value(const bool flag) {
+            this->separator();
+            this->out.append(flag ? "true" : "false");
+        }
+        /// Write a signed integer value
+        inline void value(const int64_t num) {
+            this->separator();
+            this->out.append(std::to_string(num));
+        }
+        /// Write an unsigned integer value
+        inline void value(const uint64_t num) {
+            this->separator();
+            this->out.append(std::to_string(num));
+        }
+        /// Write a floating point value; non-finite values are written as `null`
+        inline void value(const double num) {
+            this->separator();
+
+            if(!std::isfinite(num)) {
+                this->out.append("null");
+                return;
+            }
+
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%.6g", num);
+            this->out.append(buf);
+        }
+
+        /**
+         * @brief Write a key and value pair
+         */
+        template<typename T>
+        inline void field(const std::string_view name, const T &val) {
+            this->key(name);
+            this->value(val);
+        }
+
+        /**
+         * @brief Get the JSON string built so far
+         */
+        constexpr inline std::string &str() {
+            return this->out;
+        }
+
+    private:
+        /// Insert a separator before the next element, if required
+        inline void separator() {
+            if(this->afterKey) {
+                this->afterKey = false;
+                return;
+            }
+
+            if(!this->needsComma.empty()) {
+                if(this->needsComma.back()) {
+                    this->out.push_back(',');
+                }
+                this->needsComma.back() = true;
+            }
+        }
+
+        inline void beginContainer(const char open) {
+            this->separator();
+            this->out.push_back(open);
+            this->needsComma.push_back(false);
+        }
+
+        inline void endContainer(const char close) {
+            this->out.push_back(close);
+            this->needsComma.pop_back();
+        }
+
+        /// Write a quoted and escaped string
+        inline void writeString(const std::string_view str) {
+            this->out.push_back('"');
+
+            for(const char c : str) {
+                switch(c) {
+                    case '"':
+                        this->out.append("\\\"");
+                        break;
+                    case '\\':
+                        this->out.append("\\\\");
+                        break;
+                    case '\n':
+                        this->out.append("\\n");
+                        break;
+                    case '\r':
+                        this->out.append("\\r");
+                        break;
+                    case '\t':
+                        this->out.append("\\t");
+                        break;
+
+                    default:
+                        if(static_cast<unsigned char>(c) < 0x20) {
+                            char buf[8];
+                            snprintf(buf, sizeof(buf), "\\u%04x", c);
+                            this->out.append(buf);
+                        } else {
+                            this->out.push_back(c);
+                        }
+                        break;
+                }
+            }
+
+            this->out.push_back('"');
+        }
+
+    private:
+        /// Output buffer
+        std::string out;
+        /// For each nesting level, whether the next element requires a separating comma
+        std::vector<bool> needsComma;
+        /// Set when a key was just written (no separator needed before its value)
+        bool afterKey{false};
+};
+}
+
+#endif
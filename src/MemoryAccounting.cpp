@@ -0,0 +1,88 @@
+#include <array>
+#include <atomic>
+
+#include "MemoryAccounting.h"
+
+using namespace shittygui;
+
+/**
+ * @brief Counters for a single memory category
+ */
+struct Counter {
+    std::atomic_size_t current{0};
+    std::atomic_size_t peak{0};
+};
+
+/// Per category counters
+static std::array<Counter, kNumMemoryCategories> gCounters;
+/// Counter for the total over all categories
+static Counter gTotal;
+
+/**
+ * @brief Add bytes to a counter, updating its high-water mark
+ */
+static void Increment(Counter &counter, const size_t bytes) {
+    const auto now = counter.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+    auto peak = counter.peak.load(std::memory_order_relaxed);
+    while(now > peak && !counter.peak.compare_exchange_weak(peak, now,
+                std::memory_order_relaxed)) {}
+}
+
+/**
+ * @brief Remove bytes from a counter
+ */
+static void Decrement(Counter &counter, const size_t bytes) {
+    counter.current.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Record an allocation
+ *
+ * @param category Category of the memory
+ * @param bytes Number of bytes allocated
+ */
+void memory::Allocated(const MemoryCategory category, const size_t bytes) {
+    Increment(gCounters[static_cast<size_t>(category)], bytes);
+    Increment(gTotal, bytes);
+}
+
+/**
+ * @brief Record a deallocation
+ *
+ * @param category Category of the memory
+ * @param bytes Number of bytes released; this must match what was previously allocated
+ */
+void memory::Freed(const MemoryCategory category, const size_t bytes) {
+    Decrement(gCounters[static_cast<size_t>(category)], bytes);
+    Decrement(gTotal, bytes);
+}
+
+/**
+ * @brief Get the total number of bytes currently in use
+ */
+size_t memory::GetTotal() {
+    return gTotal.current.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get the number of bytes currently in use in a category
+ */
+size_t memory::GetCurrent(const MemoryCategory category) {
+    return gCounters[static_cast<size_t>(category)].current.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Fill in the usage counters of a memory statistics structure
+ *
+ * @param outStats Structure to receive usage information; the budget fields are not modified
+ */
+void memory::GetStats(MemoryStats &outStats) {
+    for(size_t i = 0; i < kNumMemoryCategories; i++) {
+        outStats.categories[i].current = gCounters[i].current.load(std::memory_order_relaxed);
+        outStats.categories[i].peak = gCounters[i].peak.load(std::memory_order_relaxed);
+    }
+
+    outStats.total.current = gTotal.current.load(std::memory_order_relaxed);
+    outStats.total.peak = gTotal.peak.load(std::memory_order_relaxed);
+}
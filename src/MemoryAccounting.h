@@ -0,0 +1,42 @@
+/**
+ * @file
+ *
+ * @brief Memory usage accounting
+ *
+ * Allocations of notable size (images, cached surfaces, text layouts, widgets) are registered here
+ * so that memory usage can be reported per category. Counters are process wide, since resources
+ * such as images may be shared between screens.
+ */
+#ifndef SHITTYGUI_MEMORYACCOUNTING_H
+#define SHITTYGUI_MEMORYACCOUNTING_H
+
+#include <cstddef>
+
+#include "MemoryStats.h"
+
+/// Memory accounting helpers
+namespace shittygui::memory {
+void Allocated(const MemoryCategory category, const size_t bytes);
+void Freed(const MemoryCategory category, const size_t bytes);
+
+/**
+ * @brief Update the accounted size of an allocation
+ *
+ * @param category Memory category to account to
+ * @param oldBytes Previously accounted size of the allocation
+ * @param newBytes New size of the allocation
+ */
+inline void Resized(const MemoryCategory category, const size_t oldBytes, const size_t newBytes) {
+    if(newBytes > oldBytes) {
+        Allocated(category, newBytes - oldBytes);
+    } else if(oldBytes > newBytes) {
+        Freed(category, oldBytes - newBytes);
+    }
+}
+
+size_t GetTotal();
+size_t GetCurrent(const MemoryCategory category);
+void GetStats(MemoryStats &outStats);
+}
+
+#endif
@@ -0,0 +1,388 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "RefreshPlanner.h"
+
+using namespace shittygui;
+
+/**
+ * @brief Create a rectangle from its edges
+ */
+static inline Rect MakeRect(const int32_t x1, const int32_t y1, const int32_t x2,
+        const int32_t y2) {
+    return Rect({static_cast<int16_t>(x1), static_cast<int16_t>(y1)},
+            Size(static_cast<uint16_t>(x2 - x1), static_cast<uint16_t>(y2 - y1)));
+}
+
+/**
+ * @brief Subtract one rectangle from another
+ *
+ * The part of the rectangle not covered by the other rectangle is split into up to four pieces:
+ * full width bands above and below the overlap, and the parts to its left and right.
+ *
+ * @param rect Rectangle to subtract from
+ * @param other Rectangle to subtract
+ * @param out Vector to receive the remaining pieces of the rectangle
+ */
+static void Subtract(const Rect &rect, const Rect &other, std::vector<Rect> &out) {
+    if(!rect.intersects(other)) {
+        out.emplace_back(rect);
+        return;
+    }
+
+    const auto overlap = rect.intersection(other);
+
+    if(overlap.origin.y > rect.origin.y) {
+        out.emplace_back(MakeRect(rect.origin.x, rect.origin.y, rect.right(), overlap.origin.y));
+    }
+    if(overlap.bottom() < rect.bottom()) {
+        out.emplace_back(MakeRect(rect.origin.x, overlap.bottom(), rect.right(), rect.bottom()));
+    }
+    if(overlap.origin.x > rect.origin.x) {
+        out.emplace_back(MakeRect(rect.origin.x, overlap.origin.y, overlap.origin.x,
+                    overlap.bottom()));
+    }
+    if(overlap.right() < rect.right()) {
+        out.emplace_back(MakeRect(overlap.right(), overlap.origin.y, rect.right(),
+                    overlap.bottom()));
+    }
+}
+
+/**
+ * @brief Round a value down to a multiple of the alignment
+ */
+static inline int32_t AlignDown(const int32_t value, const int32_t alignment) {
+    return (value / alignment) * alignment;
+}
+
+/**
+ * @brief Round a value up to a multiple of the alignment
+ */
+static inline int32_t AlignUp(const int32_t value, const int32_t alignment) {
+    return ((value + alignment - 1) / alignment) * alignment;
+}
+
+
+
+/**
+ * @brief Initialize a refresh planner
+ *
+ * @param size Size of the panel, in pixels
+ * @param model Cost model of the panel
+ */
+RefreshPlanner::RefreshPlanner(const Size &size, const CostModel &model) : size(size),
+    model(model) {
+    if(!model.alignX || !model.alignY) {
+        throw std::invalid_argument("invalid alignment");
+    }
+}
+
+/**
+ * @brief Plan the transfers to update the given damaged regions
+ *
+ * @param damage Damaged regions of the frame, in framebuffer coordinates
+ *
+ * @return Ordered list of transfers; it is valid until the next call to plan().
+ */
+const std::vector<Rect> &RefreshPlanner::plan(const std::vector<Rect> &damage) {
+    const auto start = std::chrono::steady_clock::now();
+
+    this->stats = {};
+    this->stats.regions = damage.size();
+    this->transfers.clear();
+
+    // align the regions, and split them where they overlap
+    for(const auto &rect : damage) {
+        const auto aligned = this->align(rect);
+        if(aligned.isEmpty()) {
+            continue;
+        }
+
+        this->stats.naiveCost += this->cost(aligned);
+        this->addDisjoint(aligned, this->transfers);
+    }
+
+    // merge transfers while that's cheaper, then until there's few enough of them
+    while(this->mergeBest(false)) {}
+
+    if(this->model.maxTransfers) {
+        while(this->transfers.size() > this->model.maxTransfers && this->mergeBest(true)) {}
+    }
+
+    // split transfers that are too large, and sort them in scan order
+    if(this->model.maxTransferPixels) {
+        this->splitLarge();
+    }
+
+    std::sort(this->transfers.begin(), this->transfers.end(), [](const auto &a, const auto &b) {
+        return (a.origin.y == b.origin.y) ? (a.origin.x < b.origin.x) : (a.origin.y < b.origin.y);
+    });
+
+    // update stats
+    for(const auto &rect : this->transfers) {
+        this->stats.pixels += rect.area();
+    }
+
+    this->stats.transfers = this->transfers.size();
+    this->stats.cost = this->cost(this->transfers);
+    this->stats.planTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start);
+
+    return this->transfers;
+}
+
+/**
+ * @brief Estimate the cost of a single transfer
+ *
+ * If the transfer exceeds the maximum transfer size, this includes the cost of each of the bands
+ * it's split into.
+ */
+double RefreshPlanner::cost(const Rect &rect) const {
+    if(rect.isEmpty()) {
+        return 0;
+    }
+
+    int32_t rows, cols;
+    const auto bands = this->getBandSize(rect, rows, cols);
+    const auto columns = (rect.size.width + cols - 1) / cols;
+
+    return (this->model.perTransfer * bands) +
+        (this->model.perRow * rect.size.height * columns) + (this->model.perPixel * rect.area());
+}
+
+/**
+ * @brief Estimate the cost of a list of transfers
+ */
+double RefreshPlanner::cost(const std::vector<Rect> &rects) const {
+    double total{0};
+    for(const auto &rect : rects) {
+        total += this->cost(rect);
+    }
+    return total;
+}
+
+/**
+ * @brief Expand a rectangle to the alignment requirements of the panel
+ *
+ * @return Aligned rectangle, clipped to the bounds of the panel; it may be empty.
+ */
+Rect RefreshPlanner::align(const Rect &rect) const {
+    const int32_t width = this->size.width, height = this->size.height;
+
+    int32_t x1 = std::clamp<int32_t>(rect.origin.x, 0, width),
+            x2 = std::clamp<int32_t>(rect.right(), 0, width);
+    int32_t y1 = std::clamp<int32_t>(rect.origin.y, 0, height),
+            y2 = std::clamp<int32_t>(rect.bottom(), 0, height);
+
+    if(x1 >= x2 || y1 >= y2) {
+        return {};
+    }
+
+    if(this->model.fullRows) {
+        x1 = 0;
+        x2 = width;
+    } else {
+        x1 = AlignDown(x1, this->model.alignX);
+        x2 = std::min(AlignUp(x2, this->model.alignX), width);
+    }
+
+    y1 = AlignDown(y1, this->model.alignY);
+    y2 = std::min(AlignUp(y2, this->model.alignY), height);
+
+    return MakeRect(x1, y1, x2, y2);
+}
+
+/**
+ * @brief Add the parts of a rectangle not yet covered by any transfer
+ *
+ * If splitting the rectangle into the pieces that aren't covered yet is more expensive than
+ * transferring the overlapping pixels again, it's added as is instead.
+ *
+ * @param rect Rectangle to add
+ * @param out List of transfers to add the rectangle to
+ */
+void RefreshPlanner::addDisjoint(const Rect &rect, std::vector<Rect> &out) const {
+    std::vector<Rect> pieces{rect}, remaining;
+
+    for(const auto &existing : out) {
+        remaining.clear();
+        for(const auto &piece : pieces) {
+            Subtract(piece, existing, remaining);
+        }
+
+        std::swap(pieces, remaining);
+        if(pieces.empty()) {
+            return;
+        }
+    }
+
+    if(this->cost(pieces) > this->cost(rect)) {
+        out.emplace_back(rect);
+    } else {
+        out.insert(out.end(), pieces.begin(), pieces.end());
+    }
+}
+
+/**
+ * @brief Get the size of the bands a transfer is split into
+ *
+ * Transfers are split into bands of as many (aligned) rows as fit in the maximum transfer size;
+ * if even a single band is too large, it's further split into columns, unless the panel requires
+ * transfers to cover entire rows.
+ *
+ * @param rect Transfer to split
+ * @param rows Variable to receive the number of rows in each band
+ * @param cols Variable to receive the number of columns in each band
+ *
+ * @return Total number of bands
+ */
+size_t RefreshPlanner::getBandSize(const Rect &rect, int32_t &rows, int32_t &cols) const {
+    const auto maxPixels = this->model.maxTransferPixels;
+
+    rows = rect.size.height;
+    cols = rect.size.width;
+
+    if(!maxPixels || rect.area() <= maxPixels) {
+        return 1;
+    }
+
+    rows = std::max<int32_t>(AlignDown(maxPixels / rect.size.width, this->model.alignY),
+            this->model.alignY);
+    if(!this->model.fullRows && static_cast<size_t>(rows) * cols > maxPixels) {
+        cols = std::max<int32_t>(AlignDown(maxPixels / rows, this->model.alignX),
+                this->model.alignX);
+    }
+
+    return ((rect.size.height + rows - 1) / rows) * ((rect.size.width + cols - 1) / cols);
+}
+
+/**
+ * @brief Merge the pair of transfers that yields the largest cost reduction
+ *
+ * Two transfers are merged into their bounding rectangle; any other transfers overlapping it are
+ * trimmed (or removed, if covered entirely) so none of its pixels are transferred twice.
+ *
+ * Pairs are considered in order of the cost reduction of merging just the two of them, and the
+ * first one for which the merge (including trimming other transfers) is cheaper is merged.
+ *
+ * @param force When set, merge the first pair that reduces the number of transfers, even if that
+ *        increases the total cost
+ *
+ * @return Whether two transfers were merged
+ */
+bool RefreshPlanner::mergeBest(const bool force) {
+    const auto count = this->transfers.size();
+    if(count < 2) {
+        return false;
+    }
+
+    // find pairs of transfers worth merging
+    this->candidates.clear();
+
+    for(size_t i = 0; i < count; i++) {
+        const auto &first = this->transfers[i];
+        const auto firstCost = this->cost(first);
+
+        for(size_t j = i + 1; j < count; j++) {
+            const auto &second = this->transfers[j];
+            const auto delta = this->cost(first.unionWith(second)) - firstCost -
+                this->cost(second);
+
+            if(force || delta < 0) {
+                this->candidates.push_back({delta, static_cast<uint32_t>(i),
+                        static_cast<uint32_t>(j)});
+            }
+        }
+    }
+
+    /*
+     * Try the candidates in order, accounting for the other transfers each merged transfer
+     * overlaps. Usually the first candidate is merged, so rather than sorting them all, they're
+     * kept in a heap (with the cheapest one at the front.)
+     */
+    const auto compare = [](const auto &a, const auto &b) {
+        return a.delta > b.delta;
+    };
+    std::make_heap(this->candidates.begin(), this->candidates.end(), compare);
+
+    while(!this->candidates.empty()) {
+        std::pop_heap(this->candidates.begin(), this->candidates.end(), compare);
+        const auto candidate = this->candidates.back();
+        this->candidates.pop_back();
+
+        const auto merged = this->transfers[candidate.first].unionWith(
+                this->transfers[candidate.second]);
+
+        double delta{candidate.delta};
+
+        this->scratch.clear();
+        this->scratch.emplace_back(merged);
+
+        for(size_t k = 0; k < count; k++) {
+            if(k == candidate.first || k == candidate.second) {
+                continue;
+            }
+
+            const auto &other = this->transfers[k];
+            if(!merged.intersects(other)) {
+                this->scratch.emplace_back(other);
+                continue;
+            }
+
+            const auto pieces = this->scratch.size();
+            Subtract(other, merged, this->scratch);
+
+            for(size_t piece = pieces; piece < this->scratch.size(); piece++) {
+                delta += this->cost(this->scratch[piece]);
+            }
+            delta -= this->cost(other);
+        }
+
+        const auto newCount = this->scratch.size();
+
+        if((force && newCount < count) || (!force && delta < 0)) {
+            std::swap(this->transfers, this->scratch);
+            return true;
+        }
+    }
+
+    // when forced, fall back to a single transfer covering everything
+    if(force) {
+        Rect bounds;
+        for(const auto &rect : this->transfers) {
+            bounds = bounds.unionWith(rect);
+        }
+
+        this->transfers.clear();
+        this->transfers.emplace_back(bounds);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Split transfers exceeding the maximum transfer size into bands
+ *
+ * @seeAlso getBandSize
+ */
+void RefreshPlanner::splitLarge() {
+    this->scratch.clear();
+
+    for(const auto &rect : this->transfers) {
+        int32_t rows, cols;
+        if(this->getBandSize(rect, rows, cols) == 1) {
+            this->scratch.emplace_back(rect);
+            continue;
+        }
+
+        for(int32_t y = rect.origin.y; y < rect.bottom(); y += rows) {
+            for(int32_t x = rect.origin.x; x < rect.right(); x += cols) {
+                this->scratch.emplace_back(MakeRect(x, y, std::min(x + cols, rect.right()),
+                            std::min(y + rows, rect.bottom())));
+            }
+        }
+    }
+
+    std::swap(this->transfers, this->scratch);
+}
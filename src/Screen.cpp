@@ -1,14 +1,28 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <numeric>
 #include <stdexcept>
 #include <type_traits>
+#include <vector>
 
 #include <cairo.h>
 
 #include "Animator.h"
 #include "CairoHelpers.h"
+#include "CaptureWorker.h"
+#include "DrawBackend.h"
 #include "Errors.h"
 #include "Event.h"
+#include "FocusEngine.h"
+#include "FrameRecorder.h"
+#include "GestureRecognizer.h"
+#include "JsonWriter.h"
+#include "MemoryAccounting.h"
 #include "Screen.h"
+#include "SurfacePool.h"
+#include "Tracing.h"
+#include "Upscale.h"
 #include "Util.h"
 #include "Widget.h"
 #include "ViewController.h"
@@ -31,6 +45,17 @@ static inline constexpr cairo_format_t ConvertPixelFormat(const Screen::PixelFor
     }
 }
 
+/**
+ * @brief Get the current cache tick
+ *
+ * This is a monotonic timestamp, with a resolution of one second, used to track when widgets were
+ * last visible.
+ */
+static inline uint32_t GetCacheTick() {
+    using namespace std::chrono;
+    return duration_cast<seconds>(steady_clock::now().time_since_epoch()).count();
+}
+
 /**
  * @brief Calculate the optimal stride (bytes per line) for a framebuffer of the given format+size
  *
@@ -106,18 +131,95 @@ Screen::Screen(const PixelFormat format, const Size &size, std::span<std::byte>
  * This sets up the Cairo drawing context.
  */
 void Screen::commonInit() {
-    this->drawCtx = cairo_create(this->surface);
-    auto status = cairo_status(this->drawCtx);
+    this->updateGeometry();
+
+    // prepare animation resources
+    this->anim = std::make_shared<Animator>(this);
+    this->surfacePool = std::make_shared<SurfacePool>();
+    this->focus = std::make_shared<FocusEngine>(this);
+}
+
+/**
+ * @brief Create the drawing context
+ *
+ * Any existing drawing context is released.
+ *
+ * @param target Surface to render into
+ */
+void Screen::createDrawContext(cairo_surface_t *target) {
+    if(this->drawCtx) {
+        cairo_destroy(this->drawCtx);
+        this->drawCtx = nullptr;
+    }
+
+    auto ctx = cairo_create(target);
+    auto status = cairo_status(ctx);
 
     if(status != CAIRO_STATUS_SUCCESS) {
+        cairo_destroy(ctx);
         ThrowForCairoStatus(status);
     }
 
-    // optimize rendering for performance
-    cairo_set_antialias(this->drawCtx, CAIRO_ANTIALIAS_FAST);
+    if(this->softwareRasterizer) {
+        DrawBackend::Set(ctx, DrawBackend::Software());
+    }
 
-    // prepare animation resources
-    this->anim = std::make_shared<Animator>(this);
+    this->drawCtx = ctx;
+
+    // optimize rendering for performance (as far as the quality tier allows)
+    this->applyQualityTier();
+}
+
+/**
+ * @brief Update the logical size of the screen and the rendering target
+ *
+ * The logical size is the size of the framebuffer (rotated as needed) divided by the scale factor,
+ * rounded up so that the entire framebuffer is covered. If upscaling, the intermediate surface
+ * is (re)allocated at this resolution.
+ */
+void Screen::updateGeometry() {
+    const double factor{this->scaled ? this->scaleFactor : 1.};
+    const bool rotated = (this->rotation == Rotation::Rotate90 ||
+            this->rotation == Rotation::Rotate270);
+
+    const auto physW = static_cast<uint16_t>(std::ceil(this->physSize.width / factor)),
+          physH = static_cast<uint16_t>(std::ceil(this->physSize.height / factor));
+    this->size = rotated ? Size(physH, physW) : Size(physW, physH);
+
+    // release the old intermediate surface
+    if(this->lowResSurface) {
+        memory::Freed(MemoryCategory::CachedLayers,
+                cairo_image_surface_get_stride(this->lowResSurface) *
+                cairo_image_surface_get_height(this->lowResSurface));
+
+        cairo_surface_destroy(this->lowResSurface);
+        this->lowResSurface = nullptr;
+    }
+
+    // then set up the render target
+    if(this->scaled && this->scaleFactor > 1. && this->scaleMode == ScaleMode::Upscale) {
+        auto surface = cairo_image_surface_create(ConvertPixelFormat(this->format), physW, physH);
+        auto status = cairo_surface_status(surface);
+
+        if(status != CAIRO_STATUS_SUCCESS) {
+            cairo_surface_destroy(surface);
+            ThrowForCairoStatus(status);
+        }
+
+        memory::Allocated(MemoryCategory::CachedLayers,
+                cairo_image_surface_get_stride(surface) * cairo_image_surface_get_height(surface));
+
+        this->lowResSurface = surface;
+        this->createDrawContext(surface);
+    } else {
+        this->createDrawContext(this->surface);
+    }
+
+    if(this->rootWidget) {
+        this->rootWidget->invalidateScreenGeometry();
+    }
+
+    this->needsDisplay();
 }
 
 /**
@@ -127,11 +229,95 @@ void Screen::commonInit() {
  * drawing resources.
  */
 Screen::~Screen() {
+    // finish any outstanding captures, since they may still read from the framebuffer
+    this->captureWorker.reset();
+    this->pendingCaptures.clear();
+
+    // widgets may outlive the screen, so they must forget about its cache list
+    for(auto widget : this->cacheHolders) {
+        widget->cacheList = nullptr;
+    }
+    this->cacheHolders.clear();
+
+    if(Widget::currentCacheList == &this->cacheHolders) {
+        Widget::currentCacheList = nullptr;
+    }
+
+    memory::Freed(MemoryCategory::EventQueue, this->eventQueue.size() * sizeof(Event));
+
     // clear cairo resources
     cairo_destroy(this->drawCtx);
+
+    if(this->lowResSurface) {
+        memory::Freed(MemoryCategory::CachedLayers,
+                cairo_image_surface_get_stride(this->lowResSurface) *
+                cairo_image_surface_get_height(this->lowResSurface));
+        cairo_surface_destroy(this->lowResSurface);
+    }
+
     cairo_surface_destroy(this->surface);
 }
 
+/**
+ * @brief Set the UI scale factor
+ *
+ * The scale factor can be used to support high pixel density displays. Values above 1 will
+ * increase the size of UI components, and values below 1 (and above 0) will shrink them. The
+ * logical size of the screen is adjusted accordingly.
+ *
+ * @param scale New scale factor
+ *
+ * @throw std::invalid_argument Scale factor is not positive
+ */
+void Screen::setScaleFactor(const double scale) {
+    if(!(scale > 0.)) {
+        throw std::invalid_argument("invalid scale factor");
+    }
+
+    this->scaleFactor = scale;
+    this->scaled = (scale != 1.);
+    this->updateGeometry();
+}
+
+/**
+ * @brief Set how the UI scale factor is applied
+ *
+ * @param mode New scale mode
+ *
+ * @throw std::invalid_argument The scale mode is not supported for the screen's pixel format
+ */
+void Screen::setScaleMode(const ScaleMode mode) {
+    if(mode == ScaleMode::Upscale && this->format == PixelFormat::RGB30) {
+        throw std::invalid_argument("upscaling not supported for pixel format");
+    }
+
+    this->scaleMode = mode;
+    this->updateGeometry();
+}
+
+/**
+ * @brief Enable or disable the software rasterizer
+ *
+ * When enabled, rectangle and rounded rectangle fills, borders and unscaled image blits are
+ * rasterized directly into the framebuffer, rather than with Cairo; this is considerably faster,
+ * especially for RGB16 framebuffers. Anything else (and any drawing with a transform other than a
+ * translation, such as when scaling the UI) is still drawn with Cairo.
+ *
+ * Antialiased edges may differ very slightly from those drawn by Cairo, so the entire screen is
+ * redrawn.
+ *
+ * @param enabled Whether the software rasterizer is used
+ */
+void Screen::setSoftwareRasterizer(const bool enabled) {
+    this->softwareRasterizer = enabled;
+
+    if(this->drawCtx) {
+        DrawBackend::Set(this->drawCtx, enabled ? DrawBackend::Software() : nullptr);
+    }
+
+    this->needsDisplay();
+}
+
 /**
  * @brief Return a pointer to the underlying framebuffer
  *
@@ -152,18 +338,223 @@ size_t Screen::getBufferStride() const {
 /**
  * @brief Determine if the screen is dirty
  *
- * This checks our internal dirty flag, plus the dirty flag of the root view.
+ * The screen is dirty if it needs to be redrawn entirely, or if any widgets invalidated part of
+ * the screen.
  */
 bool Screen::isDirty() const {
-    if(this->dirtyFlag || this->forceDisplayFlag) {
-        return true;
+    return this->dirtyFlag || this->forceDisplayFlag || !this->damage.empty() ||
+        !this->dirtyWidgets.empty();
+}
+
+/**
+ * @brief Add a region to the screen's damage list
+ *
+ * The rectangle is merged with any existing damage rectangles it overlaps. If there would be too
+ * many distinct rectangles, it's merged with the rectangle whose area grows the least instead.
+ *
+ * @param rect Region to invalidate, in screen coordinates
+ */
+void Screen::addDamage(const Rect &rect) {
+    auto area = rect.intersection(Rect({0, 0}, this->size));
+    if(area.isEmpty() || this->forceDisplayFlag) {
+        return;
     }
 
-    if(this->rootWidget) {
-        return this->rootWidget->isDirty();
+    this->dirtyFlag = true;
+
+    // merge with all rects it overlaps (repeat since the merged rect may overlap others)
+    bool merged;
+    do {
+        merged = false;
+
+        for(auto it = this->damage.begin(); it != this->damage.end(); ++it) {
+            if(it->contains(area)) {
+                return;
+            } else if(area.intersects(*it)) {
+                area = area.unionWith(*it);
+                this->damage.erase(it);
+                merged = true;
+                break;
+            }
+        }
+    } while(merged);
+
+    if(this->damage.size() < kMaxDamageRects) {
+        this->damage.emplace_back(area);
+        return;
+    }
+
+    // too many rects: merge with the one that grows the least
+    auto best = this->damage.begin();
+    uint32_t bestGrowth{UINT32_MAX};
+
+    for(auto it = this->damage.begin(); it != this->damage.end(); ++it) {
+        const auto growth = it->unionWith(area).area() - it->area();
+        if(growth < bestGrowth) {
+            best = it;
+            bestGrowth = growth;
+        }
     }
 
-    return false;
+    const auto combined = best->unionWith(area);
+    this->damage.erase(best);
+    this->addDamage(combined);
+}
+
+/**
+ * @brief Convert a rectangle in screen coordinates to framebuffer coordinates
+ *
+ * This takes into account the UI scale factor and screen rotation. The resulting rectangle is
+ * expanded to cover all partially covered framebuffer pixels, as well as any pixels affected by
+ * filtering when upscaling.
+ *
+ * @param rect Rectangle in screen (logical) coordinates
+ *
+ * @return Corresponding rectangle in the framebuffer
+ */
+Rect Screen::convertToFramebuffer(const Rect &rect) const {
+    // filtered upscaling also affects pixels next to the region
+    double margin{0};
+
+    if(this->scaled && this->lowResSurface && !upscale::IsIntegerFactor(this->scaleFactor)) {
+        margin = std::ceil(this->scaleFactor);
+    }
+
+    return this->mapToFramebuffer(rect, margin);
+}
+
+/**
+ * @brief Map a rectangle in screen coordinates to framebuffer coordinates
+ *
+ * @param rect Rectangle in screen (logical) coordinates
+ * @param margin Number of framebuffer pixels to expand the rectangle by on each side
+ *
+ * @return Corresponding rectangle in the framebuffer, clipped to the framebuffer
+ */
+Rect Screen::mapToFramebuffer(const Rect &rect, const double margin) const {
+    double x{static_cast<double>(rect.origin.x)}, y{static_cast<double>(rect.origin.y)},
+           w{static_cast<double>(rect.size.width)}, h{static_cast<double>(rect.size.height)};
+
+    switch(this->rotation) {
+        case Rotation::Rotate270: {
+            const auto newY = static_cast<double>(this->size.width) - x - w;
+            x = y;
+            y = newY;
+            std::swap(w, h);
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    if(this->scaled) {
+        const double factor{this->scaleFactor};
+
+        x *= factor;
+        y *= factor;
+        w *= factor;
+        h *= factor;
+    }
+
+    x -= margin;
+    y -= margin;
+    w += margin * 2;
+    h += margin * 2;
+
+    const auto x1 = std::max(0., std::floor(x)), y1 = std::max(0., std::floor(y));
+    const auto x2 = std::min(static_cast<double>(this->physSize.width), std::ceil(x + w)),
+          y2 = std::min(static_cast<double>(this->physSize.height), std::ceil(y + h));
+
+    if(x2 <= x1 || y2 <= y1) {
+        return {};
+    }
+
+    return Rect({static_cast<int16_t>(x1), static_cast<int16_t>(y1)},
+            Size(static_cast<uint16_t>(x2 - x1), static_cast<uint16_t>(y2 - y1)));
+}
+
+/**
+ * @brief Capture a region of the screen
+ *
+ * Take a snapshot of the given region of the screen as it's currently displayed. This returns
+ * immediately: the pixel data is copied and encoded on a background thread. If the screen is
+ * redrawn before the copy completes, the rows about to be overwritten are copied first.
+ *
+ * The capture is in the logical orientation of the screen (that is, screen rotation is undone)
+ * but at the resolution of the framebuffer.
+ *
+ * @param rect Region to capture, in screen coordinates
+ * @param format Output format of the capture
+ *
+ * @return A future that receives the capture once it's been encoded
+ *
+ * @remark This must be called from the same thread that redraws the screen.
+ *
+ * @throw std::invalid_argument The region does not intersect the screen
+ */
+std::future<Screen::CaptureResult> Screen::captureAsync(const Rect &rect,
+        const CaptureFormat format) {
+    const auto fbRect = this->mapToFramebuffer(rect, 0);
+    if(fbRect.isEmpty()) {
+        throw std::invalid_argument("capture region is empty");
+    }
+
+    if(!this->captureWorker) {
+        this->captureWorker = std::make_shared<CaptureWorker>();
+    }
+
+    cairo_surface_flush(this->surface);
+
+    auto request = std::make_shared<CaptureRequest>(this->surface, fbRect, this->format,
+            this->rotation, format);
+    auto future = request->promise.get_future();
+
+    std::erase_if(this->pendingCaptures, [](const auto &pending) {
+        return pending->isComplete();
+    });
+    this->pendingCaptures.emplace_back(request);
+
+    this->captureWorker->submit(request);
+    return future;
+}
+
+/**
+ * @brief Copy framebuffer rows about to be redrawn into pending captures
+ *
+ * Invoked before the damaged regions are drawn. Captures that have been copied completely are
+ * removed from the pending list.
+ */
+void Screen::preserveCaptures() {
+    std::erase_if(this->pendingCaptures, [&](const auto &request) {
+        for(const auto &rect : this->lastDamage) {
+            const auto fbRect = this->convertToFramebuffer(rect);
+            if(fbRect.intersects(request->getFramebufferRect())) {
+                request->copyRows(fbRect.origin.y, fbRect.bottom());
+            }
+        }
+
+        return request->isComplete();
+    });
+}
+
+/**
+ * @brief Pass the regions redrawn by the last redraw to the frame recorder
+ */
+void Screen::recordFrame() {
+    cairo_surface_flush(this->surface);
+
+    std::vector<Rect> fbDamage;
+    fbDamage.reserve(this->lastDamage.size());
+
+    for(const auto &rect : this->lastDamage) {
+        fbDamage.emplace_back(this->convertToFramebuffer(rect));
+    }
+
+    auto data = reinterpret_cast<const std::byte *>(cairo_image_surface_get_data(this->surface));
+    const auto stride = cairo_image_surface_get_stride(this->surface);
+
+    this->recorder->recordFrame(data, stride, this->physSize, this->format, fbDamage);
 }
 
 /**
@@ -173,10 +564,16 @@ bool Screen::isDirty() const {
  * underlying framebuffer. Only dirty widgets will be drawn.
  */
 void Screen::redraw() {
+    const auto start = std::chrono::high_resolution_clock::now();
+    SHITTYGUI_TRACE(frame__start, this->frameStats.frames);
+
+    Widget::currentTick = GetCacheTick();
+    Widget::currentCacheList = &this->cacheHolders;
+
     cairo_save(this->drawCtx);
 
-    // apply UI scale and rotation
-    if(this->scaled) {
+    // apply UI scale (unless rendering at logical resolution) and rotation
+    if(this->scaled && !this->lowResSurface) {
         const double factor{this->scaleFactor};
         cairo_scale(this->drawCtx, factor, factor);
     }
@@ -195,6 +592,102 @@ void Screen::redraw() {
             throw std::runtime_error("unimplemented screen rotation");
     }
 
+    // convert the invalidated regions of widgets into screen damage
+    this->collectDirtyWidgets();
+
+    /*
+     * Redraw each of the damaged regions of the screen; if the entire screen is to be redrawn,
+     * just treat it as a single large damage region.
+     */
+    if(this->forceDisplayFlag) {
+        this->damage.clear();
+        this->damage.emplace_back(Point(0, 0), this->size);
+        this->forceDisplayFlag = false;
+    }
+
+    // widgets invalidated while drawing go into a fresh damage list for the next frame
+    std::swap(this->lastDamage, this->damage);
+    this->damage.clear();
+
+    // save any parts of pending captures that are about to be overwritten
+    if(!this->pendingCaptures.empty()) {
+        this->preserveCaptures();
+    }
+
+    for(const auto &rect : this->lastDamage) {
+        /*
+         * Find the deepest opaque widget covering the damaged region among the widgets that were
+         * invalidated. Drawing can start at that widget instead of the root, since it hides
+         * everything beneath it.
+         */
+        Widget *cover{nullptr};
+
+        // with fractional scaling, the region is expanded to whole pixels
+        const auto coverArea = this->scaled ? rect.inset(-1) : rect;
+
+        for(const auto &weak : this->redrawWidgets) {
+            auto widget = weak.lock();
+            if(!widget) {
+                continue;
+            }
+
+            auto candidate = widget->findOpaqueCover(coverArea);
+            if(candidate && (!cover || candidate->depth > cover->depth)) {
+                cover = candidate;
+            }
+        }
+
+        if(!cover || cover == this->rootWidget.get()) {
+            this->drawDamage(rect);
+        } else {
+            this->drawDamageFrom(cover->shared_from_this(), rect);
+        }
+    }
+
+    this->redrawWidgets.clear();
+
+    // clear the dirty flag
+    this->dirtyFlag = false;
+
+    cairo_restore(this->drawCtx);
+
+    if(this->lowResSurface) {
+        this->upscaleDamage();
+    }
+
+    if(this->recorder) {
+        this->recordFrame();
+    }
+
+    const auto frameTime = std::chrono::high_resolution_clock::now() - start;
+    SHITTYGUI_TRACE(frame__done, this->frameStats.frames,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(frameTime).count(),
+            this->lastDamage.size());
+
+    this->updateFrameStats(frameTime);
+
+    // frames that didn't draw anything say nothing about the cost of rendering
+    if(this->governor && !this->lastDamage.empty() && this->governor->update(frameTime)) {
+        this->applyQualityTier();
+    }
+
+    this->checkMemoryBudget();
+}
+
+/**
+ * @brief Redraw a region of the screen
+ *
+ * The drawing context is clipped to the region, then the root widget and all widgets which
+ * intersect the region are drawn.
+ *
+ * @param rect Region to redraw, in screen coordinates
+ */
+void Screen::drawDamage(const Rect &rect) {
+    cairo_save(this->drawCtx);
+
+    cairo::AlignedRectangle(this->drawCtx, rect, true);
+    cairo_clip(this->drawCtx);
+
     // draw background if no root widget, or it's not opaque
     if(!this->rootWidget || !this->rootWidget->isOpaque()) {
         cairo::SetSource(this->drawCtx, this->backgroundColor);
@@ -209,19 +702,283 @@ void Screen::redraw() {
      * the screen will be implicitly discarded.
      */
     if(this->rootWidget) {
-        this->rootWidget->draw(this->drawCtx, this->forceDisplayFlag);
-        this->rootWidget->drawChildren(this->drawCtx,
-                (this->forceDisplayFlag || this->rootWidget->isDirty()));
+        using namespace std::chrono;
+        auto &root = this->rootWidget;
+        auto &profile = root->profile;
 
-        this->forceDisplayFlag = false;
-    }
+        root->markVisible();
+        root->dirtyRect = rect;
 
-    // clear the dirty flag
-    this->dirtyFlag = false;
+        const auto rootStart = high_resolution_clock::now();
+
+        SHITTYGUI_TRACE(widget__draw__start, root.get(), root->getDebugLabel().data());
+        root->draw(this->drawCtx, true);
+        SHITTYGUI_TRACE(widget__draw__done, root.get());
+
+        if(profile) {
+            profile->current.selfTime +=
+                duration_cast<nanoseconds>(high_resolution_clock::now() - rootStart).count();
+            profile->current.drawCount++;
+        }
+
+        root->drawChildren(this->drawCtx, true);
+
+        if(profile) {
+            profile->current.totalTime +=
+                duration_cast<nanoseconds>(high_resolution_clock::now() - rootStart).count();
+        }
+    }
 
     cairo_restore(this->drawCtx);
 }
 
+/**
+ * @brief Redraw a region of the screen, starting at a particular widget
+ *
+ * Draws the given widget, its children, and everything on top of it; that is, all later siblings
+ * of the widget and of each of its ancestors, along with their children.
+ *
+ * @param start Widget to start drawing at; it must be opaque and fully cover the region
+ * @param rect Region to redraw, in screen coordinates
+ */
+void Screen::drawDamageFrom(const std::shared_ptr<Widget> &start, const Rect &rect) {
+    std::vector<std::shared_ptr<Widget>> ancestors;
+    auto child = start;
+    bool inclusive{true};
+
+    while(auto parent = child->getParent()) {
+        const auto area = rect.intersection(parent->screenClip);
+
+        if(!area.isEmpty()) {
+            cairo_save(this->drawCtx);
+
+            cairo::AlignedRectangle(this->drawCtx, area, true);
+            cairo_clip(this->drawCtx);
+
+            /*
+             * Translate to the parent's origin the same way as a full redraw would, that is, one
+             * widget at a time with each origin snapped to device pixels. This ensures that the
+             * pixels drawn line up exactly with what's already on screen.
+             */
+            ancestors.clear();
+            for(auto widget = parent; widget; widget = widget->getParent()) {
+                ancestors.emplace_back(widget);
+            }
+
+            for(auto it = ancestors.rbegin(); it != ancestors.rend(); ++it) {
+                const auto &origin = (*it)->getFrame().origin;
+                cairo::TranslateSnapped(this->drawCtx, origin.x, origin.y);
+            }
+
+            parent->dirtyRect = rect.offset(-parent->screenOrigin.x, -parent->screenOrigin.y);
+
+            auto it = child->siblingPos;
+            if(!inclusive) {
+                ++it;
+            }
+
+            parent->drawChildRange(this->drawCtx, it);
+
+            cairo_restore(this->drawCtx);
+        }
+
+        child = parent;
+        inclusive = false;
+    }
+}
+
+/**
+ * @brief Scale up the damaged regions of the intermediate surface into the framebuffer
+ *
+ * Used when rendering at logical resolution; each region redrawn in this frame is copied to the
+ * framebuffer.
+ */
+void Screen::upscaleDamage() {
+    const auto layout = (this->format == PixelFormat::RGB16) ? upscale::Layout::Rgb565 :
+        upscale::Layout::Pixel32;
+
+    cairo_surface_flush(this->lowResSurface);
+    cairo_surface_flush(this->surface);
+
+    const upscale::Buffer src{
+        cairo_image_surface_get_data(this->lowResSurface),
+        static_cast<size_t>(cairo_image_surface_get_stride(this->lowResSurface)),
+        static_cast<uint16_t>(cairo_image_surface_get_width(this->lowResSurface)),
+        static_cast<uint16_t>(cairo_image_surface_get_height(this->lowResSurface)),
+    };
+    const upscale::Buffer dst{
+        cairo_image_surface_get_data(this->surface),
+        static_cast<size_t>(cairo_image_surface_get_stride(this->surface)),
+        this->physSize.width,
+        this->physSize.height,
+    };
+
+    for(const auto &rect : this->lastDamage) {
+        const auto fbRect = this->convertToFramebuffer(rect);
+        if(fbRect.isEmpty()) {
+            continue;
+        }
+
+        upscale::Scale(src, dst, fbRect, this->scaleFactor, layout);
+        cairo_surface_mark_dirty_rectangle(this->surface, fbRect.origin.x, fbRect.origin.y,
+                fbRect.size.width, fbRect.size.height);
+    }
+}
+
+/**
+ * @brief Collect the regions invalidated by widgets
+ *
+ * Move all widgets from the dirty list into the list of widgets being redrawn, and add the regions
+ * they invalidated (in screen coordinates) to the damage list.
+ *
+ * At the minimal quality tier, low priority widgets are left in the dirty list for all but every
+ * few frames, unless the entire screen is redrawn anyways.
+ *
+ * With content hashing, the invalidated region of a widget is discarded if its draw state is the
+ * same as when it was last drawn in its current location.
+ */
+void Screen::collectDirtyWidgets() {
+    std::swap(this->redrawWidgets, this->dirtyWidgets);
+    this->dirtyWidgets.clear();
+
+    const bool deferLowPriority = !this->forceDisplayFlag &&
+        this->getQualityTier() == QualityTier::Minimal &&
+        (this->frameStats.frames % kLowPriorityInterval) != 0;
+    const bool compareState = this->contentHashing && !this->forceDisplayFlag;
+
+    for(const auto &weak : this->redrawWidgets) {
+        auto widget = weak.lock();
+        if(!widget) {
+            continue;
+        }
+
+        if(deferLowPriority && widget->lowPriority) {
+            this->dirtyWidgets.emplace_back(widget);
+            this->frameStats.deferredUpdates++;
+            continue;
+        }
+
+        widget->inDirtyList = false;
+        widget->updateScreenGeometry();
+
+        // widgets invalidate themselves when their content changes, which may change their size
+        widget->updateMemoryAccounting();
+
+        const auto pending = widget->pendingDirtyRect;
+        widget->pendingDirtyRect = {};
+
+        if(!widget->screenVisible || pending.isEmpty()) {
+            continue;
+        }
+
+        if(compareState) {
+            const auto hash = widget->computeDrawStateHash();
+            widget->drawStateTracked = true;
+
+            // a widget that moved, or was shown, must be drawn at its new location regardless
+            if(hash && hash == widget->drawnStateHash && !widget->movedSinceDraw) {
+                widget->dirtyFlag = false;
+                this->frameStats.skippedUpdates++;
+                continue;
+            }
+        }
+
+        const auto &origin = widget->screenOrigin;
+        this->addDamage(pending.offset(origin.x, origin.y).intersection(widget->screenClip));
+    }
+}
+
+/**
+ * @brief Update frame statistics after a frame was rendered
+ *
+ * This also takes care of completing profiling windows, if profiling is enabled.
+ *
+ * @param frameTime Time taken to render the frame
+ */
+void Screen::updateFrameStats(const std::chrono::nanoseconds frameTime) {
+    auto &stats = this->frameStats;
+
+    stats.frames++;
+    stats.lastFrameTime = frameTime;
+    stats.maxFrameTime = std::max(stats.maxFrameTime, frameTime);
+
+    // exponential moving average, weighting the new sample at 1/8
+    if(stats.frames == 1) {
+        stats.averageFrameTime = frameTime;
+    } else {
+        stats.averageFrameTime += (frameTime - stats.averageFrameTime) / 8;
+    }
+
+    // complete the profiling window
+    if(this->profiling && ++this->profileWindowElapsed >= this->profileWindowFrames) {
+        if(this->rootWidget) {
+            this->rootWidget->rollProfileWindow();
+        }
+        this->profileWindowElapsed = 0;
+    }
+}
+
+/**
+ * @brief Set the frame governor
+ *
+ * The governor is fed the time taken by each frame that redrew anything, and selects the quality
+ * tier the screen renders at. The current tier is reported in the frame statistics.
+ *
+ * @param newGovernor Frame governor to use, or `nullptr` to always render at full quality
+ */
+void Screen::setFrameGovernor(const std::shared_ptr<FrameGovernor> &newGovernor) {
+    this->governor = newGovernor;
+    this->applyQualityTier();
+}
+
+/**
+ * @brief Apply the current rendering quality tier
+ *
+ * Configures the antialiasing of the drawing context, attaches the tier to the context (for
+ * widgets and images to consult while drawing) and throttles non-critical animation callbacks.
+ * When quality is restored, the entire screen is redrawn so nothing remains drawn at the lower
+ * quality.
+ */
+void Screen::applyQualityTier() {
+    const auto tier = this->getQualityTier();
+    auto &stats = this->frameStats;
+
+    if(this->drawCtx) {
+        cairo_set_antialias(this->drawCtx, (tier == QualityTier::Minimal) ? CAIRO_ANTIALIAS_NONE :
+                CAIRO_ANTIALIAS_FAST);
+        DrawBackend::SetQuality(this->drawCtx, tier);
+    }
+
+    if(this->anim) {
+        switch(tier) {
+            case QualityTier::Full:
+                this->anim->nonCriticalInterval = 1;
+                break;
+            case QualityTier::Reduced:
+                this->anim->nonCriticalInterval = 2;
+                break;
+            case QualityTier::Minimal:
+                this->anim->nonCriticalInterval = 4;
+                break;
+        }
+    }
+
+    if(tier == stats.qualityTier) {
+        return;
+    }
+
+    SHITTYGUI_TRACE(quality__change, stats.frames, static_cast<unsigned int>(stats.qualityTier),
+            static_cast<unsigned int>(tier));
+
+    if(tier < stats.qualityTier) {
+        this->needsDisplay();
+    }
+
+    stats.qualityTier = tier;
+    stats.qualityChanges++;
+    stats.lastQualityChange = stats.frames;
+}
+
 /**
  * @brief Handle animations
  *
@@ -229,7 +986,18 @@ void Screen::redraw() {
  * the UI thread to drive animations.
  */
 void Screen::handleAnimations() {
+    // time-based gestures and touch resampling
+    if(!this->activeGestures.empty()) {
+        const auto now = GestureRecognizer::Clock::now();
+
+        for(const auto &recognizer : this->activeGestures) {
+            recognizer->handleFrame(now);
+        }
+        this->updateGestures();
+    }
+
     this->anim->frameCallback();
+    this->sweepCaches();
 }
 
 /**
@@ -242,11 +1010,15 @@ void Screen::handleAnimations() {
  */
 void Screen::setRootWidget(const std::shared_ptr<Widget> &newRoot) {
     if(this->rootWidget) {
+        this->focus->invalidate(this->rootWidget);
         this->rootWidget->setScreen(nullptr);
+        this->rootWidget->setProfilingEnabled(false);
         this->rootWidget.reset();
     }
 
     newRoot->setScreen(this->shared_from_this());
+    newRoot->setProfilingEnabled(this->profiling);
+    newRoot->updateMemoryAccounting();
     this->rootWidget = newRoot;
     this->needsDisplay();
 }
@@ -275,6 +1047,298 @@ void Screen::setRootViewController(const std::shared_ptr<ViewController> &newRoo
 
 
 
+/**
+ * @brief Get memory usage statistics
+ *
+ * Memory usage is tracked per category (image pixels, cached layers, text layouts, widget objects
+ * and the event queue) along with the high-water mark of each category.
+ *
+ * @remark Usage counters are process wide; they include resources of all screens.
+ */
+MemoryStats Screen::getMemoryStats() const {
+    MemoryStats stats;
+    memory::GetStats(stats);
+
+    stats.budget = this->memoryBudget;
+    stats.trimCount = this->memoryTrimCount;
+
+    return stats;
+}
+
+/**
+ * @brief Release caches if the memory budget is exceeded
+ *
+ * Cached resources are released in least recently visible order (the order of the cache list)
+ * until usage drops below a low-water mark somewhat below the budget; this way, caches aren't
+ * released again right away when they're re-created. Offscreen widgets (hidden, or drawing
+ * inhibited, such as widgets beneath a presented view controller) are always considered before
+ * visible widgets.
+ *
+ * Nothing is released if releasing all caches couldn't bring usage back under the budget, since
+ * the caches would just be re-created by the next frame.
+ */
+void Screen::checkMemoryBudget() {
+    const auto total = memory::GetTotal();
+    if(!this->memoryBudget || !this->rootWidget || total <= this->memoryBudget) {
+        return;
+    }
+
+    const auto releasable = memory::GetCurrent(MemoryCategory::CachedLayers) +
+        memory::GetCurrent(MemoryCategory::TextLayouts);
+    if(total - std::min(total, releasable) > this->memoryBudget) {
+        return;
+    }
+
+    const auto lowWater = this->memoryBudget - (this->memoryBudget / kMemoryLowWaterDivisor);
+    this->memoryTrimCount++;
+
+    // idle pool buffers are the cheapest to give up
+    this->surfacePool->purge();
+    if(memory::GetTotal() <= lowWater) {
+        return;
+    }
+
+    // first release caches of offscreen widgets, then those of visible ones
+    for(const bool offscreenOnly : {true, false}) {
+        for(auto it = this->cacheHolders.begin(); it != this->cacheHolders.end();) {
+            // purging removes the widget from the list
+            auto widget = *it++;
+            if(offscreenOnly && !widget->isOffscreen()) {
+                continue;
+            }
+
+            widget->purgeCachedResources();
+            this->surfacePool->purge();
+
+            if(memory::GetTotal() <= lowWater) {
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Release cached resources to reduce memory usage
+ *
+ * This is intended to be invoked from a platform's low memory handler. Depending on the pressure
+ * level, caches of widgets that haven't been visible for a while, all offscreen widgets, or all
+ * widgets are released. Resources are lazily re-created when the widget is next drawn.
+ *
+ * At the lowest pressure level, only the least recently visible end of the cache list is
+ * examined, so this is cheap if no widget has been offscreen for long; other levels walk the
+ * entire widget tree.
+ *
+ * @param level How aggressively to release resources
+ *
+ * @return Number of bytes released
+ */
+size_t Screen::trimMemory(const MemoryPressure level) {
+    const auto before = memory::GetTotal();
+
+    if(level == MemoryPressure::Low) {
+        this->releaseStaleCaches();
+    } else {
+        std::vector<Widget::CacheCandidate> candidates;
+        if(this->rootWidget) {
+            this->rootWidget->collectCacheCandidates(candidates, false);
+        }
+
+        for(const auto &candidate : candidates) {
+            if(candidate.offscreen || level == MemoryPressure::Critical) {
+                candidate.widget->purgeCachedResources();
+            }
+        }
+
+        this->surfacePool->purge();
+    }
+
+    const auto after = memory::GetTotal();
+    return (before > after) ? (before - after) : 0;
+}
+
+/**
+ * @brief Release caches that have not been used for a while
+ *
+ * Idle surface pool buffers are trimmed, and caches of widgets that have been offscreen for too
+ * long are released. This is invoked periodically (from the animation handler) and checks at most
+ * once a second.
+ */
+void Screen::sweepCaches() {
+    const auto now = GetCacheTick();
+    if(now == this->lastCacheSweepTick) {
+        return;
+    }
+
+    this->lastCacheSweepTick = now;
+    this->surfacePool->trim(kSurfacePoolIdleTime);
+
+    if(this->offscreenCacheTimeout.count()) {
+        this->releaseStaleCaches();
+    }
+}
+
+/**
+ * @brief Release caches of widgets that have been offscreen for longer than the timeout
+ *
+ * Widgets are examined from the least recently visible end of the cache list, stopping at the
+ * first one that was visible within the timeout. Widgets that were not drawn for that long but
+ * are still visible (their content just didn't change) are moved to the back of the list, as if
+ * they had been drawn.
+ */
+void Screen::releaseStaleCaches() {
+    const auto now = GetCacheTick();
+    const auto timeout = static_cast<uint32_t>(this->offscreenCacheTimeout.count());
+
+    // each widget is examined at most once, even if it's moved to the back
+    for(auto remaining = this->cacheHolders.size(); remaining; remaining--) {
+        auto widget = this->cacheHolders.front();
+        if((now - widget->lastVisibleTick) < timeout) {
+            break;
+        }
+
+        if(widget->isOffscreen()) {
+            widget->purgeCachedResources();
+        } else {
+            widget->lastVisibleTick = now;
+            widget->trackCaches(&this->cacheHolders);
+        }
+    }
+}
+
+/**
+ * @brief Enable or disable draw profiling
+ *
+ * When enabled, the time spent drawing each widget (both in its own draw method, and in total
+ * including all of its children) as well as how often it was drawn is recorded. Statistics are
+ * collected in windows of a fixed number of frames; the last complete window is reported by
+ * dumpTree(). Widgets removed from the tree discard their statistics, and start over if they're
+ * added again.
+ *
+ * @param enabled Whether profiling is enabled
+ * @param windowFrames Number of frames per profiling window
+ *
+ * @remark Profiling adds some overhead to each widget draw, so it should be disabled when not
+ *         actively used.
+ */
+void Screen::setProfilingEnabled(const bool enabled, const uint32_t windowFrames) {
+    if(!windowFrames) {
+        throw std::invalid_argument("invalid profiling window");
+    }
+
+    this->profiling = enabled;
+    this->profileWindowFrames = windowFrames;
+    this->profileWindowElapsed = 0;
+
+    if(this->rootWidget) {
+        this->rootWidget->setProfilingEnabled(enabled);
+    }
+}
+
+/**
+ * @brief Dump the widget hierarchy
+ *
+ * Produce a JSON representation of the screen's widget hierarchy. Each widget is described by its
+ * class, debug label, tag, frame, state flags (dirty, opaque, hidden, inhibited, etc.) and an
+ * estimate of its memory footprint. If profiling is enabled, the draw count as well as the self
+ * and cumulative (including children) draw time over the last profiling window are included.
+ *
+ * @return JSON string describing the screen and its widgets
+ */
+std::string Screen::dumpTree() {
+    JsonWriter writer;
+
+    writer.beginObject();
+
+    writer.key("size");
+    writer.beginArray();
+    writer.value(static_cast<uint64_t>(this->size.width));
+    writer.value(static_cast<uint64_t>(this->size.height));
+    writer.endArray();
+
+    writer.field("scaleFactor", this->scaleFactor);
+
+    writer.key("frameStats");
+    writer.beginObject();
+    writer.field("frames", this->frameStats.frames);
+    writer.field("lastFrameUsec",
+            static_cast<double>(this->frameStats.lastFrameTime.count()) / 1000.);
+    writer.field("maxFrameUsec",
+            static_cast<double>(this->frameStats.maxFrameTime.count()) / 1000.);
+    writer.field("averageFrameUsec",
+            static_cast<double>(this->frameStats.averageFrameTime.count()) / 1000.);
+    writer.endObject();
+
+    if(this->profiling) {
+        writer.field("profileWindowFrames", static_cast<uint64_t>(this->profileWindowFrames));
+    }
+
+    // memory usage
+    const auto mem = this->getMemoryStats();
+
+    writer.key("memory");
+    writer.beginObject();
+    for(size_t i = 0; i < kNumMemoryCategories; i++) {
+        writer.key(GetMemoryCategoryName(static_cast<MemoryCategory>(i)));
+        writer.beginObject();
+        writer.field("current", static_cast<uint64_t>(mem.categories[i].current));
+        writer.field("peak", static_cast<uint64_t>(mem.categories[i].peak));
+        writer.endObject();
+    }
+    writer.field("budget", static_cast<uint64_t>(mem.budget));
+    writer.field("trimCount", static_cast<uint64_t>(mem.trimCount));
+
+    const auto pool = this->surfacePool->getStats();
+    writer.key("surfacePool");
+    writer.beginObject();
+    writer.field("idleBytes", static_cast<uint64_t>(pool.idleBytes));
+    writer.field("liveBytes", static_cast<uint64_t>(pool.liveBytes));
+    writer.field("hits", pool.hits);
+    writer.field("misses", pool.misses);
+    writer.endObject();
+
+    writer.endObject();
+
+    writer.key("root");
+    if(this->rootWidget) {
+        this->rootWidget->dumpTree(writer);
+    } else {
+        writer.beginObject();
+        writer.endObject();
+    }
+
+    writer.endObject();
+
+    return writer.str();
+}
+
+
+
+/**
+ * @brief Insert an event into the event queue
+ *
+ * @param eevnt Event to insert into the event queue
+ * @param atEnd Whether the event is to go at the end or front of the event queue
+ */
+void Screen::queueEvent(const Event event, const bool atEnd) {
+    std::lock_guard lg(this->eventQueueLock);
+
+    // timestamp touch events that don't have a timestamp yet
+    auto stamped = event;
+    if(auto touch = std::get_if<event::Touch>(&stamped)) {
+        if(touch->timestamp == event::Touch::Clock::time_point{}) {
+            touch->timestamp = event::Touch::Clock::now();
+        }
+    }
+
+    if(atEnd) {
+        this->eventQueue.emplace_back(stamped);
+    } else {
+        this->eventQueue.emplace_front(stamped);
+    }
+
+    memory::Allocated(MemoryCategory::EventQueue, sizeof(Event));
+}
+
 /**
  * @brief Process all pending events
  *
@@ -285,14 +1349,20 @@ void Screen::setRootViewController(const std::shared_ptr<ViewController> &newRoo
 void Screen::processEvents() {
     std::lock_guard lg(this->eventQueueLock);
 
-    // simply clear events if events are inhibited
+    // simply clear events if events are inhibited; this abandons any touch in progress
     if(this->eventsInhibited) {
+        memory::Freed(MemoryCategory::EventQueue, this->eventQueue.size() * sizeof(Event));
         this->eventQueue.clear();
+
+        if(this->touchActive) {
+            this->cancelGestures();
+        }
         return;
     }
 
     while(!this->eventQueue.empty()) {
         const auto &event = this->eventQueue.front();
+        SHITTYGUI_TRACE(event__dispatch, event.index());
 
         std::visit([&](auto&& arg) -> void {
             using T = std::decay_t<decltype(arg)>;
@@ -300,14 +1370,21 @@ void Screen::processEvents() {
             /*
              * Handle touch event
              *
-             * Figure out what widget is on screen at the given coordinate, then provide the event
-             * to it for handling. If it doesn't handle it (or there is no widget there) the event
-             * is sent to the first responder, and otherwise it's ignored.
+             * Gesture recognizers see the event first. Unless one of them recognized its gesture
+             * and cancelled the touch, figure out what widget is on screen at the given
+             * coordinate, then provide the event to it for handling. If it doesn't handle it, each
+             * of its ancestors gets a chance to handle it in turn. If none of them do (or there is
+             * no widget there) the event is sent to the first responder, and otherwise it's
+             * ignored.
              */
             if constexpr(std::is_same_v<T, event::Touch>) {
                 // set if a touch event should result in setting a new tracking widget
                 bool wantNewTrackingWidget{true};
 
+                if(this->dispatchGestureTouch(arg)) {
+                    goto beach;
+                }
+
                 // check the touch tracking widget
                 if(auto widget = this->touchTrackingWidget.lock()) {
                     wantNewTrackingWidget = false;
@@ -323,8 +1400,8 @@ void Screen::processEvents() {
                     Point targetPoint;
                     auto target = this->rootWidget->findChildAt(arg.position, targetPoint);
 
-                    // try that widget
-                    if(target) {
+                    // try that widget, then its ancestors
+                    for(; target; target = target->getParent()) {
                         const auto handeled = target->handleTouchEvent(arg);
                         if(handeled) {
                             // if it handled the event, it's going to be the new tracking widget
@@ -378,19 +1455,194 @@ beach:;
             /*
              * Handle scroll event
              *
-             * This discards the return value since we don't care if the first responder didn't
-             * handle the event; if it did not, there's nowhere else for it to go.
-             *
-             * (That is, until event bubbling is implemented…)
+             * The first responder gets the first chance to handle the event. If it doesn't, the
+             * input focus moves by the scroll delta.
              */
             else if constexpr(std::is_same_v<T, event::Scroll>) {
                 if(auto widget = this->firstResponder.lock()) {
-                    widget->handleScrollEvent(arg);
+                    if(widget->handleScrollEvent(arg)) {
+                        return;
+                    }
+                }
+
+                this->moveFocus(arg.delta);
+            }
+            /*
+             * Handle key event
+             *
+             * Only the first responder receives key events; if there is none, or it doesn't
+             * handle the event, it's dropped.
+             */
+            else if constexpr(std::is_same_v<T, event::Key>) {
+                if(auto widget = this->firstResponder.lock()) {
+                    widget->handleKeyEvent(arg);
                 }
             }
         }, event);
 
         // go to next
         this->eventQueue.pop_front();
+        memory::Freed(MemoryCategory::EventQueue, sizeof(Event));
+    }
+}
+
+/**
+ * @brief Set a widget as the first responder
+ *
+ * First responder widgets will receive all modal (that is, keyboard and scroll events) user
+ * input, and draw a focus ring. Only the previous and new first responders are redrawn.
+ *
+ * @param widget Widget to receive focus, or `nullptr` to remove focus
+ */
+void Screen::setFirstResponder(const std::shared_ptr<Widget> &widget) {
+    auto old = this->firstResponder.lock();
+    if(old == widget) {
+        return;
+    }
+
+    this->firstResponder = widget;
+    this->firstResponderDirty = true;
+
+    if(old) {
+        old->focused = false;
+        old->needsDisplay();
+        old->didResignFirstResponder();
+    }
+    if(widget) {
+        widget->focused = true;
+        widget->needsDisplay();
+        widget->didBecomeFirstResponder();
+    }
+}
+
+/**
+ * @brief Move the input focus
+ *
+ * Focus moves between all visible widgets that accept user input, in reading order (top to
+ * bottom, then left to right.) It stops at the first and last widget.
+ *
+ * @param steps Number of widgets to move focus by; negative values move backwards
+ */
+void Screen::moveFocus(const int steps) {
+    if(!steps) {
+        return;
+    }
+
+    if(auto next = this->focus->advance(this->firstResponder.lock(), steps)) {
+        this->setFirstResponder(next);
+    }
+}
+
+/**
+ * @brief Provide a touch event to gesture recognizers
+ *
+ * When a touch goes down, the recognizers of the widget under it and all of its ancestors start
+ * tracking it; they then receive all events for that touch, until it's released.
+ *
+ * @return Whether the touch was cancelled by a recognized gesture, and shall not be delivered to
+ *         any widgets
+ */
+bool Screen::dispatchGestureTouch(const event::Touch &event) {
+    // a new touch went down: find the recognizers interested in it
+    if(!this->touchActive) {
+        if(!event.isDown) {
+            return false;
+        }
+
+        this->touchActive = true;
+        this->touchesCancelled = false;
+        this->activeGestures.clear();
+
+        if(this->rootWidget) {
+            Point unused;
+            auto widget = this->rootWidget->findChildAt(event.position, unused);
+
+            for(; widget; widget = widget->getParent()) {
+                for(const auto &recognizer : widget->gestureRecognizers) {
+                    if(!recognizer->isEnabled()) {
+                        continue;
+                    }
+
+                    recognizer->begin(widget, event);
+                    this->activeGestures.emplace_back(recognizer);
+                }
+            }
+        }
+    }
+    // otherwise, it moved or was released
+    else {
+        for(const auto &recognizer : this->activeGestures) {
+            recognizer->handleTouch(event);
+        }
+    }
+
+    this->updateGestures();
+    const bool cancelled = this->touchesCancelled;
+
+    // the touch is done
+    if(!event.isDown) {
+        this->activeGestures.clear();
+        this->touchActive = false;
+        this->touchesCancelled = false;
+    }
+
+    return cancelled;
+}
+
+/**
+ * @brief Resolve conflicts between gesture recognizers
+ *
+ * Once a recognizer has recognized its gesture, all other recognizers fail, including those that
+ * recognized their gestures in response to the same event; of those, the one attached to the
+ * innermost widget wins. Only then are the winner's state changes reported. If it cancels touches,
+ * the widget currently tracking the touch is notified that the touch was cancelled.
+ */
+void Screen::updateGestures() {
+    auto winner = std::find_if(this->activeGestures.begin(), this->activeGestures.end(),
+            [](const auto &recognizer) {
+        return recognizer->hasRecognized();
+    });
+    if(winner == this->activeGestures.end()) {
+        return;
     }
+
+    // only the winner gets to report its state changes
+    for(const auto &recognizer : this->activeGestures) {
+        if(recognizer != *winner) {
+            recognizer->fail();
+        }
+    }
+
+    const auto recognizer = *winner;
+    recognizer->deliverStates();
+
+    if(recognizer->cancelsTouches && !this->touchesCancelled) {
+        this->touchesCancelled = true;
+
+        if(auto widget = this->touchTrackingWidget.lock()) {
+            widget->handleTouchCancelled();
+        }
+        this->touchTrackingWidget.reset();
+    }
+}
+
+/**
+ * @brief Abandon the current touch
+ *
+ * All gestures in progress are cancelled, and the widget tracking the touch is notified.
+ */
+void Screen::cancelGestures() {
+    for(const auto &recognizer : this->activeGestures) {
+        recognizer->cancel();
+        recognizer->deliverStates();
+    }
+    this->activeGestures.clear();
+
+    if(auto widget = this->touchTrackingWidget.lock()) {
+        widget->handleTouchCancelled();
+    }
+    this->touchTrackingWidget.reset();
+
+    this->touchActive = false;
+    this->touchesCancelled = false;
 }
@@ -0,0 +1,730 @@
+/**
+ * @file
+ *
+ * @brief Software rasterizer for simple primitives
+ *
+ * Implements the software draw backend: rectangles and rounded rectangles (filled or stroked) and
+ * image blits are written directly into the pixels of the target image surface, rather than going
+ * through Cairo's general purpose (and, particularly for RGB565 surfaces, rather slow) rendering
+ * pipeline.
+ *
+ * Shapes are rasterized a row at a time: most pixels of a row have the same coverage, and are
+ * filled as a single span, while the coverage of pixels near the (rounded) edges is computed from
+ * their distance to the shape's outline. The span loops operate on whole packed pixels without
+ * branches, so the compiler can vectorize them.
+ *
+ * The antialiasing mode of the context is honored: without antialiasing, pixels are covered
+ * entirely if their center lies inside the shape (as Cairo does), and with fast antialiasing, the
+ * coverage of pixels on rounded corners is approximated without taking square roots.
+ */
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <cairo.h>
+
+#include "CairoHelpers.h"
+#include "DrawBackend.h"
+
+using namespace shittygui;
+
+/**
+ * @brief A rectangle of device pixels
+ *
+ * The end coordinates are exclusive.
+ */
+struct PixelBox {
+    int x1, y1, x2, y2;
+
+    /// Check whether the box covers no pixels
+    constexpr inline bool isEmpty() const {
+        return (this->x2 <= this->x1) || (this->y2 <= this->y1);
+    }
+
+    /// Get the intersection of this box and another one
+    constexpr inline PixelBox intersection(const PixelBox &other) const {
+        return {std::max(this->x1, other.x1), std::max(this->y1, other.y1),
+            std::min(this->x2, other.x2), std::min(this->y2, other.y2)};
+    }
+};
+
+/**
+ * @brief Surface being drawn into, prepared for direct pixel access
+ */
+struct RasterTarget {
+    /// Maximum number of clip rectangles supported
+    constexpr static const size_t kMaxClips{16};
+
+    /// Target surface
+    cairo_surface_t *surface;
+    /// Pixel format of the surface
+    cairo_format_t format;
+    /// Pixel data and bytes per row
+    uint8_t *data;
+    int stride;
+
+    /// Offset from user space to device pixels
+    int dx, dy;
+
+    /// Antialiasing mode of the context
+    cairo_antialias_t antialias;
+
+    /// Clip rectangles (in device pixels, within the surface bounds)
+    std::array<PixelBox, kMaxClips> clips;
+    size_t numClips{0};
+};
+
+/**
+ * @brief A rounded rectangle, in device space
+ */
+struct Shape {
+    /// Center of the rectangle
+    double cx, cy;
+    /// Half of its width and height
+    double hw, hh;
+    /// Corner radius
+    double r;
+};
+
+
+
+/**
+ * @brief Divide a product of two 8-bit values by 255, with rounding
+ */
+static inline uint32_t Div255(const uint32_t x) {
+    return (x + 128 + ((x + 128) >> 8)) >> 8;
+}
+
+/**
+ * @brief Multiply each channel of a packed 32-bit pixel by a factor in [0, 255]
+ */
+static inline uint32_t ScalePixel(const uint32_t px, const uint32_t factor) {
+    uint32_t rb = (px & 0x00FF00FF) * factor + 0x00800080;
+    rb = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+
+    uint32_t ag = ((px >> 8) & 0x00FF00FF) * factor + 0x00800080;
+    ag = (ag + ((ag >> 8) & 0x00FF00FF)) & 0xFF00FF00;
+
+    return rb | ag;
+}
+
+/**
+ * @brief Pack an 8 bit per channel (A)RGB pixel as RGB565
+ */
+static inline uint16_t Pack565(const uint32_t px) {
+    return ((px >> 8) & 0xF800) | ((px >> 5) & 0x07E0) | ((px >> 3) & 0x001F);
+}
+
+/**
+ * @brief Expand an RGB565 pixel to an opaque 8 bit per channel ARGB pixel
+ */
+static inline uint32_t Expand565(const uint16_t px) {
+    const uint32_t r = (px >> 11) & 0x1F, g = (px >> 5) & 0x3F, b = px & 0x1F;
+    return 0xFF000000 | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) |
+        ((b << 3) | (b >> 2));
+}
+
+/**
+ * @brief RGB565 pixel operations
+ *
+ * Blending uses 5 bits of alpha on the pixel "spread" into a 32-bit value, so that all three
+ * channels are blended with a single multiplication.
+ */
+struct Rgb565 {
+    using Pixel = uint16_t;
+
+    /// A solid color, prepared for filling
+    struct Source {
+        /// Packed color
+        uint16_t pixel;
+        /// Packed color, spread out for blending
+        uint32_t spread;
+        /// Alpha of the color
+        uint8_t alpha;
+    };
+
+    static Source Prepare(const Color &color) {
+        const uint32_t argb = (static_cast<uint32_t>(std::lround(color.r * 255.)) << 16) |
+            (static_cast<uint32_t>(std::lround(color.g * 255.)) << 8) |
+            static_cast<uint32_t>(std::lround(color.b * 255.));
+        const auto pixel = Pack565(argb);
+
+        return {pixel, Spread(pixel),
+            static_cast<uint8_t>(std::lround(std::clamp(color.a, 0.f, 1.f) * 255.))};
+    }
+
+    /// Fill a span of pixels with the given coverage
+    static void Fill(Pixel *out, const size_t count, const Source &src, const uint8_t coverage) {
+        const auto alpha = Div255(src.alpha * coverage);
+
+        if(alpha == 255) {
+            std::fill_n(out, count, src.pixel);
+            return;
+        }
+
+        const uint32_t a5 = (alpha + 4) >> 3;
+        if(!a5) {
+            return;
+        }
+
+        for(size_t i = 0; i < count; i++) {
+            auto dst = Spread(out[i]);
+            dst = (dst + (((src.spread - dst) * a5) >> 5)) & 0x07E0F81F;
+            out[i] = static_cast<uint16_t>(dst | (dst >> 16));
+        }
+    }
+
+    /// Composite a row of image pixels
+    static void Blit(Pixel *out, const uint8_t *in, const size_t count,
+            const cairo_format_t format) {
+        const auto in32 = reinterpret_cast<const uint32_t *>(in);
+
+        switch(format) {
+            case CAIRO_FORMAT_RGB16_565:
+                memcpy(out, in, count * sizeof(Pixel));
+                break;
+
+            case CAIRO_FORMAT_RGB24:
+                for(size_t i = 0; i < count; i++) {
+                    out[i] = Pack565(in32[i]);
+                }
+                break;
+
+            case CAIRO_FORMAT_ARGB32:
+                for(size_t i = 0; i < count; i++) {
+                    const auto px = in32[i];
+                    const auto alpha = px >> 24;
+
+                    if(alpha == 255) {
+                        out[i] = Pack565(px);
+                    } else if(alpha) {
+                        out[i] = Pack565(px + ScalePixel(Expand565(out[i]), 255 - alpha));
+                    }
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    private:
+        static inline uint32_t Spread(const uint16_t px) {
+            return (px | (static_cast<uint32_t>(px) << 16)) & 0x07E0F81F;
+        }
+};
+
+/**
+ * @brief ARGB32 (premultiplied) and RGB24 pixel operations
+ *
+ * RGB24 surfaces are treated the same as ARGB32 ones; Cairo ignores their alpha channel.
+ */
+struct Argb32 {
+    using Pixel = uint32_t;
+
+    /// A solid color, prepared for filling
+    struct Source {
+        /// Premultiplied color
+        uint32_t pixel;
+        /// Alpha of the color
+        uint8_t alpha;
+    };
+
+    static Source Prepare(const Color &color) {
+        const auto a = std::clamp(color.a, 0.f, 1.f);
+        const auto alpha = static_cast<uint32_t>(std::lround(a * 255.));
+
+        const uint32_t pixel = (alpha << 24) |
+            (static_cast<uint32_t>(std::lround(color.r * a * 255.)) << 16) |
+            (static_cast<uint32_t>(std::lround(color.g * a * 255.)) << 8) |
+            static_cast<uint32_t>(std::lround(color.b * a * 255.));
+
+        return {pixel, static_cast<uint8_t>(alpha)};
+    }
+
+    /// Fill a span of pixels with the given coverage
+    static void Fill(Pixel *out, const size_t count, const Source &src, const uint8_t coverage) {
+        const auto alpha = Div255(src.alpha * coverage);
+        if(!alpha) {
+            return;
+        }
+
+        const auto pixel = (coverage == 255) ? src.pixel : ScalePixel(src.pixel, coverage);
+
+        if(alpha == 255) {
+            std::fill_n(out, count, pixel);
+            return;
+        }
+
+        const auto inverse = 255 - alpha;
+        for(size_t i = 0; i < count; i++) {
+            out[i] = pixel + ScalePixel(out[i], inverse);
+        }
+    }
+
+    /// Composite a row of image pixels
+    static void Blit(Pixel *out, const uint8_t *in, const size_t count,
+            const cairo_format_t format) {
+        const auto in16 = reinterpret_cast<const uint16_t *>(in);
+        const auto in32 = reinterpret_cast<const uint32_t *>(in);
+
+        switch(format) {
+            case CAIRO_FORMAT_RGB16_565:
+                for(size_t i = 0; i < count; i++) {
+                    out[i] = Expand565(in16[i]);
+                }
+                break;
+
+            case CAIRO_FORMAT_RGB24:
+                for(size_t i = 0; i < count; i++) {
+                    out[i] = in32[i] | 0xFF000000;
+                }
+                break;
+
+            case CAIRO_FORMAT_ARGB32:
+                for(size_t i = 0; i < count; i++) {
+                    const auto px = in32[i];
+                    const auto alpha = px >> 24;
+
+                    if(alpha == 255) {
+                        out[i] = px;
+                    } else if(alpha) {
+                        out[i] = px + ScalePixel(out[i], 255 - alpha);
+                    }
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+};
+
+
+
+/**
+ * @brief Check whether a pixel format can be drawn into (or blitted from) directly
+ */
+static inline bool IsSupportedFormat(const cairo_format_t format) {
+    return (format == CAIRO_FORMAT_RGB16_565) || (format == CAIRO_FORMAT_RGB24) ||
+        (format == CAIRO_FORMAT_ARGB32);
+}
+
+/**
+ * @brief Check whether a value is a whole number
+ */
+static inline bool IsIntegral(const double value) {
+    return value == std::round(value);
+}
+
+/**
+ * @brief Prepare to draw directly into the target of a context
+ *
+ * This checks the conditions listed in SoftwareDrawBackend's documentation, and gets the clip
+ * in device pixels.
+ *
+ * @return Whether the context can be drawn into directly
+ */
+static bool PrepareTarget(cairo_t *ctx, RasterTarget &target) {
+    if(cairo_get_operator(ctx) != CAIRO_OPERATOR_OVER) {
+        return false;
+    }
+
+    // must draw directly into an image surface
+    auto surface = cairo_get_group_target(ctx);
+    if(surface != cairo_get_target(ctx) ||
+            cairo_surface_get_type(surface) != CAIRO_SURFACE_TYPE_IMAGE) {
+        return false;
+    }
+
+    target.surface = surface;
+    target.format = cairo_image_surface_get_format(surface);
+    if(!IsSupportedFormat(target.format)) {
+        return false;
+    }
+
+    // transform must be a translation by whole pixels
+    cairo_matrix_t m;
+    cairo_get_matrix(ctx, &m);
+
+    double offsetX, offsetY;
+    cairo_surface_get_device_offset(surface, &offsetX, &offsetY);
+
+    if(m.xx != 1. || m.yy != 1. || m.xy != 0. || m.yx != 0.) {
+        return false;
+    }
+
+    const auto x0 = m.x0 + offsetX, y0 = m.y0 + offsetY;
+    if(!IsIntegral(x0) || !IsIntegral(y0)) {
+        return false;
+    }
+
+    target.dx = static_cast<int>(x0);
+    target.dy = static_cast<int>(y0);
+
+    target.antialias = cairo_get_antialias(ctx);
+
+    // clip must consist of pixel aligned rectangles
+    const PixelBox bounds{0, 0, cairo_image_surface_get_width(surface),
+        cairo_image_surface_get_height(surface)};
+
+    auto list = cairo_copy_clip_rectangle_list(ctx);
+    bool usable = (list->status == CAIRO_STATUS_SUCCESS) &&
+        (static_cast<size_t>(list->num_rectangles) <= RasterTarget::kMaxClips);
+
+    target.numClips = 0;
+    for(int i = 0; usable && i < list->num_rectangles; i++) {
+        const auto &rect = list->rectangles[i];
+        const auto x = rect.x + target.dx, y = rect.y + target.dy;
+
+        if(!IsIntegral(x) || !IsIntegral(y) || !IsIntegral(rect.width) ||
+                !IsIntegral(rect.height)) {
+            usable = false;
+            break;
+        }
+
+        const PixelBox box{static_cast<int>(x), static_cast<int>(y),
+            static_cast<int>(x + rect.width), static_cast<int>(y + rect.height)};
+        const auto clipped = box.intersection(bounds);
+
+        if(!clipped.isEmpty()) {
+            target.clips[target.numClips++] = clipped;
+        }
+    }
+
+    cairo_rectangle_list_destroy(list);
+
+    if(!usable) {
+        return false;
+    }
+
+    target.data = cairo_image_surface_get_data(surface);
+    target.stride = cairo_image_surface_get_stride(surface);
+
+    return (target.data != nullptr);
+}
+
+/**
+ * @brief Convert a rectangle in user space to a shape in device space
+ */
+static inline Shape MakeShape(const RasterTarget &target, const double x, const double y,
+        const double width, const double height, const double radius) {
+    const auto hw = std::max(width / 2., 0.), hh = std::max(height / 2., 0.);
+
+    return {x + target.dx + hw, y + target.dy + hh, hw, hh,
+        std::clamp(radius, 0., std::min(hw, hh))};
+}
+
+/**
+ * @brief Convert the signed distance from a pixel center to a shape's outline to coverage
+ *
+ * Without antialiasing, the pixel is covered entirely if its center is inside the shape.
+ */
+static inline double DistanceToCoverage(const double distance, const cairo_antialias_t mode) {
+    if(mode == CAIRO_ANTIALIAS_NONE) {
+        return (distance <= 0) ? 1. : 0.;
+    }
+    return std::clamp(0.5 - distance, 0., 1.);
+}
+
+/**
+ * @brief Get the coverage of the pixel centered at the given point by a shape
+ *
+ * This is approximated from the signed distance between the pixel center and the shape's outline;
+ * it's exact for straight edges. On rounded corners, fast antialiasing approximates the distance
+ * to the arc to first order, which is accurate within the pixel or so next to the outline where
+ * coverage is fractional.
+ */
+static inline double GetCoverage(const Shape &shape, const double px, const double py,
+        const cairo_antialias_t mode) {
+    const auto qx = std::abs(px - shape.cx) - (shape.hw - shape.r);
+    const auto qy = std::abs(py - shape.cy) - (shape.hh - shape.r);
+    const auto ox = std::max(qx, 0.), oy = std::max(qy, 0.);
+
+    // outside the corners, the distance is to a straight edge
+    if(!ox || !oy) {
+        return DistanceToCoverage(ox + oy + std::min(std::max(qx, qy), 0.) - shape.r, mode);
+    }
+
+    const auto squared = (ox * ox) + (oy * oy);
+
+    switch(mode) {
+        case CAIRO_ANTIALIAS_NONE:
+            return (squared <= shape.r * shape.r) ? 1. : 0.;
+        case CAIRO_ANTIALIAS_FAST:
+            if(shape.r > 0) {
+                return DistanceToCoverage((squared - (shape.r * shape.r)) / (2. * shape.r), mode);
+            }
+            [[fallthrough]];
+        default:
+            return DistanceToCoverage(std::sqrt(squared) - shape.r, mode);
+    }
+}
+
+/**
+ * @brief Get the coverage of pixels in a row, away from the shape's left and right edges
+ */
+static inline double GetRowCoverage(const Shape &shape, const double py,
+        const cairo_antialias_t mode) {
+    return DistanceToCoverage(std::abs(py - shape.cy) - shape.hh, mode);
+}
+
+/**
+ * @brief Rasterize a shape, optionally with a hole cut out of it
+ *
+ * For each row, the coverage of pixels within the straight part of the shape (more than a pixel
+ * away from the left and right edges, or corners) depends only on the row, so they're emitted as a
+ * single span. The pixels near the edges are emitted individually.
+ *
+ * @param clip Area to rasterize, in device pixels
+ * @param outer Shape to rasterize
+ * @param hole Shape to cut out of it (it must lie within the outer shape), if any
+ * @param mode Antialiasing mode
+ * @param emit Invoked with (y, x, count, coverage) for each span of pixels with nonzero coverage
+ */
+template<typename Emit>
+static void RasterizeShape(const PixelBox &clip, const Shape &outer, const Shape *hole,
+        const cairo_antialias_t mode, Emit &&emit) {
+    const auto area = clip.intersection({
+        static_cast<int>(std::floor(outer.cx - outer.hw)),
+        static_cast<int>(std::floor(outer.cy - outer.hh)),
+        static_cast<int>(std::ceil(outer.cx + outer.hw)),
+        static_cast<int>(std::ceil(outer.cy + outer.hh)),
+    });
+    if(area.isEmpty()) {
+        return;
+    }
+
+    // columns whose coverage depends only on the row
+    auto straight = outer.hw - outer.r;
+    if(hole) {
+        straight = std::min(straight, hole->hw - hole->r);
+    }
+    straight -= 1.;
+
+    int spanStart{area.x2}, spanEnd{area.x2};
+    if(straight >= 0) {
+        spanStart = std::clamp(static_cast<int>(std::ceil(outer.cx - straight - .5)), area.x1,
+                area.x2);
+        spanEnd = std::clamp(static_cast<int>(std::floor(outer.cx + straight - .5)) + 1,
+                spanStart, area.x2);
+    }
+
+    auto coverageAt = [&](const double px, const double py) {
+        auto coverage = GetCoverage(outer, px, py, mode);
+        if(hole) {
+            coverage -= GetCoverage(*hole, px, py, mode);
+        }
+        return static_cast<uint8_t>(std::lround(std::clamp(coverage, 0., 1.) * 255.));
+    };
+
+    for(int y = area.y1; y < area.y2; y++) {
+        const double py = y + .5;
+
+        for(int x = area.x1; x < spanStart; x++) {
+            if(const auto coverage = coverageAt(x + .5, py)) {
+                emit(y, x, 1, coverage);
+            }
+        }
+
+        if(spanEnd > spanStart) {
+            auto coverage = GetRowCoverage(outer, py, mode);
+            if(hole) {
+                coverage -= GetRowCoverage(*hole, py, mode);
+            }
+
+            const auto alpha = static_cast<uint8_t>(std::lround(std::clamp(coverage, 0., 1.) *
+                        255.));
+            if(alpha) {
+                emit(y, spanStart, spanEnd - spanStart, alpha);
+            }
+        }
+
+        for(int x = spanEnd; x < area.x2; x++) {
+            if(const auto coverage = coverageAt(x + .5, py)) {
+                emit(y, x, 1, coverage);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Fill a shape in the target's pixel format
+ */
+template<typename Format>
+static void FillShape(const RasterTarget &target, const Shape &outer, const Shape *hole,
+        const Color &color) {
+    const auto source = Format::Prepare(color);
+
+    for(size_t i = 0; i < target.numClips; i++) {
+        RasterizeShape(target.clips[i], outer, hole, target.antialias, [&](const int y,
+                    const int x, const int count, const uint8_t coverage) {
+            auto row = reinterpret_cast<typename Format::Pixel *>(target.data +
+                    (y * target.stride));
+            Format::Fill(row + x, count, source, coverage);
+        });
+    }
+}
+
+/**
+ * @brief Draw a shape into the target
+ *
+ * The target surface is flushed before drawing, and the area drawn into is marked as dirty
+ * afterwards.
+ */
+static void DrawShape(const RasterTarget &target, const Shape &outer, const Shape *hole,
+        const Color &color) {
+    cairo_surface_flush(target.surface);
+
+    switch(target.format) {
+        case CAIRO_FORMAT_RGB16_565:
+            FillShape<Rgb565>(target, outer, hole, color);
+            break;
+        default:
+            FillShape<Argb32>(target, outer, hole, color);
+            break;
+    }
+
+    const auto x1 = static_cast<int>(std::floor(outer.cx - outer.hw));
+    const auto y1 = static_cast<int>(std::floor(outer.cy - outer.hh));
+    cairo_surface_mark_dirty_rectangle(target.surface, x1, y1,
+            static_cast<int>(std::ceil(outer.cx + outer.hw)) - x1,
+            static_cast<int>(std::ceil(outer.cy + outer.hh)) - y1);
+}
+
+/**
+ * @brief Blit an image surface into the target's pixel format
+ *
+ * @param dest Area of the target covered by the image, in device pixels
+ */
+template<typename Format>
+static void BlitSurface(const RasterTarget &target, const PixelBox &dest,
+        cairo_surface_t *surface) {
+    const auto format = cairo_image_surface_get_format(surface);
+    const auto bytesPerPixel = (format == CAIRO_FORMAT_RGB16_565) ? 2 : 4;
+    const auto data = cairo_image_surface_get_data(surface);
+    const auto stride = cairo_image_surface_get_stride(surface);
+
+    for(size_t i = 0; i < target.numClips; i++) {
+        const auto area = target.clips[i].intersection(dest);
+        if(area.isEmpty()) {
+            continue;
+        }
+
+        for(int y = area.y1; y < area.y2; y++) {
+            auto out = reinterpret_cast<typename Format::Pixel *>(target.data +
+                    (y * target.stride)) + area.x1;
+            const auto in = data + ((y - dest.y1) * stride) +
+                ((area.x1 - dest.x1) * bytesPerPixel);
+
+            Format::Blit(out, in, area.x2 - area.x1, format);
+        }
+    }
+}
+
+
+
+/**
+ * @brief Fill a rectangle
+ */
+void SoftwareDrawBackend::fillRect(cairo_t *ctx, const Rect &rect, const Color &color) {
+    RasterTarget target;
+    if(!PrepareTarget(ctx, target)) {
+        return CairoDrawBackend::fillRect(ctx, rect, color);
+    }
+
+    cairo_new_path(ctx);
+
+    const auto shape = MakeShape(target, rect.origin.x, rect.origin.y, rect.size.width,
+            rect.size.height, 0);
+    DrawShape(target, shape, nullptr, color);
+}
+
+/**
+ * @brief Fill a rounded rectangle
+ */
+void SoftwareDrawBackend::fillRoundedRect(cairo_t *ctx, const Rect &rect, const double radius,
+        const Color &color) {
+    RasterTarget target;
+    if(!PrepareTarget(ctx, target)) {
+        return CairoDrawBackend::fillRoundedRect(ctx, rect, radius, color);
+    }
+
+    cairo_new_path(ctx);
+
+    const auto shape = MakeShape(target, rect.origin.x, rect.origin.y, rect.size.width,
+            rect.size.height, radius);
+    DrawShape(target, shape, nullptr, color);
+}
+
+/**
+ * @brief Stroke a rounded rectangle
+ *
+ * The stroke is rasterized as the area between the rectangle expanded and inset by half the
+ * line width.
+ */
+void SoftwareDrawBackend::strokeRoundedRect(cairo_t *ctx, const Rect &rect, const double radius,
+        const double lineWidth, const Color &color) {
+    RasterTarget target;
+    if(!PrepareTarget(ctx, target)) {
+        return CairoDrawBackend::strokeRoundedRect(ctx, rect, radius, lineWidth, color);
+    }
+
+    cairo_new_path(ctx);
+
+    const auto half = lineWidth / 2.;
+    const auto outer = MakeShape(target, rect.origin.x - half, rect.origin.y - half,
+            rect.size.width + lineWidth, rect.size.height + lineWidth,
+            (radius > 0) ? radius + half : 0);
+
+    if(rect.size.width > lineWidth && rect.size.height > lineWidth) {
+        const auto hole = MakeShape(target, rect.origin.x + half, rect.origin.y + half,
+                rect.size.width - lineWidth, rect.size.height - lineWidth,
+                std::max(radius - half, 0.));
+        DrawShape(target, outer, &hole, color);
+    } else {
+        DrawShape(target, outer, nullptr, color);
+    }
+}
+
+/**
+ * @brief Draw an image surface
+ *
+ * Images drawn at their native size are blitted directly.
+ */
+void SoftwareDrawBackend::drawSurface(cairo_t *ctx, cairo_surface_t *surface, const Size &size) {
+    RasterTarget target;
+
+    if(cairo_surface_get_type(surface) != CAIRO_SURFACE_TYPE_IMAGE ||
+            !IsSupportedFormat(cairo_image_surface_get_format(surface)) ||
+            cairo_image_surface_get_width(surface) != size.width ||
+            cairo_image_surface_get_height(surface) != size.height ||
+            !PrepareTarget(ctx, target)) {
+        return CairoDrawBackend::drawSurface(ctx, surface, size);
+    }
+
+    cairo_surface_flush(surface);
+    if(!cairo_image_surface_get_data(surface)) {
+        return CairoDrawBackend::drawSurface(ctx, surface, size);
+    }
+
+    cairo_new_path(ctx);
+    cairo_surface_flush(target.surface);
+
+    const PixelBox dest{target.dx, target.dy, target.dx + size.width, target.dy + size.height};
+
+    switch(target.format) {
+        case CAIRO_FORMAT_RGB16_565:
+            BlitSurface<Rgb565>(target, dest, surface);
+            break;
+        default:
+            BlitSurface<Argb32>(target, dest, surface);
+            break;
+    }
+
+    cairo_surface_mark_dirty_rectangle(target.surface, dest.x1, dest.y1, size.width,
+            size.height);
+}
@@ -0,0 +1,148 @@
+/**
+ * @file
+ *
+ * @brief Shared widget style storage
+ */
+#ifndef SHITTYGUI_STYLETABLE_H
+#define SHITTYGUI_STYLETABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace shittygui {
+/**
+ * @brief Table of shared styles
+ *
+ * Widgets with many style properties store only the index of their style in a table of styles,
+ * which is shared by all widgets of that type. Identical styles are stored only once; the default
+ * style is always at index 0.
+ *
+ * Styles other than the default are reference counted: each widget holds a reference to its
+ * style, acquired with intern() and given up with release(). Slots of styles that are no longer
+ * referenced are reused, so the table only grows as large as the number of distinct styles in use
+ * at the same time.
+ *
+ * @tparam T Style type; it must be default constructible and equality comparable.
+ * @tparam Hash Hash function for styles
+ */
+template<typename T, typename Hash>
+class StyleTable {
+    public:
+        /// Index of the default style
+        constexpr static const uint16_t kDefaultIndex{0};
+
+        StyleTable() {
+            this->entries.emplace_back();
+            this->index.emplace(Hash{}(this->entries.front().style), kDefaultIndex);
+        }
+
+        /**
+         * @brief Get the style at the given index
+         *
+         * References remain valid for the lifetime of the table, but a slot may be reused for a
+         * different style once all references to its style were released.
+         */
+        inline const T &operator[](const uint16_t index) const {
+            return this->entries[index].style;
+        }
+
+        /**
+         * @brief Get the index of a style and take a reference to it
+         *
+         * The style is added to the table if needed. Each call must be balanced by a call to
+         * release() once the index is no longer used.
+         *
+         * @throw std::length_error The table is full
+         */
+        uint16_t intern(const T &style) {
+            const auto hash = Hash{}(style);
+
+            // find an existing copy of the style
+            const auto [begin, end] = this->index.equal_range(hash);
+            for(auto it = begin; it != end; ++it) {
+                auto &entry = this->entries[it->second];
+                if(entry.style == style) {
+                    if(it->second != kDefaultIndex) {
+                        entry.refs++;
+                    }
+                    return it->second;
+                }
+            }
+
+            // otherwise, store it in a free slot (or a new one)
+            uint16_t slot;
+
+            if(!this->freeSlots.empty()) {
+                slot = this->freeSlots.back();
+                this->freeSlots.pop_back();
+                this->entries[slot] = {style, 1};
+            } else {
+                if(this->entries.size() > std::numeric_limits<uint16_t>::max()) {
+                    throw std::length_error("too many styles");
+                }
+
+                slot = static_cast<uint16_t>(this->entries.size());
+                this->entries.push_back({style, 1});
+            }
+
+            this->index.emplace(hash, slot);
+            return slot;
+        }
+
+        /**
+         * @brief Give up a reference to a style
+         *
+         * When its last reference is released, the style is removed and its slot can be reused.
+         */
+        void release(const uint16_t slot) {
+            if(slot == kDefaultIndex) {
+                return;
+            }
+
+            auto &entry = this->entries[slot];
+            if(--entry.refs) {
+                return;
+            }
+
+            const auto [begin, end] = this->index.equal_range(Hash{}(entry.style));
+            for(auto it = begin; it != end; ++it) {
+                if(it->second == slot) {
+                    this->index.erase(it);
+                    break;
+                }
+            }
+
+            this->freeSlots.push_back(slot);
+        }
+
+        /**
+         * @brief Get the number of distinct styles in the table
+         */
+        inline size_t size() const {
+            return this->entries.size() - this->freeSlots.size();
+        }
+
+    private:
+        /// A stored style
+        struct Entry {
+            /// Style values
+            T style{};
+            /// Number of references to the style (not counted for the default style)
+            uint32_t refs{0};
+        };
+
+        /// All styles; a deque is used so references to styles remain valid as it grows
+        std::deque<Entry> entries;
+        /// Slots that are not in use
+        std::vector<uint16_t> freeSlots;
+        /// Slots of styles, by their hash
+        std::unordered_multimap<size_t, uint16_t> index;
+};
+}
+
+#endif
@@ -0,0 +1,239 @@
+#include <bit>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+
+#include "Errors.h"
+#include "MemoryAccounting.h"
+#include "SurfacePool.h"
+
+using namespace shittygui;
+
+/// User data key for pool information attached to surfaces
+static const cairo_user_data_key_t gLeaseKey{};
+
+/**
+ * @brief Round a buffer size up to its size class
+ *
+ * There are four size classes per power of two, so rounding up wastes at most 25% of the buffer.
+ * All size classes are multiples of the buffer alignment.
+ */
+static inline size_t RoundToSizeClass(const size_t bytes, const size_t minSize) {
+    if(bytes <= minSize) {
+        return minSize;
+    }
+
+    const size_t granule = size_t{1} << (std::bit_width(bytes - 1) - 3);
+    return (bytes + granule - 1) & ~(granule - 1);
+}
+
+/**
+ * @brief Get the bucket key for the given format and size class
+ */
+static inline constexpr uint64_t MakeKey(const cairo_format_t format, const size_t size) {
+    return (static_cast<uint64_t>(format) << 56) | static_cast<uint64_t>(size);
+}
+
+/**
+ * @brief Initialize the surface pool
+ *
+ * @param maxIdleBytes Maximum amount of memory to retain in idle buffers
+ */
+SurfacePool::SurfacePool(const size_t maxIdleBytes) : maxIdleBytes(maxIdleBytes) {
+
+}
+
+/**
+ * @brief Release all idle buffers
+ *
+ * Surfaces that are still in use at this time will free their memory when they're destroyed.
+ */
+SurfacePool::~SurfacePool() {
+    for(auto &[key, buffers] : this->idle) {
+        for(auto &buffer : buffers) {
+            FreeBuffer(buffer);
+        }
+    }
+}
+
+/**
+ * @brief Get an image surface from the pool
+ *
+ * Returns an image surface of the specified format and dimensions, whose backing memory is taken
+ * from the pool if possible. Rows are aligned to a cache line.
+ *
+ * @param format Pixel format of the surface
+ * @param width Width of the surface, in pixels
+ * @param height Height of the surface, in pixels
+ *
+ * @return Image surface; release it with cairo_surface_destroy() as usual
+ *
+ * @remark The contents of the surface are undefined; the caller must clear it if required.
+ *
+ * @throw std::invalid_argument Invalid format or dimensions specified
+ */
+cairo_surface_t *SurfacePool::acquire(const cairo_format_t format, const int width,
+        const int height) {
+    const auto minStride = cairo_format_stride_for_width(format, width);
+    if(minStride == -1 || height <= 0) {
+        throw std::invalid_argument("invalid surface format or size");
+    }
+
+    const size_t stride = (static_cast<size_t>(minStride) + kAlignment - 1) & ~(kAlignment - 1);
+    const size_t capacity = RoundToSizeClass(stride * height, kMinBufferSize);
+    const auto key = MakeKey(format, capacity);
+
+    // try to get an idle buffer
+    Buffer buffer;
+
+    {
+        std::lock_guard lg(this->lock);
+
+        auto it = this->idle.find(key);
+        if(it != this->idle.end() && !it->second.empty()) {
+            buffer = it->second.back();
+            it->second.pop_back();
+
+            this->stats.idleBytes -= buffer.capacity;
+            this->stats.hits++;
+        } else {
+            this->stats.misses++;
+        }
+
+        this->stats.liveBytes += capacity;
+    }
+
+    // allocate a new one otherwise
+    if(!buffer.memory) {
+        buffer.memory = std::aligned_alloc(kAlignment, capacity);
+        if(!buffer.memory) {
+            std::lock_guard lg(this->lock);
+            this->stats.liveBytes -= capacity;
+            throw std::bad_alloc();
+        }
+
+        buffer.capacity = capacity;
+        memory::Allocated(MemoryCategory::CachedLayers, capacity);
+    }
+
+    // create the surface and attach the lease, which returns the buffer to us
+    auto surface = cairo_image_surface_create_for_data(
+            reinterpret_cast<unsigned char *>(buffer.memory), format, width, height, stride);
+    auto status = cairo_surface_status(surface);
+
+    if(status == CAIRO_STATUS_SUCCESS) {
+        auto lease = new Lease{this->weak_from_this(), key, buffer};
+        status = cairo_surface_set_user_data(surface, &gLeaseKey, lease,
+                &SurfacePool::SurfaceDestroyed);
+
+        if(status == CAIRO_STATUS_SUCCESS) {
+            return surface;
+        }
+
+        delete lease;
+    }
+
+    cairo_surface_destroy(surface);
+    this->reclaim(key, std::move(buffer));
+    ThrowForCairoStatus(status);
+    return nullptr;
+}
+
+/**
+ * @brief Surface destruction callback
+ *
+ * Invoked by Cairo when a surface created by the pool is destroyed. Its buffer is returned to the
+ * pool, if it still exists.
+ */
+void SurfacePool::SurfaceDestroyed(void *ctx) {
+    auto lease = reinterpret_cast<Lease *>(ctx);
+
+    if(auto pool = lease->pool.lock()) {
+        pool->reclaim(lease->key, std::move(lease->buffer));
+    } else {
+        FreeBuffer(lease->buffer);
+    }
+
+    delete lease;
+}
+
+/**
+ * @brief Return a buffer to the pool
+ *
+ * The buffer is added to the idle list, unless this would exceed the maximum amount of idle
+ * memory, in which case it's freed immediately.
+ */
+void SurfacePool::reclaim(const uint64_t key, Buffer &&buffer) {
+    {
+        std::lock_guard lg(this->lock);
+
+        this->stats.liveBytes -= buffer.capacity;
+
+        if(this->stats.idleBytes + buffer.capacity <= this->maxIdleBytes) {
+            buffer.released = std::chrono::steady_clock::now();
+            this->stats.idleBytes += buffer.capacity;
+            this->idle[key].emplace_back(std::move(buffer));
+            return;
+        }
+    }
+
+    FreeBuffer(buffer);
+}
+
+/**
+ * @brief Release idle buffers
+ *
+ * Frees all buffers that have been idle for at least the specified time.
+ *
+ * @param maxAge Maximum time a buffer may remain idle
+ */
+void SurfacePool::trim(const std::chrono::steady_clock::duration maxAge) {
+    const auto cutoff = std::chrono::steady_clock::now() - maxAge;
+    std::vector<Buffer> toFree;
+
+    {
+        std::lock_guard lg(this->lock);
+
+        for(auto it = this->idle.begin(); it != this->idle.end();) {
+            auto &buffers = it->second;
+
+            std::erase_if(buffers, [&](const auto &buffer) {
+                if(buffer.released > cutoff) {
+                    return false;
+                }
+
+                this->stats.idleBytes -= buffer.capacity;
+                toFree.emplace_back(buffer);
+                return true;
+            });
+
+            if(buffers.empty()) {
+                it = this->idle.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for(auto &buffer : toFree) {
+        FreeBuffer(buffer);
+    }
+}
+
+/**
+ * @brief Get pool usage statistics
+ */
+SurfacePool::Stats SurfacePool::getStats() {
+    std::lock_guard lg(this->lock);
+    return this->stats;
+}
+
+/**
+ * @brief Free a buffer's memory
+ */
+void SurfacePool::FreeBuffer(Buffer &buffer) {
+    memory::Freed(MemoryCategory::CachedLayers, buffer.capacity);
+
+    std::free(buffer.memory);
+    buffer.memory = nullptr;
+}
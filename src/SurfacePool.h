@@ -0,0 +1,118 @@
+/**
+ * @file
+ *
+ * @brief Pool of image surfaces
+ *
+ * Offscreen surfaces (used for patterns, cached layers, snapshots and the like) tend to be short
+ * lived and frequently re-created with similar sizes, for example when a widget is resized or
+ * during animations. The pool keeps the backing memory of released surfaces around for a while so
+ * that it can be reused, rather than going through malloc/free for large buffers every time.
+ */
+#ifndef SHITTYGUI_SURFACEPOOL_H
+#define SHITTYGUI_SURFACEPOOL_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <cairo.h>
+
+namespace shittygui {
+/**
+ * @brief Pool of image surface backing buffers
+ *
+ * Buffers are bucketed by their pixel format and size, which is rounded up to one of four size
+ * classes per power of two; so a buffer may be reused for any surface of the same format whose
+ * pixel data fits in the size class, wasting at most 25% of the buffer.
+ *
+ * Surfaces handed out by the pool are regular Cairo image surfaces. When the last reference to
+ * them is dropped, their backing memory returns to the pool automatically. Idle buffers are
+ * released by periodically invoking trim().
+ *
+ * @remark The pool may be accessed from multiple threads. Surfaces may outlive the pool; in that
+ *         case their memory is simply freed.
+ */
+class SurfacePool: public std::enable_shared_from_this<SurfacePool> {
+    public:
+        /**
+         * @brief Pool usage statistics
+         */
+        struct Stats {
+            /// Bytes of memory held by idle buffers
+            size_t idleBytes{0};
+            /// Bytes of memory held by buffers in use
+            size_t liveBytes{0};
+            /// Number of surfaces that could be satisfied from the pool
+            uint64_t hits{0};
+            /// Number of surfaces that required a new buffer to be allocated
+            uint64_t misses{0};
+        };
+
+        /// Default maximum amount of idle memory retained by the pool
+        constexpr static const size_t kDefaultMaxIdleBytes{8 * 1024 * 1024};
+
+        SurfacePool(const size_t maxIdleBytes = kDefaultMaxIdleBytes);
+        ~SurfacePool();
+
+        cairo_surface_t *acquire(const cairo_format_t format, const int width, const int height);
+
+        void trim(const std::chrono::steady_clock::duration maxAge);
+        /**
+         * @brief Release all idle buffers
+         */
+        inline void purge() {
+            this->trim(std::chrono::steady_clock::duration::zero());
+        }
+
+        Stats getStats();
+
+    private:
+        /// A single backing buffer
+        struct Buffer {
+            /// Pixel memory
+            void *memory{nullptr};
+            /// Size of the allocation (bytes)
+            size_t capacity{0};
+            /// When the buffer was returned to the pool
+            std::chrono::steady_clock::time_point released;
+        };
+
+        /// Information attached to a surface handed out by the pool
+        struct Lease {
+            /// Pool to return the buffer to
+            std::weak_ptr<SurfacePool> pool;
+            /// Bucket key the buffer belongs to
+            uint64_t key;
+            /// Backing buffer
+            Buffer buffer;
+        };
+
+        static void SurfaceDestroyed(void *ctx);
+        static void FreeBuffer(Buffer &buffer);
+
+        void reclaim(const uint64_t key, Buffer &&buffer);
+
+    private:
+        /// Alignment of buffers and rows within them (bytes)
+        constexpr static const size_t kAlignment{64};
+        /// Smallest buffer size (bytes)
+        constexpr static const size_t kMinBufferSize{4096};
+
+        /// Lock protecting the buffer lists and statistics
+        std::mutex lock;
+
+        /// Idle buffers, keyed by bucket
+        std::unordered_map<uint64_t, std::vector<Buffer>> idle;
+        /// Maximum number of bytes of idle buffers to retain
+        size_t maxIdleBytes;
+
+        /// Usage statistics
+        Stats stats;
+};
+}
+
+#endif
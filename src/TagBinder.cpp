@@ -0,0 +1,327 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+#include "Animator.h"
+#include "Screen.h"
+#include "TagBinder.h"
+#include "TagTable.h"
+#include "Widget.h"
+#include "Widgets/Label.h"
+#include "Widgets/ProgressBar.h"
+
+using namespace shittygui;
+
+/**
+ * @brief Create a binder for the given tag table
+ */
+TagBinder::TagBinder(const std::shared_ptr<TagTable> &table) : table(table) {
+    if(!table) {
+        throw std::invalid_argument("invalid tag table");
+    }
+}
+
+/**
+ * @brief Clean up the binder
+ *
+ * If the binder is attached to a screen, its animator callback is removed.
+ */
+TagBinder::~TagBinder() {
+    this->detach();
+}
+
+
+
+/**
+ * @brief Bind a label's text to a tag
+ *
+ * @param label Label whose text to update
+ * @param tag Index of the tag
+ * @param format How to format the tag's value
+ */
+void TagBinder::bindText(const std::shared_ptr<widgets::Label> &label, const uint32_t tag,
+        const NumberFormat &format) {
+    Binding b{};
+    b.kind = Kind::Text;
+    b.tag = tag;
+    b.format = format;
+
+    this->add(std::move(b), label);
+}
+
+/**
+ * @brief Bind a progress bar's progress to a tag
+ *
+ * The tag's value is mapped linearly from the given range to the progress bar's range, and
+ * clamped.
+ *
+ * @param bar Progress bar to update
+ * @param tag Index of the tag
+ * @param min Value corresponding to an empty progress bar
+ * @param max Value corresponding to a full progress bar
+ */
+void TagBinder::bindProgress(const std::shared_ptr<widgets::ProgressBar> &bar,
+        const uint32_t tag, const double min, const double max) {
+    if(min == max) {
+        throw std::invalid_argument("invalid progress range");
+    }
+
+    Binding b{};
+    b.kind = Kind::Progress;
+    b.tag = tag;
+    b.min = min;
+    b.max = max;
+
+    this->add(std::move(b), bar);
+}
+
+/**
+ * @brief Bind a widget's visibility to a tag
+ *
+ * @param widget Widget to show or hide
+ * @param tag Index of the tag
+ * @param hiddenWhenZero If set, the widget is hidden while the tag is zero; otherwise, it's hidden
+ *        while the tag is nonzero.
+ */
+void TagBinder::bindHidden(const std::shared_ptr<Widget> &widget, const uint32_t tag,
+        const bool hiddenWhenZero) {
+    Binding b{};
+    b.kind = Kind::Hidden;
+    b.tag = tag;
+    b.min = hiddenWhenZero ? 1. : 0.;
+
+    this->add(std::move(b), widget);
+}
+
+/**
+ * @brief Bind a widget to a tag with a custom callback
+ *
+ * @param widget Widget to pass to the callback
+ * @param tag Index of the tag
+ * @param callback Function invoked whenever the tag changes
+ *
+ * @remark The callback must not add or remove bindings.
+ */
+void TagBinder::bind(const std::shared_ptr<Widget> &widget, const uint32_t tag,
+        const Callback &callback) {
+    if(!callback) {
+        throw std::invalid_argument("invalid callback");
+    }
+
+    Binding b{};
+    b.kind = Kind::Custom;
+    b.tag = tag;
+    b.callback = callback;
+
+    this->add(std::move(b), widget);
+}
+
+/**
+ * @brief Insert a binding
+ *
+ * Bindings are kept sorted by tag, so tags are read in memory order when applying them. The new
+ * binding is applied (with the tag's current value) the next time bindings are applied.
+ *
+ * @throw std::out_of_range If the tag index is invalid
+ */
+void TagBinder::add(Binding &&binding, const std::shared_ptr<Widget> &widget) {
+    if(!widget) {
+        throw std::invalid_argument("invalid widget");
+    } else if(binding.tag >= this->table->getNumTags()) {
+        throw std::out_of_range("invalid tag index");
+    }
+
+    binding.widget = widget;
+
+    auto it = std::upper_bound(this->bindings.begin(), this->bindings.end(), binding.tag,
+            [](const uint32_t tag, const Binding &b) {
+        return tag < b.tag;
+    });
+    this->bindings.insert(it, std::move(binding));
+
+    this->bindingsDirty = true;
+}
+
+/**
+ * @brief Remove all bindings of a widget
+ *
+ * @return Number of bindings removed
+ */
+size_t TagBinder::unbind(const std::shared_ptr<Widget> &widget) {
+    return std::erase_if(this->bindings, [&](const Binding &b) {
+        return !b.widget.owner_before(widget) && !widget.owner_before(b.widget);
+    });
+}
+
+
+
+/**
+ * @brief Apply bindings once per frame
+ *
+ * Registers a callback with the screen's animator, which applies the bindings before each frame
+ * is drawn. A binder can only be attached to one screen at a time.
+ */
+void TagBinder::attach(const std::shared_ptr<Screen> &screen) {
+    this->detach();
+
+    this->animatorToken = screen->getAnimator()->registerCallback([&]() -> bool {
+        this->apply();
+        return true;
+    });
+
+    this->screen = screen;
+    this->attached = true;
+}
+
+/**
+ * @brief Stop applying bindings automatically
+ */
+void TagBinder::detach() {
+    if(!this->attached) {
+        return;
+    }
+
+    if(auto screen = this->screen.lock()) {
+        screen->getAnimator()->unregisterCallback(this->animatorToken);
+    }
+
+    this->screen.reset();
+    this->attached = false;
+}
+
+/**
+ * @brief Apply all bindings whose tags changed
+ *
+ * If the table's generation counter hasn't changed since the last time bindings were applied,
+ * nothing changed, and this returns immediately. Otherwise, only bindings whose tag version
+ * differs from the one last applied are updated.
+ *
+ * Bindings whose widgets have been deallocated are removed.
+ *
+ * @return Number of bindings that updated their widget
+ */
+size_t TagBinder::apply() {
+    const auto generation = this->table->getGeneration();
+    if(generation == this->lastGeneration && !this->bindingsDirty) {
+        return 0;
+    }
+
+    this->lastGeneration = generation;
+    this->bindingsDirty = false;
+
+    size_t updated{0};
+    bool hasDead{false};
+
+    for(auto &b : this->bindings) {
+        const auto version = this->table->getVersion(b.tag);
+        if(b.applied && version == b.version) {
+            continue;
+        }
+
+        b.version = version;
+        b.applied = true;
+
+        if(this->applyBinding(b, this->table->get(b.tag))) {
+            updated++;
+        } else {
+            hasDead = true;
+        }
+    }
+
+    if(hasDead) {
+        std::erase_if(this->bindings, [](const Binding &b) {
+            return b.widget.expired();
+        });
+    }
+
+    return updated;
+}
+
+/**
+ * @brief Update the widget of a binding with a new value
+ *
+ * @return Whether the widget still exists
+ */
+bool TagBinder::applyBinding(Binding &b, const double value) {
+    auto widget = b.widget.lock();
+    if(!widget) {
+        return false;
+    }
+
+    switch(b.kind) {
+        case Kind::Text: {
+            char buf[kMaxTextLength];
+            const auto len = Format(value, b.format, buf, sizeof(buf));
+            const std::string_view text(buf, len);
+
+            auto label = std::static_pointer_cast<widgets::Label>(widget);
+            if(label->getContent() != text) {
+                label->setContent(text);
+            }
+            break;
+        }
+
+        case Kind::Progress: {
+            const auto progress = std::clamp((value - b.min) / (b.max - b.min), 0., 1.);
+            auto bar = std::static_pointer_cast<widgets::ProgressBar>(widget);
+
+            if(bar->getProgress() != progress) {
+                bar->setProgress(progress);
+            }
+            break;
+        }
+
+        case Kind::Hidden: {
+            const bool hidden = (value == 0.) == (b.min != 0.);
+            if(widget->isHidden() != hidden) {
+                widget->setHidden(hidden);
+            }
+            break;
+        }
+
+        case Kind::Custom:
+            b.callback(widget, value);
+            break;
+    }
+
+    return true;
+}
+
+
+
+/**
+ * @brief Format a value as text
+ *
+ * The value is scaled, then formatted as a fixed point number with the prefix and suffix of the
+ * format. The output is truncated if it doesn't fit; it is not NUL terminated.
+ *
+ * @param value Value to format
+ * @param format Format specification
+ * @param out Buffer to receive the text
+ * @param outSize Size of the buffer, in bytes
+ *
+ * @return Number of bytes written to the buffer
+ */
+size_t TagBinder::Format(const double value, const NumberFormat &format, char *out,
+        const size_t outSize) {
+    char *ptr = out, *end = out + outSize;
+
+    const auto prefixLen = std::min(format.prefix.size(), outSize);
+    std::memcpy(ptr, format.prefix.data(), prefixLen);
+    ptr += prefixLen;
+
+    auto res = std::to_chars(ptr, end, value * format.scale, std::chars_format::fixed,
+            format.precision);
+    if(res.ec != std::errc()) {
+        return ptr - out;
+    }
+    ptr = res.ptr;
+
+    const auto suffixLen = std::min(format.suffix.size(), static_cast<size_t>(end - ptr));
+    std::memcpy(ptr, format.suffix.data(), suffixLen);
+    ptr += suffixLen;
+
+    return ptr - out;
+}
@@ -0,0 +1,111 @@
+#include <bit>
+#include <new>
+#include <stdexcept>
+
+#include "TagTable.h"
+
+using namespace shittygui;
+
+/**
+ * @brief Create a tag table with its own storage
+ *
+ * All tags are initialized to zero.
+ *
+ * @param numTags Number of tags in the table
+ */
+TagTable::TagTable(const size_t numTags) {
+    const auto size = GetRequiredSize(numTags);
+    auto memory = ::operator new(size, std::align_val_t{alignof(Slot)});
+
+    this->owned = true;
+
+    this->header = new(memory) Header{kMagic, static_cast<uint32_t>(numTags), {0}};
+    this->slots = reinterpret_cast<Slot *>(this->header + 1);
+
+    for(size_t i = 0; i < numTags; i++) {
+        new(&this->slots[i]) Slot{{0}, {0}, 0};
+    }
+}
+
+/**
+ * @brief Create a tag table in existing memory
+ *
+ * The memory (for example, a shared memory region) must remain valid for the lifetime of the
+ * table. Either the table is initialized in it, or it must already contain a table.
+ *
+ * @param memory Start of the table's memory; it must be aligned to 8 bytes
+ * @param size Size of the memory region, in bytes
+ * @param initialize Whether to initialize a new table (with as many tags as fit) in the memory,
+ *        rather than using an existing one
+ */
+TagTable::TagTable(void *memory, const size_t size, const bool initialize) {
+    if(!memory || reinterpret_cast<uintptr_t>(memory) % alignof(Slot)) {
+        throw std::invalid_argument("tag table memory must be 8 byte aligned");
+    } else if(size < sizeof(Header)) {
+        throw std::invalid_argument("tag table memory too small");
+    }
+
+    if(initialize) {
+        const auto numTags = (size - sizeof(Header)) / sizeof(Slot);
+
+        this->header = new(memory) Header{kMagic, static_cast<uint32_t>(numTags), {0}};
+        this->slots = reinterpret_cast<Slot *>(this->header + 1);
+
+        for(size_t i = 0; i < numTags; i++) {
+            new(&this->slots[i]) Slot{{0}, {0}, 0};
+        }
+    } else {
+        this->header = reinterpret_cast<Header *>(memory);
+        this->slots = reinterpret_cast<Slot *>(this->header + 1);
+
+        if(this->header->magic != kMagic) {
+            throw std::runtime_error("invalid tag table magic");
+        } else if(GetRequiredSize(this->header->numTags) > size) {
+            throw std::runtime_error("tag table exceeds memory region");
+        }
+    }
+}
+
+/**
+ * @brief Release the table's storage, if it was allocated by us
+ */
+TagTable::~TagTable() {
+    if(this->owned) {
+        ::operator delete(this->header, std::align_val_t{alignof(Slot)});
+    }
+}
+
+/**
+ * @brief Update the value of a tag
+ *
+ * If the value is different from the current value, it's stored, and the tag's version counter
+ * and the table's generation counter are incremented. Setting a tag to the value it already has
+ * doesn't count as a change.
+ *
+ * @remark Only one thread (or process) may update a given tag at a time.
+ */
+void TagTable::set(const uint32_t tag, const double value) {
+    auto &slot = const_cast<Slot &>(this->getSlot(tag));
+    const auto bits = std::bit_cast<uint64_t>(value);
+
+    if(slot.value.load(std::memory_order_relaxed) == bits) {
+        return;
+    }
+
+    slot.value.store(bits, std::memory_order_relaxed);
+    slot.version.fetch_add(1, std::memory_order_release);
+    this->header->generation.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * @brief Get the storage of a tag
+ *
+ * @throw std::out_of_range If the tag index is invalid
+ */
+const TagTable::Slot &TagTable::getSlot(const uint32_t tag) const {
+    if(tag >= this->header->numTags) {
+        throw std::out_of_range("invalid tag index");
+    }
+
+    return this->slots[tag];
+}
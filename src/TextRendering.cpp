@@ -1,226 +1,265 @@
-#include <cairo.h>
-#include <pango/pangocairo.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
 
-#include "CairoHelpers.h"
-#include "Util.h"
+#include "MemoryAccounting.h"
 #include "TextRendering.h"
+#include "Util.h"
 
 using namespace shittygui;
 
 /**
- * @brief Release resources
+ * @brief Key of a cached fitted font size
+ *
+ * Consists of everything that went into fitting the text, with the font identified by its name.
  */
-TextRendering::~TextRendering() {
-    this->releaseTextResources();
-}
+struct FitCacheKey {
+    /// Text that was fitted
+    std::string text;
+    /// Name of the font (without the size)
+    std::string font;
+    /// Size of the box
+    uint16_t width, height;
+    /// Allowed font sizes
+    double minSize, maxSize;
+    /// Layout properties
+    bool hasMarkup, multiParagraph, wordWrap;
+
+    bool operator==(const FitCacheKey &) const = default;
+};
+
+/**
+ * @brief Hash function for fit cache keys
+ */
+struct FitCacheKeyHash {
+    size_t operator()(const FitCacheKey &key) const {
+        size_t hash = std::hash<std::string>{}(key.text);
+        hash ^= std::hash<std::string>{}(key.font) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        hash ^= (static_cast<size_t>(key.width) << 16 | key.height) + 0x9e3779b9 + (hash << 6) +
+            (hash >> 2);
+        return hash;
+    }
+};
+
+/// List of cached fitted font sizes
+using FitCacheList = std::list<std::pair<FitCacheKey, double>>;
 
 /**
- * @brief Initialize the Pango text layout context
+ * @brief Estimated base memory usage of a text layout (bytes)
  *
- * This context is by default configured for single paragraph operation, with left alignment.
+ * Neither backend exposes how much memory a layout uses, so this is an estimate of the layout
+ * object and its line/run structures for a short string.
+ */
+constexpr static const size_t kLayoutBaseBytes{1024};
+/**
+ * @brief Estimated memory usage per byte of text in a layout
+ *
+ * Covers the copy of the text, its attributes, and the shaped glyph strings.
+ */
+constexpr static const size_t kLayoutBytesPerChar{48};
+
+/// Maximum number of fitted font sizes to cache
+constexpr static const size_t kFitCacheSize{128};
+/// Granularity of fitted font sizes, in points
+constexpr static const double kFitSizeStep{.5};
+
+/// Recently fitted font sizes, most recently used first
+static FitCacheList gFitCache;
+/// Index of the fit cache
+static std::unordered_map<FitCacheKey, FitCacheList::iterator, FitCacheKeyHash> gFitCacheIndex;
+
+/**
+ * @brief Get the estimated memory used by a fit cache entry
  *
- * @param drawCtx Cairo drawing context to render text onto
+ * The key is stored twice: in the list, and in its index.
  */
-void TextRendering::initTextResources(cairo_t *drawCtx) {
-    this->layout = pango_cairo_create_layout(drawCtx);
+static inline size_t GetFitCacheEntryBytes(const FitCacheKey &key) {
+    return (sizeof(FitCacheList::value_type) + key.text.capacity() + key.font.capacity()) * 2 +
+        (sizeof(void *) * 4);
+}
+
 
-    this->setTextLayoutWrapMode(false, true);
-    this->setTextLayoutAlign(TextAlign::Left, false);
+
+/**
+ * @brief Release resources
+ */
+TextRendering::~TextRendering() {
+    this->releaseTextResources();
 }
 
 /**
- * @brief Clean up the allocated Pango resources
+ * @brief Update the estimated memory usage of the text layout
+ *
+ * @param textLength Length of the layout's text, in bytes
  */
-void TextRendering::releaseTextResources() {
-    if(this->layout) {
-        g_object_unref(this->layout);
-        this->layout = nullptr;
-    }
+void TextRendering::updateLayoutBytes(const size_t textLength) {
+    const auto newLayoutBytes = kLayoutBaseBytes + (textLength * kLayoutBytesPerChar);
+    memory::Resized(MemoryCategory::TextLayouts, this->layoutBytes, newLayoutBytes);
+    this->layoutBytes = newLayoutBytes;
 }
 
 /**
- * @brief Parse a font descriptor string
+ * @brief Store a font in a widget archive
  *
- * Fonts are automatically loaded using the system's font discovery mechanism. Names are parsed as
- * [Pango FontDescriptions](https://docs.gtk.org/Pango/type_func.FontDescription.from_string.html)
- * so you can customize the style, variants, weight, gravity, and stretch values of the font.
+ * The font is stored as its name (without the size) and size, which can be passed to getFont()
+ * again when the archive is instantiated.
  *
- * @param name Font name
- * @param size Font size, in points
+ * @param encoder Archive encoder to receive the font
+ * @param key Property key to store the font under
+ * @param font Font to store; nothing is stored if it's `nullptr`
  */
-PangoFontDescription *TextRendering::getFont(const std::string_view name, const double size) const {
-    auto desc = pango_font_description_from_string(name.data());
-    pango_font_description_set_size(desc, size * PANGO_SCALE);
+void TextRendering::EncodeFont(ArchiveEncoder &encoder, const ArchiveKey key,
+        const TextFont *font) {
+    if(!font) {
+        return;
+    }
 
-    return desc;
+    encoder.addFont(key, GetFontName(font), GetFontSize(font));
 }
 
 /**
- * @brief Render a specified string set on the layout context
+ * @brief Mix a font into a draw state hash
  *
- * @param Cairo drawing context to render into
- * @param bounds Frame rectangle of the resulting text
- * @param color Color to render the text in
- * @param str String to render (it is applied to the layout)
- * @param parseMarkup Whether Pango markup should be parsed in the string content
+ * The font is identified by its name and size, rather than its address, since a font that's
+ * released may be followed by a different one at the same address.
  *
- * @remark The render context should have its "current point" set as the origin of the text.
+ * @param hash Hash to update
+ * @param font Font to mix into the hash; may be `nullptr` for the default font
  */
-void TextRendering::drawString(cairo_t *drawCtx, const Rect &bounds, const Color &color,
-        const std::string_view &str, const VerticalAlign valign, const bool parseMarkup) {
-    this->setTextContent(str, parseMarkup);
-    this->drawString(drawCtx, bounds, color, valign);
+void TextRendering::HashFont(uint64_t &hash, const TextFont *font) {
+    if(!font) {
+        HashCombine(hash, 0);
+        return;
+    }
+
+    HashCombine(hash, GetFontName(font));
+    HashCombine(hash, GetFontSize(font));
 }
 
 /**
- * @brief Render the last string set on the layout context
+ * @brief Find the largest font size at which the text fits in a box
+ *
+ * Binary searches the allowed font sizes (in steps of half a point) for the largest one at which
+ * the text, laid out without ellipsization, fits the box. Results are cached (shared by all
+ * widgets) so fitting the same text again, such as when a widget is redrawn or another widget
+ * displays the same string, doesn't lay out the text at all.
+ *
+ * The layout must have the text set, and be configured with the wrap mode specified in the fit
+ * parameters. Afterwards, its font is reset to `font`.
  *
- * @param Cairo drawing context to render into
- * @param bounds Frame rectangle of the resulting text
- * @param color Color to render the text in
+ * @param font Font to fit; only its name is used.
+ * @param fit Text and box to fit it into
  *
- * @remark The render context should have its "current point" set as the origin of the text.
+ * @return Font size, in points; the smallest allowed size if the text doesn't fit at all.
  */
-void TextRendering::drawString(cairo_t *drawCtx, const Rect &bounds, const Color &color,
-        const VerticalAlign valign) {
-    int width, height;
-    double pX, pY;
-
-    cairo_move_to(drawCtx, bounds.origin.x, bounds.origin.y);
+double TextRendering::getFittingFontSize(const TextFont *font, const TextFit &fit) {
+    FitCacheKey key{std::string(fit.text), GetFontName(font), fit.box.width, fit.box.height,
+        fit.minSize, fit.maxSize, fit.hasMarkup, fit.multiParagraph, fit.wordWrap};
 
-    // lay out the text and get its size
-    pango_layout_set_width(this->layout, bounds.size.width * PANGO_SCALE);
-    pango_layout_set_height(this->layout, bounds.size.height * PANGO_SCALE);
+    if(auto it = gFitCacheIndex.find(key); it != gFitCacheIndex.end()) {
+        gFitCache.splice(gFitCache.begin(), gFitCache, it->second);
+        return it->second->second;
+    }
 
-    pango_cairo_update_layout(drawCtx, this->layout);
+    // lay out the text with a temporary font of the given size
+    auto fits = [&](const double size) -> bool {
+        auto probe = this->getFont(key.font, size);
+        this->setTextFont(probe);
+        const auto extents = this->measureText(fit.box.width);
+        this->setTextFont(font);
+        ReleaseFont(probe);
 
-    pango_layout_get_size(this->layout, &width, &height);
+        return extents.width <= fit.box.width && extents.height <= fit.box.height;
+    };
 
-    // perform vertical align offsetting
-    cairo_get_current_point(drawCtx, &pX, &pY);
+    double size{fit.maxSize};
+    if(fit.maxSize > fit.minSize && !fits(fit.maxSize)) {
+        // largest step that fits; the smallest size is used if none do
+        int lo{0}, hi{static_cast<int>(std::floor((fit.maxSize - fit.minSize) / kFitSizeStep))};
+        if(fit.minSize + (hi * kFitSizeStep) >= fit.maxSize) {
+            hi--;
+        }
 
-    switch(valign) {
-        case VerticalAlign::Middle:
-            cairo_move_to(drawCtx, pX, pY);
-            pY += (bounds.size.height - (height / PANGO_SCALE)) / 2;
-            cairo_move_to(drawCtx, pX, pY);
-            break;
+        while(lo < hi) {
+            const auto mid = (lo + hi + 1) / 2;
+            if(fits(fit.minSize + (mid * kFitSizeStep))) {
+                lo = mid;
+            } else {
+                hi = mid - 1;
+            }
+        }
 
-        case VerticalAlign::Bottom:
-            pY += bounds.size.height - (height / PANGO_SCALE);
-            cairo_move_to(drawCtx, pX, pY);
-            break;
+        size = fit.minSize + (lo * kFitSizeStep);
+    }
 
-        default:
-            break;
+    // cache the result, evicting the least recently used one if needed
+    if(gFitCache.size() >= kFitCacheSize) {
+        const auto &oldest = gFitCache.back();
+        memory::Freed(MemoryCategory::TextLayouts, GetFitCacheEntryBytes(oldest.first));
+        gFitCacheIndex.erase(oldest.first);
+        gFitCache.pop_back();
     }
 
-    // render it
-    cairo::SetSource(drawCtx, color);
-    pango_cairo_show_layout(drawCtx, this->layout);
-}
+    gFitCache.emplace_front(std::move(key), size);
 
-/**
- * @brief Update the text alignment and justification settings of the text layout context
- *
- * @param newAlign New horizontal alignment setting
- * @param justified Whether text is justified
- */
-void TextRendering::setTextLayoutAlign(const TextAlign newAlign, const bool justified) {
-    switch(newAlign) {
-        case TextAlign::Left:
-            pango_layout_set_alignment(this->layout, PANGO_ALIGN_LEFT);
-            break;
-        case TextAlign::Center:
-            pango_layout_set_alignment(this->layout, PANGO_ALIGN_CENTER);
-            break;
-        case TextAlign::Right:
-            pango_layout_set_alignment(this->layout, PANGO_ALIGN_RIGHT);
-            break;
-    }
+    const auto &entry = gFitCache.front();
+    gFitCacheIndex.emplace(entry.first, gFitCache.begin());
+    memory::Allocated(MemoryCategory::TextLayouts, GetFitCacheEntryBytes(entry.first));
 
-    pango_layout_set_justify(this->layout, justified);
+    return size;
 }
 
 /**
- * @brief Update the text ellipsization mode of the text drawing context
+ * @brief Set the layout's font to the largest size of a font at which the text fits
+ *
+ * This is used by widgets that automatically fit their text. The fitted font is only created (or
+ * replaced) when the fitted size changes.
  *
- * @param newMode Text ellipsization mode to set
+ * @param font Font to fit; its size is the largest allowed size.
+ * @param fitted Font at the fitted size (if smaller than `font`), owned by the caller which must
+ *        release it with ReleaseFont()
+ * @param fit Text and box to fit it into; its maximum size is ignored.
  */
-void TextRendering::setTextLayoutEllipsization(const EllipsizeMode newMode) {
-    switch(newMode) {
-        case EllipsizeMode::None:
-            pango_layout_set_ellipsize(this->layout, PANGO_ELLIPSIZE_NONE);
-            break;
-        case EllipsizeMode::Start:
-            pango_layout_set_ellipsize(this->layout, PANGO_ELLIPSIZE_START);
-            break;
-        case EllipsizeMode::Middle:
-            pango_layout_set_ellipsize(this->layout, PANGO_ELLIPSIZE_MIDDLE);
-            break;
-        case EllipsizeMode::End:
-            pango_layout_set_ellipsize(this->layout, PANGO_ELLIPSIZE_END);
-            break;
+void TextRendering::setFittedTextFont(const TextFont *font, TextFont *&fitted, TextFit fit) {
+    fit.maxSize = GetFontSize(font);
+    fit.minSize = std::min(fit.minSize, fit.maxSize);
+
+    const auto size = this->getFittingFontSize(font, fit);
+    if(size >= fit.maxSize) {
+        this->setTextFont(font);
+        return;
     }
-}
 
-/**
- * @brief Update the wrapping and line break mode
- *
- * @param multiParagraph Whether the text renderer renders multiple paragraphs
- * @param wordWrap Whether lines are wrapped on word (`true`) or character (`false`) boundaries
- */
-void TextRendering::setTextLayoutWrapMode(const bool multiParagraph, const bool wordWrap) {
-    if(wordWrap) {
-        pango_layout_set_wrap(this->layout, PANGO_WRAP_WORD);
-    } else {
-        pango_layout_set_wrap(this->layout, PANGO_WRAP_CHAR);
+    if(!fitted || GetFontSize(fitted) != size) {
+        this->setTextFont(font);
+        ReleaseFont(fitted);
+        fitted = this->getFont(GetFontName(font), size);
     }
-    pango_layout_set_single_paragraph_mode(this->layout, !multiParagraph);
+
+    this->setTextFont(fitted);
 }
 
 
 
 /**
- * @brief Set the text content of the text layout context
- *
- * Update the string content that will be drawn by the layout context. If specified, the text can
- * be parsed for attributes which affect how it is rendered; this is implemented by Pango, see
- * [this page](https://docs.gtk.org/Pango/pango_markup.html) for documentation on the markup
- * format.
+ * @brief Calculate the vertical offset of text in its bounds
  *
- * @param str String to set
- * @param parseMarkup Whether Pango markup should be parsed
- *
- * @remark Note that when markup is parsed, any existing attributes are replaced.
+ * @param bounds Frame rectangle of the text
+ * @param height Height of the laid out text, in pixels
+ * @param valign Vertical alignment of the text
  */
-void TextRendering::setTextContent(const std::string_view &str, const bool parseMarkup) {
-    if(!parseMarkup) {
-        pango_layout_set_text(this->layout, str.data(), str.length());
-    } else {
-        PangoAttrList *attrList{nullptr};
-        char *strippedStr{nullptr};
-        GError *outError{nullptr};
-
-        // parse markup
-        auto ret = pango_parse_markup(str.data(), str.length(), 0, &attrList, &strippedStr,
-                nullptr, &outError);
-        if(!ret) {
-            if(outError) {
-                fprintf(stderr, "shittygui: %s failed (%u): %s\n", "pango_parse_markup",
-                        outError->code, outError->message);
-                throw std::runtime_error(outError->message);
-            } else {
-                throw std::runtime_error("unspecified error in pango_parse_markup");
-            }
-        }
-
-        // apply text and attributes
-        pango_layout_set_text(this->layout, strippedStr, -1);
-        pango_layout_set_attributes(this->layout, attrList);
-
-        // clean up
-        free(strippedStr);
-        pango_attr_list_unref(attrList);
+int TextRendering::GetVerticalOffset(const Rect &bounds, const int height,
+        const VerticalAlign valign) {
+    switch(valign) {
+        case VerticalAlign::Middle:
+            return (bounds.size.height - height) / 2;
+        case VerticalAlign::Bottom:
+            return bounds.size.height - height;
+        default:
+            return 0;
     }
 }
@@ -0,0 +1,1589 @@
+/**
+ * @file
+ *
+ * @brief Lightweight text rendering backend
+ *
+ * Shapes text with HarfBuzz, and renders the shaped glyphs through Cairo's FreeType font
+ * backend; fonts are located with fontconfig. This avoids depending on Pango, GLib and GObject,
+ * which considerably reduces memory use and startup time.
+ *
+ * Compared to the Pango backend, there are a few limitations:
+ *
+ * - Text is laid out left to right, without bidirectional reordering.
+ * - Only a subset of Pango's markup is supported: the `<b>`, `<i>` and `<u>` tags, and `<span>`
+ *   tags with the `foreground` (or `color`/`fgcolor`), `weight`, `style` and `underline`
+ *   attributes. Colors must be specified in hex notation.
+ * - Bold and italic text in markup is synthesized from the regular font face.
+ * - Line breaks are only inserted at spaces (or anywhere, for character wrapping) rather than
+ *   according to the full Unicode line breaking algorithm.
+ */
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <cairo.h>
+#include <cairo-ft.h>
+#include <fontconfig/fontconfig.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <hb.h>
+#include <hb-ft.h>
+
+#include "CairoHelpers.h"
+#include "MemoryAccounting.h"
+#include "TextRendering.h"
+#include "Tracing.h"
+
+using namespace shittygui;
+
+/**
+ * @brief Resolution fonts are rendered at, in dots per inch
+ *
+ * This is the same resolution the Pango backend uses, so that fonts are the same size with both.
+ */
+constexpr static const double kFontDpi{96.};
+/**
+ * @brief Subpixel units per pixel in HarfBuzz positions
+ */
+constexpr static const double kHbScale{64.};
+
+/// Default font, used if none was set on a layout
+constexpr static const std::string_view kDefaultFont{"Sans"};
+/// Size of the default font, in points
+constexpr static const double kDefaultFontSize{12.};
+
+/**
+ * @brief A loaded font file
+ *
+ * Faces are loaded once, and kept for the lifetime of the process; user interfaces generally use
+ * only a handful of fonts, so this is cheaper than reloading them.
+ */
+struct FontFace {
+    /// FreeType face object
+    FT_Face ft{nullptr};
+    /// HarfBuzz face, used for shaping
+    hb_face_t *hb{nullptr};
+    /// Cairo font faces, indexed by the styles to synthesize (`cairo_ft_synthesize_t`)
+    cairo_font_face_t *cairo[4]{};
+};
+
+/// FreeType library handle, created when the first font is loaded
+static FT_Library gFreeType{nullptr};
+/// All loaded font faces, keyed by file path and face index
+static std::unordered_map<std::string, std::unique_ptr<FontFace>> gFaces;
+/// Protects the font face cache and FreeType library
+static std::mutex gFacesLock;
+/// Font used for layouts without an explicitly set font
+static TextFont *gDefaultFont{nullptr};
+
+/**
+ * @brief A font at a particular size
+ */
+struct shittygui::TextFont {
+    /// Font description (without the size) it was created from
+    std::string name;
+    /// Font size, in points
+    double size;
+
+    /// Font face
+    FontFace *face;
+    /// Styles to synthesize (`cairo_ft_synthesize_t`) because the face doesn't provide them
+    unsigned int synthesize;
+
+    /// HarfBuzz font, scaled to the font size
+    hb_font_t *hb;
+    /// Font size, in pixels
+    double pixelSize;
+
+    /// Distance from the top of a line to the baseline, in pixels
+    double ascent;
+    /// Height of a line, in pixels
+    double lineHeight;
+    /// Distance from the baseline to the top of underlines, in pixels
+    double underlinePosition;
+    /// Thickness of underlines, in pixels
+    double underlineThickness;
+
+    /// Glyph and advance of a space
+    uint32_t spaceGlyph;
+    float spaceAdvance;
+    /// Glyph used to indicate ellipsized text, its advance, and how many times it's repeated
+    uint32_t ellipsisGlyph;
+    float ellipsisAdvance;
+    uint8_t ellipsisCount;
+};
+
+/**
+ * @brief A range of text with the same style
+ *
+ * Produced by parsing markup; plain text is a single span.
+ */
+struct TextSpan {
+    /// Style flags
+    enum Style: uint8_t {
+        Bold                            = (1 << 0),
+        Italic                          = (1 << 1),
+        Underline                       = (1 << 2),
+    };
+
+    /// Byte range of the span in the text
+    uint32_t start, end;
+    /// Style flags
+    uint8_t style{0};
+    /// Whether the span has its own color (rather than the color the text is drawn with)
+    bool hasColor{false};
+    /// Color of the span
+    Color color;
+};
+
+/**
+ * @brief A glyph resulting from shaping the text
+ */
+struct ShapedGlyph {
+    /// Glyph flags
+    enum Flags: uint8_t {
+        /// Whitespace; lines may be broken after it
+        Space                           = (1 << 0),
+        /// Newline; inserted for each newline in the text, with the advance of a space
+        Newline                         = (1 << 1),
+    };
+
+    /// Glyph index
+    uint32_t id;
+    /// Byte offset of the character (cluster) the glyph belongs to
+    uint32_t cluster;
+    /// Horizontal advance, and offsets (in pixels)
+    float advance, xOffset, yOffset;
+    /// Span the glyph belongs to
+    uint16_t span;
+    /// Glyph flags
+    uint8_t flags;
+};
+
+/**
+ * @brief A glyph positioned on a line
+ */
+struct PlacedGlyph {
+    /// Glyph index
+    uint32_t id;
+    /// Byte offset of the character (cluster) the glyph belongs to
+    uint32_t cluster;
+    /// Pen position, relative to the start of the line
+    float x;
+    /// Horizontal advance
+    float advance;
+    /// Offset of the glyph from the pen position (y is upwards)
+    float xOffset, yOffset;
+    /// Span the glyph belongs to
+    uint16_t span;
+};
+
+/**
+ * @brief A line of laid out text
+ */
+struct TextLine {
+    /// Index of the line's first glyph in the placed glyphs array
+    uint32_t first;
+    /// Number of glyphs in the line
+    uint32_t count;
+    /// Horizontal offset of the line (due to alignment)
+    float x;
+    /// Width of the line, excluding trailing whitespace
+    float width;
+};
+
+/**
+ * @brief Text layout state
+ *
+ * The text is shaped whenever it (or the font) changes, and broken into lines whenever it's
+ * shaped, or any of the properties affecting line breaking change.
+ */
+struct shittygui::TextLayout {
+    /// Font to lay out text with
+    const TextFont *font{nullptr};
+
+    /// Text to lay out (with any markup removed)
+    std::string text;
+    /// Styled spans of the text
+    std::vector<TextSpan> spans;
+    /// Whether the text was set with markup
+    bool hasMarkup{false};
+
+    /// Horizontal alignment
+    TextAlign align{TextAlign::Left};
+    /// Whether lines are justified
+    bool justify{false};
+    /// Ellipsization mode
+    EllipsizeMode ellipsize{EllipsizeMode::None};
+    /// Whether newlines start new paragraphs (rather than being treated as spaces)
+    bool multiParagraph{false};
+    /// Whether lines are wrapped at word (rather than character) boundaries
+    bool wordWrap{true};
+    /// Whether glyph hinting is disabled (for fractional scale factors)
+    bool noHinting{false};
+
+    /// Maximum width and height of the laid out text, in pixels; negative for no limit
+    int width{-1}, height{-1};
+
+    /// Set when the text must be reshaped
+    bool shapeDirty{true};
+    /// Set when the text must be broken into lines again
+    bool linesDirty{true};
+
+    /// Shaping output
+    std::vector<ShapedGlyph> shaped;
+    /// Glyphs positioned on lines
+    std::vector<PlacedGlyph> placed;
+    /// Lines of text
+    std::vector<TextLine> lines;
+    /// Width of the widest line
+    float maxWidth{0};
+
+    /// HarfBuzz buffer used for shaping
+    hb_buffer_t *buffer{nullptr};
+    /// Glyph buffer for rendering
+    std::vector<cairo_glyph_t> glyphBuffer;
+};
+
+
+
+/**
+ * @brief Append a Unicode code point to a string, encoded as UTF-8
+ */
+static void AppendUtf8(std::string &out, const char32_t cp) {
+    if(cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if(cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if(cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if(cp < 0x110000) {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+/**
+ * @brief Trim leading and trailing whitespace off a string
+ */
+static std::string_view Trim(std::string_view str) {
+    while(!str.empty() && std::isspace(static_cast<unsigned char>(str.front()))) {
+        str.remove_prefix(1);
+    }
+    while(!str.empty() && std::isspace(static_cast<unsigned char>(str.back()))) {
+        str.remove_suffix(1);
+    }
+
+    return str;
+}
+
+/**
+ * @brief Compare two strings, ignoring case
+ */
+static bool EqualsIgnoringCase(const std::string_view a, const std::string_view b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) ==
+            std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+/**
+ * @brief Parse a hex color specification
+ *
+ * Colors may be specified as `#rgb`, `#rrggbb` or `#rrggbbaa`.
+ *
+ * @throw std::runtime_error If the color is invalid
+ */
+static Color ParseColor(const std::string_view str) {
+    uint32_t value{0};
+
+    if(str.size() < 2 || str.front() != '#') {
+        throw std::runtime_error("unsupported color (only hex colors are supported)");
+    }
+
+    const auto digits = str.substr(1);
+    auto res = std::from_chars(digits.data(), digits.data() + digits.size(), value, 16);
+    if(res.ec != std::errc() || res.ptr != digits.data() + digits.size()) {
+        throw std::runtime_error("invalid color");
+    }
+
+    switch(digits.size()) {
+        case 3:
+            return Color(((value >> 8) & 0xF) / 15.f, ((value >> 4) & 0xF) / 15.f,
+                    (value & 0xF) / 15.f);
+        case 6:
+            return Color(((value >> 16) & 0xFF) / 255.f, ((value >> 8) & 0xFF) / 255.f,
+                    (value & 0xFF) / 255.f);
+        case 8:
+            return Color(((value >> 24) & 0xFF) / 255.f, ((value >> 16) & 0xFF) / 255.f,
+                    ((value >> 8) & 0xFF) / 255.f, (value & 0xFF) / 255.f);
+        default:
+            throw std::runtime_error("invalid color");
+    }
+}
+
+/**
+ * @brief Apply the attributes of a `<span>` tag to a span
+ *
+ * @param attributes Attribute string of the tag (everything after the tag name)
+ * @param span Span to update
+ *
+ * @throw std::runtime_error If an attribute is malformed or unsupported
+ */
+static void ParseSpanAttributes(std::string_view attributes, TextSpan &span) {
+    while(!(attributes = Trim(attributes)).empty()) {
+        // split off name="value"
+        const auto equals = attributes.find('=');
+        if(equals == std::string_view::npos || equals + 1 >= attributes.size()) {
+            throw std::runtime_error("malformed markup attribute");
+        }
+
+        const auto name = Trim(attributes.substr(0, equals));
+        auto rest = Trim(attributes.substr(equals + 1));
+
+        const auto quote = rest.empty() ? '\0' : rest.front();
+        if(quote != '"' && quote != '\'') {
+            throw std::runtime_error("markup attribute values must be quoted");
+        }
+
+        const auto close = rest.find(quote, 1);
+        if(close == std::string_view::npos) {
+            throw std::runtime_error("unterminated markup attribute value");
+        }
+
+        const auto value = rest.substr(1, close - 1);
+        attributes = rest.substr(close + 1);
+
+        // apply it
+        if(name == "foreground" || name == "fgcolor" || name == "color") {
+            span.color = ParseColor(value);
+            span.hasColor = true;
+        } else if(name == "weight") {
+            int numeric{0};
+            std::from_chars(value.data(), value.data() + value.size(), numeric);
+
+            if(value == "bold" || value == "ultrabold" || value == "heavy" ||
+                    value == "semibold" || numeric >= 600) {
+                span.style |= TextSpan::Bold;
+            } else {
+                span.style &= ~TextSpan::Bold;
+            }
+        } else if(name == "style") {
+            if(value == "italic" || value == "oblique") {
+                span.style |= TextSpan::Italic;
+            } else {
+                span.style &= ~TextSpan::Italic;
+            }
+        } else if(name == "underline") {
+            if(value == "none") {
+                span.style &= ~TextSpan::Underline;
+            } else {
+                span.style |= TextSpan::Underline;
+            }
+        } else {
+            throw std::runtime_error("unsupported markup attribute");
+        }
+    }
+}
+
+/**
+ * @brief Parse markup
+ *
+ * Supports the subset of Pango markup described at the top of this file, as well as the
+ * predefined XML entities and numeric character references.
+ *
+ * @param in Markup string to parse
+ * @param outText String to receive the text, with markup removed
+ * @param outSpans Vector to receive the styled spans of the text
+ *
+ * @throw std::runtime_error If the markup is malformed, or uses unsupported features
+ */
+static void ParseMarkup(const std::string_view in, std::string &outText,
+        std::vector<TextSpan> &outSpans) {
+    std::vector<TextSpan> stack{TextSpan{0, 0}};
+    std::vector<std::string_view> tags;
+
+    outText.clear();
+    outSpans.clear();
+
+    // append text with the current style, extending the last span if possible
+    auto append = [&](const size_t start) {
+        const auto &style = stack.back();
+        const auto end = static_cast<uint32_t>(outText.size());
+        if(end == start) {
+            return;
+        }
+
+        if(!outSpans.empty()) {
+            auto &last = outSpans.back();
+
+            if(last.end == start && last.style == style.style &&
+                    last.hasColor == style.hasColor && (!style.hasColor ||
+                    (last.color.r == style.color.r && last.color.g == style.color.g &&
+                     last.color.b == style.color.b && last.color.a == style.color.a))) {
+                last.end = end;
+                return;
+            }
+        }
+
+        auto span = style;
+        span.start = static_cast<uint32_t>(start);
+        span.end = end;
+        outSpans.push_back(span);
+    };
+
+    size_t i{0};
+    while(i < in.size()) {
+        const auto start = outText.size();
+
+        // tags
+        if(in[i] == '<') {
+            const auto close = in.find('>', i);
+            if(close == std::string_view::npos) {
+                throw std::runtime_error("unterminated markup tag");
+            }
+
+            const auto tag = Trim(in.substr(i + 1, close - i - 1));
+            i = close + 1;
+
+            if(!tag.empty() && tag.front() == '/') {
+                const auto name = Trim(tag.substr(1));
+                if(tags.empty() || tags.back() != name) {
+                    throw std::runtime_error("mismatched markup closing tag");
+                }
+
+                tags.pop_back();
+                stack.pop_back();
+                continue;
+            }
+
+            const auto nameEnd = std::min(tag.find_first_of(" \t\r\n"), tag.size());
+            const auto name = tag.substr(0, nameEnd);
+            auto style = stack.back();
+
+            if(name == "b") {
+                style.style |= TextSpan::Bold;
+            } else if(name == "i") {
+                style.style |= TextSpan::Italic;
+            } else if(name == "u") {
+                style.style |= TextSpan::Underline;
+            } else if(name == "span") {
+                ParseSpanAttributes(tag.substr(nameEnd), style);
+            } else {
+                throw std::runtime_error("unsupported markup tag");
+            }
+
+            tags.push_back(name);
+            stack.push_back(style);
+        }
+        // entities
+        else if(in[i] == '&') {
+            const auto semi = in.find(';', i);
+            if(semi == std::string_view::npos) {
+                throw std::runtime_error("unterminated markup entity");
+            }
+
+            const auto entity = in.substr(i + 1, semi - i - 1);
+            i = semi + 1;
+
+            if(entity == "amp") {
+                outText.push_back('&');
+            } else if(entity == "lt") {
+                outText.push_back('<');
+            } else if(entity == "gt") {
+                outText.push_back('>');
+            } else if(entity == "quot") {
+                outText.push_back('"');
+            } else if(entity == "apos") {
+                outText.push_back('\'');
+            } else if(entity.size() > 1 && entity.front() == '#') {
+                const bool hex = (entity[1] == 'x' || entity[1] == 'X');
+                const auto digits = entity.substr(hex ? 2 : 1);
+                uint32_t cp{0};
+
+                auto res = std::from_chars(digits.data(), digits.data() + digits.size(), cp,
+                        hex ? 16 : 10);
+                if(res.ec != std::errc() || res.ptr != digits.data() + digits.size()) {
+                    throw std::runtime_error("invalid markup character reference");
+                }
+
+                AppendUtf8(outText, cp);
+            } else {
+                throw std::runtime_error("unsupported markup entity");
+            }
+
+            append(start);
+        }
+        // regular text
+        else {
+            const auto next = std::min(in.find_first_of("<&", i), in.size());
+            outText.append(in.substr(i, next - i));
+            i = next;
+
+            append(start);
+        }
+    }
+
+    if(!tags.empty()) {
+        throw std::runtime_error("unclosed markup tag");
+    }
+}
+
+
+
+/**
+ * @brief Find a font face with fontconfig, and load it
+ *
+ * @param families Comma separated list of font families
+ * @param weight Requested weight (fontconfig weight value)
+ * @param slant Requested slant (fontconfig slant value)
+ * @param outSynthesize Variable to receive the styles that must be synthesized, because the
+ *        matched face does not provide them
+ *
+ * @return Loaded font face (owned by the face cache)
+ *
+ * @throw std::runtime_error If no font could be found or loaded
+ */
+static FontFace *FindFace(const std::string_view families, const int weight, const int slant,
+        unsigned int &outSynthesize) {
+    std::lock_guard lg(gFacesLock);
+
+    if(!gFreeType) {
+        if(FT_Init_FreeType(&gFreeType)) {
+            throw std::runtime_error("failed to initialize FreeType");
+        }
+    }
+
+    // build the pattern
+    auto pattern = FcPatternCreate();
+
+    std::string_view remaining{families};
+    while(!remaining.empty()) {
+        const auto comma = std::min(remaining.find(','), remaining.size());
+        const std::string family(Trim(remaining.substr(0, comma)));
+        remaining.remove_prefix(std::min(comma + 1, remaining.size()));
+
+        if(!family.empty()) {
+            FcPatternAddString(pattern, FC_FAMILY,
+                    reinterpret_cast<const FcChar8 *>(family.c_str()));
+        }
+    }
+
+    FcPatternAddInteger(pattern, FC_WEIGHT, weight);
+    FcPatternAddInteger(pattern, FC_SLANT, slant);
+
+    FcConfigSubstitute(nullptr, pattern, FcMatchPattern);
+    FcDefaultSubstitute(pattern);
+
+    // find the best match
+    FcResult result;
+    auto match = FcFontMatch(nullptr, pattern, &result);
+    FcPatternDestroy(pattern);
+
+    if(!match) {
+        throw std::runtime_error("no matching font found");
+    }
+
+    FcChar8 *file{nullptr};
+    int index{0}, matchedWeight{weight}, matchedSlant{slant};
+
+    if(FcPatternGetString(match, FC_FILE, 0, &file) != FcResultMatch) {
+        FcPatternDestroy(match);
+        throw std::runtime_error("matched font has no file");
+    }
+
+    FcPatternGetInteger(match, FC_INDEX, 0, &index);
+    FcPatternGetInteger(match, FC_WEIGHT, 0, &matchedWeight);
+    FcPatternGetInteger(match, FC_SLANT, 0, &matchedSlant);
+
+    const std::string path(reinterpret_cast<const char *>(file));
+    FcPatternDestroy(match);
+
+    outSynthesize = 0;
+    if(weight >= FC_WEIGHT_BOLD && matchedWeight < FC_WEIGHT_DEMIBOLD) {
+        outSynthesize |= CAIRO_FT_SYNTHESIZE_BOLD;
+    }
+    if(slant != FC_SLANT_ROMAN && matchedSlant == FC_SLANT_ROMAN) {
+        outSynthesize |= CAIRO_FT_SYNTHESIZE_OBLIQUE;
+    }
+
+    // load it, if not already loaded
+    auto &face = gFaces[path + ':' + std::to_string(index)];
+    if(!face) {
+        FT_Face ft;
+        if(FT_New_Face(gFreeType, path.c_str(), index, &ft)) {
+            gFaces.erase(path + ':' + std::to_string(index));
+            throw std::runtime_error("failed to load font file");
+        }
+
+        face = std::make_unique<FontFace>();
+        face->ft = ft;
+        face->hb = hb_ft_face_create_referenced(ft);
+    }
+
+    return face.get();
+}
+
+/**
+ * @brief Get the Cairo font face for a font face, with the given styles synthesized
+ */
+static cairo_font_face_t *GetCairoFace(FontFace *face, const unsigned int synthesize) {
+    std::lock_guard lg(gFacesLock);
+
+    auto &cairoFace = face->cairo[synthesize & 3];
+    if(!cairoFace) {
+        cairoFace = cairo_ft_font_face_create_for_ft_face(face->ft, 0);
+        cairo_ft_font_face_set_synthesize(cairoFace, synthesize & 3);
+    }
+
+    return cairoFace;
+}
+
+/**
+ * @brief Create a font from a Pango style font description
+ *
+ * The description is a comma separated list of families, optionally followed by style words
+ * (such as "Bold" or "Italic") and a size, which is ignored.
+ *
+ * @param name Font description
+ * @param size Font size, in points
+ */
+static TextFont *CreateFont(const std::string_view name, const double size) {
+    /// Style words understood in font descriptions
+    struct StyleWord {
+        std::string_view word;
+        int weight;
+        int slant;
+    };
+    static const StyleWord kStyleWords[]{
+        {"Thin", FC_WEIGHT_THIN, -1},
+        {"Ultra-Light", FC_WEIGHT_ULTRALIGHT, -1},
+        {"Light", FC_WEIGHT_LIGHT, -1},
+        {"Book", FC_WEIGHT_BOOK, -1},
+        {"Regular", FC_WEIGHT_REGULAR, -1},
+        {"Normal", FC_WEIGHT_REGULAR, -1},
+        {"Medium", FC_WEIGHT_MEDIUM, -1},
+        {"Semi-Bold", FC_WEIGHT_DEMIBOLD, -1},
+        {"Demi-Bold", FC_WEIGHT_DEMIBOLD, -1},
+        {"Bold", FC_WEIGHT_BOLD, -1},
+        {"Ultra-Bold", FC_WEIGHT_ULTRABOLD, -1},
+        {"Heavy", FC_WEIGHT_HEAVY, -1},
+        {"Black", FC_WEIGHT_BLACK, -1},
+        {"Italic", -1, FC_SLANT_ITALIC},
+        {"Oblique", -1, FC_SLANT_OBLIQUE},
+    };
+
+    int weight{FC_WEIGHT_REGULAR}, slant{FC_SLANT_ROMAN};
+
+    // strip style words and sizes off the end
+    std::string_view families = Trim(name);
+    while(!families.empty()) {
+        const auto space = families.find_last_of(" \t");
+        const auto word = (space == std::string_view::npos) ? families :
+            families.substr(space + 1);
+
+        auto it = std::find_if(std::begin(kStyleWords), std::end(kStyleWords),
+                [&](const auto &style) {
+            return EqualsIgnoringCase(style.word, word);
+        });
+
+        double ignored;
+        if(it != std::end(kStyleWords)) {
+            if(it->weight != -1) {
+                weight = it->weight;
+            }
+            if(it->slant != -1) {
+                slant = it->slant;
+            }
+        } else if(std::from_chars(word.data(), word.data() + word.size(), ignored).ptr !=
+                word.data() + word.size()) {
+            break;
+        }
+
+        families = Trim(families.substr(0, (space == std::string_view::npos) ? 0 : space));
+    }
+
+    if(families.empty()) {
+        families = kDefaultFont;
+    }
+
+    // load the face, and create a HarfBuzz font for it
+    auto font = new TextFont;
+    font->name = name;
+    font->size = size;
+    font->face = FindFace(families, weight, slant, font->synthesize);
+
+    font->pixelSize = size * kFontDpi / 72.;
+    const auto scale = static_cast<int>(std::lround(font->pixelSize * kHbScale));
+
+    font->hb = hb_font_create(font->face->hb);
+    hb_font_set_scale(font->hb, scale, scale);
+
+    // get metrics
+    hb_font_extents_t extents;
+    hb_font_get_h_extents(font->hb, &extents);
+
+    font->ascent = extents.ascender / kHbScale;
+    font->lineHeight = (extents.ascender - extents.descender) / kHbScale;
+
+    const auto ft = font->face->ft;
+    const auto unitScale = font->pixelSize / std::max<double>(ft->units_per_EM, 1);
+    font->underlinePosition = -ft->underline_position * unitScale;
+    font->underlineThickness = std::max(ft->underline_thickness * unitScale, 1.);
+
+    // special glyphs
+    hb_codepoint_t glyph{0};
+    hb_font_get_nominal_glyph(font->hb, ' ', &glyph);
+    font->spaceGlyph = glyph;
+    font->spaceAdvance = hb_font_get_glyph_h_advance(font->hb, glyph) / kHbScale;
+
+    if(hb_font_get_nominal_glyph(font->hb, 0x2026, &glyph)) {
+        font->ellipsisCount = 1;
+    } else {
+        hb_font_get_nominal_glyph(font->hb, '.', &glyph);
+        font->ellipsisCount = 3;
+    }
+    font->ellipsisGlyph = glyph;
+    font->ellipsisAdvance = hb_font_get_glyph_h_advance(font->hb, glyph) / kHbScale;
+
+    return font;
+}
+
+
+
+/**
+ * @brief Shape a run of text
+ *
+ * @param layout Layout whose text to shape
+ * @param start Byte offset of the run
+ * @param end Byte offset past the end of the run
+ * @param span Index of the span the run belongs to
+ */
+static void ShapeRun(TextLayout &layout, const size_t start, const size_t end,
+        const uint16_t span) {
+    auto buf = layout.buffer;
+
+    hb_buffer_clear_contents(buf);
+    hb_buffer_add_utf8(buf, layout.text.data(), layout.text.size(), start, end - start);
+    hb_buffer_guess_segment_properties(buf);
+
+    hb_shape(layout.font->hb, buf, nullptr, 0);
+
+    unsigned int numGlyphs;
+    const auto infos = hb_buffer_get_glyph_infos(buf, &numGlyphs);
+    const auto positions = hb_buffer_get_glyph_positions(buf, &numGlyphs);
+
+    for(unsigned int i = 0; i < numGlyphs; i++) {
+        const auto cluster = infos[i].cluster;
+        const auto ch = layout.text[cluster];
+
+        layout.shaped.push_back({
+            infos[i].codepoint, cluster,
+            static_cast<float>(positions[i].x_advance / kHbScale),
+            static_cast<float>(positions[i].x_offset / kHbScale),
+            static_cast<float>(positions[i].y_offset / kHbScale),
+            span,
+            static_cast<uint8_t>((ch == ' ' || ch == '\t') ? ShapedGlyph::Space : 0),
+        });
+    }
+}
+
+/**
+ * @brief Shape the layout's text
+ *
+ * Each span is shaped separately; newlines are not shaped, but represented by a space glyph
+ * flagged as a newline.
+ */
+static void Shape(TextLayout &layout) {
+    layout.shaped.clear();
+
+    for(size_t i = 0; i < layout.spans.size(); i++) {
+        const auto &span = layout.spans[i];
+        size_t pos = span.start;
+
+        while(pos < span.end) {
+            const auto newline = layout.text.find('\n', pos);
+            const auto runEnd = std::min<size_t>(newline, span.end);
+
+            if(runEnd > pos) {
+                ShapeRun(layout, pos, runEnd, i);
+            }
+
+            if(runEnd < span.end) {
+                layout.shaped.push_back({layout.font->spaceGlyph, static_cast<uint32_t>(runEnd),
+                        layout.font->spaceAdvance, 0, 0, static_cast<uint16_t>(i),
+                        ShapedGlyph::Space | ShapedGlyph::Newline});
+                pos = runEnd + 1;
+            } else {
+                pos = runEnd;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Place a range of shaped glyphs on the current line
+ *
+ * @param layout Layout to place glyphs in
+ * @param start Index of the first shaped glyph
+ * @param end Index past the last shaped glyph
+ * @param x Pen position to start at
+ * @param extraSpace Additional advance for each space (for justification)
+ *
+ * @return Pen position after the last glyph
+ */
+static float PlaceGlyphs(TextLayout &layout, const size_t start, const size_t end, float x,
+        const float extraSpace = 0) {
+    for(size_t i = start; i < end; i++) {
+        const auto &g = layout.shaped[i];
+        const auto advance = g.advance + ((g.flags & ShapedGlyph::Space) ? extraSpace : 0);
+
+        layout.placed.push_back({g.id, g.cluster, x, advance, g.xOffset, g.yOffset, g.span});
+        x += advance;
+    }
+
+    return x;
+}
+
+/**
+ * @brief Find the end of a range of whole clusters that fits in the given width
+ *
+ * @param layout Layout containing the shaped glyphs
+ * @param start Index of the first glyph
+ * @param end Index past the last glyph to consider
+ * @param width Available width
+ * @param outWidth Variable to receive the width of the glyphs that fit
+ *
+ * @return Index past the last glyph that fits
+ */
+static size_t FitForward(const TextLayout &layout, const size_t start, const size_t end,
+        const float width, float &outWidth) {
+    float x{0};
+    size_t i{start}, fits{start};
+
+    while(i < end) {
+        // measure the whole cluster
+        const auto cluster = layout.shaped[i].cluster;
+        float clusterWidth{0};
+        size_t next{i};
+
+        while(next < end && layout.shaped[next].cluster == cluster) {
+            clusterWidth += layout.shaped[next++].advance;
+        }
+
+        if(x + clusterWidth > width) {
+            break;
+        }
+
+        x += clusterWidth;
+        i = fits = next;
+    }
+
+    outWidth = x;
+    return fits;
+}
+
+/**
+ * @brief Find the start of a range of whole clusters, ending at the given glyph, that fits in the
+ *        given width
+ *
+ * @see FitForward
+ */
+static size_t FitBackward(const TextLayout &layout, const size_t start, const size_t end,
+        const float width, float &outWidth) {
+    float x{0};
+    size_t i{end}, fits{end};
+
+    while(i > start) {
+        const auto cluster = layout.shaped[i - 1].cluster;
+        float clusterWidth{0};
+        size_t prev{i};
+
+        while(prev > start && layout.shaped[prev - 1].cluster == cluster) {
+            clusterWidth += layout.shaped[--prev].advance;
+        }
+
+        if(x + clusterWidth > width) {
+            break;
+        }
+
+        x += clusterWidth;
+        i = fits = prev;
+    }
+
+    outWidth = x;
+    return fits;
+}
+
+/**
+ * @brief Add a line to the layout
+ *
+ * @param layout Layout to add the line to
+ * @param start Index of the line's first shaped glyph
+ * @param end Index past the line's last shaped glyph
+ * @param justify Whether the line should be justified to the layout width
+ * @param ellipsize Whether the line should be ellipsized if it doesn't fit the layout width
+ */
+static void AddLine(TextLayout &layout, const size_t start, size_t end, const bool justify,
+        const bool ellipsize) {
+    const auto limit = static_cast<float>(layout.width);
+
+    // trailing whitespace doesn't count
+    while(end > start && (layout.shaped[end - 1].flags & ShapedGlyph::Space)) {
+        end--;
+    }
+
+    float width{0};
+    for(size_t i = start; i < end; i++) {
+        width += layout.shaped[i].advance;
+    }
+
+    TextLine line{static_cast<uint32_t>(layout.placed.size()), 0, 0, width};
+
+    // ellipsize the line if it's too long
+    if(ellipsize && layout.width >= 0 && width > limit) {
+        const auto font = layout.font;
+        const auto ellipsisWidth = font->ellipsisAdvance * font->ellipsisCount;
+        const auto available = std::max(limit - ellipsisWidth, 0.f);
+
+        size_t prefixEnd{start}, suffixStart{end};
+        float prefixWidth{0}, suffixWidth{0};
+
+        switch(layout.ellipsize) {
+            case EllipsizeMode::Start:
+                suffixStart = FitBackward(layout, start, end, available, suffixWidth);
+                break;
+            case EllipsizeMode::Middle:
+                prefixEnd = FitForward(layout, start, end, available / 2, prefixWidth);
+                suffixStart = FitBackward(layout, prefixEnd, end, available - prefixWidth,
+                        suffixWidth);
+                break;
+            case EllipsizeMode::End:
+            default:
+                prefixEnd = FitForward(layout, start, end, available, prefixWidth);
+                break;
+        }
+
+        auto x = PlaceGlyphs(layout, start, prefixEnd, 0);
+
+        const auto &elided = layout.shaped[std::min(prefixEnd, end - 1)];
+        for(size_t i = 0; i < font->ellipsisCount; i++) {
+            layout.placed.push_back({font->ellipsisGlyph, elided.cluster, x, font->ellipsisAdvance,
+                    0, 0, elided.span});
+            x += font->ellipsisAdvance;
+        }
+
+        line.width = PlaceGlyphs(layout, suffixStart, end, x);
+    }
+    // justify it by widening spaces
+    else if(justify && layout.width >= 0 && width < limit) {
+        size_t spaces{0};
+        for(size_t i = start; i < end; i++) {
+            if(layout.shaped[i].flags & ShapedGlyph::Space) {
+                spaces++;
+            }
+        }
+
+        const auto extra = spaces ? (limit - width) / spaces : 0.f;
+        line.width = PlaceGlyphs(layout, start, end, 0, extra);
+    }
+    // otherwise, place the glyphs as they are
+    else {
+        PlaceGlyphs(layout, start, end, 0);
+    }
+
+    line.count = static_cast<uint32_t>(layout.placed.size()) - line.first;
+
+    layout.maxWidth = std::max(layout.maxWidth, line.width);
+    layout.lines.push_back(line);
+}
+
+/**
+ * @brief Break the shaped text into lines
+ *
+ * Lines are broken at newlines (if the layout has multiple paragraphs) and, if the layout has a
+ * width, wherever the text would exceed it: after the last space that fits for word wrapping, or
+ * at the last character that fits otherwise (and for words wider than a line.)
+ *
+ * If the layout is ellipsized and has a height, lines that don't fit are removed, and the last
+ * line that fits is ellipsized.
+ */
+static void BreakLines(TextLayout &layout) {
+    const auto limit = static_cast<float>(layout.width);
+    const auto numGlyphs = layout.shaped.size();
+
+    size_t maxLines{std::numeric_limits<size_t>::max()};
+    if(layout.ellipsize != EllipsizeMode::None && layout.height >= 0) {
+        maxLines = std::max<size_t>(1, std::floor(layout.height / layout.font->lineHeight));
+    }
+
+    layout.placed.clear();
+    layout.lines.clear();
+    layout.maxWidth = 0;
+
+    size_t start{0};
+    while(true) {
+        size_t end{numGlyphs}, next{numGlyphs}, lastBreak{0};
+        bool newline{false}, wrapped{false};
+        float x{0};
+
+        for(size_t i = start; i < numGlyphs; i++) {
+            const auto &g = layout.shaped[i];
+
+            if((g.flags & ShapedGlyph::Newline) && layout.multiParagraph) {
+                end = i;
+                next = i + 1;
+                newline = true;
+                break;
+            }
+
+            if(layout.width >= 0 && x + g.advance > limit && i > start &&
+                    !(g.flags & ShapedGlyph::Space)) {
+                if(layout.wordWrap && lastBreak > start) {
+                    end = lastBreak;
+                } else {
+                    // don't break inside a cluster
+                    end = i;
+                    while(end > start + 1 &&
+                            layout.shaped[end].cluster == layout.shaped[end - 1].cluster) {
+                        end--;
+                    }
+                }
+
+                next = end;
+                wrapped = true;
+                break;
+            }
+
+            x += g.advance;
+            if(g.flags & ShapedGlyph::Space) {
+                lastBreak = i + 1;
+            }
+        }
+
+        // the last line that fits gets the rest of the paragraph, ellipsized
+        if(wrapped && layout.lines.size() + 1 >= maxLines) {
+            size_t paragraphEnd{end};
+            while(paragraphEnd < numGlyphs && !(layout.multiParagraph &&
+                        (layout.shaped[paragraphEnd].flags & ShapedGlyph::Newline))) {
+                paragraphEnd++;
+            }
+
+            AddLine(layout, start, paragraphEnd, false, true);
+            break;
+        }
+
+        AddLine(layout, start, end, layout.justify && wrapped, false);
+
+        if(next >= numGlyphs) {
+            // text ending in a newline has an empty last line
+            if(newline && layout.lines.size() < maxLines) {
+                AddLine(layout, numGlyphs, numGlyphs, false, false);
+            }
+            break;
+        } else if(layout.lines.size() >= maxLines) {
+            break;
+        }
+
+        start = next;
+    }
+
+    // align the lines
+    const auto alignWidth = (layout.width >= 0) ? limit : layout.maxWidth;
+
+    for(auto &line : layout.lines) {
+        switch(layout.align) {
+            case TextAlign::Left:
+                line.x = 0;
+                break;
+            case TextAlign::Center:
+                line.x = (alignWidth - line.width) / 2.f;
+                break;
+            case TextAlign::Right:
+                line.x = alignWidth - line.width;
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Make sure the layout is up to date
+ *
+ * Shapes the text and breaks it into lines, if needed.
+ */
+static void UpdateLayout(TextLayout &layout) {
+    if(!layout.font) {
+        if(!gDefaultFont) {
+            gDefaultFont = CreateFont(kDefaultFont, kDefaultFontSize);
+        }
+        layout.font = gDefaultFont;
+        layout.shapeDirty = true;
+    }
+
+    if(layout.shapeDirty) {
+        Shape(layout);
+        layout.shapeDirty = false;
+        layout.linesDirty = true;
+    }
+
+    if(layout.linesDirty) {
+        BreakLines(layout);
+        layout.linesDirty = false;
+    }
+}
+
+/**
+ * @brief Set the size limits of the layout
+ *
+ * @param width Maximum width, in pixels, or -1 for no limit
+ * @param height Maximum height, in pixels, or -1 for no limit
+ */
+static void SetLayoutSize(TextLayout &layout, const int width, const int height) {
+    if(width != layout.width) {
+        layout.linesDirty = true;
+    }
+    // the height only affects ellipsized layouts
+    if(height != layout.height && layout.ellipsize != EllipsizeMode::None) {
+        layout.linesDirty = true;
+    }
+
+    layout.width = width;
+    layout.height = height;
+}
+
+/**
+ * @brief Get the height of the laid out text, in pixels
+ */
+static inline int GetLayoutHeight(const TextLayout &layout) {
+    return std::ceil(layout.lines.size() * layout.font->lineHeight);
+}
+
+/**
+ * @brief Render the layout
+ *
+ * Consecutive glyphs with the same style are drawn together.
+ *
+ * @param layout Layout to render (it must be up to date)
+ * @param drawCtx Cairo context to render into
+ * @param originX Left edge of the layout
+ * @param originY Top edge of the layout
+ * @param color Color of text without an explicit color
+ */
+static void RenderLayout(TextLayout &layout, cairo_t *drawCtx, const double originX,
+        const double originY, const Color &color) {
+    const auto font = layout.font;
+
+    cairo_save(drawCtx);
+
+    if(layout.noHinting) {
+        auto options = cairo_font_options_create();
+        cairo_font_options_set_hint_style(options, CAIRO_HINT_STYLE_NONE);
+        cairo_font_options_set_hint_metrics(options, CAIRO_HINT_METRICS_OFF);
+        cairo_set_font_options(drawCtx, options);
+        cairo_font_options_destroy(options);
+    }
+
+    for(size_t l = 0; l < layout.lines.size(); l++) {
+        const auto &line = layout.lines[l];
+        const auto lineX = originX + line.x;
+        const auto baseline = originY + (l * font->lineHeight) + font->ascent;
+
+        size_t i{line.first};
+        const size_t end{line.first + line.count};
+
+        while(i < end) {
+            // find all glyphs with the same span
+            const auto spanIndex = layout.placed[i].span;
+            const auto &span = layout.spans[spanIndex];
+
+            layout.glyphBuffer.clear();
+            const auto runStart = i;
+
+            for(; i < end && layout.placed[i].span == spanIndex; i++) {
+                const auto &g = layout.placed[i];
+                layout.glyphBuffer.push_back({g.id, lineX + g.x + g.xOffset,
+                        baseline - g.yOffset});
+            }
+
+            // set up the font and draw
+            unsigned int synthesize{font->synthesize};
+            if(span.style & TextSpan::Bold) {
+                synthesize |= CAIRO_FT_SYNTHESIZE_BOLD;
+            }
+            if(span.style & TextSpan::Italic) {
+                synthesize |= CAIRO_FT_SYNTHESIZE_OBLIQUE;
+            }
+
+            cairo_set_font_face(drawCtx, GetCairoFace(font->face, synthesize));
+            cairo_set_font_size(drawCtx, font->pixelSize);
+            cairo::SetSource(drawCtx, span.hasColor ? span.color : color);
+
+            cairo_show_glyphs(drawCtx, layout.glyphBuffer.data(), layout.glyphBuffer.size());
+
+            if(span.style & TextSpan::Underline) {
+                const auto &first = layout.placed[runStart];
+                const auto &last = layout.placed[i - 1];
+
+                cairo_rectangle(drawCtx, lineX + first.x, baseline + font->underlinePosition,
+                        (last.x + last.advance) - first.x, font->underlineThickness);
+                cairo_fill(drawCtx);
+            }
+        }
+    }
+
+    cairo_restore(drawCtx);
+}
+
+
+
+/**
+ * @brief Initialize the text layout
+ *
+ * The layout is by default configured for single paragraph operation, with left alignment.
+ *
+ * @param drawCtx Cairo drawing context to render text onto
+ */
+void TextRendering::initTextResources(cairo_t *drawCtx) {
+    this->layout = new TextLayout;
+    this->layout->buffer = hb_buffer_create();
+
+    // disable hinting with fractional scale factors (see the Pango backend)
+    cairo_matrix_t m;
+    cairo_get_matrix(drawCtx, &m);
+
+    const auto scale = std::hypot(m.xx, m.yx);
+    this->layout->noHinting = (std::abs(scale - std::round(scale)) > 1e-3);
+
+    this->updateLayoutBytes(0);
+
+    this->setTextLayoutWrapMode(false, true);
+    this->setTextLayoutAlign(TextAlign::Left, false);
+}
+
+/**
+ * @brief Release the text layout
+ */
+void TextRendering::releaseTextResources() {
+    if(this->layout) {
+        hb_buffer_destroy(this->layout->buffer);
+        delete this->layout;
+        this->layout = nullptr;
+
+        memory::Freed(MemoryCategory::TextLayouts, this->layoutBytes);
+        this->layoutBytes = 0;
+    }
+}
+
+/**
+ * @brief Load a font
+ *
+ * Fonts are located with fontconfig. Names are parsed like Pango font descriptions: a comma
+ * separated list of families, followed by optional weight and style words, such as "Liberation
+ * Sans Bold Italic".
+ *
+ * @param name Font name
+ * @param size Font size, in points
+ *
+ * @return Font, to be released with ReleaseFont()
+ */
+TextFont *TextRendering::getFont(const std::string_view name, const double size) const {
+    return CreateFont(name, size);
+}
+
+/**
+ * @brief Release a font returned by getFont()
+ *
+ * The font face remains loaded, so it can be reused without reloading it.
+ */
+void TextRendering::ReleaseFont(TextFont *font) {
+    if(font) {
+        hb_font_destroy(font->hb);
+        delete font;
+    }
+}
+
+/**
+ * @brief Get the name of a font
+ *
+ * This is the name it was created with, without the size.
+ */
+std::string TextRendering::GetFontName(const TextFont *font) {
+    return font->name;
+}
+
+/**
+ * @brief Get the size of a font, in points
+ */
+double TextRendering::GetFontSize(const TextFont *font) {
+    return font->size;
+}
+
+/**
+ * @brief Set the font of the text layout
+ *
+ * @param font Font to use; it must remain valid until the layout is released, or another font
+ *        is set.
+ *
+ * @remark Fonts are compared by address to find out whether the text must be shaped again, so
+ *         a font must be detached from the layout (by setting another font, or `nullptr`) before
+ *         it's released: a font loaded afterwards may be allocated at the same address.
+ */
+void TextRendering::setTextFont(const TextFont *font) {
+    if(this->layout->font != font) {
+        this->layout->font = font;
+        this->layout->shapeDirty = true;
+    }
+}
+
+/**
+ * @brief Render a specified string set on the layout context
+ *
+ * @param Cairo drawing context to render into
+ * @param bounds Frame rectangle of the resulting text
+ * @param color Color to render the text in
+ * @param str String to render (it is applied to the layout)
+ * @param parseMarkup Whether markup should be parsed in the string content
+ */
+void TextRendering::drawString(cairo_t *drawCtx, const Rect &bounds, const Color &color,
+        const std::string_view &str, const VerticalAlign valign, const bool parseMarkup) {
+    this->setTextContent(str, parseMarkup);
+    this->drawString(drawCtx, bounds, color, valign);
+}
+
+/**
+ * @brief Render the last string set on the layout context
+ *
+ * @param Cairo drawing context to render into
+ * @param bounds Frame rectangle of the resulting text
+ * @param color Color to render the text in
+ */
+void TextRendering::drawString(cairo_t *drawCtx, const Rect &bounds, const Color &color,
+        const VerticalAlign valign) {
+    auto &layout = *this->layout;
+    SHITTYGUI_TRACE(text__layout__start, this, layout.text.size());
+
+    SetLayoutSize(layout, bounds.size.width, bounds.size.height);
+    UpdateLayout(layout);
+
+    const auto yOffset = GetVerticalOffset(bounds, GetLayoutHeight(layout), valign);
+    RenderLayout(layout, drawCtx, bounds.origin.x, bounds.origin.y + yOffset, color);
+
+    SHITTYGUI_TRACE(text__layout__done, this);
+}
+
+/**
+ * @brief Get the area covered by the text in the layout
+ *
+ * This is the logical extents of the laid out lines, positioned the same way as drawString()
+ * would draw them.
+ *
+ * @param bounds Frame rectangle of the text
+ * @param valign Vertical alignment of the text
+ *
+ * @return Rectangle covering the text, clipped to the bounds
+ */
+Rect TextRendering::getTextExtents(const Rect &bounds, const VerticalAlign valign) {
+    auto &layout = *this->layout;
+
+    SetLayoutSize(layout, bounds.size.width, bounds.size.height);
+    UpdateLayout(layout);
+
+    float minX{std::numeric_limits<float>::max()}, maxX{0};
+    for(const auto &line : layout.lines) {
+        minX = std::min(minX, line.x);
+        maxX = std::max(maxX, line.x + line.width);
+    }
+    if(layout.lines.empty()) {
+        minX = 0;
+    }
+
+    const auto height = GetLayoutHeight(layout);
+    const auto yOffset = GetVerticalOffset(bounds, height, valign);
+
+    // expand by a pixel on each side to account for antialiasing and synthesized styles
+    const Rect extents({static_cast<int16_t>(bounds.origin.x + std::floor(minX) - 1),
+            static_cast<int16_t>(bounds.origin.y + yOffset - 1)},
+            Size(std::ceil(maxX - std::floor(minX)) + 2, height + 2));
+    return extents.intersection(bounds);
+}
+
+/**
+ * @brief Measure the text, without ellipsizing it
+ *
+ * @param width Maximum width of the text, in pixels (lines wider than this are wrapped,) or -1 for
+ *        no limit
+ *
+ * @return Logical size of the laid out text
+ */
+Size TextRendering::measureText(const int width) {
+    auto &layout = *this->layout;
+
+    const auto ellipsize = layout.ellipsize;
+    this->setTextLayoutEllipsization(EllipsizeMode::None);
+
+    SetLayoutSize(layout, width, -1);
+    UpdateLayout(layout);
+
+    const Size size(std::ceil(layout.maxWidth), GetLayoutHeight(layout));
+
+    this->setTextLayoutEllipsization(ellipsize);
+    return size;
+}
+
+/**
+ * @brief Render the text as a single line, without a width limit
+ *
+ * @param drawCtx Cairo drawing context to render into
+ * @param origin Top left corner of the text
+ * @param color Color to render the text in
+ */
+void TextRendering::drawTextLine(cairo_t *drawCtx, const Point origin, const Color &color) {
+    auto &layout = *this->layout;
+    SHITTYGUI_TRACE(text__layout__start, this, layout.text.size());
+
+    SetLayoutSize(layout, -1, -1);
+    UpdateLayout(layout);
+
+    RenderLayout(layout, drawCtx, origin.x, origin.y, color);
+
+    SHITTYGUI_TRACE(text__layout__done, this);
+}
+
+/**
+ * @brief Get the logical size of the text laid out as a single line
+ */
+Size TextRendering::getTextLineSize() {
+    auto &layout = *this->layout;
+
+    SetLayoutSize(layout, -1, -1);
+    UpdateLayout(layout);
+
+    return Size(std::ceil(layout.maxWidth), GetLayoutHeight(layout));
+}
+
+/**
+ * @brief Get the position of each character of the text laid out as a single line
+ *
+ * Characters that are shaped together (such as ligatures) share a position.
+ *
+ * @param out Vector to receive the positions, in ascending order of byte offset; it's terminated
+ *        by the position of the end of the text.
+ */
+void TextRendering::getCharacterPositions(std::vector<CharacterPosition> &out) {
+    auto &layout = *this->layout;
+
+    SetLayoutSize(layout, -1, -1);
+    UpdateLayout(layout);
+
+    out.clear();
+
+    float end{0};
+    if(!layout.lines.empty()) {
+        const auto &line = layout.lines.front();
+
+        for(size_t i = line.first; i < line.first + line.count; i++) {
+            const auto &g = layout.placed[i];
+            if(out.empty() || out.back().index != g.cluster) {
+                out.push_back({g.cluster, static_cast<int32_t>(std::lround(line.x + g.x))});
+            }
+        }
+
+        end = line.x + line.width;
+    }
+
+    out.push_back({static_cast<uint32_t>(layout.text.size()),
+            static_cast<int32_t>(std::lround(end))});
+}
+
+/**
+ * @brief Update the text alignment and justification settings of the text layout
+ *
+ * @param newAlign New horizontal alignment setting
+ * @param justified Whether text is justified
+ */
+void TextRendering::setTextLayoutAlign(const TextAlign newAlign, const bool justified) {
+    auto &layout = *this->layout;
+
+    if(layout.align != newAlign || layout.justify != justified) {
+        layout.align = newAlign;
+        layout.justify = justified;
+        layout.linesDirty = true;
+    }
+}
+
+/**
+ * @brief Update the text ellipsization mode of the text layout
+ *
+ * @param newMode Text ellipsization mode to set
+ */
+void TextRendering::setTextLayoutEllipsization(const EllipsizeMode newMode) {
+    auto &layout = *this->layout;
+
+    if(layout.ellipsize != newMode) {
+        layout.ellipsize = newMode;
+        layout.linesDirty = true;
+    }
+}
+
+/**
+ * @brief Update the wrapping and line break mode
+ *
+ * @param multiParagraph Whether the text renderer renders multiple paragraphs
+ * @param wordWrap Whether lines are wrapped on word (`true`) or character (`false`) boundaries
+ */
+void TextRendering::setTextLayoutWrapMode(const bool multiParagraph, const bool wordWrap) {
+    auto &layout = *this->layout;
+
+    if(layout.multiParagraph != multiParagraph || layout.wordWrap != wordWrap) {
+        layout.multiParagraph = multiParagraph;
+        layout.wordWrap = wordWrap;
+        layout.linesDirty = true;
+    }
+}
+
+
+
+/**
+ * @brief Set the text content of the text layout
+ *
+ * If specified, the text is parsed for markup, which can change the style of parts of it. Only a
+ * subset of Pango's markup is supported; see the description at the top of this file.
+ *
+ * @param str String to set
+ * @param parseMarkup Whether markup should be parsed
+ *
+ * @throw std::runtime_error If the markup is invalid or unsupported
+ */
+void TextRendering::setTextContent(const std::string_view &str, const bool parseMarkup) {
+    auto &layout = *this->layout;
+
+    // plain text that didn't change doesn't need to be shaped again
+    if(!parseMarkup && !layout.hasMarkup && layout.text == str) {
+        return;
+    }
+
+    this->updateLayoutBytes(str.length());
+
+    if(parseMarkup) {
+        ParseMarkup(str, layout.text, layout.spans);
+    } else {
+        layout.text.assign(str);
+        layout.spans.assign(1, TextSpan{0, static_cast<uint32_t>(str.size())});
+    }
+
+    layout.hasMarkup = parseMarkup;
+    layout.shapeDirty = true;
+}
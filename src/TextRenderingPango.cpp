@@ -0,0 +1,454 @@
+/**
+ * @file
+ *
+ * @brief Pango text rendering backend
+ *
+ * Lays out and renders text with Pango, through its Cairo integration. This supports everything
+ * Pango does, including its full markup language, bidirectional text and complex scripts.
+ */
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+#include <cairo.h>
+#include <pango/pangocairo.h>
+
+#include "CairoHelpers.h"
+#include "MemoryAccounting.h"
+#include "Tracing.h"
+#include "Util.h"
+#include "TextRendering.h"
+
+using namespace shittygui;
+
+/**
+ * @brief Pango font
+ */
+struct shittygui::TextFont {
+    /// Pango font description
+    PangoFontDescription *desc;
+};
+
+/**
+ * @brief Pango text layout
+ */
+struct shittygui::TextLayout {
+    /// Pango layout object
+    PangoLayout *layout;
+};
+
+
+
+/**
+ * @brief Initialize the Pango text layout context
+ *
+ * This context is by default configured for single paragraph operation, with left alignment.
+ *
+ * @param drawCtx Cairo drawing context to render text onto
+ */
+void TextRendering::initTextResources(cairo_t *drawCtx) {
+    this->layout = new TextLayout{pango_cairo_create_layout(drawCtx)};
+
+    /*
+     * With fractional scale factors, hinting would snap glyph outlines and metrics to the pixel
+     * grid of the unscaled font size, resulting in uneven spacing; so disable it.
+     */
+    cairo_matrix_t m;
+    cairo_get_matrix(drawCtx, &m);
+
+    const auto scale = std::hypot(m.xx, m.yx);
+    if(std::abs(scale - std::round(scale)) > 1e-3) {
+        auto options = cairo_font_options_create();
+        cairo_font_options_set_hint_style(options, CAIRO_HINT_STYLE_NONE);
+        cairo_font_options_set_hint_metrics(options, CAIRO_HINT_METRICS_OFF);
+
+        pango_cairo_context_set_font_options(pango_layout_get_context(this->layout->layout),
+                options);
+        cairo_font_options_destroy(options);
+    }
+
+    this->updateLayoutBytes(0);
+
+    this->setTextLayoutWrapMode(false, true);
+    this->setTextLayoutAlign(TextAlign::Left, false);
+}
+
+/**
+ * @brief Clean up the allocated Pango resources
+ */
+void TextRendering::releaseTextResources() {
+    if(this->layout) {
+        g_object_unref(this->layout->layout);
+        delete this->layout;
+        this->layout = nullptr;
+
+        memory::Freed(MemoryCategory::TextLayouts, this->layoutBytes);
+        this->layoutBytes = 0;
+    }
+}
+
+/**
+ * @brief Parse a font descriptor string
+ *
+ * Fonts are automatically loaded using the system's font discovery mechanism. Names are parsed as
+ * [Pango FontDescriptions](https://docs.gtk.org/Pango/type_func.FontDescription.from_string.html)
+ * so you can customize the style, variants, weight, gravity, and stretch values of the font.
+ *
+ * @param name Font name
+ * @param size Font size, in points
+ *
+ * @return Font, to be released with ReleaseFont()
+ */
+TextFont *TextRendering::getFont(const std::string_view name, const double size) const {
+    const std::string nameStr(name);
+
+    auto desc = pango_font_description_from_string(nameStr.c_str());
+    pango_font_description_set_size(desc, size * PANGO_SCALE);
+
+    return new TextFont{desc};
+}
+
+/**
+ * @brief Release a font returned by getFont()
+ */
+void TextRendering::ReleaseFont(TextFont *font) {
+    if(font) {
+        pango_font_description_free(font->desc);
+        delete font;
+    }
+}
+
+/**
+ * @brief Get the name of a font
+ *
+ * This is its description string, without the size; it can be passed to getFont() again.
+ */
+std::string TextRendering::GetFontName(const TextFont *font) {
+    auto desc = pango_font_description_copy(font->desc);
+    pango_font_description_unset_fields(desc, PANGO_FONT_MASK_SIZE);
+    auto name = pango_font_description_to_string(desc);
+
+    std::string nameStr(name);
+
+    g_free(name);
+    pango_font_description_free(desc);
+
+    return nameStr;
+}
+
+/**
+ * @brief Get the size of a font, in points
+ */
+double TextRendering::GetFontSize(const TextFont *font) {
+    return static_cast<double>(pango_font_description_get_size(font->desc)) / PANGO_SCALE;
+}
+
+/**
+ * @brief Set the font of the text layout
+ *
+ * @param font Font to use; it must remain valid until the layout is released, or another font
+ *        is set.
+ */
+void TextRendering::setTextFont(const TextFont *font) {
+    pango_layout_set_font_description(this->layout->layout, font ? font->desc : nullptr);
+}
+
+/**
+ * @brief Render a specified string set on the layout context
+ *
+ * @param Cairo drawing context to render into
+ * @param bounds Frame rectangle of the resulting text
+ * @param color Color to render the text in
+ * @param str String to render (it is applied to the layout)
+ * @param parseMarkup Whether Pango markup should be parsed in the string content
+ *
+ * @remark The render context should have its "current point" set as the origin of the text.
+ */
+void TextRendering::drawString(cairo_t *drawCtx, const Rect &bounds, const Color &color,
+        const std::string_view &str, const VerticalAlign valign, const bool parseMarkup) {
+    this->setTextContent(str, parseMarkup);
+    this->drawString(drawCtx, bounds, color, valign);
+}
+
+/**
+ * @brief Render the last string set on the layout context
+ *
+ * @param Cairo drawing context to render into
+ * @param bounds Frame rectangle of the resulting text
+ * @param color Color to render the text in
+ *
+ * @remark The render context should have its "current point" set as the origin of the text.
+ */
+void TextRendering::drawString(cairo_t *drawCtx, const Rect &bounds, const Color &color,
+        const VerticalAlign valign) {
+    auto layout = this->layout->layout;
+    int width, height;
+    double pX, pY;
+
+    SHITTYGUI_TRACE(text__layout__start, this, strlen(pango_layout_get_text(layout)));
+
+    cairo_move_to(drawCtx, bounds.origin.x, bounds.origin.y);
+
+    // lay out the text and get its size
+    pango_layout_set_width(layout, bounds.size.width * PANGO_SCALE);
+    pango_layout_set_height(layout, bounds.size.height * PANGO_SCALE);
+
+    pango_cairo_update_layout(drawCtx, layout);
+
+    pango_layout_get_size(layout, &width, &height);
+
+    // perform vertical align offsetting
+    cairo_get_current_point(drawCtx, &pX, &pY);
+
+    if(valign != VerticalAlign::Top) {
+        pY += GetVerticalOffset(bounds, height / PANGO_SCALE, valign);
+        cairo_move_to(drawCtx, pX, pY);
+    }
+
+    // render it
+    cairo::SetSource(drawCtx, color);
+    pango_cairo_show_layout(drawCtx, layout);
+
+    SHITTYGUI_TRACE(text__layout__done, this);
+}
+
+/**
+ * @brief Get the area covered by the text in the layout
+ *
+ * Determines the ink extents of the text, positioned the same way as drawString() would draw it.
+ * This can be used to invalidate only the part of a widget covered by text.
+ *
+ * @param bounds Frame rectangle of the text
+ * @param valign Vertical alignment of the text
+ *
+ * @return Rectangle covering the text, clipped to the bounds
+ */
+Rect TextRendering::getTextExtents(const Rect &bounds, const VerticalAlign valign) {
+    auto layout = this->layout->layout;
+    PangoRectangle ink, logical;
+    int width, height;
+
+    pango_layout_set_width(layout, bounds.size.width * PANGO_SCALE);
+    pango_layout_set_height(layout, bounds.size.height * PANGO_SCALE);
+
+    pango_layout_get_size(layout, &width, &height);
+    pango_layout_get_pixel_extents(layout, &ink, &logical);
+
+    const auto yOffset = GetVerticalOffset(bounds, height / PANGO_SCALE, valign);
+
+    // expand by a pixel on each side to account for antialiasing
+    const Rect extents({static_cast<int16_t>(bounds.origin.x + ink.x - 1),
+            static_cast<int16_t>(bounds.origin.y + yOffset + ink.y - 1)},
+            Size(ink.width + 2, ink.height + 2));
+    return extents.intersection(bounds);
+}
+
+/**
+ * @brief Measure the text, without ellipsizing it
+ *
+ * @param width Maximum width of the text, in pixels (lines wider than this are wrapped,) or -1 for
+ *        no limit
+ *
+ * @return Logical size of the laid out text
+ */
+Size TextRendering::measureText(const int width) {
+    auto layout = this->layout->layout;
+    PangoRectangle ink, logical;
+
+    const auto ellipsize = pango_layout_get_ellipsize(layout);
+    pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_NONE);
+
+    pango_layout_set_width(layout, (width >= 0) ? width * PANGO_SCALE : -1);
+    pango_layout_set_height(layout, -1);
+    pango_layout_get_pixel_extents(layout, &ink, &logical);
+
+    pango_layout_set_ellipsize(layout, ellipsize);
+
+    return Size(logical.width, logical.height);
+}
+
+/**
+ * @brief Render the text as a single line, without a width limit
+ *
+ * @param drawCtx Cairo drawing context to render into
+ * @param origin Top left corner of the text
+ * @param color Color to render the text in
+ */
+void TextRendering::drawTextLine(cairo_t *drawCtx, const Point origin, const Color &color) {
+    auto layout = this->layout->layout;
+
+    SHITTYGUI_TRACE(text__layout__start, this, strlen(pango_layout_get_text(layout)));
+
+    pango_layout_set_width(layout, -1);
+    pango_cairo_update_layout(drawCtx, layout);
+
+    cairo_move_to(drawCtx, origin.x, origin.y);
+    cairo::SetSource(drawCtx, color);
+    pango_cairo_show_layout(drawCtx, layout);
+
+    SHITTYGUI_TRACE(text__layout__done, this);
+}
+
+/**
+ * @brief Get the logical size of the text laid out as a single line
+ */
+Size TextRendering::getTextLineSize() {
+    auto layout = this->layout->layout;
+    PangoRectangle ink, logical;
+
+    pango_layout_set_width(layout, -1);
+    pango_layout_get_pixel_extents(layout, &ink, &logical);
+
+    return Size(logical.width, logical.height);
+}
+
+/**
+ * @brief Get the position of each character of the text laid out as a single line
+ *
+ * @param out Vector to receive the positions, in ascending order of byte offset; it's terminated
+ *        by the position of the end of the text.
+ */
+void TextRendering::getCharacterPositions(std::vector<CharacterPosition> &out) {
+    auto layout = this->layout->layout;
+    const auto length = std::strlen(pango_layout_get_text(layout));
+
+    pango_layout_set_width(layout, -1);
+    out.clear();
+
+    auto iter = pango_layout_get_iter(layout);
+    do {
+        const auto index = pango_layout_iter_get_index(iter);
+        if(static_cast<size_t>(index) >= length) {
+            break;
+        }
+
+        PangoRectangle extents;
+        pango_layout_iter_get_char_extents(iter, &extents);
+
+        out.push_back({static_cast<uint32_t>(index), PANGO_PIXELS(extents.x)});
+    } while(pango_layout_iter_next_char(iter));
+
+    pango_layout_iter_free(iter);
+
+    // the end of the text
+    PangoRectangle ink, logical;
+    pango_layout_get_pixel_extents(layout, &ink, &logical);
+
+    out.push_back({static_cast<uint32_t>(length), logical.width});
+}
+
+/**
+ * @brief Update the text alignment and justification settings of the text layout context
+ *
+ * @param newAlign New horizontal alignment setting
+ * @param justified Whether text is justified
+ */
+void TextRendering::setTextLayoutAlign(const TextAlign newAlign, const bool justified) {
+    auto layout = this->layout->layout;
+
+    switch(newAlign) {
+        case TextAlign::Left:
+            pango_layout_set_alignment(layout, PANGO_ALIGN_LEFT);
+            break;
+        case TextAlign::Center:
+            pango_layout_set_alignment(layout, PANGO_ALIGN_CENTER);
+            break;
+        case TextAlign::Right:
+            pango_layout_set_alignment(layout, PANGO_ALIGN_RIGHT);
+            break;
+    }
+
+    pango_layout_set_justify(layout, justified);
+}
+
+/**
+ * @brief Update the text ellipsization mode of the text drawing context
+ *
+ * @param newMode Text ellipsization mode to set
+ */
+void TextRendering::setTextLayoutEllipsization(const EllipsizeMode newMode) {
+    auto layout = this->layout->layout;
+
+    switch(newMode) {
+        case EllipsizeMode::None:
+            pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_NONE);
+            break;
+        case EllipsizeMode::Start:
+            pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_START);
+            break;
+        case EllipsizeMode::Middle:
+            pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_MIDDLE);
+            break;
+        case EllipsizeMode::End:
+            pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_END);
+            break;
+    }
+}
+
+/**
+ * @brief Update the wrapping and line break mode
+ *
+ * @param multiParagraph Whether the text renderer renders multiple paragraphs
+ * @param wordWrap Whether lines are wrapped on word (`true`) or character (`false`) boundaries
+ */
+void TextRendering::setTextLayoutWrapMode(const bool multiParagraph, const bool wordWrap) {
+    auto layout = this->layout->layout;
+
+    if(wordWrap) {
+        pango_layout_set_wrap(layout, PANGO_WRAP_WORD);
+    } else {
+        pango_layout_set_wrap(layout, PANGO_WRAP_CHAR);
+    }
+    pango_layout_set_single_paragraph_mode(layout, !multiParagraph);
+}
+
+
+
+/**
+ * @brief Set the text content of the text layout context
+ *
+ * Update the string content that will be drawn by the layout context. If specified, the text can
+ * be parsed for attributes which affect how it is rendered; this is implemented by Pango, see
+ * [this page](https://docs.gtk.org/Pango/pango_markup.html) for documentation on the markup
+ * format.
+ *
+ * @param str String to set
+ * @param parseMarkup Whether Pango markup should be parsed
+ *
+ * @remark Note that when markup is parsed, any existing attributes are replaced.
+ */
+void TextRendering::setTextContent(const std::string_view &str, const bool parseMarkup) {
+    auto layout = this->layout->layout;
+
+    this->updateLayoutBytes(str.length());
+
+    if(!parseMarkup) {
+        pango_layout_set_text(layout, str.data(), str.length());
+    } else {
+        PangoAttrList *attrList{nullptr};
+        char *strippedStr{nullptr};
+        GError *outError{nullptr};
+
+        // parse markup
+        auto ret = pango_parse_markup(str.data(), str.length(), 0, &attrList, &strippedStr,
+                nullptr, &outError);
+        if(!ret) {
+            if(outError) {
+                fprintf(stderr, "shittygui: %s failed (%u): %s\n", "pango_parse_markup",
+                        outError->code, outError->message);
+                throw std::runtime_error(outError->message);
+            } else {
+                throw std::runtime_error("unspecified error in pango_parse_markup");
+            }
+        }
+
+        // apply text and attributes
+        pango_layout_set_text(layout, strippedStr, -1);
+        pango_layout_set_attributes(layout, attrList);
+
+        // clean up
+        free(strippedStr);
+        pango_attr_list_unref(attrList);
+    }
+}
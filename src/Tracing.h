@@ -0,0 +1,52 @@
+/**
+ * @file
+ *
+ * @brief Static tracepoints
+ *
+ * When built with the `SHITTYGUI_TRACEPOINTS` CMake option, the library contains user space
+ * statically defined tracepoints (USDT, as defined by SystemTap's `sys/sdt.h`) in the `shittygui`
+ * provider. These can be attached to by tools such as `perf`, `bpftrace` and `bcc` without
+ * rebuilding the library; when no tracer is attached, each costs a single `nop` instruction.
+ * Without the option, tracepoints are compiled out entirely, and their arguments are never
+ * evaluated.
+ *
+ * The following tracepoints are defined:
+ *
+ * - frame__start(frame): A redraw of the screen started; frame is the number of frames drawn
+ *   before it.
+ * - frame__done(frame, nsec, regions): The redraw finished, taking nsec nanoseconds to draw the
+ *   given number of damaged regions.
+ * - event__dispatch(type): An event is being dispatched; type is the index of the event type in
+ *   the Event variant (0 = touch, 1 = button, 2 = scroll, 3 = key.)
+ * - widget__draw__start(widget, label): A widget is about to be drawn; label is its debug label
+ *   (a C string, empty if none is set.)
+ * - widget__draw__done(widget): The widget (and its children) finished drawing.
+ * - text__layout__start(renderer, length): Text is about to be laid out and drawn; renderer is
+ *   the widget's text renderer, and length the length of its text in bytes.
+ * - text__layout__done(renderer)
+ * - image__decode__start(path): An image file is about to be decoded.
+ * - image__decode__done(width, height)
+ * - animator__callback(token): An animator callback is about to be invoked.
+ * - quality__change(frame, old, new): The frame governor changed the rendering quality tier
+ *   (0 = full, 1 = reduced, 2 = minimal.)
+ *
+ * See the scripts in `tools/bpftrace` for examples.
+ */
+#ifndef SHITTYGUI_TRACING_H
+#define SHITTYGUI_TRACING_H
+
+#ifdef SHITTYGUI_TRACEPOINTS
+#include <sys/sdt.h>
+
+/**
+ * @brief Fire a tracepoint
+ *
+ * @param name Name of the tracepoint (double underscores are shown as dashes by most tools)
+ * @param ... Up to 12 integer or pointer arguments
+ */
+#define SHITTYGUI_TRACE(name, ...) STAP_PROBEV(shittygui, name, ##__VA_ARGS__)
+#else
+#define SHITTYGUI_TRACE(name, ...) do {} while(0)
+#endif
+
+#endif
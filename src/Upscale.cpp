@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "Upscale.h"
+
+using namespace shittygui;
+
+/**
+ * @brief 32 bits per pixel pixel operations
+ *
+ * Interpolation operates on two channels at a time, by splitting the pixel into its even and odd
+ * bytes, each of which gets 8 bits of headroom for the multiplication.
+ */
+struct Pixel32Ops {
+    using Type = uint32_t;
+    /// Number of bits in the interpolation weight
+    constexpr static const unsigned kWeightBits{8};
+
+    /**
+     * @brief Interpolate between two pixels
+     *
+     * @param a First pixel
+     * @param b Second pixel
+     * @param f Weight of the second pixel, in [0, 256)
+     */
+    static inline Type Lerp(const Type a, const Type b, const uint32_t f) {
+        const uint32_t inv = (1U << kWeightBits) - f;
+
+        const uint32_t rb = ((((a & 0x00FF00FF) * inv) + ((b & 0x00FF00FF) * f)) >> 8) &
+            0x00FF00FF;
+        const uint32_t ag = ((((a >> 8) & 0x00FF00FF) * inv) + (((b >> 8) & 0x00FF00FF) * f)) &
+            0xFF00FF00;
+
+        return rb | ag;
+    }
+};
+
+/**
+ * @brief RGB565 pixel operations
+ *
+ * The pixel is spread out into a 32-bit word (green in the upper half, red and blue in the lower
+ * half) with enough headroom between the channels to interpolate all three at once.
+ */
+struct Rgb565Ops {
+    using Type = uint16_t;
+    /// Number of bits in the interpolation weight
+    constexpr static const unsigned kWeightBits{5};
+    /// Channel mask of the expanded pixel
+    constexpr static const uint32_t kMask{0x07E0F81F};
+
+    /**
+     * @brief Interpolate between two pixels
+     *
+     * @param a First pixel
+     * @param b Second pixel
+     * @param f Weight of the second pixel, in [0, 32)
+     */
+    static inline Type Lerp(const Type a, const Type b, const uint32_t f) {
+        const uint32_t inv = (1U << kWeightBits) - f;
+
+        const uint32_t ea = (a | (static_cast<uint32_t>(a) << 16)) & kMask,
+              eb = (b | (static_cast<uint32_t>(b) << 16)) & kMask;
+        const uint32_t out = (((ea * inv) + (eb * f)) >> kWeightBits) & kMask;
+
+        return static_cast<Type>(out | (out >> 16));
+    }
+};
+
+/**
+ * @brief Source sample position for one destination row or column
+ */
+struct Sample {
+    /// First source pixel
+    uint16_t first;
+    /// Second source pixel
+    uint16_t second;
+    /// Weight of the second pixel (8 bits)
+    uint8_t weight;
+};
+
+/**
+ * @brief Calculate the source sample positions for a range of destination pixels
+ *
+ * Pixel centers are mapped onto each other, so the source position of destination pixel `d` is
+ * `(d + 0.5) / factor - 0.5`; this is evaluated in 16.16 fixed point.
+ *
+ * @param start First destination pixel
+ * @param count Number of destination pixels
+ * @param srcSize Number of source pixels along this axis
+ * @param step Source pixels per destination pixel (16.16 fixed point)
+ * @param out Vector to receive sample positions
+ */
+static void CalculateSamples(const int start, const size_t count, const uint16_t srcSize,
+        const int64_t step, std::vector<Sample> &out) {
+    const int64_t max = static_cast<int64_t>(srcSize - 1) << 16;
+    out.resize(count);
+
+    for(size_t i = 0; i < count; i++) {
+        const int64_t pos = std::clamp(((start + static_cast<int64_t>(i)) * step) + (step / 2) -
+                0x8000, int64_t{0}, max);
+
+        auto &sample = out[i];
+        sample.first = static_cast<uint16_t>(pos >> 16);
+        sample.second = std::min<uint16_t>(sample.first + 1, srcSize - 1);
+        sample.weight = static_cast<uint8_t>(pos >> 8);
+    }
+}
+
+/**
+ * @brief Upscale by an integer factor
+ *
+ * Each source pixel is replicated into a factor × factor block. Destination rows that map to the
+ * same source row as the previous row are copied.
+ */
+template<typename Ops>
+static void ScaleNearest(const upscale::Buffer &src, const upscale::Buffer &dst, const Rect &rect,
+        const unsigned factor) {
+    using T = typename Ops::Type;
+
+    const unsigned x1 = rect.origin.x, x2 = rect.right();
+    const size_t rowBytes = rect.size.width * sizeof(T);
+
+    const T *prevRow{nullptr};
+    unsigned prevSrcY{~0U};
+
+    for(unsigned y = rect.origin.y; y < static_cast<unsigned>(rect.bottom()); y++) {
+        const auto srcY = std::min<unsigned>(y / factor, src.height - 1);
+        auto out = reinterpret_cast<T *>(dst.data + (y * dst.stride)) + x1;
+
+        if(srcY == prevSrcY) {
+            std::memcpy(out, prevRow, rowBytes);
+            continue;
+        }
+
+        const auto in = reinterpret_cast<const T *>(src.data + (srcY * src.stride));
+        prevRow = out;
+        prevSrcY = srcY;
+
+        for(unsigned x = x1; x < x2;) {
+            const auto srcX = x / factor;
+            const T pixel = in[std::min<unsigned>(srcX, src.width - 1)];
+            const auto runEnd = std::min(x2, (srcX + 1) * factor);
+
+            for(; x < runEnd; x++) {
+                *out++ = pixel;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Upscale by an arbitrary factor, with bilinear filtering
+ */
+template<typename Ops>
+static void ScaleBilinear(const upscale::Buffer &src, const upscale::Buffer &dst, const Rect &rect,
+        const double factor) {
+    using T = typename Ops::Type;
+    constexpr auto kShift = 8 - Ops::kWeightBits;
+
+    const auto step = static_cast<int64_t>(std::lround(65536. / factor));
+
+    std::vector<Sample> columns, rows;
+    CalculateSamples(rect.origin.x, rect.size.width, src.width, step, columns);
+    CalculateSamples(rect.origin.y, rect.size.height, src.height, step, rows);
+
+    for(size_t i = 0; i < rows.size(); i++) {
+        const auto &row = rows[i];
+        const auto fy = row.weight >> kShift;
+
+        const auto top = reinterpret_cast<const T *>(src.data + (row.first * src.stride)),
+              bottom = reinterpret_cast<const T *>(src.data + (row.second * src.stride));
+        auto out = reinterpret_cast<T *>(dst.data + ((rect.origin.y + i) * dst.stride)) +
+            rect.origin.x;
+
+        for(const auto &col : columns) {
+            const auto fx = col.weight >> kShift;
+
+            const T a = Ops::Lerp(top[col.first], top[col.second], fx),
+                  b = Ops::Lerp(bottom[col.first], bottom[col.second], fx);
+            *out++ = Ops::Lerp(a, b, fy);
+        }
+    }
+}
+
+/**
+ * @brief Upscale a region with the appropriate method for the scale factor
+ */
+template<typename Ops>
+static void ScaleRegion(const upscale::Buffer &src, const upscale::Buffer &dst, const Rect &rect,
+        const double factor) {
+    if(upscale::IsIntegerFactor(factor)) {
+        ScaleNearest<Ops>(src, dst, rect, static_cast<unsigned>(std::lround(factor)));
+    } else {
+        ScaleBilinear<Ops>(src, dst, rect, factor);
+    }
+}
+
+
+
+/**
+ * @brief Upscale a region of the destination buffer
+ *
+ * Fill the specified region of the destination buffer with the corresponding, scaled up, region
+ * of the source buffer. Integer scale factors replicate pixels; other factors use bilinear
+ * filtering.
+ *
+ * The interpolation works on multiple channels of a pixel at once, packed into a single 32-bit
+ * word, which is fast on CPUs without usable vector units and auto-vectorizes well otherwise.
+ *
+ * @param src Source (low resolution) buffer
+ * @param dst Destination buffer
+ * @param dstRect Region of the destination buffer to fill; it's clipped to the buffer
+ * @param factor Scale factor; destination pixels per source pixel
+ * @param layout Pixel layout of both buffers
+ *
+ * @throw std::invalid_argument Invalid scale factor or empty source buffer
+ */
+void upscale::Scale(const Buffer &src, const Buffer &dst, const Rect &dstRect,
+        const double factor, const Layout layout) {
+    if(!(factor >= 1.)) {
+        throw std::invalid_argument("invalid upscale factor");
+    } else if(!src.width || !src.height) {
+        throw std::invalid_argument("empty source buffer");
+    }
+
+    const auto rect = dstRect.intersection(Rect({0, 0}, Size(dst.width, dst.height)));
+    if(rect.isEmpty()) {
+        return;
+    }
+
+    switch(layout) {
+        case Layout::Pixel32:
+            ScaleRegion<Pixel32Ops>(src, dst, rect, factor);
+            break;
+        case Layout::Rgb565:
+            ScaleRegion<Rgb565Ops>(src, dst, rect, factor);
+            break;
+    }
+}
@@ -0,0 +1,57 @@
+/**
+ * @file
+ *
+ * @brief Framebuffer upscaling
+ *
+ * Routines to scale up regions of a low resolution render buffer into the framebuffer. These are
+ * used when the screen renders at its logical resolution rather than at the resolution of the
+ * framebuffer.
+ */
+#ifndef SHITTYGUI_UPSCALE_H
+#define SHITTYGUI_UPSCALE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Types.h"
+
+namespace shittygui::upscale {
+/**
+ * @brief Pixel layouts supported by the upscaler
+ */
+enum class Layout {
+    /// 32 bits per pixel, with four 8-bit channels (ARGB32 and RGB24)
+    Pixel32,
+    /// 16 bits per pixel, in 5-6-5 RGB format
+    Rgb565,
+};
+
+/**
+ * @brief Describes a pixel buffer
+ */
+struct Buffer {
+    /// Pointer to the first row of pixels
+    uint8_t *data{nullptr};
+    /// Bytes per row
+    size_t stride{0};
+    /// Width of the buffer, in pixels
+    uint16_t width{0};
+    /// Height of the buffer, in pixels
+    uint16_t height{0};
+};
+
+void Scale(const Buffer &src, const Buffer &dst, const Rect &dstRect, const double factor,
+        const Layout layout);
+
+/**
+ * @brief Test whether a scale factor is an integer
+ *
+ * Integer scale factors are handled by replicating pixels, rather than filtering.
+ */
+constexpr inline bool IsIntegerFactor(const double factor) {
+    const auto rounded = static_cast<double>(static_cast<int>(factor + .5));
+    return (factor - rounded) < 1e-6 && (rounded - factor) < 1e-6;
+}
+}
+
+#endif
@@ -7,9 +7,13 @@
 #define SHITTYGUI_UTIL_H
 
 #include <algorithm>
+#include <cstdint>
 #include <deque>
+#include <functional>
 #include <vector>
 
+#include "Types.h"
+
 namespace shittygui {
 /**
  * @brief Move elements based on predicate
@@ -27,6 +31,30 @@ void transfer_if_not(std::deque<T> &old, std::vector<T> &out, F pred) {
     std::move(part, old.end(), std::back_inserter(out));
     old.erase(part);
 }
+
+/**
+ * @brief Mix a value into a hash
+ *
+ * @tparam T Value type; it must be hashable with `std::hash`
+ *
+ * @param hash Hash to update
+ * @param value Value to mix into the hash
+ */
+template <class T>
+inline void HashCombine(uint64_t &hash, const T &value) {
+    hash ^= std::hash<T>{}(value) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+}
 }
 
+/**
+ * @brief Hash function for packed colors
+ */
+template<>
+struct std::hash<shittygui::PackedColor> {
+    size_t operator()(const shittygui::PackedColor &color) const noexcept {
+        return (static_cast<size_t>(color.r) << 24) | (static_cast<size_t>(color.g) << 16) |
+            (static_cast<size_t>(color.b) << 8) | color.a;
+    }
+};
+
 #endif
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <chrono>
+
+#include "GestureRecognizer.h"
+
+using namespace shittygui;
+
+/**
+ * @brief Record a touch sample
+ *
+ * Samples must be added in chronological order. If the history is full, the oldest sample is
+ * discarded.
+ *
+ * @param position Position of the touch
+ * @param time Time at which the touch was sampled
+ */
+void VelocityTracker::addSample(const Point position, const Clock::time_point time) {
+    if(this->count) {
+        this->head = (this->head + 1) % kHistorySize;
+    }
+
+    this->samples[this->head] = Sample{static_cast<double>(position.x),
+        static_cast<double>(position.y), time};
+    this->count = std::min(this->count + 1, kHistorySize);
+}
+
+/**
+ * @brief Estimate the velocity of the touch
+ *
+ * Fit a line (by least squares) through the samples within the velocity horizon of the newest
+ * sample; its slope is the velocity. Samples before a gap in the history (where the touch stopped
+ * moving, so no new samples were reported) are ignored.
+ *
+ * @return Velocity in points per second, or zero if there are insufficient samples
+ */
+GesturePoint VelocityTracker::getVelocity() const {
+    if(this->count < 2) {
+        return {};
+    }
+
+    // find the samples to use
+    const auto &newest = this->get(0);
+    size_t num{1};
+
+    for(; num < this->count; num++) {
+        const auto &sample = this->get(num);
+
+        if(newest.time - sample.time > kHorizon ||
+                this->get(num - 1).time - sample.time > kAssumeStopped) {
+            break;
+        }
+    }
+
+    if(num < 2) {
+        return {};
+    }
+
+    // compute means (times in seconds relative to the newest sample)
+    double meanT{0.}, meanX{0.}, meanY{0.};
+
+    for(size_t i = 0; i < num; i++) {
+        const auto &sample = this->get(i);
+        const std::chrono::duration<double> t = sample.time - newest.time;
+
+        meanT += t.count();
+        meanX += sample.x;
+        meanY += sample.y;
+    }
+
+    meanT /= num;
+    meanX /= num;
+    meanY /= num;
+
+    // then, the slopes
+    double sTT{0.}, sTX{0.}, sTY{0.};
+
+    for(size_t i = 0; i < num; i++) {
+        const auto &sample = this->get(i);
+        const std::chrono::duration<double> t = sample.time - newest.time;
+        const auto dt = t.count() - meanT;
+
+        sTT += dt * dt;
+        sTX += dt * (sample.x - meanX);
+        sTY += dt * (sample.y - meanY);
+    }
+
+    if(sTT <= 0.) {
+        return {};
+    }
+
+    return {sTX / sTT, sTY / sTT};
+}
+
+/**
+ * @brief Get the position of the touch at a given time
+ *
+ * If the time lies between two samples, the position is linearly interpolated between them. If
+ * it's after the newest sample, the position is extrapolated from the newest two samples; but by
+ * no more than a few milliseconds, and no more than half the interval between those samples, to
+ * avoid overshooting when the touch slows down.
+ *
+ * @param time Time to get the position at
+ */
+GesturePoint VelocityTracker::resample(const Clock::time_point time) const {
+    if(!this->count) {
+        return {};
+    }
+
+    const auto &newest = this->get(0);
+    if(this->count == 1) {
+        return {newest.x, newest.y};
+    }
+
+    // extrapolate
+    if(time >= newest.time) {
+        const auto &prev = this->get(1);
+        const auto interval = newest.time - prev.time;
+        if(interval <= Clock::duration::zero()) {
+            return {newest.x, newest.y};
+        }
+
+        const auto predict = std::min({time - newest.time, Clock::duration(interval / 2),
+                std::chrono::duration_cast<Clock::duration>(kMaxPrediction)});
+        const auto alpha = std::chrono::duration<double>(predict).count() /
+            std::chrono::duration<double>(interval).count();
+
+        return {newest.x + ((newest.x - prev.x) * alpha), newest.y + ((newest.y - prev.y) * alpha)};
+    }
+
+    // interpolate between the samples either side of the time
+    for(size_t i = 1; i < this->count; i++) {
+        const auto &a = this->get(i), &b = this->get(i - 1);
+        if(a.time > time) {
+            continue;
+        }
+
+        const auto interval = b.time - a.time;
+        if(interval <= Clock::duration::zero()) {
+            return {b.x, b.y};
+        }
+
+        const auto alpha = std::chrono::duration<double>(time - a.time).count() /
+            std::chrono::duration<double>(interval).count();
+        return {a.x + ((b.x - a.x) * alpha), a.y + ((b.y - a.y) * alpha)};
+    }
+
+    // before the oldest sample
+    const auto &oldest = this->get(this->count - 1);
+    return {oldest.x, oldest.y};
+}
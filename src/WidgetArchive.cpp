@@ -0,0 +1,756 @@
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory_resource>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Image.h"
+#include "Widget.h"
+#include "WidgetArchive.h"
+#include "WidgetArchiveFormat.h"
+#include "Widgets/Button.h"
+#include "Widgets/Checkbox.h"
+#include "Widgets/Container.h"
+#include "Widgets/ImageView.h"
+#include "Widgets/Label.h"
+#include "Widgets/ProgressBar.h"
+#include "Widgets/RadioButton.h"
+
+using namespace shittygui;
+using namespace shittygui::widgetarchive;
+
+/// Maximum memory a single archived widget may require, in bytes
+constexpr static const size_t kMaxWidgetAllocation{4096};
+/// Minimum size of the arena widgets are allocated from, in bytes
+constexpr static const size_t kMinArenaSize{256};
+
+/**
+ * @brief Allocator for widgets instantiated from an archive
+ *
+ * Allocates from a monotonic arena that's shared by all widgets of one instantiation. Each
+ * widget's control block holds a reference to the arena, so it's released once the last of the
+ * widgets is deallocated.
+ */
+template<typename T>
+class ArenaAllocator {
+    template<typename U>
+    friend class ArenaAllocator;
+
+    public:
+        using value_type = T;
+        using Arena = std::pmr::monotonic_buffer_resource;
+
+        ArenaAllocator(const std::shared_ptr<Arena> &arena) : arena(arena) {}
+        template<typename U>
+        ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+        inline T *allocate(const size_t n) {
+            return static_cast<T *>(this->arena->allocate(n * sizeof(T), alignof(T)));
+        }
+        inline void deallocate(T *ptr, const size_t n) {
+            this->arena->deallocate(ptr, n * sizeof(T), alignof(T));
+        }
+
+        template<typename U>
+        inline bool operator==(const ArenaAllocator<U> &other) const {
+            return this->arena == other.arena;
+        }
+
+    private:
+        std::shared_ptr<Arena> arena;
+};
+
+/**
+ * @brief Append the raw bytes of a value to a buffer
+ */
+template<typename T>
+static inline void Append(std::vector<std::byte> &out, const T &value) {
+    const auto offset = out.size();
+    out.resize(offset + sizeof(T));
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+/**
+ * @brief Read a value from a (possibly unaligned) location
+ */
+template<typename T>
+static inline T Load(const std::byte *data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+/**
+ * @brief Get the memory required to allocate a widget of the given type
+ *
+ * This is the size of the widget object, plus an allowance for the shared pointer control block.
+ */
+static size_t GetAllocationSize(const ArchiveWidgetType type) {
+    constexpr static const size_t kControlBlockSize{64};
+
+    switch(type) {
+        case ArchiveWidgetType::Container:
+            return sizeof(widgets::Container) + kControlBlockSize;
+        case ArchiveWidgetType::Label:
+            return sizeof(widgets::Label) + kControlBlockSize;
+        case ArchiveWidgetType::Button:
+            return sizeof(widgets::Button) + kControlBlockSize;
+        case ArchiveWidgetType::Checkbox:
+            return sizeof(widgets::Checkbox) + kControlBlockSize;
+        case ArchiveWidgetType::RadioButton:
+            return sizeof(widgets::RadioButton) + kControlBlockSize;
+        case ArchiveWidgetType::ImageView:
+            return sizeof(widgets::ImageView) + kControlBlockSize;
+        case ArchiveWidgetType::ProgressBar:
+            return sizeof(widgets::ProgressBar) + kControlBlockSize;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Create a widget of the given type
+ *
+ * @param type Widget type read from the archive
+ * @param frame Frame rectangle of the widget
+ * @param alloc Allocator to allocate the widget with
+ *
+ * @throw std::runtime_error Unknown widget type
+ */
+static std::shared_ptr<Widget> MakeArchivedWidget(const ArchiveWidgetType type, const Rect &frame,
+        const ArenaAllocator<Widget> &alloc) {
+    switch(type) {
+        case ArchiveWidgetType::Container:
+            return std::allocate_shared<widgets::Container>(alloc, frame);
+        case ArchiveWidgetType::Label:
+            return std::allocate_shared<widgets::Label>(alloc, frame);
+        case ArchiveWidgetType::Button:
+            return std::allocate_shared<widgets::Button>(alloc, frame,
+                    widgets::Button::Type::Push);
+        case ArchiveWidgetType::Checkbox:
+            return std::allocate_shared<widgets::Checkbox>(alloc, frame);
+        case ArchiveWidgetType::RadioButton:
+            return std::allocate_shared<widgets::RadioButton>(alloc, frame);
+        case ArchiveWidgetType::ImageView:
+            return std::allocate_shared<widgets::ImageView>(alloc, frame);
+        case ArchiveWidgetType::ProgressBar:
+            return std::allocate_shared<widgets::ProgressBar>(alloc, frame);
+
+        default:
+            throw std::runtime_error("unknown widget type in archive");
+    }
+}
+
+
+
+/**
+ * @brief Write a property header
+ */
+void ArchiveEncoder::addHeader(const ArchiveKey key, const uint8_t kind) {
+    this->properties.push_back(static_cast<std::byte>(key));
+    this->properties.push_back(static_cast<std::byte>(kind));
+}
+
+/**
+ * @brief Write a reference to a string, adding it to the string table if needed
+ */
+void ArchiveEncoder::addStringRef(const std::string_view value) {
+    StringRef ref{0, static_cast<uint32_t>(value.size())};
+
+    std::string key(value);
+    if(auto it = this->stringOffsets.find(key); it != this->stringOffsets.end()) {
+        ref.offset = it->second;
+    } else {
+        ref.offset = this->strings.size();
+
+        const auto bytes = reinterpret_cast<const std::byte *>(value.data());
+        this->strings.insert(this->strings.end(), bytes, bytes + value.size());
+        this->strings.push_back(std::byte{0});
+
+        this->stringOffsets.emplace(std::move(key), ref.offset);
+    }
+
+    Append(this->properties, ref);
+}
+
+/**
+ * @brief Add a boolean property
+ */
+void ArchiveEncoder::addBool(const ArchiveKey key, const bool value) {
+    this->addHeader(key, kValueBool);
+    this->properties.push_back(std::byte{value ? uint8_t{1} : uint8_t{0}});
+}
+
+/**
+ * @brief Add an integer property
+ */
+void ArchiveEncoder::addInteger(const ArchiveKey key, const int64_t value) {
+    this->addHeader(key, kValueInteger);
+    Append(this->properties, value);
+}
+
+/**
+ * @brief Add a floating point property
+ */
+void ArchiveEncoder::addDouble(const ArchiveKey key, const double value) {
+    this->addHeader(key, kValueDouble);
+    Append(this->properties, value);
+}
+
+/**
+ * @brief Add a color property
+ */
+void ArchiveEncoder::addColor(const ArchiveKey key, const Color &value) {
+    this->addHeader(key, kValueColor);
+
+    const float components[4]{value.r, value.g, value.b, value.a};
+    Append(this->properties, components);
+}
+
+/**
+ * @brief Add a string property
+ */
+void ArchiveEncoder::addString(const ArchiveKey key, const std::string_view value) {
+    this->addHeader(key, kValueString);
+    this->addStringRef(value);
+}
+
+/**
+ * @brief Add a font property
+ *
+ * @param name Font description string, as accepted by Pango (without the size)
+ * @param size Font size, in points
+ */
+void ArchiveEncoder::addFont(const ArchiveKey key, const std::string_view name,
+        const double size) {
+    this->addHeader(key, kValueFont);
+    this->addStringRef(name);
+    Append(this->properties, size);
+}
+
+/**
+ * @brief Add an image property
+ *
+ * Images are stored by name; nothing is stored if there's no image, or it has no name.
+ */
+void ArchiveEncoder::addImage(const ArchiveKey key, const std::shared_ptr<Image> &image) {
+    if(!image || image->getName().empty()) {
+        return;
+    }
+
+    this->addHeader(key, kValueImage);
+    this->addStringRef(image->getName());
+}
+
+
+
+/**
+ * @brief Get the value as a boolean
+ *
+ * @throw std::invalid_argument The value is not a boolean
+ */
+bool ArchiveValue::getBool() const {
+    if(this->kind != kValueBool) {
+        throw std::invalid_argument("archive value is not a bool");
+    }
+    return Load<uint8_t>(this->payload) != 0;
+}
+
+/**
+ * @brief Get the value as an integer
+ *
+ * @throw std::invalid_argument The value is not an integer
+ */
+int64_t ArchiveValue::getInteger() const {
+    if(this->kind != kValueInteger) {
+        throw std::invalid_argument("archive value is not an integer");
+    }
+    return Load<int64_t>(this->payload);
+}
+
+/**
+ * @brief Get the value as a floating point number
+ *
+ * @throw std::invalid_argument The value is not a floating point number
+ */
+double ArchiveValue::getDouble() const {
+    if(this->kind != kValueDouble) {
+        throw std::invalid_argument("archive value is not a double");
+    }
+    return Load<double>(this->payload);
+}
+
+/**
+ * @brief Get the value as a color
+ *
+ * @throw std::invalid_argument The value is not a color
+ */
+Color ArchiveValue::getColor() const {
+    if(this->kind != kValueColor) {
+        throw std::invalid_argument("archive value is not a color");
+    }
+
+    const auto components = Load<std::array<float, 4>>(this->payload);
+    return Color(components[0], components[1], components[2], components[3]);
+}
+
+/**
+ * @brief Get the value as a string
+ *
+ * For fonts, this is the font description. The string is backed by the archive data, and it's
+ * followed by a NUL terminator.
+ *
+ * @throw std::invalid_argument The value is not a string or font
+ */
+std::string_view ArchiveValue::getString() const {
+    if(this->kind != kValueString && this->kind != kValueFont) {
+        throw std::invalid_argument("archive value is not a string");
+    }
+    return this->archive->getString(this->payload);
+}
+
+/**
+ * @brief Get the size of a font value
+ *
+ * @throw std::invalid_argument The value is not a font
+ */
+double ArchiveValue::getFontSize() const {
+    if(this->kind != kValueFont) {
+        throw std::invalid_argument("archive value is not a font");
+    }
+    return Load<double>(this->payload + sizeof(StringRef));
+}
+
+/**
+ * @brief Get the image referenced by the value
+ *
+ * The image is loaded by the archive's image loader; images referenced multiple times in an
+ * archive are only loaded once.
+ *
+ * @throw std::invalid_argument The value is not an image
+ */
+std::shared_ptr<Image> ArchiveValue::getImage() const {
+    if(this->kind != kValueImage) {
+        throw std::invalid_argument("archive value is not an image");
+    }
+    return this->archive->getImage(this->archive->getString(this->payload));
+}
+
+
+
+/**
+ * @brief Use an archive held in memory
+ *
+ * This can be used for archives embedded in the application, or stored in memory mapped flash.
+ *
+ * @param data Archive data; it must remain valid for the lifetime of the archive object, but
+ *        not the widgets instantiated from it.
+ *
+ * @throw std::runtime_error The data is not a valid archive
+ */
+WidgetArchive::WidgetArchive(std::span<const std::byte> data) : WidgetArchive(data, false) {}
+
+/**
+ * @brief Initialize an archive object, and validate the archive header
+ */
+WidgetArchive::WidgetArchive(std::span<const std::byte> data, const bool mapped) : data(data),
+    mapped(mapped) {
+    this->validate();
+}
+
+/**
+ * @brief Release the archive data, if it was mapped
+ */
+WidgetArchive::~WidgetArchive() {
+    if(this->mapped) {
+        munmap(const_cast<std::byte *>(this->data.data()), this->data.size());
+    }
+}
+
+/**
+ * @brief Open an archive file
+ *
+ * The file is mapped into memory, rather than read; only the parts of it that are accessed while
+ * instantiating widgets are read from storage.
+ *
+ * @param path Path to an archive file written by Export()
+ *
+ * @throw std::system_error Failed to open or map the file
+ * @throw std::runtime_error The file is not a valid archive
+ */
+std::shared_ptr<WidgetArchive> WidgetArchive::Open(const std::filesystem::path &path) {
+    int fd = open(path.native().c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd == -1) {
+        throw std::system_error(errno, std::generic_category(), "open archive");
+    }
+
+    struct stat sb;
+    if(fstat(fd, &sb) == -1) {
+        const auto err = errno;
+        close(fd);
+        throw std::system_error(err, std::generic_category(), "fstat archive");
+    } else if(static_cast<size_t>(sb.st_size) < sizeof(FileHeader)) {
+        close(fd);
+        throw std::runtime_error("widget archive too small");
+    }
+
+    const size_t length = sb.st_size;
+    void *base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    const auto err = errno;
+    close(fd);
+
+    if(base == MAP_FAILED) {
+        throw std::system_error(err, std::generic_category(), "mmap archive");
+    }
+
+    try {
+        return std::shared_ptr<WidgetArchive>(new WidgetArchive(
+                    {static_cast<const std::byte *>(base), length}, true));
+    } catch(...) {
+        munmap(base, length);
+        throw;
+    }
+}
+
+/**
+ * @brief Validate the archive header and locate its sections
+ *
+ * @throw std::runtime_error The archive is invalid
+ */
+void WidgetArchive::validate() {
+    if(this->data.size() < sizeof(FileHeader)) {
+        throw std::runtime_error("widget archive too small");
+    }
+
+    const auto hdr = Load<FileHeader>(this->data.data());
+    if(hdr.magic != kMagic) {
+        throw std::runtime_error("invalid widget archive magic");
+    } else if(hdr.version != kVersion) {
+        throw std::runtime_error("unsupported widget archive version");
+    } else if(!hdr.numNodes) {
+        throw std::runtime_error("widget archive is empty");
+    }
+
+    // ensure sections are within the archive
+    const uint64_t nodesEnd = static_cast<uint64_t>(hdr.nodesOffset) + hdr.nodesSize,
+          stringsEnd = static_cast<uint64_t>(hdr.stringsOffset) + hdr.stringsSize;
+
+    if(nodesEnd > this->data.size() || stringsEnd > this->data.size()) {
+        throw std::runtime_error("widget archive truncated");
+    }
+
+    // every node takes at least a header, and every widget a bounded amount of memory
+    if(hdr.numNodes > hdr.nodesSize / sizeof(NodeHeader)) {
+        throw std::runtime_error("widget archive truncated");
+    } else if(!hdr.allocationSize ||
+            hdr.allocationSize > static_cast<uint64_t>(hdr.numNodes) * kMaxWidgetAllocation) {
+        throw std::runtime_error("invalid allocation size in widget archive");
+    }
+
+    this->numWidgets = hdr.numNodes;
+    this->nodes = this->data.subspan(hdr.nodesOffset, hdr.nodesSize);
+    this->strings = this->data.subspan(hdr.stringsOffset, hdr.stringsSize);
+}
+
+/**
+ * @brief Resolve a string reference
+ *
+ * @param ref Location of the string reference in the archive
+ *
+ * @throw std::runtime_error The reference is out of bounds of the string table
+ */
+std::string_view WidgetArchive::getString(const std::byte *ref) const {
+    const auto str = Load<StringRef>(ref);
+    if(static_cast<uint64_t>(str.offset) + str.length + 1 > this->strings.size() ||
+            this->strings[str.offset + str.length] != std::byte{0}) {
+        throw std::runtime_error("invalid string reference in widget archive");
+    }
+
+    return {reinterpret_cast<const char *>(this->strings.data()) + str.offset, str.length};
+}
+
+/**
+ * @brief Load an image referenced by the archive
+ *
+ * Images are cached for the duration of an instantiation, so each is loaded only once.
+ */
+std::shared_ptr<Image> WidgetArchive::getImage(const std::string_view name) const {
+    if(auto it = this->images.find(name); it != this->images.end()) {
+        return it->second;
+    }
+
+    std::shared_ptr<Image> image;
+    if(this->loader && *this->loader) {
+        image = (*this->loader)(name);
+    } else {
+        image = Image::Read(name);
+    }
+
+    this->images.emplace(name, image);
+    return image;
+}
+
+/**
+ * @brief Create the widget tree described by the archive
+ *
+ * Widgets are created in a single pass over the archive, and allocated from a single block of
+ * memory. It's released once all widgets created by this call are deallocated; removing some of
+ * them from the tree does not free any memory.
+ *
+ * @param loader Function to load images referenced by the archive; if not specified, images are
+ *        read from disk, with the name as the path.
+ *
+ * @return Root widget of the tree
+ *
+ * @throw std::runtime_error The archive is invalid
+ */
+std::shared_ptr<Widget> WidgetArchive::instantiate(const ImageLoader &loader) {
+    const auto hdr = Load<FileHeader>(this->data.data());
+
+    auto arena = std::make_shared<ArenaAllocator<Widget>::Arena>(
+            std::max<size_t>(hdr.allocationSize, kMinArenaSize));
+    ArenaAllocator<Widget> alloc(arena);
+
+    this->loader = &loader;
+    this->images.clear();
+
+    /// Widget that still expects children
+    struct Parent {
+        std::shared_ptr<Widget> widget;
+        uint16_t remaining;
+    };
+
+    std::shared_ptr<Widget> root;
+    std::vector<Parent> parents;
+    std::vector<ArchiveValue> values;
+    size_t offset{0};
+
+    const auto base = this->nodes.data();
+    const auto length = this->nodes.size();
+
+    try {
+        for(size_t i = 0; i < this->numWidgets; i++) {
+            if(offset + sizeof(NodeHeader) > length) {
+                throw std::runtime_error("widget archive node truncated");
+            }
+
+            const auto node = Load<NodeHeader>(base + offset);
+            offset += sizeof(NodeHeader);
+
+            const auto propsEnd = offset + node.propertiesSize;
+            if(propsEnd > length) {
+                throw std::runtime_error("widget archive node truncated");
+            }
+
+            // create the widget and apply its properties
+            auto widget = MakeArchivedWidget(static_cast<ArchiveWidgetType>(node.type),
+                    Rect({node.x, node.y}, {node.width, node.height}), alloc);
+
+            values.clear();
+
+            while(offset < propsEnd) {
+                if(offset + kPropertyHeaderSize > propsEnd) {
+                    throw std::runtime_error("widget archive property truncated");
+                }
+
+                ArchiveValue value;
+                value.key = static_cast<ArchiveKey>(base[offset]);
+                value.kind = static_cast<uint8_t>(base[offset + 1]);
+                value.payload = base + offset + kPropertyHeaderSize;
+                value.archive = this;
+
+                const auto payloadSize = GetPayloadSize(value.kind);
+                if(!payloadSize) {
+                    throw std::runtime_error("invalid property type in widget archive");
+                }
+
+                offset += kPropertyHeaderSize + payloadSize;
+                if(offset > propsEnd) {
+                    throw std::runtime_error("widget archive property truncated");
+                }
+
+                values.push_back(value);
+            }
+
+            widget->decodeProperties(values);
+
+            if(node.flags & kNodeHidden) {
+                widget->setHidden(true);
+            }
+
+            // insert it into the tree
+            if(parents.empty()) {
+                if(root) {
+                    throw std::runtime_error("widget archive has multiple roots");
+                }
+                root = widget;
+            } else {
+                auto &parent = parents.back();
+                parent.widget->addChild(widget);
+
+                if(!--parent.remaining) {
+                    parents.pop_back();
+                }
+            }
+
+            if(node.numChildren) {
+                parents.push_back({widget, node.numChildren});
+            }
+        }
+
+        if(!parents.empty()) {
+            throw std::runtime_error("widget archive truncated");
+        }
+    } catch(...) {
+        this->loader = nullptr;
+        this->images.clear();
+        throw;
+    }
+
+    this->loader = nullptr;
+    this->images.clear();
+
+    return root;
+}
+
+/**
+ * @brief Archive a widget tree
+ *
+ * All widgets in the tree must support archiving, and their frames must lie within the 16-bit
+ * coordinate space.
+ *
+ * @param root Root of the widget tree to archive
+ *
+ * @return Archive data
+ *
+ * @throw std::invalid_argument A widget in the tree can't be archived, or the tree is too large
+ */
+std::vector<std::byte> WidgetArchive::Export(const std::shared_ptr<Widget> &root) {
+    if(!root) {
+        throw std::invalid_argument("invalid root widget");
+    }
+
+    std::vector<std::byte> nodes, strings;
+    std::unordered_map<std::string, uint32_t> stringOffsets;
+    uint32_t numWidgets{0};
+    size_t allocationSize{0};
+
+    ExportWidget(root, nodes, strings, stringOffsets, numWidgets, allocationSize);
+
+    if(sizeof(FileHeader) + nodes.size() + strings.size() > UINT32_MAX ||
+            allocationSize > UINT32_MAX) {
+        throw std::invalid_argument("widget tree too large to archive");
+    }
+
+    // assemble the archive
+    FileHeader hdr{};
+    hdr.magic = kMagic;
+    hdr.version = kVersion;
+    hdr.numNodes = numWidgets;
+    hdr.nodesOffset = sizeof(FileHeader);
+    hdr.nodesSize = nodes.size();
+    hdr.stringsOffset = hdr.nodesOffset + hdr.nodesSize;
+    hdr.stringsSize = strings.size();
+    hdr.allocationSize = allocationSize;
+
+    std::vector<std::byte> out;
+    out.reserve(sizeof(FileHeader) + nodes.size() + strings.size());
+
+    Append(out, hdr);
+    out.insert(out.end(), nodes.begin(), nodes.end());
+    out.insert(out.end(), strings.begin(), strings.end());
+
+    return out;
+}
+
+/**
+ * @brief Archive a widget tree to a file
+ *
+ * @param root Root of the widget tree to archive
+ * @param path Path of the file to write; it's overwritten if it exists
+ *
+ * @throw std::invalid_argument A widget in the tree can't be archived
+ * @throw std::system_error Failed to write the file
+ */
+void WidgetArchive::Export(const std::shared_ptr<Widget> &root,
+        const std::filesystem::path &path) {
+    const auto data = Export(root);
+
+    auto fp = fopen(path.native().c_str(), "wb");
+    if(!fp) {
+        throw std::system_error(errno, std::generic_category(), "fopen archive");
+    }
+
+    const bool ok = fwrite(data.data(), 1, data.size(), fp) == data.size();
+    if(fclose(fp) || !ok) {
+        throw std::system_error(errno, std::generic_category(), "write archive");
+    }
+}
+
+/**
+ * @brief Archive a widget and all its children
+ *
+ * The widget's node is appended to the node data, followed by the nodes of each of its children.
+ */
+void WidgetArchive::ExportWidget(const std::shared_ptr<Widget> &widget,
+        std::vector<std::byte> &nodes, std::vector<std::byte> &strings,
+        std::unordered_map<std::string, uint32_t> &stringOffsets, uint32_t &numWidgets,
+        size_t &allocationSize) {
+    const auto type = widget->getArchiveType();
+    if(type == ArchiveWidgetType::None) {
+        throw std::invalid_argument("widget type can't be archived");
+    }
+
+    // collect properties
+    std::vector<std::byte> props;
+    ArchiveEncoder encoder(props, strings, stringOffsets);
+    widget->encode(encoder);
+
+    if(props.size() > UINT16_MAX) {
+        throw std::invalid_argument("too many widget properties");
+    }
+
+    size_t numChildren{0};
+    widget->forEachChild([&](auto &) {
+        numChildren++;
+    });
+
+    if(numChildren > UINT16_MAX) {
+        throw std::invalid_argument("too many child widgets");
+    }
+
+    // write the node; its extent must be addressable with 16-bit coordinates
+    const auto frame = widget->getFrame();
+    if(frame.right() > INT16_MAX || frame.bottom() > INT16_MAX) {
+        throw std::invalid_argument("widget frame out of range");
+    }
+
+    NodeHeader node{};
+    node.type = static_cast<uint16_t>(type);
+    node.flags = widget->isHidden() ? kNodeHidden : 0;
+    node.x = frame.origin.x;
+    node.y = frame.origin.y;
+    node.width = frame.size.width;
+    node.height = frame.size.height;
+    node.numChildren = numChildren;
+    node.propertiesSize = props.size();
+
+    Append(nodes, node);
+    nodes.insert(nodes.end(), props.begin(), props.end());
+
+    numWidgets++;
+    allocationSize += GetAllocationSize(type);
+
+    // then its children
+    widget->forEachChild([&](auto &child) {
+        ExportWidget(child, nodes, strings, stringOffsets, numWidgets, allocationSize);
+    });
+}
@@ -0,0 +1,137 @@
+/**
+ * @file
+ *
+ * @brief Widget archive format
+ *
+ * A widget archive consists of a file header, followed by the widget nodes and a string table.
+ * All values are stored in native byte order, without any padding between nodes or properties, so
+ * that an archive can be used directly from a memory mapping without any conversion.
+ *
+ * Widget nodes are stored in pre-order: each node is followed by its first child (and all of its
+ * descendants), then the next child, and so forth. Each node consists of a fixed size header,
+ * followed by its properties; properties start with a key and type byte, followed by a payload
+ * whose size depends on the type.
+ *
+ * Strings (including font and image names) are stored in the string table, and referenced by
+ * offset and length. They're NUL terminated in the table, so they can be passed directly to APIs
+ * that expect C strings.
+ */
+#ifndef SHITTYGUI_WIDGETARCHIVEFORMAT_H
+#define SHITTYGUI_WIDGETARCHIVEFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace shittygui::widgetarchive {
+/// Archive magic value ('SGUI')
+constexpr static const uint32_t kMagic{0x49554753};
+/// Current format version
+constexpr static const uint16_t kVersion{1};
+
+/**
+ * @brief Archive header
+ *
+ * Located at the start of the archive. Offsets are relative to the start of the archive.
+ */
+struct FileHeader {
+    /// Magic value (kMagic)
+    uint32_t magic;
+    /// Format version (kVersion)
+    uint16_t version;
+    uint16_t reserved;
+    /// Total number of widget nodes
+    uint32_t numNodes;
+    /// Offset of the first widget node
+    uint32_t nodesOffset;
+    /// Total size of all widget nodes, in bytes
+    uint32_t nodesSize;
+    /// Offset of the string table
+    uint32_t stringsOffset;
+    /// Size of the string table, in bytes
+    uint32_t stringsSize;
+    /// Bytes of memory required to allocate all widgets (a hint)
+    uint32_t allocationSize;
+};
+static_assert(sizeof(FileHeader) == 32, "invalid archive header size");
+
+/**
+ * @brief Widget node header
+ */
+struct NodeHeader {
+    /// Widget type (ArchiveWidgetType)
+    uint16_t type;
+    /// Node flags
+    uint16_t flags;
+    /// Frame of the widget
+    int16_t x, y;
+    uint16_t width, height;
+    /// Number of direct children
+    uint16_t numChildren;
+    /// Size of the properties following the header, in bytes
+    uint16_t propertiesSize;
+};
+static_assert(sizeof(NodeHeader) == 16, "invalid node header size");
+
+/// Node flag: the widget is hidden
+constexpr static const uint16_t kNodeHidden{(1 << 0)};
+
+/**
+ * @brief Property value types
+ */
+enum ValueKind: uint8_t {
+    /// Single byte, 0 or 1
+    kValueBool                          = 1,
+    /// 64-bit signed integer
+    kValueInteger                       = 2,
+    /// Double precision floating point
+    kValueDouble                        = 3,
+    /// Four single precision floats (red, green, blue, alpha)
+    kValueColor                         = 4,
+    /// String reference
+    kValueString                        = 5,
+    /// String reference (font description) followed by a double precision size
+    kValueFont                          = 6,
+    /// String reference (image name)
+    kValueImage                         = 7,
+};
+
+/**
+ * @brief Reference to a string in the string table
+ */
+struct StringRef {
+    /// Offset into the string table
+    uint32_t offset;
+    /// Length of the string, excluding the terminating NUL
+    uint32_t length;
+};
+static_assert(sizeof(StringRef) == 8, "invalid string ref size");
+
+/// Size of a property header (key and kind), in bytes
+constexpr static const size_t kPropertyHeaderSize{2};
+
+/**
+ * @brief Get the size of a property value's payload
+ *
+ * @return Size in bytes, or 0 if the kind is invalid
+ */
+constexpr static inline size_t GetPayloadSize(const uint8_t kind) {
+    switch(kind) {
+        case kValueBool:
+            return 1;
+        case kValueInteger:
+        case kValueDouble:
+            return 8;
+        case kValueColor:
+            return 16;
+        case kValueString:
+        case kValueImage:
+            return sizeof(StringRef);
+        case kValueFont:
+            return sizeof(StringRef) + sizeof(double);
+        default:
+            return 0;
+    }
+}
+}
+
+#endif
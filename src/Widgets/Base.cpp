@@ -1,21 +1,61 @@
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cxxabi.h>
 #include <functional>
 #include <stdexcept>
+#include <typeinfo>
 
 #include <cairo.h>
 
 #include "Animator.h"
 #include "CairoHelpers.h"
 #include "Errors.h"
+#include "FocusEngine.h"
+#include "GestureRecognizer.h"
+#include "Image/SurfaceImage.h"
+#include "JsonWriter.h"
+#include "MemoryAccounting.h"
+#include "SurfacePool.h"
+#include "Tracing.h"
 #include "Util.h"
 #include "Widget.h"
 
 using namespace shittygui;
 
+/**
+ * @brief Get the number of nanoseconds elapsed since a given time point
+ */
+static inline uint64_t NsecSince(const std::chrono::high_resolution_clock::time_point start) {
+    const auto diff = std::chrono::high_resolution_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(diff).count();
+}
+
+/**
+ * @brief Initialize a widget with the given frame
+ *
+ * @param frame Frame rectangle, its origin is relative to the parent widget
+ */
+Widget::Widget(const Rect &frame) {
+    this->setFrame(frame);
+
+    this->accountedBytes = sizeof(Widget);
+    memory::Allocated(MemoryCategory::Widgets, this->accountedBytes);
+}
+
+/**
+ * @brief Release widget resources
+ */
+Widget::~Widget() {
+    this->untrackCaches();
+    memory::Freed(MemoryCategory::Widgets, this->accountedBytes);
+}
+
 /**
  * @brief Add a new widget as a child
  *
- * The given widget is added to our children list, and its callbacks are invoked.
+ * The given widget is added to our children list, and its callbacks are invoked. If the widget
+ * already has a parent, it's removed from it first.
  *
  * @remark A widget hierarchy should be built from the top down. That is, create the root view
  *         first and associate it with a screen. Then, add subviews of the root view to it; then
@@ -26,6 +66,40 @@ using namespace shittygui;
  *        end of the list (when unset, default)instead of the end (default)
  */
 void Widget::addChild(const std::shared_ptr<Widget> &toAdd, const bool atStart) {
+    this->insertChild(toAdd, atStart ? this->children.begin() : this->children.end());
+    this->childrenDirtyFlag = true;
+}
+
+/**
+ * @brief Add multiple widgets as children
+ *
+ * This is equivalent to adding each widget with addChild(), but is cheaper for large numbers of
+ * widgets. The widgets are inserted in order, either at the end of the child list, or before all
+ * existing children.
+ *
+ * @param toAdd Widgets to add
+ * @param atStart Insert the widgets at the start of the child list rather than at the end
+ */
+void Widget::addChildren(std::span<const std::shared_ptr<Widget>> toAdd, const bool atStart) {
+    auto pos = atStart ? this->children.begin() : this->children.end();
+
+    for(const auto &widget : toAdd) {
+        pos = std::next(this->insertChild(widget, pos));
+    }
+
+    this->childrenDirtyFlag = true;
+}
+
+/**
+ * @brief Insert a child widget into the child list
+ *
+ * @param toAdd Widget to add
+ * @param pos Child list position to insert the widget before
+ *
+ * @return Child list position of the inserted widget
+ */
+std::list<std::shared_ptr<Widget>>::iterator Widget::insertChild(const std::shared_ptr<Widget> &toAdd,
+        std::list<std::shared_ptr<Widget>>::iterator pos) {
     // validate the widget ptr
     if(!toAdd) {
         throw std::invalid_argument("invalid widget ptr");
@@ -33,73 +107,180 @@ void Widget::addChild(const std::shared_ptr<Widget> &toAdd, const bool atStart)
         throw std::invalid_argument("cannot add widget to itself");
     }
 
+    if(auto oldParent = toAdd->parent.lock()) {
+        // don't invalidate the insertion position if the widget is already there
+        if(oldParent.get() == this && toAdd->siblingPos == pos) {
+            ++pos;
+        }
+        oldParent->removeChild(toAdd);
+    }
+
     // TODO: check whether adding it would form a loop in the widget tree
     toAdd->willMoveToParent(toAdd);
 
-    if(atStart) {
-        this->children.emplace_front(toAdd);
-    } else {
-        this->children.emplace_back(toAdd);
-    }
+    toAdd->siblingPos = this->children.emplace(pos, toAdd);
 
     toAdd->parent = this->shared_from_this();
+    toAdd->movedSinceDraw = true;
+    toAdd->invalidateScreenGeometry();
+    toAdd->invalidateFocus();
     toAdd->didMoveToParent();
 
-    this->updateChildData();
+    // inherit profiling state
+    if(this->profile && !toAdd->profile) {
+        toAdd->setProfilingEnabled(true);
+    }
+
+    toAdd->updateMemoryAccounting();
+    this->updateMemoryAccounting();
+
+    // transparency optimizations
+    toAdd->countedTransparent = !toAdd->isOpaque();
+    if(toAdd->countedTransparent) {
+        this->numTransparentChildren++;
+    }
+    this->hasTransparentChildren = (this->numTransparentChildren != 0);
+
+    toAdd->needsDisplay();
+    return toAdd->siblingPos;
 }
 
 /**
  * @brief Remove a particular child
  *
- * Remove a child widget from our hierarchy
+ * Remove a child widget from our hierarchy. This takes constant time, regardless of the number of
+ * children.
  *
  * @param toRemove Widget to remove
  *
  * @return Whether the widget was found and removed
  */
 bool Widget::removeChild(const std::shared_ptr<Widget> &toRemove) {
-    using namespace std::placeholders;
-
     if(!toRemove) {
         throw std::invalid_argument("invalid widget ptr");
+    } else if(toRemove->parent.lock().get() != this) {
+        // not one of our children
+        return false;
     }
 
-    for(auto it = this->children.begin(); it != this->children.end(); ++it) {
-        auto child = *it;
-        if(child != toRemove) {
+    this->detachChild(toRemove->siblingPos);
+    this->childrenDirtyFlag = true;
+
+    return true;
+}
+
+/**
+ * @brief Remove all children matching a predicate
+ *
+ * The child list is walked once, and each child for which the predicate returns true is removed,
+ * as if with removeChild().
+ *
+ * @param predicate Function invoked for each child; return true to remove it
+ *
+ * @return Number of children removed
+ */
+size_t Widget::removeChildren(const std::function<bool(const std::shared_ptr<Widget> &)> &predicate) {
+    size_t removed{0};
+
+    for(auto it = this->children.begin(); it != this->children.end();) {
+        if(!predicate(*it)) {
+            ++it;
             continue;
         }
 
-        // remove this bad boy
-        child->willMoveToParent(nullptr);
+        it = this->detachChild(it);
+        removed++;
+    }
 
-        child->parent.reset();
-        child->didMoveToParent();
+    if(removed) {
+        this->childrenDirtyFlag = true;
+    }
 
-        // erase the entry
-        this->children.erase(it);
+    return removed;
+}
 
-        this->updateChildData();
-        return true;
+/**
+ * @brief Remove the child at the given child list position
+ *
+ * @return Child list position following the removed child
+ */
+std::list<std::shared_ptr<Widget>>::iterator Widget::detachChild(
+        std::list<std::shared_ptr<Widget>>::iterator it) {
+    // keep the widget alive until it's fully removed
+    auto child = *it;
+
+    if(!child->hidden) {
+        this->addStructuralDamage(child->frame);
     }
 
-    // not found
-    return false;
+    child->willMoveToParent(nullptr);
+    child->invalidateFocus();
+
+    child->parent.reset();
+    child->invalidateScreenGeometry();
+    child->didMoveToParent();
+
+    if(child->countedTransparent) {
+        this->numTransparentChildren--;
+        child->countedTransparent = false;
+    }
+    this->hasTransparentChildren = (this->numTransparentChildren != 0);
+
+    // it's no longer drawn as part of the tree, so its statistics would only go stale
+    if(child->profile) {
+        child->setProfilingEnabled(false);
+    }
+
+    // erase the entry
+    child->siblingPos = {};
+    auto next = this->children.erase(it);
+
+    this->updateMemoryAccounting();
+    return next;
 }
 
+
+
 /**
- * @brief Updates cached child data after modifying the child list
+ * @brief Draw the widget
+ *
+ * The base implementation clears the dirty flag, and draws the focus ring if the widget is the
+ * first responder. Subclasses should invoke it after drawing their content.
+ *
+ * If the screen compares the widget's draw state, it's recorded here as well. It's only known to
+ * match the pixels on screen (at the widget's current location) if no part of the widget is still
+ * waiting to be redrawn.
  */
-void Widget::updateChildData() {
-    using namespace std::placeholders;
+void Widget::draw(cairo_t *drawCtx, const bool everything) {
+    if(this->focused) {
+        cairo_save(drawCtx);
+        this->drawFocusRing(drawCtx);
+        cairo_restore(drawCtx);
+    }
 
-    // transparency optimizations
-    this->hasTransparentChildren = !std::all_of(this->children.begin(), this->children.end(),
-            std::bind(&Widget::isOpaque, _1));
-    this->childrenDirtyFlag = true;
+    if(this->drawStateTracked) {
+        this->drawnStateHash = this->pendingDirtyRect.isEmpty() ? this->computeDrawStateHash() : 0;
+    }
+
+    this->dirtyFlag = false;
+    if(this->pendingDirtyRect.isEmpty()) {
+        this->movedSinceDraw = false;
+    }
 }
 
+/**
+ * @brief Draw the focus ring
+ *
+ * The default focus ring is a rectangle just inside the widget's bounds. Widgets with a different
+ * shape should override this to draw a matching outline.
+ */
+void Widget::drawFocusRing(cairo_t *drawCtx) {
+    cairo::Rectangle(drawCtx, this->getBounds().inset(kFocusRingWidth / 2.));
 
+    cairo::SetSource(drawCtx, kFocusRingColor);
+    cairo_set_line_width(drawCtx, kFocusRingWidth);
+    cairo_stroke(drawCtx);
+}
 
 /**
  * @brief Draw child widgets
@@ -112,14 +293,14 @@ void Widget::updateChildData() {
  * least one child exists, this routine will be invoked. This implies that the content of
  * a widget with children will be painted over by its children.
  *
- * Additionally, this routine takes into account the dirty status of children (unless the
- * `everything` flag is set) when deciding which children to draw.
+ * Only children that intersect the region being redrawn (this widget's dirty rect) are drawn; each
+ * of them has its dirty rect updated to the part of it that's being redrawn.
  *
  * @remark This routine should be called with the coordinate space translated such that the origin
  *         of the drawing context is the same as the origin of the widget we're drawing.
  *
  * @param drawCtx Cairo drawing context
- * @param everything When set, draw everything regardless of dirty status
+ * @param everything Unused; the region to draw is determined by the dirty rect
  */
 void Widget::drawChildren(cairo_t *drawCtx, bool everything) {
     // early abort if no children
@@ -127,21 +308,40 @@ void Widget::drawChildren(cairo_t *drawCtx, bool everything) {
         return;
     }
 
-    everything |= this->animationParticipant;
-
     // translate coordinates to our origin
     cairo_save(drawCtx);
 
     const auto &frame = this->getFrame();
-    cairo_translate(drawCtx, frame.origin.x, frame.origin.y);
+    cairo::TranslateSnapped(drawCtx, frame.origin.x, frame.origin.y);
 
     if(this->clipToBounds()) {
-        cairo::Rectangle(drawCtx, this->getBounds());
+        cairo::AlignedRectangle(drawCtx, this->getBounds());
         cairo_clip(drawCtx);
     }
 
-    // process each child, in the order they were added
-    for(const auto &child : this->children) {
+    this->drawChildRange(drawCtx, this->children.begin());
+
+    // restore original coordinate system
+    cairo_restore(drawCtx);
+
+    this->childrenDirtyFlag = false;
+}
+
+/**
+ * @brief Draw a range of child widgets
+ *
+ * Draws all children starting at the given position in the child list, in order, along with their
+ * children. Only children that intersect this widget's dirty rect are drawn.
+ *
+ * @param drawCtx Cairo drawing context, with its origin at this widget's origin
+ * @param from First child to draw
+ */
+void Widget::drawChildRange(cairo_t *drawCtx, std::list<std::shared_ptr<Widget>>::iterator from) {
+    const auto &dirty = this->dirtyRect;
+
+    for(auto it = from; it != this->children.end(); ++it) {
+        const auto &child = *it;
+
         // skip if drawing is inhibited
         if(child->inhibitDrawing && !this->animationParticipant) {
             continue;
@@ -151,51 +351,225 @@ void Widget::drawChildren(cairo_t *drawCtx, bool everything) {
             continue;
         }
 
-        // if the child is dirty, draw it
-        if(child->isDirty() || everything) {
-            const auto &childFrame = child->getFrame();
+        child->markVisible();
+
+        /*
+         * Determine which part of the child needs to be redrawn, and skip it if it doesn't
+         * intersect the region being redrawn at all. Widgets that don't clip to their bounds
+         * may draw anywhere, so they'll always get drawn.
+         */
+        const auto &childFrame = child->getFrame();
+        child->dirtyRect = dirty.offset(-childFrame.origin.x, -childFrame.origin.y);
 
-            cairo_save(drawCtx);
+        if(child->clipToBounds()) {
+            child->dirtyRect = child->dirtyRect.intersection(child->getBounds());
 
-            // clip the child to its bounds
-            if(child->clipToBounds()) {
-                cairo::Rectangle(drawCtx, childFrame);
-                cairo_clip(drawCtx);
+            if(child->dirtyRect.isEmpty()) {
+                continue;
             }
+        }
 
-            // translate coordinate origin
-            cairo_translate(drawCtx, childFrame.origin.x, childFrame.origin.y);
+        const bool profiled{child->profile != nullptr};
+        std::chrono::high_resolution_clock::time_point start;
 
-            // draw the child then restore gfx state
-            child->draw(drawCtx, everything);
-            cairo_restore(drawCtx);
+        if(profiled) {
+            start = std::chrono::high_resolution_clock::now();
         }
 
-        // then recurse and draw its children, if any
-        child->drawChildren(drawCtx, everything);
-    }
+        // translate coordinate origin (aligned to a device pixel) and clip to its bounds
+        cairo_save(drawCtx);
+        cairo::TranslateSnapped(drawCtx, childFrame.origin.x, childFrame.origin.y);
 
-    // restore original coordinate system
-    cairo_restore(drawCtx);
+        if(child->clipToBounds()) {
+            cairo::AlignedRectangle(drawCtx, child->getBounds());
+            cairo_clip(drawCtx);
+        }
 
-    this->childrenDirtyFlag = false;
+        // draw the child then restore gfx state
+        SHITTYGUI_TRACE(widget__draw__start, child.get(), child->getDebugLabel().data());
+        child->draw(drawCtx, true);
+        SHITTYGUI_TRACE(widget__draw__done, child.get());
+        cairo_restore(drawCtx);
+
+        if(profiled) {
+            child->profile->current.selfTime += NsecSince(start);
+            child->profile->current.drawCount++;
+        }
+
+        // then recurse and draw its children, if any
+        child->drawChildren(drawCtx, true);
+
+        if(profiled) {
+            child->profile->current.totalTime += NsecSince(start);
+        }
+    }
 }
 
 /**
  * @brief Mark the widget as dirty
  *
  * This routine is invoked by other code in the GUI layer to mark this widget as needing
- * to be redrawn.
+ * to be redrawn. The entire widget is invalidated.
  *
  * @remark Subclasses must invoke the superclass' implementation of this method if they override it
  *         as it is used to propagate dirtiness up the view hierarchy.
  */
 void Widget::needsDisplay() {
+    this->needsDisplayInRect(this->getBounds());
+}
+
+/**
+ * @brief Get the hash of the widget's complete draw state
+ *
+ * Combines the widget specific draw state with its size and focus state.
+ *
+ * @return Draw state hash, or 0 if the widget doesn't provide one
+ */
+uint64_t Widget::computeDrawStateHash() const {
+    auto hash = this->getDrawStateHash();
+    if(!hash) {
+        return 0;
+    }
+
+    HashCombine(hash, this->frame.size.width);
+    HashCombine(hash, this->frame.size.height);
+    HashCombine(hash, static_cast<bool>(this->focused));
+
+    return hash ? hash : 1;
+}
+
+/**
+ * @brief Render the widget into an image
+ *
+ * Draws the widget and all its children into an offscreen image, regardless of whether the
+ * widget is currently visible. This can be used for transitions or to produce thumbnails.
+ *
+ * If the widget is on a screen that renders at the framebuffer resolution, the image is rendered
+ * at that resolution, and its scale factor is set accordingly.
+ *
+ * @return Image of the widget; areas the widget does not draw to are transparent.
+ */
+std::shared_ptr<Image> Widget::snapshot() {
+    double scale{1.};
+
+    auto screen = this->getScreen();
+    if(screen && screen->getScaleMode() == Screen::ScaleMode::Vector) {
+        scale = screen->getScaleFactor();
+    }
+
+    const auto width = std::max(1, static_cast<int>(std::ceil(this->frame.size.width * scale))),
+          height = std::max(1, static_cast<int>(std::ceil(this->frame.size.height * scale)));
+
+    // get a surface to render into; the image takes ownership of it
+    cairo_surface_t *surface{nullptr};
+
+    if(auto pool = this->getSurfacePool()) {
+        surface = pool->acquire(CAIRO_FORMAT_ARGB32, width, height);
+    } else {
+        surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    }
+
+    auto image = std::make_shared<image::SurfaceImage>(surface);
+    image->setScale(scale);
+
+    // clear it, then draw the widget and its children
+    auto ctx = cairo_create(surface);
+    cairo_set_antialias(ctx, CAIRO_ANTIALIAS_FAST);
+
+    cairo_set_operator(ctx, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(ctx);
+    cairo_set_operator(ctx, CAIRO_OPERATOR_OVER);
+
+    cairo_scale(ctx, scale, scale);
+
+    this->dirtyRect = this->getBounds();
+
+    cairo_save(ctx);
+    this->draw(ctx, true);
+    cairo_restore(ctx);
+
+    cairo_translate(ctx, -this->frame.origin.x, -this->frame.origin.y);
+    this->drawChildren(ctx, true);
+
+    cairo_destroy(ctx);
+    cairo_surface_flush(surface);
+
+    return image;
+}
+
+/**
+ * @brief Mark part of the widget as dirty
+ *
+ * Invalidate only the specified region of the widget. Invalidated regions are accumulated, and
+ * the widget is added to its screen's list of dirty widgets. On the next redraw, the region is
+ * converted to screen coordinates and only widgets intersecting it are drawn, with drawing
+ * clipped to it.
+ *
+ * Invalidations of widgets that are hidden (or whose ancestors are hidden) or that lie outside the
+ * clipping bounds of their ancestors are ignored.
+ *
+ * @param rect Region to invalidate, in the coordinate space of this widget
+ */
+void Widget::needsDisplayInRect(const Rect &rect) {
     if(auto ptr = this->getParent()) {
         ptr->needsChildDisplay();
     }
 
     this->dirtyFlag = true;
+
+    const auto area = rect.intersection(this->getBounds());
+    if(area.isEmpty()) {
+        return;
+    }
+
+    this->pendingDirtyRect = this->pendingDirtyRect.unionWith(area);
+    this->registerDirty();
+}
+
+/**
+ * @brief Add the widget to its screen's dirty widget list
+ *
+ * This is a no-op if the widget is already in the list, or is not on a screen.
+ */
+void Widget::registerDirty() {
+    if(this->inDirtyList) {
+        return;
+    }
+
+    if(auto screen = this->getScreen()) {
+        screen->dirtyWidgets.emplace_back(this->weak_from_this());
+        this->inDirtyList = true;
+    }
+}
+
+/**
+ * @brief Invalidate a region of the screen covered by this widget
+ *
+ * Unlike needsDisplayInRect(), this immediately adds the region (in screen coordinates) to the
+ * screen's damage region. It's used when the structure of the widget hierarchy changes, that is,
+ * when children are moved, hidden or removed, rather than when the widget's content changes.
+ *
+ * @param rect Region to invalidate, in the coordinate space of this widget
+ */
+void Widget::addStructuralDamage(const Rect &rect) {
+    this->updateScreenGeometry();
+    if(!this->screenVisible) {
+        return;
+    }
+
+    auto screen = this->getScreen();
+    if(!screen) {
+        return;
+    }
+
+    const auto area = rect.offset(this->screenOrigin.x, this->screenOrigin.y)
+        .intersection(this->screenClip);
+    if(area.isEmpty()) {
+        return;
+    }
+
+    screen->addDamage(area);
+    this->registerDirty();
 }
 
 /**
@@ -212,13 +586,30 @@ void Widget::needsChildDisplay() {
 }
 
 /**
- * This will notify our parent (or, if there is none, the screen) that it needs to redraw
- * everything.
+ * @brief Invalidate the area currently covered by the widget
+ *
+ * Invoked before the widget's frame or visibility changes, so that whatever is below the widget
+ * in its current location is redrawn.
  */
-void Widget::frameDidChange() {
+void Widget::invalidateFrame() {
+    if(this->hidden) {
+        return;
+    }
+
     if(auto parent = this->getParent()) {
-        parent->childrenDirtyFlag = true;
-        parent->needsDisplay();
+        parent->addStructuralDamage(this->frame);
+    } else if(auto screen = this->screen.lock()) {
+        screen->needsDisplay();
+    }
+}
+
+/**
+ * Both the previous and new area covered by the widget are invalidated by the frame setters. For
+ * the root widget, the entire screen is redrawn.
+ */
+void Widget::frameDidChange() {
+    if(this->getParent()) {
+        return;
     } else if(auto screen = this->getScreen()) {
         screen->needsDisplay();
     }
@@ -237,16 +628,130 @@ void Widget::setScreen(const std::shared_ptr<Screen> &newScreen) {
 
     this->invokeCallbackRecursive(std::bind(&Widget::willMoveToScreen, _1, _2), newScreen);
     this->screen = newScreen;
+    this->invalidateScreenGeometry();
+    this->invalidateFocus();
     this->invokeCallbackRecursive(std::bind(&Widget::didMoveToScreen, _1, _2), newScreen);
 }
 
 
 
+/**
+ * @brief Update the cached screen space geometry
+ *
+ * Calculate the widget's origin and visible area in screen coordinates, as well as whether it's
+ * visible at all, if the cached values are out of date. The geometry of all ancestors is updated
+ * first, as it's derived from theirs.
+ */
+void Widget::updateScreenGeometry() {
+    if(!this->geometryDirty) {
+        return;
+    }
+
+    const Rect ownRect{Point(0, 0), this->frame.size};
+
+    if(auto parent = this->getParent()) {
+        parent->updateScreenGeometry();
+
+        this->screenOrigin = Point(parent->screenOrigin.x + this->frame.origin.x,
+                parent->screenOrigin.y + this->frame.origin.y);
+        this->screenVisible = parent->screenVisible && !this->hidden;
+        this->depth = parent->depth + 1;
+
+        if(this->clipToBounds()) {
+            this->screenClip = ownRect.offset(this->screenOrigin.x, this->screenOrigin.y)
+                .intersection(parent->screenClip);
+        } else {
+            this->screenClip = parent->screenClip;
+        }
+    } else {
+        auto screen = this->screen.lock();
+
+        this->screenOrigin = this->frame.origin;
+        this->screenVisible = (screen != nullptr) && !this->hidden;
+        this->depth = 0;
+        this->screenClip = ownRect.offset(this->screenOrigin.x, this->screenOrigin.y);
+
+        if(screen) {
+            this->screenClip = this->screenClip.intersection(Rect({0, 0}, screen->getSize()));
+        }
+    }
+
+    this->geometryDirty = false;
+}
+
+/**
+ * @brief Invalidate the cached screen space geometry of this widget and all its children
+ *
+ * Since a widget's geometry can only be calculated once its parent's is valid, any children of a
+ * widget with invalid geometry also have invalid geometry, so they need not be visited.
+ */
+void Widget::invalidateScreenGeometry() {
+    if(this->geometryDirty) {
+        return;
+    }
+
+    this->geometryDirty = true;
+
+    for(auto &child : this->children) {
+        child->invalidateScreenGeometry();
+    }
+}
+
+/**
+ * @brief Queue this widget and its children for re-indexing by the focus engine
+ *
+ * Invoke when the widget's membership in the screen's widget tree, position, or visibility
+ * changes. Nothing happens if the widget isn't on a screen.
+ */
+void Widget::invalidateFocus() {
+    if(auto screen = this->getScreen()) {
+        screen->focus->invalidate(this->shared_from_this());
+    }
+}
+
+/**
+ * @brief Find the widget to start redrawing a region from
+ *
+ * Walks up the hierarchy from this widget to find the nearest opaque widget that fully covers the
+ * given area. Since it paints the entire area, nothing beneath it needs to be drawn; only the
+ * widget itself, its children, and whatever is above it (later siblings of it and its ancestors.)
+ *
+ * @param area Region to be redrawn, in screen coordinates
+ *
+ * @return Widget to start drawing from, or `nullptr` if the entire hierarchy must be drawn
+ */
+Widget *Widget::findOpaqueCover(const Rect &area) {
+    Widget *cover{nullptr};
+    std::shared_ptr<Widget> parent;
+
+    for(Widget *widget = this; widget; widget = parent.get()) {
+        widget->updateScreenGeometry();
+        if(!widget->screenVisible) {
+            return nullptr;
+        }
+
+        parent = widget->getParent();
+
+        // anything beneath a widget with inhibited drawing isn't visible
+        if(widget->inhibitDrawing && !(parent && parent->animationParticipant)) {
+            cover = nullptr;
+            continue;
+        }
+
+        if(!cover && widget->isOpaque() && widget->screenClip.contains(area) &&
+                Rect(widget->screenOrigin, widget->frame.size).contains(area)) {
+            cover = widget;
+        }
+    }
+
+    return cover;
+}
+
 /**
  * @brief Search for a child containing the given point
  *
  * This will descend the child hierarchy to find the most specific (that is, deepest into the
- * hierarchy) widget whose frame rectangle contains this point.
+ * hierarchy) visible widget whose frame rectangle contains this point.
  *
  * @param at Point to find the widget under
  * @param outRelativePoint Input point relative to the origin of the returned widget
@@ -257,7 +762,7 @@ void Widget::setScreen(const std::shared_ptr<Screen> &newScreen) {
  */
 std::shared_ptr<Widget> Widget::findChildAt(const Point at, Point &outRelativePoint) {
     // bail if we don't contain this point
-    if(!this->bounds.contains(at)) {
+    if(!this->getBounds().contains(at)) {
         return nullptr;
     }
 
@@ -269,6 +774,11 @@ std::shared_ptr<Widget> Widget::findChildAt(const Point at, Point &outRelativePo
     for(auto it = this->children.rbegin(); it != this->children.rend(); ++it) {
         const auto &child = *it;
 
+        // hidden widgets can't be touched
+        if(child->isHidden()) {
+            continue;
+        }
+
         // translate the point to the child's origin
         const auto &childFrame = child->getFrame();
         const auto translated = Point(at.x - childFrame.origin.x, at.y - childFrame.origin.y);
@@ -284,3 +794,350 @@ std::shared_ptr<Widget> Widget::findChildAt(const Point at, Point &outRelativePo
     outRelativePoint = at;
     return this->shared_from_this();
 }
+
+/**
+ * @brief Attach a gesture recognizer
+ *
+ * The recognizer receives all touches that go down inside this widget or any of its children.
+ *
+ * @param recognizer Recognizer to attach
+ */
+void Widget::addGestureRecognizer(const std::shared_ptr<GestureRecognizer> &recognizer) {
+    if(!recognizer) {
+        throw std::invalid_argument("invalid gesture recognizer ptr");
+    }
+
+    this->gestureRecognizers.emplace_back(recognizer);
+}
+
+/**
+ * @brief Detach a gesture recognizer
+ *
+ * If the recognizer is tracking a touch, it continues to receive events until that touch is
+ * released.
+ *
+ * @return Whether the recognizer was found and removed
+ */
+bool Widget::removeGestureRecognizer(const std::shared_ptr<GestureRecognizer> &recognizer) {
+    auto it = std::find(this->gestureRecognizers.begin(), this->gestureRecognizers.end(),
+            recognizer);
+    if(it == this->gestureRecognizers.end()) {
+        return false;
+    }
+
+    this->gestureRecognizers.erase(it);
+    return true;
+}
+
+
+
+/**
+ * @brief Estimate the memory used by this widget
+ *
+ * This is the size of the widget object itself, plus any memory it allocated on the heap (such as
+ * strings.) Memory used by child widgets is not included, nor are cached rendering resources;
+ * those are accounted in their own memory categories.
+ *
+ * @remark Subclasses should override this, and add their own allocations as well as the size
+ *         difference of their object to the base class implementation.
+ *
+ * @return Estimated memory footprint, in bytes
+ */
+size_t Widget::getMemoryFootprint() const {
+    // each list node holds a shared pointer, plus next/previous links
+    constexpr static const size_t kListNodeSize{sizeof(std::shared_ptr<Widget>) +
+        (2 * sizeof(void *))};
+
+    size_t total = sizeof(Widget);
+#ifndef SHITTYGUI_NO_DEBUG_LABELS
+    if(this->debugLabel) {
+        total += sizeof(std::string) + this->debugLabel->capacity();
+    }
+#endif
+    total += this->children.size() * kListNodeSize;
+
+    if(this->profile) {
+        total += sizeof(DrawProfile);
+    }
+
+    return total;
+}
+
+/**
+ * @brief Update the memory accounted for this widget
+ *
+ * Since the actual size of the widget is not known when the base class constructor runs, the
+ * accounting is updated when the widget is inserted into a widget hierarchy. It's updated again
+ * when its children or profiling state change, and whenever the screen collects it as dirty (since
+ * widgets invalidate themselves when their content, and thus possibly their size, changes.)
+ */
+void Widget::updateMemoryAccounting() {
+    const auto footprint = this->getMemoryFootprint();
+
+    memory::Resized(MemoryCategory::Widgets, this->accountedBytes, footprint);
+    this->accountedBytes = footprint;
+}
+
+/**
+ * @brief Gather all widgets that may hold cached resources
+ *
+ * Walk this widget and all of its children, and record each widget whose caches were not already
+ * released, along with when it was last visible.
+ *
+ * @param out Vector to receive the candidate widgets
+ * @param offscreen Whether this widget is currently not visible (because an ancestor is hidden, or
+ *        has drawing inhibited)
+ */
+void Widget::collectCacheCandidates(std::vector<CacheCandidate> &out, bool offscreen) {
+    offscreen |= this->hidden || this->inhibitDrawing;
+
+    if(!this->cachesReleased) {
+        out.push_back({this, offscreen});
+    }
+
+    for(auto &child : this->children) {
+        child->collectCacheCandidates(out, offscreen);
+    }
+}
+
+/**
+ * @brief Determine whether the widget is currently not visible
+ *
+ * This is the case if it's not on a screen, or it or any of its ancestors are hidden or have
+ * drawing inhibited.
+ */
+bool Widget::isOffscreen() {
+    this->updateScreenGeometry();
+    if(!this->screenVisible) {
+        return true;
+    }
+
+    for(auto widget = this->shared_from_this(); widget; widget = widget->getParent()) {
+        if(widget->inhibitDrawing) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Move the widget to the back of a cache list
+ *
+ * If the widget is in a different cache list (it was drawn on another screen before) it's removed
+ * from that list first.
+ *
+ * @param list Cache list to add the widget to, or `nullptr` to only remove it from its list
+ */
+void Widget::trackCaches(std::list<Widget *> *list) {
+    if(list && list == this->cacheList) {
+        list->splice(list->end(), *list, this->cacheEntry);
+        return;
+    }
+
+    this->untrackCaches();
+
+    if(list) {
+        this->cacheEntry = list->insert(list->end(), this);
+        this->cacheList = list;
+    }
+}
+
+/**
+ * @brief Remove the widget from its cache list, if it's in one
+ */
+void Widget::untrackCaches() {
+    if(this->cacheList) {
+        this->cacheList->erase(this->cacheEntry);
+        this->cacheList = nullptr;
+    }
+}
+
+/**
+ * @brief Enable or disable draw profiling for this widget and all its children
+ *
+ * Enabling profiling allocates the profiling data structure (and resets any existing profiling
+ * statistics) while disabling it releases the structure again.
+ */
+void Widget::setProfilingEnabled(const bool enabled) {
+    if(enabled) {
+        this->profile = std::make_unique<DrawProfile>();
+    } else {
+        this->profile.reset();
+    }
+
+    for(auto &child : this->children) {
+        child->setProfilingEnabled(enabled);
+    }
+
+    this->updateMemoryAccounting();
+}
+
+/**
+ * @brief Complete the current profiling window
+ *
+ * The statistics accumulated in the current window are moved to the "last" window slot, for this
+ * widget and all of its children.
+ */
+void Widget::rollProfileWindow() {
+    if(this->profile) {
+        this->profile->last = this->profile->current;
+        this->profile->current = {};
+    }
+
+    for(auto &child : this->children) {
+        child->rollProfileWindow();
+    }
+}
+
+/**
+ * @brief Write information about this widget (and its children) to a JSON writer
+ *
+ * Each widget is represented by an object containing its class, labels, geometry, state flags,
+ * memory usage and profiling information (if enabled), as well as an array of its children.
+ *
+ * @param writer JSON writer to receive the widget object
+ *
+ * @return Estimated memory footprint of the widget and all of its children
+ */
+size_t Widget::dumpTree(JsonWriter &writer) {
+    writer.beginObject();
+
+    // get a readable name for the class
+    const auto mangledName = typeid(*this).name();
+    int status{-1};
+    char *demangled = abi::__cxa_demangle(mangledName, nullptr, nullptr, &status);
+
+    writer.field("class", (status == 0 && demangled) ? demangled : mangledName);
+    free(demangled);
+
+    writer.field("label", this->getDebugLabel());
+    writer.field("tag", static_cast<uint64_t>(this->tag));
+    writer.field("address", static_cast<uint64_t>(reinterpret_cast<uintptr_t>(this)));
+
+    // geometry
+    writer.key("frame");
+    writer.beginArray();
+    writer.value(static_cast<int64_t>(this->frame.origin.x));
+    writer.value(static_cast<int64_t>(this->frame.origin.y));
+    writer.value(static_cast<int64_t>(this->frame.size.width));
+    writer.value(static_cast<int64_t>(this->frame.size.height));
+    writer.endArray();
+
+    // state flags
+    writer.key("flags");
+    writer.beginObject();
+    writer.field("dirty", static_cast<bool>(this->dirtyFlag));
+    writer.field("childrenDirty", static_cast<bool>(this->childrenDirtyFlag));
+    writer.field("opaque", this->isOpaque());
+    writer.field("hidden", static_cast<bool>(this->hidden));
+    writer.field("inhibited", static_cast<bool>(this->inhibitDrawing));
+    writer.field("animating", static_cast<bool>(this->animationParticipant));
+    writer.field("clipsToBounds", this->clipToBounds());
+    writer.endObject();
+
+    // drawing statistics of the last complete window
+    if(this->profile) {
+        const auto &window = this->profile->last;
+
+        writer.key("draw");
+        writer.beginObject();
+        writer.field("count", static_cast<uint64_t>(window.drawCount));
+        writer.field("selfTimeUsec", static_cast<double>(window.selfTime) / 1000.);
+        writer.field("totalTimeUsec", static_cast<double>(window.totalTime) / 1000.);
+        writer.endObject();
+    }
+
+    // memory and children
+    const auto selfMemory = this->getMemoryFootprint();
+    size_t totalMemory{selfMemory};
+
+    writer.field("memory", static_cast<uint64_t>(selfMemory));
+
+    writer.key("children");
+    writer.beginArray();
+    for(auto &child : this->children) {
+        totalMemory += child->dumpTree(writer);
+    }
+    writer.endArray();
+
+    writer.field("subtreeMemory", static_cast<uint64_t>(totalMemory));
+
+    writer.endObject();
+    return totalMemory;
+}
+
+
+
+/**
+ * @brief Find a descendant widget by its tag
+ *
+ * Searches the widget's children (and their children, depth first) for a widget with the given
+ * tag. This is typically used to locate widgets in a tree instantiated from a widget archive.
+ *
+ * @param tag Tag value to search for
+ *
+ * @return First widget with the given tag, or `nullptr` if there is none
+ */
+std::shared_ptr<Widget> Widget::findChildWithTag(const uintptr_t tag) {
+    for(auto &child : this->children) {
+        if(child->tag == tag) {
+            return child;
+        } else if(auto found = child->findChildWithTag(tag)) {
+            return found;
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Write the widget's properties to an archive
+ *
+ * Subclasses that can be archived should add their own properties, then invoke this base class
+ * implementation. The frame and hidden state are stored by the archive itself.
+ */
+void Widget::encode(ArchiveEncoder &encoder) const {
+    if(this->tag) {
+        encoder.addInteger(ArchiveKey::Tag, this->tag);
+    }
+    if(const auto label = this->getDebugLabel(); !label.empty()) {
+        encoder.addString(ArchiveKey::DebugLabel, label);
+    }
+}
+
+/**
+ * @brief Apply a property read from an archive
+ *
+ * Invoked once for each property of a widget being instantiated from an archive. Subclasses
+ * should handle their own properties, and invoke this base class implementation for all others.
+ *
+ * @return Whether the property was applied
+ */
+bool Widget::decode(const ArchiveValue &value) {
+    switch(value.getKey()) {
+        case ArchiveKey::Tag:
+            this->setTag(value.getInteger());
+            return true;
+        case ArchiveKey::DebugLabel:
+            this->setDebugLabel(value.getString());
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Apply all properties of a widget read from an archive
+ *
+ * The default implementation applies each property with decode(). Widgets whose properties are
+ * cheaper to apply together can override this.
+ *
+ * @param values All properties of the widget, in the order they were archived
+ */
+void Widget::decodeProperties(std::span<const ArchiveValue> values) {
+    for(const auto &value : values) {
+        this->decode(value);
+    }
+}
@@ -1,49 +1,122 @@
+#include <algorithm>
+
 #include <cairo.h>
-#include <pango/pangocairo.h>
 
 #include "CairoHelpers.h"
+#include "StyleTable.h"
 #include "Util.h"
 #include "Widgets/Button.h"
 
+using namespace shittygui;
 using namespace shittygui::widgets;
 
+/**
+ * @brief Hash function for button styles
+ */
+struct ButtonStyleHash {
+    size_t operator()(const Button::Style &style) const noexcept {
+        uint64_t hash{0};
+        HashCombine(hash, style.borderColor);
+        HashCombine(hash, style.borderWidth);
+        HashCombine(hash, style.borderRadius);
+        HashCombine(hash, style.textColor);
+        HashCombine(hash, style.fillingColor);
+        HashCombine(hash, style.selectedTextColor);
+        HashCombine(hash, style.selectedFillingColor);
+        HashCombine(hash, style.helpContentColor);
+        return static_cast<size_t>(hash);
+    }
+};
+
+/**
+ * @brief Get the styles shared between all buttons
+ *
+ * The table is never destroyed, since buttons with static storage duration may release their
+ * style after it otherwise would have been.
+ */
+static StyleTable<Button::Style, ButtonStyleHash> &GetStyles() {
+    static auto gStyles = new StyleTable<Button::Style, ButtonStyleHash>;
+    return *gStyles;
+}
+
 /**
  * @brief Free all rendering resources belonging to the button.
  */
 Button::~Button() {
+    GetStyles().release(this->styleIndex);
+
     if(this->fontDesc) {
-        pango_font_description_free(this->fontDesc);
+        ReleaseFont(this->fontDesc);
         this->fontDesc = nullptr;
     }
+    if(this->fitFontDesc) {
+        ReleaseFont(this->fitFontDesc);
+        this->fitFontDesc = nullptr;
+    }
 }
 
 /**
- * @brief Draw a regular push button
+ * @brief Release the text rendering resources
+ *
+ * All text layout attributes are marked as dirty, so they're re-applied when the layout is next
+ * created.
  */
-void Button::drawPushButton(cairo_t *drawCtx, const bool everything) {
-    const auto &bounds = this->getBounds();
-    const auto contentBounds = bounds.inset(this->borderWidth);
+void Button::releaseResources() {
+    this->releaseTextResources();
 
-    // draw filling
-    cairo::RoundedRect(drawCtx, bounds, this->borderRadius);
+    this->titleDirty = true;
+    this->fontDirty = (this->fontDesc != nullptr);
+    this->iconGravityDirty = true;
+}
 
-    if(this->selected) {
-        cairo::SetSource(drawCtx, this->selectedFillingColor);
-    } else {
-        cairo::SetSource(drawCtx, this->fillingColor);
+/**
+ * @brief Get the button's style
+ *
+ * @return Reference to the shared style; it remains valid after the button's style is changed,
+ *         but no longer reflects the button's style then.
+ */
+const Button::Style &Button::getStyle() const {
+    return GetStyles()[this->styleIndex];
+}
+
+/**
+ * @brief Change the button's style
+ *
+ * The button is redrawn if the style differs from its current style. To change several style
+ * properties at once, modify a copy of the current style and apply it with a single call, rather
+ * than using the individual setters.
+ *
+ * @param newStyle Style to apply; it's copied into the shared style table if needed.
+ */
+void Button::setStyle(const Style &newStyle) {
+    auto &styles = GetStyles();
+
+    const auto index = styles.intern(newStyle);
+    styles.release(this->styleIndex);
+
+    if(index == this->styleIndex) {
+        return;
     }
 
-    cairo_fill(drawCtx);
+    this->styleIndex = index;
+    this->needsDisplay();
+}
 
-    // draw border
-    cairo::RoundedRect(drawCtx, bounds, this->borderRadius);
-    cairo::SetSource(drawCtx, this->borderColor);
+/**
+ * @brief Draw a regular push button
+ */
+void Button::drawPushButton(cairo_t *drawCtx, const bool everything) {
+    const auto &style = this->getStyle();
+    const auto &bounds = this->getBounds();
+    const auto contentBounds = bounds.inset(style.borderWidth);
 
-    cairo_set_line_cap(drawCtx, CAIRO_LINE_CAP_BUTT);
-    cairo_set_line_join(drawCtx, CAIRO_LINE_JOIN_MITER);
-    cairo_set_line_width(drawCtx, this->borderWidth);
+    // draw filling
+    cairo::FillRoundedRect(drawCtx, bounds, style.borderRadius,
+            this->selected ? style.selectedFillingColor : style.fillingColor);
 
-    cairo_stroke(drawCtx);
+    // draw border
+    cairo::StrokeRoundedRect(drawCtx, bounds, style.borderRadius, style.borderWidth,
+            style.borderColor);
 
     // draw icon
     if(this->shouldRenderIcon && this->icon) {
@@ -99,13 +172,15 @@ void Button::drawTitle(cairo_t *drawCtx, const Rect &contentRect) {
         }
     }
 
-    this->updateTextLayout();
+    this->updateTextLayout(rect.size);
 
     // draw string
+    const auto &style = this->getStyle();
+
     if(this->selected) {
-        this->drawString(drawCtx, rect, this->selectedTextColor, VerticalAlign::Middle);
+        this->drawString(drawCtx, rect, style.selectedTextColor, VerticalAlign::Middle);
     } else {
-        this->drawString(drawCtx, rect, this->textColor, VerticalAlign::Middle);
+        this->drawString(drawCtx, rect, style.textColor, VerticalAlign::Middle);
     }
 }
 
@@ -121,7 +196,7 @@ void Button::drawTitle(cairo_t *drawCtx, const Rect &contentRect) {
  */
 void Button::drawIcon(cairo_t *drawCtx, const Rect &contentRect) {
     // calculate the rect for the icon
-    const auto &iconSize = this->icon->getSize();
+    const auto iconSize = this->icon->getLogicalSize();
     auto iconRect = contentRect.inset(this->iconPadding);
     const auto iconSpaceWidth = iconRect.size.width;
 
@@ -147,26 +222,37 @@ void Button::drawIcon(cairo_t *drawCtx, const Rect &contentRect) {
 
     // draw the icon
     this->iconRect = iconRect;
-    cairo::Rectangle(drawCtx, iconRect);
-
-    const double iconScale = static_cast<double>(iconRect.size.height) / static_cast<double>(iconSize.height);
-    cairo_scale(drawCtx, iconScale, iconScale);
-
-    cairo_set_source_surface(drawCtx, this->icon->getSurface(), iconRect.origin.x, iconRect.origin.y);
-    cairo_fill(drawCtx);
+    this->icon->draw(drawCtx, iconRect);
 }
 
 /**
  * @brief Update the text layout
  */
-void Button::updateTextLayout() {
+void Button::updateTextLayout(const Size &textSize) {
     if(this->titleDirty) {
         this->setTextContent(this->title, false);
         this->titleDirty = false;
+
+        if(this->autoFit) {
+            this->fontDirty = true;
+        }
+    }
+
+    // fit the title again if the area available to it changed
+    if(this->autoFit && (textSize.width != this->fitSize.width ||
+                textSize.height != this->fitSize.height)) {
+        this->fitSize = textSize;
+        this->fontDirty = true;
     }
 
     if(this->fontDirty) {
-        pango_layout_set_font_description(this->layout, this->fontDesc);
+        if(this->autoFit && this->fontDesc) {
+            const TextFit fit{this->title, textSize, this->minFitSize, 0, false, false, true};
+            this->setFittedTextFont(this->fontDesc, this->fitFontDesc, fit);
+        } else {
+            this->setTextFont(this->fontDesc);
+        }
+
         this->fontDirty = false;
     }
 
@@ -193,14 +279,50 @@ void Button::updateTextLayout() {
  * @param size Font size, in points
  */
 void Button::setFont(const std::string_view name, const double size) {
+    // the layout may refer to either font; detach it so the change isn't missed
+    if(this->hasTextResources()) {
+        this->setTextFont(nullptr);
+    }
     if(this->fontDesc) {
-        pango_font_description_free(this->fontDesc);
+        ReleaseFont(this->fontDesc);
+    }
+    if(this->fitFontDesc) {
+        ReleaseFont(this->fitFontDesc);
+        this->fitFontDesc = nullptr;
     }
 
     this->fontDesc = this->getFont(name, size);
     this->fontDirty = true;
 }
 
+/**
+ * @brief Enable or disable automatically fitting the title
+ *
+ * When enabled, the title is rendered at the largest font size (no larger than the size of the
+ * button's font) at which it fits next to the icon without being ellipsized.
+ *
+ * @param enabled Whether the title is fitted
+ * @param minSize Smallest font size to use, in points
+ *
+ * @seeAlso Label::setAutoFit
+ */
+void Button::setAutoFit(const bool enabled, const double minSize) {
+    this->autoFit = enabled;
+    this->minFitSize = minSize;
+    this->fitSize = Size();
+
+    if(!enabled && this->fitFontDesc) {
+        if(this->hasTextResources()) {
+            this->setTextFont(this->fontDesc);
+        }
+        ReleaseFont(this->fitFontDesc);
+        this->fitFontDesc = nullptr;
+    }
+
+    this->fontDirty = true;
+    this->needsDisplay();
+}
+
 /**
  * @brief Handle a touch event
  *
@@ -223,3 +345,198 @@ bool Button::handleTouchEvent(const event::Touch &event) {
 
     return true;
 }
+
+/**
+ * @brief Handle a button event
+ *
+ * When the button is focused, the select button pushes it: it's highlighted while the select
+ * button is held, and the push callback is invoked when it's released.
+ */
+bool Button::handleButtonEvent(const event::Button &event) {
+    if(event.type != event::Button::Select) {
+        return false;
+    }
+
+    this->selected = event.isDown;
+    this->needsDisplay();
+
+    if(!event.isDown && this->pushCallback) {
+        (*this->pushCallback)(this->shared_from_this());
+    }
+
+    return true;
+}
+
+/**
+ * @brief Draw the focus ring, following the button's rounded corners
+ */
+void Button::drawFocusRing(cairo_t *drawCtx) {
+    cairo::RoundedRect(drawCtx, this->getBounds().inset(kFocusRingWidth / 2.),
+            this->getStyle().borderRadius);
+
+    cairo::SetSource(drawCtx, kFocusRingColor);
+    cairo_set_line_width(drawCtx, kFocusRingWidth);
+    cairo_stroke(drawCtx);
+}
+
+
+/**
+ * @brief Get the memory footprint of the button
+ *
+ * This includes the title string. The icon is not included, as it may be shared between multiple
+ * widgets.
+ */
+size_t Button::getMemoryFootprint() const {
+    return Widget::getMemoryFootprint() + (sizeof(Button) - sizeof(Widget)) +
+        this->title.capacity();
+}
+
+/**
+ * @brief Get the hash of the button's draw state
+ *
+ * Since styles are interned, the style index identifies the style, and the icon is identified by
+ * its generation. Changes to the title, font or icon that haven't been applied to the layout yet
+ * always require a redraw.
+ */
+uint64_t Button::getDrawStateHash() const {
+    if(this->titleDirty || this->fontDirty || this->iconDirty || this->iconGravityDirty) {
+        return 0;
+    }
+
+    uint64_t hash{0};
+    HashCombine(hash, this->title);
+    HashCombine(hash, this->icon ? this->icon->getGeneration() : 0);
+    HashCombine(hash, this->styleIndex);
+    HashCombine(hash, static_cast<uint8_t>(this->type));
+    HashCombine(hash, static_cast<uint8_t>(this->ig));
+    HashCombine(hash, this->iconPadding);
+    HashCombine(hash, static_cast<bool>(this->shouldRenderTitle));
+    HashCombine(hash, static_cast<bool>(this->shouldRenderIcon));
+    HashCombine(hash, static_cast<bool>(this->selected));
+    HashFont(hash, this->fontDesc);
+    HashFont(hash, this->fitFontDesc);
+    HashCombine(hash, static_cast<bool>(this->autoFit));
+    HashCombine(hash, this->minFitSize);
+    return hash;
+}
+
+
+
+/**
+ * @brief Write the button's properties to an archive
+ */
+void Button::encode(ArchiveEncoder &encoder) const {
+    const auto &style = this->getStyle();
+
+    encoder.addInteger(ArchiveKey::Style, static_cast<int64_t>(this->type));
+
+    if(!this->title.empty()) {
+        encoder.addString(ArchiveKey::Text, this->title);
+    }
+    EncodeFont(encoder, ArchiveKey::Font, this->fontDesc);
+    if(this->autoFit) {
+        encoder.addDouble(ArchiveKey::MinFontSize, this->minFitSize);
+    }
+    encoder.addColor(ArchiveKey::TextColor, style.textColor);
+    encoder.addColor(ArchiveKey::SelectedTextColor, style.selectedTextColor);
+
+    encoder.addImage(ArchiveKey::Image, this->icon);
+    encoder.addInteger(ArchiveKey::IconGravity, static_cast<int64_t>(this->ig));
+
+    encoder.addColor(ArchiveKey::BorderColor, style.borderColor);
+    encoder.addDouble(ArchiveKey::BorderWidth, style.borderWidth);
+    encoder.addDouble(ArchiveKey::BorderRadius, style.borderRadius);
+    encoder.addColor(ArchiveKey::FillingColor, style.fillingColor);
+    encoder.addColor(ArchiveKey::SelectedFillingColor, style.selectedFillingColor);
+
+    Widget::encode(encoder);
+}
+
+/**
+ * @brief Apply an archived style property to a style
+ *
+ * @return Whether the property is a style property
+ */
+static bool DecodeStyleProperty(const ArchiveValue &value, Button::Style &style) {
+    switch(value.getKey()) {
+        case ArchiveKey::TextColor:
+            style.textColor = value.getColor();
+            return true;
+        case ArchiveKey::SelectedTextColor:
+            style.selectedTextColor = value.getColor();
+            return true;
+        case ArchiveKey::BorderColor:
+            style.borderColor = value.getColor();
+            return true;
+        case ArchiveKey::BorderWidth:
+            style.borderWidth = std::max(0., value.getDouble());
+            return true;
+        case ArchiveKey::BorderRadius:
+            style.borderRadius = value.getDouble();
+            return true;
+        case ArchiveKey::FillingColor:
+            style.fillingColor = value.getColor();
+            return true;
+        case ArchiveKey::SelectedFillingColor:
+            style.selectedFillingColor = value.getColor();
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Apply all properties read from an archive
+ *
+ * Style properties are collected, and the resulting style is applied once.
+ */
+void Button::decodeProperties(std::span<const ArchiveValue> values) {
+    auto style = this->getStyle();
+
+    for(const auto &value : values) {
+        if(!DecodeStyleProperty(value, style)) {
+            this->decode(value);
+        }
+    }
+
+    this->setStyle(style);
+}
+
+/**
+ * @brief Apply a property read from an archive
+ */
+bool Button::decode(const ArchiveValue &value) {
+    auto style = this->getStyle();
+    if(DecodeStyleProperty(value, style)) {
+        this->setStyle(style);
+        return true;
+    }
+
+    switch(value.getKey()) {
+        case ArchiveKey::Style:
+            this->type = static_cast<Type>(value.getInteger());
+            this->needsDisplay();
+            return true;
+
+        case ArchiveKey::Text:
+            this->setTitle(value.getString());
+            return true;
+        case ArchiveKey::Font:
+            this->setFont(value.getString(), value.getFontSize());
+            return true;
+        case ArchiveKey::MinFontSize:
+            this->setAutoFit(true, value.getDouble());
+            return true;
+
+        case ArchiveKey::Image:
+            this->setIcon(value.getImage());
+            return true;
+        case ArchiveKey::IconGravity:
+            this->setIconGravity(static_cast<IconGravity>(value.getInteger()));
+            return true;
+
+        default:
+            return Widget::decode(value);
+    }
+}
@@ -74,3 +74,52 @@ void Checkbox::drawCheck(cairo_t *drawCtx, const bool everything) {
 
     Widget::draw(drawCtx, everything);
 }
+
+
+
+/**
+ * @brief Write the checkbox's properties to an archive
+ */
+void Checkbox::encode(ArchiveEncoder &encoder) const {
+    encoder.addColor(ArchiveKey::BorderColor, this->borderColor);
+    encoder.addDouble(ArchiveKey::BorderWidth, this->borderWidth);
+    encoder.addDouble(ArchiveKey::BorderRadius, this->borderRadius);
+    encoder.addColor(ArchiveKey::FillingColor, this->fillingColor);
+    encoder.addColor(ArchiveKey::SelectedFillingColor, this->selectedFillingColor);
+    encoder.addColor(ArchiveKey::IndicatorColor, this->checkColor);
+    encoder.addColor(ArchiveKey::SelectedIndicatorColor, this->selectedCheckColor);
+
+    ToggleButtonBase::encode(encoder);
+}
+
+/**
+ * @brief Apply a property read from an archive
+ */
+bool Checkbox::decode(const ArchiveValue &value) {
+    switch(value.getKey()) {
+        case ArchiveKey::BorderColor:
+            this->setBorderColor(value.getColor());
+            return true;
+        case ArchiveKey::BorderWidth:
+            this->setBorderWidth(value.getDouble());
+            return true;
+        case ArchiveKey::BorderRadius:
+            this->setBorderRadius(value.getDouble());
+            return true;
+        case ArchiveKey::FillingColor:
+            this->setRegularFillingColor(value.getColor());
+            return true;
+        case ArchiveKey::SelectedFillingColor:
+            this->setSelectedFillingColor(value.getColor());
+            return true;
+        case ArchiveKey::IndicatorColor:
+            this->setRegularCheckColor(value.getColor());
+            return true;
+        case ArchiveKey::SelectedIndicatorColor:
+            this->setSelectedCheckColor(value.getColor());
+            return true;
+
+        default:
+            return ToggleButtonBase::decode(value);
+    }
+}
@@ -19,35 +19,59 @@ void Container::draw(cairo_t *drawCtx, const bool everything) {
         goto beach;
     }
 
-    // set the path to use for border and rec
-    if(this->borderRadius > 0) {
-        cairo::RoundedRect(drawCtx, rect, this->borderRadius);
-    } else {
-        cairo::Rectangle(drawCtx, rect);
-    }
-
     // fill background
-    cairo::SetSource(drawCtx, this->background);
-    cairo_fill_preserve(drawCtx);
+    cairo::FillRoundedRect(drawCtx, rect, this->borderRadius, this->background);
 
     // border
     if(this->drawBorder) {
-        cairo::SetSource(drawCtx, this->border);
-
-        if(this->borderRadius > 0) {
-            cairo_set_line_cap(drawCtx, CAIRO_LINE_CAP_ROUND);
-            cairo_set_line_join(drawCtx, CAIRO_LINE_JOIN_ROUND);
-        } else {
-            cairo_set_line_cap(drawCtx, CAIRO_LINE_CAP_BUTT);
-            cairo_set_line_join(drawCtx, CAIRO_LINE_JOIN_BEVEL);
-        }
-
-        cairo_set_line_width(drawCtx, kBorderWidth);
-
-        cairo_stroke(drawCtx);
+        cairo::StrokeRoundedRect(drawCtx, rect, this->borderRadius, kBorderWidth, this->border);
     }
 
 beach:;
     Widget::draw(drawCtx, everything);
 }
 
+
+/**
+ * @brief Get the memory footprint of the container
+ */
+size_t Container::getMemoryFootprint() const {
+    return Widget::getMemoryFootprint() + (sizeof(Container) - sizeof(Widget));
+}
+
+
+
+/**
+ * @brief Write the container's properties to an archive
+ */
+void Container::encode(ArchiveEncoder &encoder) const {
+    encoder.addColor(ArchiveKey::BackgroundColor, this->background);
+    encoder.addColor(ArchiveKey::BorderColor, this->border);
+    encoder.addDouble(ArchiveKey::BorderRadius, this->borderRadius);
+    encoder.addBool(ArchiveKey::DrawsBorder, this->drawBorder);
+
+    Widget::encode(encoder);
+}
+
+/**
+ * @brief Apply a property read from an archive
+ */
+bool Container::decode(const ArchiveValue &value) {
+    switch(value.getKey()) {
+        case ArchiveKey::BackgroundColor:
+            this->setBackgroundColor(value.getColor());
+            return true;
+        case ArchiveKey::BorderColor:
+            this->setBorderColor(value.getColor());
+            return true;
+        case ArchiveKey::BorderRadius:
+            this->setBorderRadius(value.getDouble());
+            return true;
+        case ArchiveKey::DrawsBorder:
+            this->setDrawsBorder(value.getBool());
+            return true;
+
+        default:
+            return Widget::decode(value);
+    }
+}
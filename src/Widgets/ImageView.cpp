@@ -18,10 +18,7 @@ void ImageView::draw(cairo_t *drawCtx, const bool everything) {
     const auto &bounds = this->getBounds();
 
     // draw background
-    cairo::Rectangle(drawCtx, bounds);
-
-    cairo::SetSource(drawCtx, this->backgroundColor);
-    cairo_fill(drawCtx);
+    cairo::FillRect(drawCtx, bounds, this->backgroundColor);
 
     // draw the image
     if(this->image) {
@@ -31,22 +28,68 @@ void ImageView::draw(cairo_t *drawCtx, const bool everything) {
 
     // draw border (over the image if it peeks out at the edges)
     if(this->borderWidth > 0) {
-        cairo::SetSource(drawCtx, this->borderColor);
-        cairo::Rectangle(drawCtx, bounds);
-
-        cairo_set_line_cap(drawCtx, CAIRO_LINE_CAP_BUTT);
-        cairo_set_line_join(drawCtx, CAIRO_LINE_JOIN_BEVEL);
-        cairo_set_line_width(drawCtx, this->borderWidth);
-        cairo_stroke(drawCtx);
+        cairo::StrokeRoundedRect(drawCtx, bounds, 0, this->borderWidth, this->borderColor);
     }
 
     Widget::draw(drawCtx, everything);
 }
 
+/**
+ * @brief Set the image to be displayed
+ *
+ * If the new image has the same size as the current one, only the area covered by the image is
+ * invalidated, since the scaling and placement do not change.
+ *
+ * @param newImage Image to render in the widget; a strong reference is taken.
+ */
+void ImageView::setImage(const std::shared_ptr<Image> &newImage) {
+    const bool sameSize = this->image && newImage && !this->imageMatrixDirty &&
+        this->image->getLogicalSize().width == newImage->getLogicalSize().width &&
+        this->image->getLogicalSize().height == newImage->getLogicalSize().height;
+
+    this->image = newImage;
+
+    if(sameSize) {
+        this->needsDisplayInRect(this->imageRect);
+    } else {
+        this->imageMatrixDirty = true;
+        this->needsDisplay();
+    }
+}
+
+/**
+ * @brief Invalidate the area covered by the border
+ *
+ * The border is split into four non-overlapping strips (top and bottom spanning the full width, and
+ * the left and right edges in between) so they're not merged into a single damage region.
+ */
+void ImageView::invalidateBorder() {
+    const auto &bounds = this->getBounds();
+    const auto width = static_cast<uint16_t>(std::ceil(this->borderWidth));
+
+    if(!width) {
+        return;
+    } else if(width * 2 >= bounds.size.width || width * 2 >= bounds.size.height) {
+        this->needsDisplay();
+        return;
+    }
+
+    const auto innerHeight = static_cast<uint16_t>(bounds.size.height - (width * 2));
+
+    const Rect horizontal(bounds.origin, Size(bounds.size.width, width)),
+          vertical(bounds.origin, Size(width, innerHeight));
+
+    this->needsDisplayInRect(horizontal);
+    this->needsDisplayInRect(horizontal.offset(0, bounds.size.height - width));
+    this->needsDisplayInRect(vertical.offset(0, width));
+    this->needsDisplayInRect(vertical.offset(bounds.size.width - width, width));
+}
+
 /**
  * @brief Render the image
  *
- * Draw the image stored in the class according to the current scale information.
+ * Draw the image stored in the class into the image rect. The image takes care of resampling
+ * itself to the size of the rect on the device.
  *
  * @param drawCtx Cairo drawing context
  * @param imageAreaRect Rect for the total area available for the image to be drawn into
@@ -63,20 +106,14 @@ void ImageView::drawImage(cairo_t *drawCtx, const Rect &imageAreaRect) {
     }
 
     // draw a debug outline, if enabled
-    cairo::Rectangle(drawCtx, this->imageRect);
-
     if(kDrawImageOutline) {
+        cairo::Rectangle(drawCtx, this->imageRect);
         cairo_set_line_width(drawCtx, 1);
         cairo_set_source_rgb(drawCtx, 1, 0, 1);
-        cairo_stroke_preserve(drawCtx);
+        cairo_stroke(drawCtx);
     }
 
-    // draw the image (scaled)
-    cairo_scale(drawCtx, this->imageXScale, this->imageYScale);
-
-    cairo_set_source_surface(drawCtx, this->image->getSurface(), this->imageRect.origin.x,
-            this->imageRect.origin.y);
-    cairo_fill(drawCtx);
+    this->image->draw(drawCtx, this->imageRect);
 
     cairo_restore(drawCtx);
 }
@@ -84,13 +121,13 @@ void ImageView::drawImage(cairo_t *drawCtx, const Rect &imageAreaRect) {
 /**
  * @brief Recalculate the image transformation
  *
- * Determine what horizontal/vertical scale factors to apply to the image, and where its origin
- * should lie for the current image gravity setting.
+ * Determine the size at which the image is drawn, and where its origin should lie for the current
+ * image gravity setting. Sizes are calculated using the logical size of the image.
  *
  * @param imageAreaRect Rect for the total area available for the image to be drawn into
  */
 void ImageView::updateImageTransform(const Rect &imageAreaRect) {
-    const auto &origImageSize = this->image->getSize();
+    const auto origImageSize = this->image->getLogicalSize();
     Size imageSize;
     auto rect = imageAreaRect;
 
@@ -98,16 +135,12 @@ void ImageView::updateImageTransform(const Rect &imageAreaRect) {
     switch(this->imageMode) {
         // use the original image size
         case Mode::None:
-            imageSize = this->image->getSize();
-            this->imageXScale = 1;
-            this->imageYScale = 1;
+            imageSize = origImageSize;
             break;
 
         // scale axes independently
         case Mode::ScaleIndependently:
             imageSize = imageAreaRect.size;
-            this->imageXScale = static_cast<double>(imageSize.width) / static_cast<double>(origImageSize.width);
-            this->imageYScale = static_cast<double>(imageSize.height) / static_cast<double>(origImageSize.height);
             break;
 
         // scale proportionally down
@@ -119,9 +152,6 @@ void ImageView::updateImageTransform(const Rect &imageAreaRect) {
             };
             GetProportionalFit(origImageSize, minImageSize, newSize);
 
-            this->imageXScale = std::floor(newSize.first + 1.) / static_cast<double>(origImageSize.width);
-            this->imageYScale = std::floor(newSize.second + 1.) / static_cast<double>(origImageSize.height);
-
             imageSize = Size(std::ceil(newSize.first), std::ceil(newSize.second));
             break;
         }
@@ -131,9 +161,6 @@ void ImageView::updateImageTransform(const Rect &imageAreaRect) {
             std::pair<double, double> newSize;
             GetProportionalFit(origImageSize, imageAreaRect.size, newSize);
 
-            this->imageXScale = std::floor(newSize.first) / static_cast<double>(origImageSize.width);
-            this->imageYScale = std::floor(newSize.second) / static_cast<double>(origImageSize.height);
-
             imageSize = Size(std::ceil(newSize.first), std::ceil(newSize.second));
             break;
         }
@@ -147,3 +174,56 @@ void ImageView::updateImageTransform(const Rect &imageAreaRect) {
 
     this->imageRect = rect;
 }
+
+
+/**
+ * @brief Get the memory footprint of the image view
+ *
+ * The image itself is not included, since it may be shared between multiple widgets.
+ */
+size_t ImageView::getMemoryFootprint() const {
+    return Widget::getMemoryFootprint() + (sizeof(ImageView) - sizeof(Widget));
+}
+
+
+
+/**
+ * @brief Write the image view's properties to an archive
+ */
+void ImageView::encode(ArchiveEncoder &encoder) const {
+    encoder.addImage(ArchiveKey::Image, this->image);
+    encoder.addInteger(ArchiveKey::ImageMode, static_cast<int64_t>(this->imageMode));
+    encoder.addColor(ArchiveKey::BackgroundColor, this->backgroundColor);
+    encoder.addColor(ArchiveKey::BorderColor, this->borderColor);
+    encoder.addDouble(ArchiveKey::BorderWidth, this->borderWidth);
+
+    Widget::encode(encoder);
+}
+
+/**
+ * @brief Apply a property read from an archive
+ */
+bool ImageView::decode(const ArchiveValue &value) {
+    switch(value.getKey()) {
+        case ArchiveKey::Image:
+            this->setImage(value.getImage());
+            return true;
+        case ArchiveKey::ImageMode:
+            this->imageMode = static_cast<Mode>(value.getInteger());
+            this->imageMatrixDirty = true;
+            this->needsDisplay();
+            return true;
+        case ArchiveKey::BackgroundColor:
+            this->setBackgroundColor(value.getColor());
+            return true;
+        case ArchiveKey::BorderColor:
+            this->setBorderColor(value.getColor());
+            return true;
+        case ArchiveKey::BorderWidth:
+            this->setBorderWidth(value.getDouble());
+            return true;
+
+        default:
+            return Widget::decode(value);
+    }
+}
@@ -1,5 +1,4 @@
 #include <cairo.h>
-#include <pango/pangocairo.h>
 
 #include "CairoHelpers.h"
 #include "Util.h"
@@ -11,21 +10,26 @@ using namespace shittygui::widgets;
  * @brief Free all rendering resources belonging to the label.
  */
 Label::~Label() {
-    // release font descriptor
+    // release font descriptors
     if(this->fontDesc) {
-        pango_font_description_free(this->fontDesc);
+        ReleaseFont(this->fontDesc);
         this->fontDesc = nullptr;
     }
+    if(this->fitFontDesc) {
+        ReleaseFont(this->fitFontDesc);
+        this->fitFontDesc = nullptr;
+    }
 }
 
 /**
- * @brief Clean up the label's allocated Pango resources
+ * @brief Clean up the label's allocated text resources
  */
 void Label::releaseResources() {
     this->releaseTextResources();
 
     // restore the default dirty flags
     this->contentDirty = true;
+    this->fontDirty = (this->fontDesc != nullptr);
     this->alignDirty = true;
     this->wordWrapDirty = true;
     this->ellipsizationDirty = true;
@@ -39,10 +43,7 @@ void Label::draw(cairo_t *drawCtx, const bool everything) {
 
     // render background
     if(this->drawBackground) {
-        cairo::SetSource(drawCtx, this->background);
-
-        cairo::Rectangle(drawCtx, bounds);
-        cairo_fill(drawCtx);
+        cairo::FillRect(drawCtx, bounds, this->background);
     }
 
     // render the string
@@ -52,14 +53,46 @@ void Label::draw(cairo_t *drawCtx, const bool everything) {
 
     this->updateLayout();
     this->drawString(drawCtx, bounds, this->foreground, this->vAlign);
+    this->textRect = this->getTextExtents(bounds, this->vAlign);
 
     Widget::draw(drawCtx, everything);
 }
 
+/**
+ * @brief Set the text displayed on the label
+ *
+ * If the label has a text layout, it's updated immediately so that only the area covered by the
+ * old and new text needs to be redrawn.
+ *
+ * @param newContent Text to display
+ * @param hasMarkup Whether the string contains Pango markup
+ */
+void Label::setContent(const std::string_view newContent, const bool hasMarkup) {
+    this->content = newContent;
+    this->contentDirty = true;
+    this->contentHasMarkup = hasMarkup;
+
+    if(this->autoFit) {
+        this->fontDirty = true;
+    }
+
+    if(!this->hasTextResources() || this->textRect.isEmpty()) {
+        this->needsDisplay();
+        return;
+    }
+
+    const auto oldRect = this->textRect;
+
+    this->updateLayout();
+    this->textRect = this->getTextExtents(this->getBounds(), this->vAlign);
+
+    this->needsDisplayInRect(oldRect.unionWith(this->textRect));
+}
+
 /**
  * @brief Updates the text layout
  *
- * Apply any changed text layout attributes to the underlying Pango layout object.
+ * Apply any changed text layout attributes to the underlying text layout.
  */
 void Label::updateLayout() {
     // text content
@@ -68,12 +101,6 @@ void Label::updateLayout() {
         this->contentDirty = false;
     }
 
-    // font
-    if(this->fontDirty) {
-        pango_layout_set_font_description(this->layout, this->fontDesc);
-        this->fontDirty = false;
-    }
-
     // text alignment and justification
     if(this->alignDirty) {
         this->setTextLayoutAlign(this->hAlign, this->justified);
@@ -91,6 +118,19 @@ void Label::updateLayout() {
         this->setTextLayoutEllipsization(this->ellipsizationMode);
         this->ellipsizationDirty = false;
     }
+
+    // font (applied last, since fitting it depends on the content and wrap mode)
+    if(this->fontDirty) {
+        if(this->autoFit && this->fontDesc) {
+            const TextFit fit{this->content, this->getBounds().size, this->minFitSize, 0,
+                static_cast<bool>(this->contentHasMarkup), true, static_cast<bool>(this->wordWrap)};
+            this->setFittedTextFont(this->fontDesc, this->fitFontDesc, fit);
+        } else {
+            this->setTextFont(this->fontDesc);
+        }
+
+        this->fontDirty = false;
+    }
 }
 
 
@@ -99,16 +139,173 @@ void Label::updateLayout() {
  *
  * Fonts are automatically loaded using the system's font discovery mechanism. Names are parsed as
  * [Pango FontDescriptions](https://docs.gtk.org/Pango/type_func.FontDescription.from_string.html)
- * so you can customize the style, variants, weight, gravity, and stretch values of the font.
+ * so you can customize the style, variants, weight, gravity, and stretch values of the font. (The
+ * HarfBuzz text backend understands only the family list, weight and style.)
  *
  * @param name Font name
  * @param size Font size, in points
  */
 void Label::setFont(const std::string_view name, const double size) {
+    // detach the old font first: the new one may be allocated at the same address
+    if(this->hasTextResources()) {
+        this->setTextFont(nullptr);
+    }
     if(this->fontDesc) {
-        pango_font_description_free(this->fontDesc);
+        ReleaseFont(this->fontDesc);
+    }
+    if(this->fitFontDesc) {
+        ReleaseFont(this->fitFontDesc);
+        this->fitFontDesc = nullptr;
     }
 
     this->fontDesc = this->getFont(name, size);
     this->fontDirty = true;
+    this->needsDisplay();
+}
+
+/**
+ * @brief Enable or disable automatically fitting the text
+ *
+ * When enabled, the label uses the largest font size (no larger than the size of its font) at
+ * which the text fits in its bounds without being ellipsized. The fitted size is found by laying
+ * out the text at different sizes; results are cached, so only the first label to show a given
+ * string (in a given font and size) pays this cost.
+ *
+ * @param enabled Whether the text is fitted
+ * @param minSize Smallest font size to use, in points; text that doesn't fit at this size is
+ *        ellipsized as usual.
+ *
+ * @remark Fitting requires that a font was set with setFont().
+ */
+void Label::setAutoFit(const bool enabled, const double minSize) {
+    this->autoFit = enabled;
+    this->minFitSize = minSize;
+
+    if(!enabled && this->fitFontDesc) {
+        if(this->hasTextResources()) {
+            this->setTextFont(this->fontDesc);
+        }
+        ReleaseFont(this->fitFontDesc);
+        this->fitFontDesc = nullptr;
+    }
+
+    this->fontDirty = true;
+    this->needsDisplay();
+}
+
+
+/**
+ * @brief Get the memory footprint of the label
+ *
+ * This includes the content string of the label.
+ */
+size_t Label::getMemoryFootprint() const {
+    return Widget::getMemoryFootprint() + (sizeof(Label) - sizeof(Widget)) +
+        this->content.capacity();
+}
+
+/**
+ * @brief Get the hash of the label's draw state
+ *
+ * Fonts are identified by their name and size. Layout attributes that were changed, but not yet
+ * applied to the text layout, always require a redraw.
+ */
+uint64_t Label::getDrawStateHash() const {
+    if(this->contentDirty || this->fontDirty || this->alignDirty || this->wordWrapDirty ||
+            this->ellipsizationDirty) {
+        return 0;
+    }
+
+    uint64_t hash{0};
+    HashCombine(hash, this->content);
+    HashCombine(hash, static_cast<bool>(this->contentHasMarkup));
+    HashCombine(hash, this->foreground);
+    HashCombine(hash, static_cast<bool>(this->drawBackground));
+    HashCombine(hash, this->background);
+    HashCombine(hash, static_cast<uint8_t>(this->hAlign));
+    HashCombine(hash, static_cast<uint8_t>(this->vAlign));
+    HashCombine(hash, static_cast<uint8_t>(this->ellipsizationMode));
+    HashCombine(hash, static_cast<bool>(this->justified));
+    HashCombine(hash, static_cast<bool>(this->wordWrap));
+    HashFont(hash, this->fontDesc);
+    HashFont(hash, this->fitFontDesc);
+    HashCombine(hash, static_cast<bool>(this->autoFit));
+    HashCombine(hash, this->minFitSize);
+    return hash;
+}
+
+
+
+/**
+ * @brief Write the label's properties to an archive
+ */
+void Label::encode(ArchiveEncoder &encoder) const {
+    if(!this->content.empty()) {
+        // markup flag must precede the content, as it's applied along with it
+        encoder.addBool(ArchiveKey::TextMarkup, this->contentHasMarkup);
+        encoder.addString(ArchiveKey::Text, this->content);
+    }
+
+    EncodeFont(encoder, ArchiveKey::Font, this->fontDesc);
+
+    encoder.addColor(ArchiveKey::TextColor, this->foreground);
+    encoder.addInteger(ArchiveKey::TextAlign, static_cast<int64_t>(this->hAlign));
+    encoder.addInteger(ArchiveKey::VerticalAlign, static_cast<int64_t>(this->vAlign));
+    encoder.addBool(ArchiveKey::Justified, this->justified);
+    encoder.addBool(ArchiveKey::WordWrap, this->wordWrap);
+    encoder.addInteger(ArchiveKey::EllipsizeMode, static_cast<int64_t>(this->ellipsizationMode));
+
+    if(this->autoFit) {
+        encoder.addDouble(ArchiveKey::MinFontSize, this->minFitSize);
+    }
+
+    if(this->drawBackground) {
+        encoder.addColor(ArchiveKey::BackgroundColor, this->background);
+    }
+
+    Widget::encode(encoder);
+}
+
+/**
+ * @brief Apply a property read from an archive
+ */
+bool Label::decode(const ArchiveValue &value) {
+    switch(value.getKey()) {
+        case ArchiveKey::TextMarkup:
+            this->contentHasMarkup = value.getBool();
+            return true;
+        case ArchiveKey::Text:
+            this->setContent(value.getString(), this->contentHasMarkup);
+            return true;
+        case ArchiveKey::Font:
+            this->setFont(value.getString(), value.getFontSize());
+            return true;
+        case ArchiveKey::TextColor:
+            this->setTextColor(value.getColor());
+            return true;
+        case ArchiveKey::TextAlign:
+            this->setTextAlign(static_cast<TextAlign>(value.getInteger()), this->vAlign);
+            return true;
+        case ArchiveKey::VerticalAlign:
+            this->setTextAlign(this->hAlign, static_cast<VerticalAlign>(value.getInteger()));
+            return true;
+        case ArchiveKey::Justified:
+            this->setJustified(value.getBool());
+            return true;
+        case ArchiveKey::WordWrap:
+            this->setWordWrap(value.getBool());
+            return true;
+        case ArchiveKey::EllipsizeMode:
+            this->setEllipsizeMode(static_cast<EllipsizeMode>(value.getInteger()));
+            return true;
+        case ArchiveKey::MinFontSize:
+            this->setAutoFit(true, value.getDouble());
+            return true;
+        case ArchiveKey::BackgroundColor:
+            this->setBackgroundColor(value.getColor());
+            return true;
+
+        default:
+            return Widget::decode(value);
+    }
 }
@@ -0,0 +1,373 @@
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+
+#include <cairo.h>
+
+#include "Animator.h"
+#include "CairoHelpers.h"
+#include "Errors.h"
+#include "MemoryAccounting.h"
+#include "SurfacePool.h"
+#include "Widgets/Marquee.h"
+
+using namespace shittygui::widgets;
+
+/// Maximum width of an image surface supported by Cairo, in pixels
+constexpr static const double kMaxSurfaceSize{32767.};
+
+/**
+ * @brief Free all rendering resources belonging to the marquee
+ */
+Marquee::~Marquee() {
+    this->stopAnimating();
+    this->releaseStrip();
+
+    if(this->fontDesc) {
+        ReleaseFont(this->fontDesc);
+        this->fontDesc = nullptr;
+    }
+}
+
+/**
+ * @brief Release the text layout and the cached strip
+ */
+void Marquee::releaseResources() {
+    this->releaseTextResources();
+    this->releaseStrip();
+}
+
+/**
+ * @brief Release the cached strip
+ *
+ * It's rendered again the next time the marquee is drawn.
+ */
+void Marquee::releaseStrip() {
+    if(this->strip) {
+        if(!this->stripPooled) {
+            memory::Freed(MemoryCategory::CachedLayers,
+                    cairo_image_surface_get_stride(this->strip) *
+                    cairo_image_surface_get_height(this->strip));
+        }
+
+        cairo_surface_destroy(this->strip);
+        this->strip = nullptr;
+    }
+
+    this->stripDirty = true;
+}
+
+/**
+ * @brief Draw the marquee
+ *
+ * The strip is rendered if needed; then it's blitted as many times as needed to cover the bounds,
+ * starting at the current scroll offset. Scrolling never redraws the text itself.
+ */
+void Marquee::draw(cairo_t *drawCtx, const bool everything) {
+    const auto &bounds = this->getBounds();
+
+    if(this->stripDirty) {
+        this->updateStrip(drawCtx);
+    }
+
+    const auto offset = static_cast<int>(this->getScrollOffset(Clock::now()));
+    this->drawnOffset = offset;
+
+    // without any text, there's nothing to scroll
+    if(!this->strip) {
+        cairo::FillRect(drawCtx, bounds, this->background);
+        Widget::draw(drawCtx, everything);
+        return;
+    }
+
+    // blit the strip, repeating it across the marquee
+    cairo_save(drawCtx);
+    cairo::Rectangle(drawCtx, bounds);
+    cairo_clip(drawCtx);
+
+    const Size stripSize(static_cast<uint16_t>(this->stripWidth), bounds.size.height);
+
+    for(int x = -offset; x < bounds.size.width; x += this->stripWidth) {
+        cairo_save(drawCtx);
+        cairo_translate(drawCtx, x, 0);
+        cairo::DrawSurface(drawCtx, this->strip, stripSize);
+        cairo_restore(drawCtx);
+    }
+
+    cairo_restore(drawCtx);
+
+    // keep scrolling
+    if(!this->paused && this->speed > 0) {
+        this->startAnimating();
+    }
+
+    Widget::draw(drawCtx, everything);
+}
+
+/**
+ * @brief Render the strip
+ *
+ * The strip holds the background, the text (vertically centered) and the gap after it. It's
+ * rendered at the device scale of the screen, so blitting it doesn't require any resampling.
+ *
+ * @param drawCtx Drawing context of the screen
+ */
+void Marquee::updateStrip(cairo_t *drawCtx) {
+    cairo_status_t status;
+
+    this->releaseStrip();
+    this->stripDirty = false;
+    this->stripWidth = 0;
+
+    // lay out the text
+    if(!this->hasTextResources()) {
+        this->initTextResources(drawCtx);
+
+        this->setTextLayoutWrapMode(false, false);
+        this->setTextLayoutEllipsization(EllipsizeMode::None);
+    }
+
+    if(!this->fontDesc) {
+        this->fontDesc = this->getFont(kDefaultFont, kDefaultFontSize);
+    }
+    this->setTextFont(this->fontDesc);
+    this->setTextContent(this->content, this->contentHasMarkup);
+
+    if(this->content.empty()) {
+        return;
+    }
+
+    const auto textSize = this->getTextLineSize();
+    const auto height = this->getBounds().size.height;
+
+    // figure out the pixel size of the strip
+    double dx{1.}, dy{0.};
+    cairo_user_to_device_distance(drawCtx, &dx, &dy);
+    const auto scale = std::max(1., std::hypot(dx, dy));
+
+    const auto width = std::min(static_cast<double>(textSize.width + this->gap),
+            std::floor(kMaxSurfaceSize / scale));
+    if(width <= 0 || !height) {
+        return;
+    }
+
+    this->stripWidth = static_cast<int>(width);
+
+    const auto pixelWidth = static_cast<int>(std::ceil(this->stripWidth * scale)),
+          pixelHeight = static_cast<int>(std::ceil(height * scale));
+
+    // create the surface
+    if(auto pool = this->getSurfacePool()) {
+        this->strip = pool->acquire(CAIRO_FORMAT_ARGB32, pixelWidth, pixelHeight);
+        this->stripPooled = true;
+    } else {
+        this->strip = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, pixelWidth, pixelHeight);
+        status = cairo_surface_status(this->strip);
+
+        if(status != CAIRO_STATUS_SUCCESS) {
+            cairo_surface_destroy(this->strip);
+            this->strip = nullptr;
+            ThrowForCairoStatus(status);
+        }
+
+        this->stripPooled = false;
+        memory::Allocated(MemoryCategory::CachedLayers,
+                cairo_image_surface_get_stride(this->strip) *
+                cairo_image_surface_get_height(this->strip));
+    }
+
+    cairo_surface_set_device_scale(this->strip, scale, scale);
+
+    // set up temporary drawing context and draw the background and text
+    auto ctx = cairo_create(this->strip);
+    status = cairo_status(ctx);
+    if(status != CAIRO_STATUS_SUCCESS) {
+        ThrowForCairoStatus(status);
+    }
+
+    const Color bg = this->background;
+    cairo_set_operator(ctx, CAIRO_OPERATOR_SOURCE);
+    cairo_set_source_rgba(ctx, bg.r, bg.g, bg.b, bg.a);
+    cairo_paint(ctx);
+    cairo_set_operator(ctx, CAIRO_OPERATOR_OVER);
+
+    this->drawTextLine(ctx, {0, static_cast<int16_t>((height - textSize.height) / 2)},
+            this->foreground);
+
+    // finalize the drawing context and release it
+    cairo_surface_flush(this->strip);
+    cairo_destroy(ctx);
+}
+
+/**
+ * @brief Get the current scroll offset
+ *
+ * @param now Current time
+ *
+ * @return Horizontal offset into the strip, in pixels; always less than the strip width.
+ */
+double Marquee::getScrollOffset(const Clock::time_point now) const {
+    if(this->stripWidth <= 0) {
+        return 0;
+    } else if(this->paused || this->speed <= 0) {
+        return std::fmod(this->pausedOffset, this->stripWidth);
+    }
+
+    const std::chrono::duration<double> elapsed = now - this->start;
+    return std::fmod(std::max(0., elapsed.count() * this->speed), this->stripWidth);
+}
+
+/**
+ * @brief Get the memory used by the marquee
+ *
+ * The strip is accounted for as a cached layer (by the surface pool, if it was allocated from it.)
+ */
+size_t Marquee::getMemoryFootprint() const {
+    return Widget::getMemoryFootprint() + (sizeof(Marquee) - sizeof(Widget)) +
+        this->content.capacity();
+}
+
+
+
+/**
+ * @brief Set the scrolling text
+ *
+ * @param newContent Text to scroll
+ * @param hasMarkup Whether the string contains Pango markup
+ */
+void Marquee::setContent(const std::string_view newContent, const bool hasMarkup) {
+    this->content = newContent;
+    this->contentHasMarkup = hasMarkup;
+    this->stripDirty = true;
+    this->needsDisplay();
+}
+
+/**
+ * @brief Set the font used by the marquee
+ *
+ * @param name Font name
+ * @param size Font size, in points
+ *
+ * @seeAlso Label::setFont
+ */
+void Marquee::setFont(const std::string_view name, const double size) {
+    if(this->hasTextResources()) {
+        this->setTextFont(nullptr);
+    }
+    if(this->fontDesc) {
+        ReleaseFont(this->fontDesc);
+    }
+
+    this->fontDesc = this->getFont(name, size);
+    this->stripDirty = true;
+    this->needsDisplay();
+}
+
+/**
+ * @brief Set the scrolling speed
+ *
+ * The text keeps scrolling from its current position.
+ *
+ * @param pixelsPerSecond New speed, in pixels per second; 0 stops the scrolling.
+ */
+void Marquee::setSpeed(const double pixelsPerSecond) {
+    const auto now = Clock::now();
+    const auto offset = this->getScrollOffset(now);
+
+    this->speed = std::max(0., pixelsPerSecond);
+
+    if(this->paused) {
+        this->pausedOffset = offset;
+    } else if(this->speed > 0) {
+        this->start = now - std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(offset / this->speed));
+        this->needsDisplay();
+    } else {
+        // freeze the text where it is
+        this->pausedOffset = offset;
+        this->start = now;
+        this->stopAnimating();
+    }
+}
+
+/**
+ * @brief Pause or resume scrolling
+ *
+ * While paused, the marquee doesn't need to be redrawn at all.
+ */
+void Marquee::setPaused(const bool newPaused) {
+    if(newPaused == static_cast<bool>(this->paused)) {
+        return;
+    }
+
+    const auto now = Clock::now();
+
+    if(newPaused) {
+        this->pausedOffset = this->getScrollOffset(now);
+        this->paused = true;
+        this->stopAnimating();
+    } else {
+        this->paused = false;
+
+        if(this->speed > 0) {
+            this->start = now - std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(this->pausedOffset / this->speed));
+        }
+        this->needsDisplay();
+    }
+}
+
+/**
+ * @brief Scroll the text back to its starting position
+ */
+void Marquee::restart() {
+    this->start = Clock::now();
+    this->pausedOffset = 0;
+    this->needsDisplay();
+}
+
+
+
+/**
+ * @brief Register the animator callback, if not already registered
+ */
+void Marquee::startAnimating() {
+    if(this->animatorRegistered) {
+        return;
+    }
+
+    if(auto anim = this->getAnimator()) {
+        // scrolling is time based, so it's not critical to get every frame
+        this->animatorToken = anim->registerCallback([&]() -> bool {
+            this->processAnimationFrame();
+            return true;
+        }, false);
+        this->animatorRegistered = true;
+    }
+}
+
+/**
+ * @brief Remove the animator callback
+ */
+void Marquee::stopAnimating() {
+    if(this->animatorRegistered) {
+        if(auto anim = this->getAnimator()) {
+            anim->unregisterCallback(this->animatorToken);
+        }
+        this->animatorRegistered = false;
+    }
+}
+
+/**
+ * @brief Redraw the marquee if the text scrolled by at least a pixel
+ */
+void Marquee::processAnimationFrame() {
+    if(this->paused || this->stripDirty) {
+        return;
+    }
+
+    const auto offset = static_cast<int>(this->getScrollOffset(Clock::now()));
+    if(offset != this->drawnOffset) {
+        this->needsDisplay();
+    }
+}
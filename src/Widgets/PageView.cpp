@@ -0,0 +1,568 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+#include <cairo.h>
+
+#include "Animator.h"
+#include "CairoHelpers.h"
+#include "EasingFunctions.h"
+#include "GestureRecognizer.h"
+#include "Image.h"
+#include "Widgets/PageView.h"
+
+using namespace shittygui::widgets;
+
+/**
+ * @brief Initialize an empty page view
+ *
+ * Set up the gesture recognizer for swipes.
+ */
+PageView::PageView(const Rect &rect) : Widget(rect) {
+    this->pan = std::make_shared<PanGestureRecognizer>();
+    this->pan->setCallback([&](GestureRecognizer &recognizer) {
+        this->handlePan(recognizer);
+    });
+
+    this->addGestureRecognizer(this->pan);
+}
+
+/**
+ * @brief Clean up the page view
+ *
+ * Stop the settle animation, if it's still running.
+ */
+PageView::~PageView() {
+    this->stopAnimating();
+}
+
+/**
+ * @brief Draw the page view
+ *
+ * Fill the background; then, if a swipe is in progress, composite the snapshots of the current
+ * page and the neighbor that's being swiped towards. Otherwise, the current page is a regular
+ * child widget, and draws itself.
+ */
+void PageView::draw(cairo_t *drawCtx, const bool everything) {
+    const auto &bounds = this->getBounds();
+
+    cairo::Rectangle(drawCtx, bounds);
+    cairo::SetSource(drawCtx, this->background);
+    cairo_fill(drawCtx);
+
+    if(this->swiping) {
+        const int width = bounds.size.width;
+        const int x = static_cast<int>(std::lround(this->offset));
+
+        this->drawSnapshot(drawCtx, this->current, x);
+
+        // neighbor to the left
+        if(x > 0) {
+            if(this->animating && this->animTarget < this->current) {
+                this->drawSnapshot(drawCtx, this->animTarget, x - width);
+            } else if(this->current > 0) {
+                this->drawSnapshot(drawCtx, this->current - 1, x - width);
+            }
+        }
+        // neighbor to the right
+        else if(x < 0) {
+            if(this->animating && this->animTarget > this->current) {
+                this->drawSnapshot(drawCtx, this->animTarget, x + width);
+            } else if(this->current + 1 < this->pages.size()) {
+                this->drawSnapshot(drawCtx, this->current + 1, x + width);
+            }
+        }
+    }
+
+    Widget::draw(drawCtx, everything);
+}
+
+/**
+ * @brief Draw a page's snapshot
+ *
+ * @param drawCtx Drawing context
+ * @param index Page whose snapshot to draw; nothing is drawn if it has none
+ * @param x Horizontal position of the page
+ */
+void PageView::drawSnapshot(cairo_t *drawCtx, const size_t index, const int x) {
+    const auto &snapshot = this->pages[index].snapshot;
+    if(!snapshot) {
+        return;
+    }
+
+    snapshot->draw(drawCtx, this->getBounds().offset(x, 0));
+}
+
+/**
+ * @brief Resize all live pages when the page view is resized
+ *
+ * Snapshots are dropped, since they no longer have the right size.
+ */
+void PageView::frameDidChange() {
+    Widget::frameDidChange();
+
+    const auto &bounds = this->getBounds();
+    for(auto &page : this->pages) {
+        if(page.widget) {
+            page.widget->setFrame(bounds);
+        }
+    }
+
+    this->releaseSnapshots();
+    this->needsDisplay();
+}
+
+/**
+ * @brief Finish any swipe in progress when the page view is moved
+ *
+ * The animator may belong to a different screen after the move, so the settle animation can't
+ * continue; instead, it completes immediately.
+ */
+void PageView::willMoveToParent(const std::shared_ptr<Widget> &newParent) {
+    Widget::willMoveToParent(newParent);
+
+    if(this->animating) {
+        this->stopAnimating();
+        this->finishSwipe();
+    } else if(this->swiping) {
+        this->cancelSwipe();
+    }
+}
+
+/**
+ * @brief Get the memory footprint of the page view
+ *
+ * This includes the page table, but not the pages (which are accounted as regular widgets) nor
+ * their snapshots (which are accounted as surfaces.)
+ */
+size_t PageView::getMemoryFootprint() const {
+    return Widget::getMemoryFootprint() + (sizeof(PageView) - sizeof(Widget)) +
+        (this->pages.capacity() * sizeof(Page));
+}
+
+
+
+/**
+ * @brief Add a page
+ *
+ * Pages are added after all existing pages. The factory isn't invoked until the page is shown,
+ * or a snapshot of it is needed; the first page added is shown immediately.
+ *
+ * @param factory Function invoked to create the page's widgets
+ *
+ * @return Index of the page
+ */
+size_t PageView::addPage(const PageFactory &factory) {
+    if(!factory) {
+        throw std::invalid_argument("invalid page factory");
+    }
+
+    const auto index = this->pages.size();
+    this->pages.emplace_back(Page{factory});
+
+    if(!index) {
+        this->showPage(0);
+    }
+
+    return index;
+}
+
+/**
+ * @brief Change the current page
+ *
+ * @param index Page to show
+ * @param animated Whether the change is animated by sliding the new page in; this requires the
+ *        page view to be on a screen.
+ */
+void PageView::setCurrentPage(const size_t index, const bool animated) {
+    if(index >= this->pages.size()) {
+        throw std::out_of_range("page index out of range");
+    }
+
+    // finish whatever is in progress first
+    if(this->animating) {
+        this->stopAnimating();
+        this->finishSwipe();
+    } else if(this->swiping) {
+        this->cancelSwipe();
+    }
+
+    if(index == this->current) {
+        return;
+    }
+
+    if(animated && this->getAnimator()) {
+        this->beginSwipe();
+        this->getSnapshot(index);
+        this->animateTo(index);
+    } else {
+        this->showPage(index);
+
+        if(this->pageChangeCallback) {
+            (*this->pageChangeCallback)(this->shared_from_this(), this->current);
+        }
+    }
+}
+
+/**
+ * @brief Get a page's widget
+ *
+ * @return The page's root widget, or `nullptr` if the page isn't alive
+ */
+std::shared_ptr<shittygui::Widget> PageView::getPage(const size_t index) const {
+    return this->pages.at(index).widget;
+}
+
+/**
+ * @brief Discard a page's cached snapshot
+ *
+ * Invoke this when the content of a page that isn't visible changed, so that swipes show its
+ * current content.
+ */
+void PageView::invalidatePageSnapshot(const size_t index) {
+    this->pages.at(index).snapshot.reset();
+}
+
+
+
+/**
+ * @brief Make a page the current page
+ *
+ * Create the page if needed, then show it and hide the previously current page. Before it's
+ * hidden, that page is snapshotted, so swiping back to it doesn't need to draw it again.
+ */
+void PageView::showPage(const size_t index) {
+    auto &page = this->makeLive(index);
+    page.lastShown = ++this->showCounter;
+
+    if(index != this->current) {
+        auto &old = this->pages[this->current];
+        if(old.widget && !old.widget->isHidden()) {
+            old.snapshot = old.widget->snapshot();
+            old.widget->setHidden(true);
+        }
+
+        this->current = index;
+    }
+
+    if(page.widget->isHidden()) {
+        page.widget->setHidden(false);
+    }
+
+    this->evictPages();
+    this->trimSnapshots();
+}
+
+/**
+ * @brief Ensure a page is alive
+ *
+ * If the page doesn't exist, it's created by invoking its factory, and added (hidden) as a child.
+ *
+ * @return The page
+ */
+PageView::Page &PageView::makeLive(const size_t index) {
+    auto &page = this->pages.at(index);
+    if(page.widget) {
+        return page;
+    }
+
+    auto widget = page.factory(index);
+    if(!widget) {
+        throw std::runtime_error("page factory returned no widget");
+    }
+
+    widget->setFrame(this->getBounds());
+    if(!widget->isHidden()) {
+        widget->setHidden(true);
+    }
+
+    this->addChild(widget);
+    page.widget = std::move(widget);
+
+    return page;
+}
+
+/**
+ * @brief Destroy the least recently shown pages
+ *
+ * Destroy pages until no more than the maximum number of pages are alive. The current page is
+ * never destroyed; snapshots of destroyed pages are kept.
+ */
+void PageView::evictPages() {
+    size_t live = std::count_if(this->pages.begin(), this->pages.end(), [](const auto &page) {
+        return !!page.widget;
+    });
+
+    while(live > this->maxLivePages) {
+        Page *lru{nullptr};
+
+        for(size_t i = 0; i < this->pages.size(); i++) {
+            auto &page = this->pages[i];
+            if(i == this->current || !page.widget) {
+                continue;
+            }
+
+            if(!lru || page.lastShown < lru->lastShown) {
+                lru = &page;
+            }
+        }
+
+        if(!lru) {
+            break;
+        }
+
+        this->removeChild(lru->widget);
+        lru->widget.reset();
+        live--;
+    }
+}
+
+
+
+/**
+ * @brief Get a page's snapshot, taking it if needed
+ *
+ * If the page has no snapshot, it's created (if not alive) and snapshotted.
+ */
+std::shared_ptr<shittygui::Image> &PageView::getSnapshot(const size_t index) {
+    auto &page = this->pages.at(index);
+
+    if(!page.snapshot) {
+        this->makeLive(index);
+        page.snapshot = page.widget->snapshot();
+    }
+
+    return page.snapshot;
+}
+
+/**
+ * @brief Release all page snapshots
+ *
+ * Snapshots in use by a swipe in progress are retained.
+ */
+void PageView::releaseSnapshots() {
+    if(this->swiping) {
+        return;
+    }
+
+    for(auto &page : this->pages) {
+        page.snapshot.reset();
+    }
+}
+
+/**
+ * @brief Release snapshots of pages that aren't neighbors of the current page
+ */
+void PageView::trimSnapshots() {
+    for(size_t i = 0; i < this->pages.size(); i++) {
+        if(i + 1 < this->current || i > this->current + 1) {
+            this->pages[i].snapshot.reset();
+        }
+    }
+}
+
+
+
+/**
+ * @brief Handle the swipe gesture
+ *
+ * Once the pan begins, the swipe starts, and the page follows the touch. When the touch is
+ * released, the page view either settles on the neighboring page (if the page was moved far
+ * enough, or released with enough velocity) or slides back to the current page.
+ */
+void PageView::handlePan(GestureRecognizer &recognizer) {
+    using State = GestureRecognizer::State;
+    const auto state = recognizer.getState();
+
+    if(state == State::Began) {
+        // ignore new swipes while the previous one settles
+        if(this->animating || this->pages.empty()) {
+            return;
+        }
+
+        this->beginSwipe();
+    } else if(!this->swiping || this->animating) {
+        return;
+    }
+
+    const double width = this->getBounds().size.width;
+    const auto dx = recognizer.getTranslation().x;
+
+    switch(state) {
+        // follow the touch, resisting movement past the first and last page
+        case State::Began:
+        case State::Changed: {
+            double newOffset = dx;
+
+            if((dx > 0 && !this->current) ||
+                    (dx < 0 && this->current + 1 == this->pages.size())) {
+                newOffset *= kOverscrollResistance;
+            }
+
+            newOffset = std::clamp(newOffset, -width, width);
+            if(newOffset != this->offset) {
+                this->offset = newOffset;
+                this->needsDisplay();
+            }
+            break;
+        }
+
+        // pick the page to settle on
+        case State::Ended: {
+            const double threshold = width * kPageChangeFraction;
+            const auto vx = recognizer.getVelocity().x;
+            auto target = this->current;
+
+            if(this->offset < 0 && (this->offset <= -threshold || vx <= -kFlingVelocity) &&
+                    this->current + 1 < this->pages.size()) {
+                target = this->current + 1;
+            } else if(this->offset > 0 && (this->offset >= threshold || vx >= kFlingVelocity) &&
+                    this->current > 0) {
+                target = this->current - 1;
+            }
+
+            this->animateTo(target);
+            break;
+        }
+
+        // slide back to the current page
+        case State::Cancelled:
+            this->animateTo(this->current);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Start compositing snapshots
+ *
+ * Snapshot the current page (since its content may have changed since it was last captured) and
+ * make sure its neighbors have snapshots. Then hide the current page, so that only the snapshots
+ * are drawn for the duration of the swipe.
+ */
+void PageView::beginSwipe() {
+    auto &page = this->pages[this->current];
+    page.snapshot = page.widget->snapshot();
+
+    if(this->current > 0) {
+        this->getSnapshot(this->current - 1);
+    }
+    if(this->current + 1 < this->pages.size()) {
+        this->getSnapshot(this->current + 1);
+    }
+
+    page.widget->setHidden(true);
+
+    this->swiping = true;
+    this->offset = 0.;
+
+    // neighbors that were created just to snapshot them may be destroyed again
+    this->evictPages();
+
+    this->needsDisplay();
+}
+
+/**
+ * @brief Stop compositing snapshots without changing the page
+ */
+void PageView::cancelSwipe() {
+    this->swiping = false;
+    this->offset = 0.;
+
+    this->pages[this->current].widget->setHidden(false);
+    this->needsDisplay();
+}
+
+/**
+ * @brief Animate the swipe to its final position
+ *
+ * @param target Page to show when the animation completes; if this is the current page, it's slid
+ *        back into place.
+ */
+void PageView::animateTo(const size_t target) {
+    const double width = this->getBounds().size.width;
+
+    this->animTarget = target;
+    this->animStartOffset = this->offset;
+
+    if(target == this->current) {
+        this->animEndOffset = 0.;
+    } else {
+        this->animEndOffset = (target > this->current) ? -width : width;
+    }
+
+    // without an animator, jump to the end
+    auto animator = this->getAnimator();
+    if(!animator) {
+        this->finishSwipe();
+        return;
+    }
+
+    this->animatorToken = animator->registerCallback([&]() -> bool {
+        return this->processAnimationFrame();
+    });
+
+    this->animating = true;
+    this->animStart = std::chrono::high_resolution_clock::now();
+}
+
+/**
+ * @brief Advance the settle animation
+ *
+ * @return Whether the animation shall continue
+ */
+bool PageView::processAnimationFrame() {
+    const auto now = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double> diff = now - this->animStart;
+    const auto percent = std::min(diff.count() / kSettleDuration, 1.);
+
+    const auto frac = EasingFunctions::InOutQuad(percent);
+    this->offset = this->animStartOffset + ((this->animEndOffset - this->animStartOffset) * frac);
+    this->needsDisplay();
+
+    if(percent >= 1.) {
+        // the animator removes the callback once we return
+        this->animating = false;
+        this->finishSwipe();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Stop the settle animation, if it's running
+ */
+void PageView::stopAnimating() {
+    if(!this->animating) {
+        return;
+    }
+
+    if(auto anim = this->getAnimator()) {
+        anim->unregisterCallback(this->animatorToken);
+    }
+    this->animating = false;
+}
+
+/**
+ * @brief Complete a swipe
+ *
+ * Show the page the swipe ended on, and stop compositing snapshots. The page change callback is
+ * invoked if the page changed.
+ */
+void PageView::finishSwipe() {
+    const auto old = this->current;
+
+    this->swiping = false;
+    this->offset = 0.;
+
+    this->showPage(this->animTarget);
+    this->needsDisplay();
+
+    if(this->current != old && this->pageChangeCallback) {
+        (*this->pageChangeCallback)(this->shared_from_this(), this->current);
+    }
+}
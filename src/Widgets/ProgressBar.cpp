@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <chrono>
 
@@ -5,7 +6,10 @@
 
 #include "Animator.h"
 #include "CairoHelpers.h"
+#include "DrawBackend.h"
 #include "Errors.h"
+#include "MemoryAccounting.h"
+#include "SurfacePool.h"
 #include "Util.h"
 #include "Widgets/ProgressBar.h"
 
@@ -17,15 +21,32 @@ using namespace shittygui::widgets;
  * This will terminate any animations, and release allocated patterns for the fill of the bar.
  */
 void ProgressBar::releaseResources() {
-    if(this->barberSurface) {
-        cairo_surface_destroy(this->barberSurface);
+    this->releaseFill();
+
+    if(this->animatorRegistered) {
+        this->unregisterAnimCallback();
     }
+}
+
+/**
+ * @brief Release the indeterminate fill pattern
+ *
+ * The pattern is re-created the next time the bar is drawn.
+ */
+void ProgressBar::releaseFill() {
     if(this->barberPattern) {
         cairo_pattern_destroy(this->barberPattern);
+        this->barberPattern = nullptr;
     }
+    if(this->barberSurface) {
+        if(!this->barberPooled) {
+            memory::Freed(MemoryCategory::CachedLayers,
+                    cairo_image_surface_get_stride(this->barberSurface) *
+                    cairo_image_surface_get_height(this->barberSurface));
+        }
 
-    if(this->animatorRegistered) {
-        this->unregisterAnimCallback();
+        cairo_surface_destroy(this->barberSurface);
+        this->barberSurface = nullptr;
     }
 }
 
@@ -38,19 +59,21 @@ void ProgressBar::releaseResources() {
 void ProgressBar::draw(cairo_t *drawCtx, const bool everything) {
     const auto &bounds = this->getBounds();
 
-    // draw border
-    cairo::Rectangle(drawCtx, bounds);
+    // calculate the filling's rect
+    const auto fillingRect = bounds.inset(kBorderWidth);
 
-    cairo::SetSource(drawCtx, kBorderColor);
+    // draw border, unless only the filling is being redrawn
+    if(!fillingRect.contains(this->getDirtyRect())) {
+        cairo::Rectangle(drawCtx, bounds);
 
-    cairo_set_line_cap(drawCtx, CAIRO_LINE_CAP_BUTT);
-    cairo_set_line_join(drawCtx, CAIRO_LINE_JOIN_MITER);
-    cairo_set_line_width(drawCtx, kBorderWidth);
+        cairo::SetSource(drawCtx, kBorderColor);
 
-    cairo_stroke(drawCtx);
+        cairo_set_line_cap(drawCtx, CAIRO_LINE_CAP_BUTT);
+        cairo_set_line_join(drawCtx, CAIRO_LINE_JOIN_MITER);
+        cairo_set_line_width(drawCtx, kBorderWidth);
 
-    // calculate the filling's rect
-    const auto fillingRect = bounds.inset(kBorderWidth);
+        cairo_stroke(drawCtx);
+    }
 
     // draw the solid filled style
     if(this->style == Style::Determinate) {
@@ -75,9 +98,11 @@ void ProgressBar::draw(cairo_t *drawCtx, const bool everything) {
     }
     // handle the animated indeterminate style
     else {
-        // update the animation pattern
-        if(!this->barberPattern || this->fillDirty) {
-            this->updateIndeterminateFill(fillingRect);
+        // update the animation pattern (also when the rendering quality changed)
+        const auto quality = DrawBackend::GetQuality(drawCtx);
+
+        if(!this->barberPattern || this->fillDirty || quality != this->fillQuality) {
+            this->updateIndeterminateFill(fillingRect, quality);
             this->fillDirty = false;
         }
         // register animation callback if not done yet
@@ -113,6 +138,40 @@ void ProgressBar::draw(cairo_t *drawCtx, const bool everything) {
     Widget::draw(drawCtx, everything);
 }
 
+/**
+ * @brief Set the progress value
+ *
+ * For determinate bars, only the part of the bar between the old and new progress value is
+ * invalidated. Indeterminate bars don't display the progress, so they're not redrawn at all.
+ *
+ * @param newProgress Progress percentage {0, 1}
+ */
+void ProgressBar::setProgress(const double newProgress) {
+    const auto oldProgress = this->progress;
+    this->progress = std::max(std::min(newProgress, 1.), 0.);
+
+    if(this->style != Style::Determinate || this->progress == oldProgress) {
+        return;
+    }
+
+    /*
+     * Invalidate the changed part. The edge of the filled part usually falls inside a pixel, which
+     * is antialiased, so the range is rounded outwards. The unfilled part is drawn from the rounded
+     * down edge in bounds (rather than filling) coordinates, so it starts up to the border width
+     * further left; pad the range by a pixel either side to cover that.
+     */
+    const auto fillingRect = this->getBounds().inset(kBorderWidth);
+    const double width = fillingRect.size.width;
+
+    const auto x1 = std::floor(width * std::min(oldProgress, this->progress)) - 1.,
+          x2 = std::ceil(width * std::max(oldProgress, this->progress)) + 2.;
+
+    this->needsDisplayInRect(Rect(
+            {static_cast<int16_t>(fillingRect.origin.x + x1), fillingRect.origin.y},
+            Size(static_cast<uint16_t>(x2 - x1), fillingRect.size.height))
+            .intersection(fillingRect));
+}
+
 /**
  * @brief Render the indeterminate fill pattern
  *
@@ -120,27 +179,35 @@ void ProgressBar::draw(cairo_t *drawCtx, const bool everything) {
  * We'll render a square texture, the side length equal to the filling height of the bar.
  *
  * @param fillingRect Rect used for the filling of the bar
+ * @param quality Rendering quality tier, which determines the antialiasing of the pattern
  */
-void ProgressBar::updateIndeterminateFill(const Rect &fillingRect) {
+void ProgressBar::updateIndeterminateFill(const Rect &fillingRect, const QualityTier quality) {
     cairo_status_t status;
 
     // release old pattern and surfaces
-    if(this->barberSurface) {
-        cairo_surface_destroy(this->barberSurface);
-    }
-    if(this->barberPattern) {
-        cairo_pattern_destroy(this->barberPattern);
-    }
+    this->releaseFill();
 
     // create the surface
     const double w = fillingRect.size.height * 2, h = fillingRect.size.height;
     this->patternWidth = w;
 
-    this->barberSurface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
-    status = cairo_surface_status(this->barberSurface);
+    if(auto pool = this->getSurfacePool()) {
+        this->barberSurface = pool->acquire(CAIRO_FORMAT_ARGB32, w, h);
+        this->barberPooled = true;
+    } else {
+        this->barberSurface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
+        status = cairo_surface_status(this->barberSurface);
+
+        if(status != CAIRO_STATUS_SUCCESS) {
+            cairo_surface_destroy(this->barberSurface);
+            this->barberSurface = nullptr;
+            ThrowForCairoStatus(status);
+        }
 
-    if(status != CAIRO_STATUS_SUCCESS) {
-        ThrowForCairoStatus(status);
+        this->barberPooled = false;
+        memory::Allocated(MemoryCategory::CachedLayers,
+                cairo_image_surface_get_stride(this->barberSurface) *
+                cairo_image_surface_get_height(this->barberSurface));
     }
 
     // set up temporary drawing context and draw the pattern
@@ -150,7 +217,18 @@ void ProgressBar::updateIndeterminateFill(const Rect &fillingRect) {
         ThrowForCairoStatus(status);
     }
 
-    cairo_set_antialias(ctx, CAIRO_ANTIALIAS_BEST);
+    switch(quality) {
+        case QualityTier::Full:
+            cairo_set_antialias(ctx, CAIRO_ANTIALIAS_BEST);
+            break;
+        case QualityTier::Reduced:
+            cairo_set_antialias(ctx, CAIRO_ANTIALIAS_FAST);
+            break;
+        case QualityTier::Minimal:
+            cairo_set_antialias(ctx, CAIRO_ANTIALIAS_NONE);
+            break;
+    }
+    this->fillQuality = quality;
 
     this->drawIndeterminatePattern(ctx, w, h);
 
@@ -194,14 +272,14 @@ void ProgressBar::drawIndeterminatePattern(cairo_t *ctx, const double width, con
 /**
  * @brief Handle an animation frame
  *
- * If the bar is indeterminate, we'll simply request to get redrawn.
+ * If the bar is indeterminate, we'll simply request for the filling to get redrawn.
  */
 void ProgressBar::processAnimationFrame() {
     if(this->style != Style::Indeterminate) {
         return;
     }
 
-    this->needsDisplay();
+    this->needsDisplayInRect(this->getBounds().inset(kBorderWidth));
 }
 
 
@@ -214,10 +292,11 @@ void ProgressBar::registerAnimCallback() {
         this->unregisterAnimCallback();
     }
 
+    // the pattern offset is derived from the time, so skipped frames don't slow it down
     this->animatorToken = this->getAnimator()->registerCallback([&]() -> bool {
         this->processAnimationFrame();
         return true;
-    });
+    }, false);
     this->animatorRegistered = true;
 }
 
@@ -230,3 +309,40 @@ void ProgressBar::unregisterAnimCallback() {
         this->animatorRegistered = false;
     }
 }
+
+
+/**
+ * @brief Get the memory footprint of the progress bar
+ */
+size_t ProgressBar::getMemoryFootprint() const {
+    return Widget::getMemoryFootprint() + (sizeof(ProgressBar) - sizeof(Widget));
+}
+
+
+
+/**
+ * @brief Write the progress bar's properties to an archive
+ */
+void ProgressBar::encode(ArchiveEncoder &encoder) const {
+    encoder.addInteger(ArchiveKey::Style, static_cast<int64_t>(this->style));
+    encoder.addDouble(ArchiveKey::Progress, this->progress);
+
+    Widget::encode(encoder);
+}
+
+/**
+ * @brief Apply a property read from an archive
+ */
+bool ProgressBar::decode(const ArchiveValue &value) {
+    switch(value.getKey()) {
+        case ArchiveKey::Style:
+            this->setStyle(static_cast<Style>(value.getInteger()));
+            return true;
+        case ArchiveKey::Progress:
+            this->setProgress(value.getDouble());
+            return true;
+
+        default:
+            return Widget::decode(value);
+    }
+}
@@ -198,3 +198,50 @@ void RadioButton::UncheckAllOthers(const std::shared_ptr<RadioButton> &radio) {
         }
     });
 }
+
+
+
+/**
+ * @brief Write the radio button's properties to an archive
+ *
+ * @remark Group callbacks (installed by MakeRadioGroup()) are not archived.
+ */
+void RadioButton::encode(ArchiveEncoder &encoder) const {
+    encoder.addColor(ArchiveKey::BorderColor, this->borderColor);
+    encoder.addDouble(ArchiveKey::BorderWidth, this->borderWidth);
+    encoder.addColor(ArchiveKey::FillingColor, this->fillingColor);
+    encoder.addColor(ArchiveKey::SelectedFillingColor, this->selectedFillingColor);
+    encoder.addColor(ArchiveKey::IndicatorColor, this->indicatorColor);
+    encoder.addColor(ArchiveKey::SelectedIndicatorColor, this->selectedIndicatorColor);
+
+    ToggleButtonBase::encode(encoder);
+}
+
+/**
+ * @brief Apply a property read from an archive
+ */
+bool RadioButton::decode(const ArchiveValue &value) {
+    switch(value.getKey()) {
+        case ArchiveKey::BorderColor:
+            this->setBorderColor(value.getColor());
+            return true;
+        case ArchiveKey::BorderWidth:
+            this->setBorderWidth(value.getDouble());
+            return true;
+        case ArchiveKey::FillingColor:
+            this->setRegularFillingColor(value.getColor());
+            return true;
+        case ArchiveKey::SelectedFillingColor:
+            this->setSelectedFillingColor(value.getColor());
+            return true;
+        case ArchiveKey::IndicatorColor:
+            this->setRegularIndicatorColor(value.getColor());
+            return true;
+        case ArchiveKey::SelectedIndicatorColor:
+            this->setSelectedIndicatorColor(value.getColor());
+            return true;
+
+        default:
+            return ToggleButtonBase::decode(value);
+    }
+}
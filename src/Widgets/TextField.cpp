@@ -0,0 +1,614 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include <cairo.h>
+
+#include "Animator.h"
+#include "CairoHelpers.h"
+#include "Screen.h"
+#include "Widgets/TextField.h"
+
+using namespace shittygui::widgets;
+
+/**
+ * @brief Encode a Unicode code point as UTF-8
+ *
+ * @param codepoint Code point to encode
+ * @param out Buffer to receive the encoded character (at least 4 bytes)
+ *
+ * @return Number of bytes written, or 0 if the code point is invalid
+ */
+static size_t EncodeUtf8(const char32_t codepoint, char *out) {
+    if(codepoint < 0x80) {
+        out[0] = static_cast<char>(codepoint);
+        return 1;
+    } else if(codepoint < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (codepoint >> 6));
+        out[1] = static_cast<char>(0x80 | (codepoint & 0x3F));
+        return 2;
+    } else if(codepoint < 0x10000) {
+        // reject surrogates
+        if(codepoint >= 0xD800 && codepoint <= 0xDFFF) {
+            return 0;
+        }
+
+        out[0] = static_cast<char>(0xE0 | (codepoint >> 12));
+        out[1] = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (codepoint & 0x3F));
+        return 3;
+    } else if(codepoint < 0x110000) {
+        out[0] = static_cast<char>(0xF0 | (codepoint >> 18));
+        out[1] = static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (codepoint & 0x3F));
+        return 4;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Check whether a byte is a UTF-8 continuation byte
+ */
+static inline bool IsContinuationByte(const char byte) {
+    return (static_cast<uint8_t>(byte) & 0xC0) == 0x80;
+}
+
+
+
+/**
+ * @brief Free all rendering resources belonging to the text field
+ */
+TextField::~TextField() {
+    if(this->animatorRegistered) {
+        if(auto anim = this->getAnimator()) {
+            anim->unregisterCallback(this->animatorToken);
+        }
+    }
+
+    if(this->fontDesc) {
+        ReleaseFont(this->fontDesc);
+        this->fontDesc = nullptr;
+    }
+}
+
+/**
+ * @brief Release the text layout
+ *
+ * The layout, and the cached character positions, are rebuilt the next time the field is drawn.
+ */
+void TextField::releaseResources() {
+    this->releaseTextResources();
+
+    this->stops.clear();
+    this->layoutDirty = true;
+}
+
+/**
+ * @brief Draw the text field
+ *
+ * The field's background and border are drawn, followed by the text (clipped to the text area)
+ * and the caret, if it's currently visible.
+ */
+void TextField::draw(cairo_t *drawCtx, const bool everything) {
+    const auto &bounds = this->getBounds();
+
+    // background and border
+    cairo::FillRect(drawCtx, bounds, this->background);
+    cairo::StrokeRoundedRect(drawCtx, bounds, 0, kBorderWidth, kBorderColor);
+
+    // set up the text layout, if needed
+    if(!this->hasTextResources()) {
+        this->initTextResources(drawCtx);
+
+        this->setTextLayoutWrapMode(false, false);
+        this->setTextLayoutEllipsization(EllipsizeMode::None);
+    }
+
+    if(this->layoutDirty) {
+        this->updateLayout();
+        this->scrollToCaret();
+    }
+
+    // draw the text
+    const auto textRect = this->getTextRect();
+
+    cairo_save(drawCtx);
+    cairo::Rectangle(drawCtx, textRect);
+    cairo_clip(drawCtx);
+
+    this->drawTextLine(drawCtx, {static_cast<int16_t>(textRect.origin.x - this->scrollOffset),
+            textRect.origin.y}, this->foreground);
+
+    cairo_restore(drawCtx);
+
+    // then the caret
+    if(this->caretVisible) {
+        cairo::FillRect(drawCtx, this->getCaretRect(), this->caretColor);
+    }
+
+    Widget::draw(drawCtx, everything);
+}
+
+/**
+ * @brief Lay out the text, and cache the position of each character boundary
+ *
+ * The text is laid out as a single line; caching the position of every character boundary allows
+ * placing the caret, and finding the extent of edits, without querying the layout again.
+ */
+void TextField::updateLayout() {
+    if(!this->fontDesc) {
+        this->fontDesc = this->getFont(kDefaultFont, kDefaultFontSize);
+    }
+    this->setTextFont(this->fontDesc);
+
+    this->setTextContent(this->text);
+
+    this->getCharacterPositions(this->stops);
+
+    const auto size = this->getTextLineSize();
+    this->textWidth = size.width;
+    this->lineHeight = size.height;
+
+    this->layoutDirty = false;
+}
+
+/**
+ * @brief Replace a range of the text
+ *
+ * The caret is placed after the replacement. If the field has a text layout, it's updated
+ * immediately; only the part of the field from the character before the edit to the end of the
+ * old or new text (whichever is longer) is redrawn, unless the text had to be scrolled.
+ *
+ * @param start Byte offset of the first byte to replace
+ * @param end Byte offset past the last byte to replace
+ * @param replacement Text to insert in place of the range
+ */
+void TextField::edit(const size_t start, const size_t end, const std::string_view replacement) {
+    const auto oldCaretRect = this->getCaretRect();
+    const auto oldWidth = this->textWidth;
+    // the character before the edit may be kerned against the edited text
+    const auto startX = this->getCaretX(PrevCharacter(this->text, start));
+
+    this->text.replace(start, end - start, replacement);
+    this->caret = start + replacement.size();
+
+    this->caretVisible = this->isFocused();
+    this->lastBlink = Clock::now();
+
+    if(!this->hasTextResources() || this->layoutDirty) {
+        this->layoutDirty = true;
+        this->needsDisplay();
+        return;
+    }
+
+    this->updateLayout();
+
+    if(this->scrollToCaret()) {
+        this->needsDisplay();
+        return;
+    }
+
+    const auto textRect = this->getTextRect();
+    const auto x1 = textRect.origin.x + startX - this->scrollOffset - 1,
+          x2 = textRect.origin.x + std::max(oldWidth, this->textWidth) - this->scrollOffset + 1;
+
+    const Rect changed({static_cast<int16_t>(x1), textRect.origin.y},
+            Size(std::max(x2 - x1, 0), textRect.size.height));
+
+    this->needsDisplayInRect(changed.intersection(textRect).unionWith(oldCaretRect)
+            .unionWith(this->getCaretRect()));
+}
+
+/**
+ * @brief Move the caret
+ *
+ * The caret is shown, and its blink timer restarted. Only the old and new caret are redrawn,
+ * unless the text had to be scrolled.
+ *
+ * @param position New caret position; it must be a character boundary
+ */
+void TextField::moveCaret(const size_t position) {
+    const auto oldCaretRect = this->getCaretRect();
+
+    this->caret = position;
+    this->caretVisible = this->isFocused();
+    this->lastBlink = Clock::now();
+
+    if(this->scrollToCaret()) {
+        this->needsDisplay();
+    } else {
+        this->needsDisplayInRect(oldCaretRect.unionWith(this->getCaretRect()));
+    }
+}
+
+
+
+/**
+ * @brief Set the text of the field
+ *
+ * The caret is placed at the end of the text. The change callback is not invoked.
+ */
+void TextField::setText(const std::string_view newText) {
+    this->edit(0, this->text.size(), newText);
+}
+
+/**
+ * @brief Insert text at the caret
+ *
+ * The caret is placed after the inserted text. The change callback is not invoked.
+ */
+void TextField::insertText(const std::string_view str) {
+    this->edit(this->caret, this->caret, str);
+}
+
+/**
+ * @brief Move the caret
+ *
+ * @param position Byte offset into the text; it must be at a character boundary
+ *
+ * @throw std::out_of_range If the position is past the end of the text
+ * @throw std::invalid_argument If the position is inside a character
+ */
+void TextField::setCaretPosition(const size_t position) {
+    if(position > this->text.size()) {
+        throw std::out_of_range("caret position out of range");
+    } else if(position < this->text.size() && IsContinuationByte(this->text[position])) {
+        throw std::invalid_argument("caret position is not a character boundary");
+    }
+
+    this->moveCaret(position);
+}
+
+/**
+ * @brief Set the font used by the text field
+ *
+ * @param name Font name
+ * @param size Font size, in points
+ *
+ * @seeAlso Label::setFont
+ */
+void TextField::setFont(const std::string_view name, const double size) {
+    if(this->hasTextResources()) {
+        this->setTextFont(nullptr);
+    }
+    if(this->fontDesc) {
+        ReleaseFont(this->fontDesc);
+    }
+
+    this->fontDesc = this->getFont(name, size);
+    this->layoutDirty = true;
+    this->needsDisplay();
+}
+
+
+
+/**
+ * @brief Handle a touch event
+ *
+ * Touching the field makes it the first responder, and moves the caret to the character boundary
+ * closest to the touch; dragging moves the caret along.
+ */
+bool TextField::handleTouchEvent(const event::Touch &event) {
+    if(!event.isDown) {
+        return true;
+    }
+
+    if(!this->isFocused()) {
+        if(auto screen = this->getScreen()) {
+            screen->setFirstResponder(this->shared_from_this());
+        }
+    }
+
+    if(!this->stops.empty()) {
+        const auto textRect = this->convertToScreenSpace(this->getTextRect());
+        const auto x = event.position.x - textRect.origin.x + this->scrollOffset;
+
+        const auto position = this->getPositionAt(x);
+        if(position != this->caret) {
+            this->moveCaret(position);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Handle a key event
+ *
+ * Characters are inserted at the caret, and the editing keys move the caret or delete the
+ * character before or after it. The change callback is invoked after every edit.
+ */
+bool TextField::handleKeyEvent(const event::Key &event) {
+    bool changed{false};
+
+    switch(event.type) {
+        case event::Key::Character: {
+            char buf[4];
+
+            // ignore control characters
+            if(event.character < 0x20 || event.character == 0x7F) {
+                return false;
+            }
+
+            const auto len = EncodeUtf8(event.character, buf);
+            if(!len) {
+                return false;
+            }
+
+            this->edit(this->caret, this->caret, std::string_view(buf, len));
+            changed = true;
+            break;
+        }
+
+        case event::Key::Backspace:
+            if(this->caret) {
+                this->edit(PrevCharacter(this->text, this->caret), this->caret, {});
+                changed = true;
+            }
+            break;
+        case event::Key::Delete:
+            if(this->caret < this->text.size()) {
+                this->edit(this->caret, NextCharacter(this->text, this->caret), {});
+                changed = true;
+            }
+            break;
+
+        case event::Key::Left:
+            this->moveCaret(PrevCharacter(this->text, this->caret));
+            break;
+        case event::Key::Right:
+            this->moveCaret(NextCharacter(this->text, this->caret));
+            break;
+        case event::Key::Home:
+            this->moveCaret(0);
+            break;
+        case event::Key::End:
+            this->moveCaret(this->text.size());
+            break;
+
+        case event::Key::Enter:
+            if(this->returnCallback) {
+                (*this->returnCallback)(this->shared_from_this());
+            }
+            break;
+    }
+
+    if(changed && this->changeCallback) {
+        (*this->changeCallback)(this->shared_from_this());
+    }
+
+    return true;
+}
+
+/**
+ * @brief Start blinking the caret when the field gains focus
+ */
+void TextField::didBecomeFirstResponder() {
+    Widget::didBecomeFirstResponder();
+    this->startBlinking();
+}
+
+/**
+ * @brief Hide the caret when the field loses focus
+ */
+void TextField::didResignFirstResponder() {
+    Widget::didResignFirstResponder();
+    this->stopBlinking();
+}
+
+
+
+/**
+ * @brief Get the horizontal position of a character boundary
+ *
+ * @param position Byte offset into the text
+ *
+ * @return Position, in pixels relative to the start of the text
+ */
+int TextField::getCaretX(const size_t position) const {
+    if(this->stops.empty()) {
+        return 0;
+    }
+
+    auto it = std::lower_bound(this->stops.begin(), this->stops.end(), position,
+            [](const CaretStop &stop, const size_t index) {
+        return stop.index < index;
+    });
+    if(it == this->stops.end()) {
+        return this->textWidth;
+    }
+
+    return it->x;
+}
+
+/**
+ * @brief Find the character boundary closest to a horizontal position
+ *
+ * @param x Position, in pixels relative to the start of the text
+ *
+ * @return Byte offset of the closest character boundary
+ */
+size_t TextField::getPositionAt(const int x) const {
+    if(this->stops.empty()) {
+        return this->text.size();
+    }
+
+    auto it = std::lower_bound(this->stops.begin(), this->stops.end(), x,
+            [](const CaretStop &stop, const int x) {
+        return stop.x < x;
+    });
+
+    if(it == this->stops.begin()) {
+        return it->index;
+    } else if(it == this->stops.end()) {
+        return this->stops.back().index;
+    }
+
+    const auto prev = std::prev(it);
+    return (x - prev->x < it->x - x) ? prev->index : it->index;
+}
+
+/**
+ * @brief Get the area the text is drawn in
+ *
+ * This is the full width of the field (less padding) and the height of one line of text,
+ * centered vertically.
+ */
+shittygui::Rect TextField::getTextRect() const {
+    const auto &bounds = this->getBounds();
+
+    return Rect({static_cast<int16_t>(bounds.origin.x + kTextPadding),
+            static_cast<int16_t>(bounds.origin.y + (bounds.size.height - this->lineHeight) / 2)},
+            Size(std::max(bounds.size.width - (2 * kTextPadding), 0), this->lineHeight));
+}
+
+/**
+ * @brief Get the area covered by the caret
+ *
+ * @return Caret rectangle, or an empty rectangle if the text hasn't been laid out
+ */
+shittygui::Rect TextField::getCaretRect() const {
+    if(this->stops.empty()) {
+        return {};
+    }
+
+    const auto textRect = this->getTextRect();
+    const auto x = textRect.origin.x + this->getCaretX(this->caret) - this->scrollOffset -
+        (kCaretWidth / 2);
+
+    return Rect({static_cast<int16_t>(x), textRect.origin.y}, Size(kCaretWidth, this->lineHeight))
+        .intersection(this->getBounds());
+}
+
+/**
+ * @brief Scroll the text horizontally so that the caret is visible
+ *
+ * @return Whether the scroll offset changed
+ */
+bool TextField::scrollToCaret() {
+    if(this->stops.empty()) {
+        return false;
+    }
+
+    const int visible = this->getTextRect().size.width;
+    const auto x = this->getCaretX(this->caret);
+
+    auto offset = this->scrollOffset;
+    if(x - offset > visible - kCaretWidth) {
+        offset = x - visible + kCaretWidth;
+    } else if(x < offset) {
+        offset = x;
+    }
+    offset = std::clamp(offset, 0, std::max(this->textWidth + kCaretWidth - visible, 0));
+
+    if(offset == this->scrollOffset) {
+        return false;
+    }
+
+    this->scrollOffset = offset;
+    return true;
+}
+
+
+
+/**
+ * @brief Show the caret, and start blinking it
+ */
+void TextField::startBlinking() {
+    this->caretVisible = true;
+    this->lastBlink = Clock::now();
+
+    if(!this->animatorRegistered) {
+        if(auto anim = this->getAnimator()) {
+            // blinking late by a frame or three isn't noticeable
+            this->animatorToken = anim->registerCallback([&]() -> bool {
+                this->processAnimationFrame();
+                return true;
+            }, false);
+            this->animatorRegistered = true;
+        }
+    }
+
+    this->needsDisplayInRect(this->getCaretRect());
+}
+
+/**
+ * @brief Stop blinking the caret, and hide it
+ */
+void TextField::stopBlinking() {
+    if(this->animatorRegistered) {
+        if(auto anim = this->getAnimator()) {
+            anim->unregisterCallback(this->animatorToken);
+        }
+        this->animatorRegistered = false;
+    }
+
+    if(this->caretVisible) {
+        this->caretVisible = false;
+        this->needsDisplayInRect(this->getCaretRect());
+    }
+}
+
+/**
+ * @brief Toggle the caret visibility when the blink interval elapsed
+ *
+ * Only the caret is redrawn.
+ */
+void TextField::processAnimationFrame() {
+    const auto now = Clock::now();
+    if(now - this->lastBlink < kBlinkInterval) {
+        return;
+    }
+
+    this->lastBlink = now;
+    this->caretVisible = !this->caretVisible;
+
+    this->needsDisplayInRect(this->getCaretRect());
+}
+
+
+
+/**
+ * @brief Find the start of the character before the given position
+ */
+size_t TextField::PrevCharacter(const std::string_view str, const size_t position) {
+    if(!position) {
+        return 0;
+    }
+
+    auto i = std::min(position, str.size()) - 1;
+    while(i && IsContinuationByte(str[i])) {
+        i--;
+    }
+
+    return i;
+}
+
+/**
+ * @brief Find the start of the character after the given position
+ */
+size_t TextField::NextCharacter(const std::string_view str, const size_t position) {
+    if(position >= str.size()) {
+        return str.size();
+    }
+
+    auto i = position + 1;
+    while(i < str.size() && IsContinuationByte(str[i])) {
+        i++;
+    }
+
+    return i;
+}
+
+
+
+/**
+ * @brief Get the memory footprint of the text field
+ *
+ * This includes the text, and the cached character positions.
+ */
+size_t TextField::getMemoryFootprint() const {
+    return Widget::getMemoryFootprint() + (sizeof(TextField) - sizeof(Widget)) +
+        this->text.capacity() + (this->stops.capacity() * sizeof(CaretStop));
+}
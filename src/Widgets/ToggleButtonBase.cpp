@@ -1,7 +1,6 @@
 #include <cmath>
 
 #include <cairo.h>
-#include <pango/pangocairo.h>
 
 #include "CairoHelpers.h"
 #include "Util.h"
@@ -14,11 +13,23 @@ using namespace shittygui::widgets;
  */
 ToggleButtonBase::~ToggleButtonBase() {
     if(this->fontDesc) {
-        pango_font_description_free(this->fontDesc);
+        ReleaseFont(this->fontDesc);
         this->fontDesc = nullptr;
     }
 }
 
+/**
+ * @brief Release the text rendering resources
+ *
+ * The label and font are marked as dirty, so they're re-applied when the layout is next created.
+ */
+void ToggleButtonBase::releaseResources() {
+    this->releaseTextResources();
+
+    this->labelDirty = this->label.has_value();
+    this->fontDirty = (this->fontDesc != nullptr);
+}
+
 /**
  * @brief Draw the button label
  *
@@ -61,7 +72,7 @@ void ToggleButtonBase::updateTextLayout() {
     }
 
     if(this->fontDirty) {
-        pango_layout_set_font_description(this->layout, this->fontDesc);
+        this->setTextFont(this->fontDesc);
         this->fontDirty = false;
     }
 }
@@ -73,8 +84,11 @@ void ToggleButtonBase::updateTextLayout() {
  * @param size Font size, in points
  */
 void ToggleButtonBase::setFont(const std::string_view name, const double size) {
+    if(this->hasTextResources()) {
+        this->setTextFont(nullptr);
+    }
     if(this->fontDesc) {
-        pango_font_description_free(this->fontDesc);
+        ReleaseFont(this->fontDesc);
     }
 
     this->fontDesc = this->getFont(name, size);
@@ -112,3 +126,87 @@ bool ToggleButtonBase::handleTouchEvent(const event::Touch &event) {
 
     return true;
 }
+
+/**
+ * @brief Handle a button event
+ *
+ * When the toggle button is focused, releasing the select button toggles it, the same as a touch.
+ */
+bool ToggleButtonBase::handleButtonEvent(const event::Button &event) {
+    if(event.type != event::Button::Select) {
+        return false;
+    }
+
+    this->selected = event.isDown;
+    this->needsDisplay();
+
+    if(!event.isDown) {
+        this->updateStateFromTouch();
+
+        if(this->pushCallback) {
+            (*this->pushCallback)(this->shared_from_this());
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Get the memory footprint of the toggle button
+ *
+ * This includes the label string, if any.
+ */
+size_t ToggleButtonBase::getMemoryFootprint() const {
+    size_t total = Widget::getMemoryFootprint() + (sizeof(ToggleButtonBase) - sizeof(Widget));
+
+    if(this->label) {
+        total += this->label->capacity();
+    }
+
+    return total;
+}
+
+
+
+/**
+ * @brief Write the toggle button's properties to an archive
+ */
+void ToggleButtonBase::encode(ArchiveEncoder &encoder) const {
+    encoder.addBool(ArchiveKey::Checked, this->checked);
+    encoder.addBool(ArchiveKey::CheckAreaTouchOnly, this->touchInsideCheckOnly);
+
+    if(this->label.has_value()) {
+        encoder.addString(ArchiveKey::Text, *this->label);
+    }
+    EncodeFont(encoder, ArchiveKey::Font, this->fontDesc);
+    encoder.addColor(ArchiveKey::TextColor, this->textColor);
+
+    Widget::encode(encoder);
+}
+
+/**
+ * @brief Apply a property read from an archive
+ */
+bool ToggleButtonBase::decode(const ArchiveValue &value) {
+    switch(value.getKey()) {
+        case ArchiveKey::Checked:
+            this->setChecked(value.getBool());
+            return true;
+        case ArchiveKey::CheckAreaTouchOnly:
+            this->setCheckAreaTouchOnly(value.getBool());
+            return true;
+        case ArchiveKey::Text:
+            this->setLabel(value.getString());
+            return true;
+        case ArchiveKey::Font:
+            this->setFont(value.getString(), value.getFontSize());
+            return true;
+        case ArchiveKey::TextColor:
+            this->setTextColor(value.getColor());
+            return true;
+
+        default:
+            return Widget::decode(value);
+    }
+}
@@ -0,0 +1,181 @@
+/**
+ * @file
+ *
+ * @brief Content hashing tests
+ *
+ * Checks that the screen skips redrawing widgets that are invalidated without their draw state
+ * changing, but still draws widgets that moved since they were last drawn. It exits with a nonzero
+ * status if any check fails.
+ */
+#include <shittygui/Screen.h>
+#include <shittygui/Types.h>
+#include <shittygui/ViewController.h>
+#include <shittygui/Widget.h>
+#include <shittygui/Widgets/Button.h>
+#include <shittygui/Widgets/Container.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using namespace shittygui;
+
+/// Number of failed checks
+static size_t gFailures{0};
+
+/**
+ * @brief Verify a condition, and record a failure if it doesn't hold
+ */
+#define CHECK(cond) do { \
+    if(!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        gFailures++; \
+    } \
+} while(0)
+
+/**
+ * @brief View controller with a plain container as its root widget
+ */
+class TestViewController: public ViewController {
+    public:
+        TestViewController(const Size &size) {
+            this->root = MakeWidget<widgets::Container>({0, 0}, size);
+        }
+
+        std::shared_ptr<Widget> &getWidget() override {
+            return this->root;
+        }
+
+    private:
+        std::shared_ptr<Widget> root;
+};
+
+
+
+/**
+ * @brief Test whether every pixel of a rectangle is covered by the damaged regions
+ */
+static bool IsDamaged(const std::vector<Rect> &damage, const Rect &rect) {
+    for(int32_t y = rect.origin.y; y < rect.bottom(); y++) {
+        for(int32_t x = rect.origin.x; x < rect.right(); x++) {
+            bool hit{false};
+            for(const auto &region : damage) {
+                if(x >= region.origin.x && x < region.right() &&
+                        y >= region.origin.y && y < region.bottom()) {
+                    hit = true;
+                    break;
+                }
+            }
+
+            if(!hit) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+
+/**
+ * @brief A widget that moves is drawn at its new location, even if its draw state is unchanged
+ *
+ * Moving focus updates the screen geometry of all focusable widgets before the next redraw, so
+ * the move can't be detected from the widget's geometry alone.
+ */
+static void TestMovedWidget() {
+    constexpr static const Size kScreenSize{100, 100};
+    constexpr static const Size kButtonSize{40, 20};
+    constexpr static const Point kNewOrigin{50, 60};
+
+    auto screen = std::make_shared<Screen>(Screen::PixelFormat::ARGB32, kScreenSize);
+    screen->setContentHashing(true);
+
+    auto vc = std::make_shared<TestViewController>(kScreenSize);
+    screen->setRootViewController(vc);
+
+    auto first = MakeWidget<widgets::Button>({0, 0}, kButtonSize, widgets::Button::Type::Push);
+    auto moved = MakeWidget<widgets::Button>({0, 40}, kButtonSize, widgets::Button::Type::Push);
+    vc->getWidget()->addChild(first);
+    vc->getWidget()->addChild(moved);
+
+    screen->setFirstResponder(first);
+    screen->redraw();
+
+    // the first invalidation after the full redraw records the draw state
+    moved->needsDisplay();
+    screen->redraw();
+
+    // so invalidating it again without any changes is skipped
+    const auto skipped = screen->getFrameStats().skippedUpdates;
+    moved->needsDisplay();
+    screen->redraw();
+
+    CHECK(screen->getFrameStats().skippedUpdates == skipped + 1);
+    CHECK(screen->getLastDamage().empty());
+
+    /*
+     * Move the widget, then move focus: the first responder stays the same (it's the first
+     * widget) but the focus engine brings the geometry of all focusable widgets up to date.
+     */
+    moved->setFrameOrigin(kNewOrigin);
+    screen->moveFocus(-1);
+    screen->redraw();
+
+    CHECK(screen->getFrameStats().skippedUpdates == skipped + 1);
+    CHECK(IsDamaged(screen->getLastDamage(), Rect(kNewOrigin, kButtonSize)));
+    CHECK(IsDamaged(screen->getLastDamage(), Rect({0, 40}, kButtonSize)));
+
+    // once drawn at its new location, it can be skipped again
+    moved->needsDisplay();
+    screen->redraw();
+
+    CHECK(screen->getFrameStats().skippedUpdates == skipped + 2);
+}
+
+/**
+ * @brief A widget that's shown again is drawn, even if its draw state is unchanged
+ */
+static void TestShownWidget() {
+    constexpr static const Size kScreenSize{100, 100};
+    constexpr static const Point kOrigin{10, 10};
+    constexpr static const Size kButtonSize{40, 20};
+
+    auto screen = std::make_shared<Screen>(Screen::PixelFormat::ARGB32, kScreenSize);
+    screen->setContentHashing(true);
+
+    auto vc = std::make_shared<TestViewController>(kScreenSize);
+    screen->setRootViewController(vc);
+
+    auto button = MakeWidget<widgets::Button>(kOrigin, kButtonSize, widgets::Button::Type::Push);
+    vc->getWidget()->addChild(button);
+
+    screen->redraw();
+    button->needsDisplay();
+    screen->redraw();
+
+    button->setHidden(true);
+    screen->redraw();
+    CHECK(IsDamaged(screen->getLastDamage(), Rect(kOrigin, kButtonSize)));
+
+    button->setHidden(false);
+    screen->redraw();
+    CHECK(IsDamaged(screen->getLastDamage(), Rect(kOrigin, kButtonSize)));
+}
+
+
+
+int main(int, const char **) {
+    TestMovedWidget();
+    TestShownWidget();
+
+    if(gFailures) {
+        fprintf(stderr, "%zu check(s) failed\n", gFailures);
+        return EXIT_FAILURE;
+    }
+
+    puts("all checks passed");
+    return EXIT_SUCCESS;
+}
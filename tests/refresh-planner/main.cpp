@@ -0,0 +1,225 @@
+/**
+ * @file
+ *
+ * @brief Refresh planner tests
+ *
+ * Checks the transfers planned for a few damage patterns: alignment of damaged regions to the
+ * panel's requirements, merging of adjacent regions, splitting of large transfers, and the limit
+ * on the number of transfers. It exits with a nonzero status if any check fails.
+ */
+#include <shittygui/RefreshPlanner.h>
+#include <shittygui/Types.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+using namespace shittygui;
+
+/// Number of failed checks
+static size_t gFailures{0};
+
+/**
+ * @brief Verify a condition, and record a failure if it doesn't hold
+ */
+#define CHECK(cond) do { \
+    if(!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        gFailures++; \
+    } \
+} while(0)
+
+
+
+/**
+ * @brief Test whether two rectangles are identical
+ */
+static bool Equal(const Rect &a, const Rect &b) {
+    return a.origin.x == b.origin.x && a.origin.y == b.origin.y &&
+        a.size.width == b.size.width && a.size.height == b.size.height;
+}
+
+/**
+ * @brief Test whether every pixel of the damaged regions is covered by exactly one transfer
+ */
+static bool CoversOnce(const std::vector<Rect> &damage, const std::vector<Rect> &transfers) {
+    for(const auto &rect : damage) {
+        for(int32_t y = rect.origin.y; y < rect.bottom(); y++) {
+            for(int32_t x = rect.origin.x; x < rect.right(); x++) {
+                size_t hits{0};
+                for(const auto &transfer : transfers) {
+                    if(x >= transfer.origin.x && x < transfer.right() &&
+                            y >= transfer.origin.y && y < transfer.bottom()) {
+                        hits++;
+                    }
+                }
+
+                if(hits != 1) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Test whether transfers are in scan order (top to bottom, then left to right)
+ */
+static bool IsScanOrder(const std::vector<Rect> &transfers) {
+    for(size_t i = 1; i < transfers.size(); i++) {
+        const auto &a = transfers[i - 1], &b = transfers[i];
+        if(a.origin.y > b.origin.y || (a.origin.y == b.origin.y && a.origin.x >= b.origin.x)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+/**
+ * @brief Damaged regions are expanded to the panel's alignment, and clipped to its bounds
+ */
+static void TestAlignment() {
+    RefreshPlanner::CostModel model;
+    model.alignX = 8;
+    model.alignY = 4;
+
+    RefreshPlanner planner({100, 50}, model);
+
+    const auto &inside = planner.plan({Rect({3, 5}, {10, 2})});
+    CHECK(inside.size() == 1);
+    CHECK(inside.size() == 1 && Equal(inside[0], Rect({0, 4}, {16, 4})));
+
+    const auto &edge = planner.plan({Rect({95, 48}, {20, 10})});
+    CHECK(edge.size() == 1);
+    CHECK(edge.size() == 1 && Equal(edge[0], Rect({88, 48}, {12, 2})));
+
+    const auto &outside = planner.plan({Rect({120, 10}, {10, 10})});
+    CHECK(outside.empty());
+
+    // panels that only take entire rows
+    model.fullRows = true;
+    RefreshPlanner rows({100, 50}, model);
+
+    const auto &full = rows.plan({Rect({40, 9}, {5, 5})});
+    CHECK(full.size() == 1);
+    CHECK(full.size() == 1 && Equal(full[0], Rect({0, 8}, {100, 8})));
+
+    // alignment must be nonzero
+    model.alignX = 0;
+
+    bool threw{false};
+    try {
+        RefreshPlanner invalid({100, 50}, model);
+    } catch(const std::invalid_argument &) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+/**
+ * @brief Adjacent regions are merged when that's cheaper, and overlaps are transferred once
+ */
+static void TestMerging() {
+    RefreshPlanner::CostModel model;
+    model.perTransfer = 1000;
+
+    RefreshPlanner expensive({100, 100}, model);
+
+    const std::vector<Rect> adjacent{Rect({0, 0}, {10, 10}), Rect({10, 0}, {10, 10})};
+    const auto &merged = expensive.plan(adjacent);
+    CHECK(merged.size() == 1);
+    CHECK(merged.size() == 1 && Equal(merged[0], Rect({0, 0}, {20, 10})));
+    CHECK(expensive.getStats().regions == 2);
+    CHECK(expensive.getStats().cost <= expensive.getStats().naiveCost);
+
+    // with free transfers, distant regions are left alone
+    model.perTransfer = 0;
+    RefreshPlanner cheap({100, 100}, model);
+
+    const std::vector<Rect> distant{Rect({0, 0}, {10, 10}), Rect({50, 50}, {10, 10})};
+    const auto &separate = cheap.plan(distant);
+    CHECK(separate.size() == 2);
+    CHECK(cheap.getStats().pixels == 200);
+    CHECK(CoversOnce(distant, separate));
+
+    // overlapping regions don't transfer the overlap twice
+    const std::vector<Rect> overlapping{Rect({0, 0}, {10, 10}), Rect({5, 0}, {10, 10})};
+    const auto &disjoint = cheap.plan(overlapping);
+    CHECK(cheap.getStats().pixels == 150);
+    CHECK(CoversOnce(overlapping, disjoint));
+}
+
+/**
+ * @brief Transfers larger than the maximum transfer size are split into bands
+ */
+static void TestSplitting() {
+    RefreshPlanner::CostModel model;
+    model.maxTransferPixels = 1000;
+
+    RefreshPlanner planner({100, 100}, model);
+
+    const std::vector<Rect> damage{Rect({0, 0}, {100, 25})};
+    const auto &bands = planner.plan(damage);
+    CHECK(bands.size() == 3);
+    CHECK(bands.size() == 3 && Equal(bands[0], Rect({0, 0}, {100, 10})) &&
+            Equal(bands[1], Rect({0, 10}, {100, 10})) && Equal(bands[2], Rect({0, 20}, {100, 5})));
+    CHECK(IsScanOrder(bands));
+
+    // a single row exceeding the limit is split into columns too
+    model.maxTransferPixels = 50;
+    RefreshPlanner narrow({100, 100}, model);
+
+    const auto &tiles = narrow.plan(damage);
+    CHECK(tiles.size() == 50);
+    for(const auto &tile : tiles) {
+        CHECK(tile.area() <= 50);
+    }
+    CHECK(CoversOnce(damage, tiles));
+    CHECK(IsScanOrder(tiles));
+}
+
+/**
+ * @brief The number of transfers is capped, even if merging is more expensive
+ */
+static void TestMaxTransfers() {
+    RefreshPlanner::CostModel model;
+    model.maxTransfers = 2;
+
+    RefreshPlanner planner({100, 100}, model);
+
+    const std::vector<Rect> damage{Rect({0, 0}, {5, 5}), Rect({90, 0}, {5, 5}),
+        Rect({0, 90}, {5, 5}), Rect({90, 90}, {5, 5}), Rect({45, 45}, {5, 5})};
+    const auto &transfers = planner.plan(damage);
+    CHECK(transfers.size() <= 2);
+    CHECK(planner.getStats().transfers == transfers.size());
+    CHECK(CoversOnce(damage, transfers));
+    CHECK(IsScanOrder(transfers));
+
+    // without a cap, they stay separate
+    model.maxTransfers = 0;
+    RefreshPlanner uncapped({100, 100}, model);
+    CHECK(uncapped.plan(damage).size() == damage.size());
+}
+
+
+
+int main(int, const char **) {
+    TestAlignment();
+    TestMerging();
+    TestSplitting();
+    TestMaxTransfers();
+
+    if(gFailures) {
+        fprintf(stderr, "%zu check(s) failed\n", gFailures);
+        return EXIT_FAILURE;
+    }
+
+    puts("all checks passed");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file
+ *
+ * @brief Frame recording decoder
+ *
+ * Reconstructs all frames of a recording made with FrameRecorder, and writes them out as PNG
+ * files (named by frame index) to an output directory.
+ */
+#include <shittygui/FrameRecorder.h>
+#include <shittygui/Screen.h>
+
+#include <cairo.h>
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <vector>
+
+/**
+ * @brief Get the Cairo pixel format for a recording
+ */
+static cairo_format_t ConvertPixelFormat(const shittygui::Screen::PixelFormat format) {
+    using PixelFormat = shittygui::Screen::PixelFormat;
+
+    switch(format) {
+        case PixelFormat::ARGB32:
+            return CAIRO_FORMAT_ARGB32;
+        case PixelFormat::RGB24:
+            return CAIRO_FORMAT_RGB24;
+        case PixelFormat::RGB16:
+            return CAIRO_FORMAT_RGB16_565;
+        case PixelFormat::RGB30:
+            return CAIRO_FORMAT_RGB30;
+    }
+
+    return CAIRO_FORMAT_INVALID;
+}
+
+/**
+ * @brief Write the current frame of the recording to a PNG file
+ */
+static bool WriteFrame(const shittygui::FrameRecording &rec, const std::filesystem::path &path) {
+    const auto size = rec.getSize();
+    const auto format = ConvertPixelFormat(rec.getPixelFormat());
+
+    // copy into a buffer with a stride that Cairo accepts
+    const auto stride = cairo_format_stride_for_width(format, size.width);
+    std::vector<unsigned char> pixels(stride * size.height);
+
+    const auto frame = rec.getFrame();
+    for(size_t y = 0; y < size.height; y++) {
+        std::memcpy(pixels.data() + (y * stride), frame.data() + (y * rec.getStride()),
+                rec.getStride());
+    }
+
+    auto surface = cairo_image_surface_create_for_data(pixels.data(), format, size.width,
+            size.height, stride);
+    const auto status = cairo_surface_write_to_png(surface, path.native().c_str());
+    cairo_surface_destroy(surface);
+
+    return status == CAIRO_STATUS_SUCCESS;
+}
+
+int main(const int argc, const char **argv) {
+    if(argc != 3) {
+        fprintf(stderr, "usage: %s [recording] [output directory]\n", argv[0]);
+        return 1;
+    }
+
+    const std::filesystem::path outDir(argv[2]);
+
+    try {
+        std::filesystem::create_directories(outDir);
+
+        shittygui::FrameRecording rec(argv[1]);
+        const auto size = rec.getSize();
+        printf("recording: %ux%u, format %u\n", size.width, size.height,
+                static_cast<unsigned int>(rec.getPixelFormat()));
+
+        size_t index{0};
+        while(rec.nextFrame()) {
+            char name[32];
+            snprintf(name, sizeof(name), "%06zu.png", index);
+
+            if(!WriteFrame(rec, outDir / name)) {
+                fprintf(stderr, "failed to write frame %zu\n", index);
+                return 1;
+            }
+
+            printf("%6zu: %10.3f ms, %s, %zu rect(s)\n", index,
+                    rec.getTimestamp().count() / 1'000'000., rec.isKeyframe() ? "key" : "delta",
+                    rec.getDamage().size());
+            index++;
+        }
+
+        printf("decoded %zu frame(s)\n", index);
+    } catch(const std::exception &e) {
+        fprintf(stderr, "failed to decode recording: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}